@@ -100,6 +100,11 @@ public:
   virtual std::vector<TransactionOutputInformation> getTransactionInputs(const Crypto::Hash& transactionHash, uint32_t flags) const = 0;
   virtual void getUnconfirmedTransactions(std::vector<Crypto::Hash>& transactions) const = 0;
   virtual std::vector<TransactionSpentOutputInformation> getSpentOutputs() const = 0;
+  // Unlocked key outputs with amount in [minAmount, maxAmount], ordered by amount and block height.
+  // Outputs unlocked by timestamp follow the ordered ones.
+  virtual size_t getUnlockedOutputsCount(uint64_t minAmount, uint64_t maxAmount) const = 0;
+  // Returns false if index is out of range
+  virtual bool getUnlockedOutput(uint64_t minAmount, uint64_t maxAmount, size_t index, TransactionOutputInformation& output) const = 0;
 };
 
 }
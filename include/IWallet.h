@@ -174,6 +174,8 @@ public:
   virtual size_t transfer(const TransactionParameters& sendingTransaction) = 0;
 
   virtual size_t makeTransaction(const TransactionParameters& sendingTransaction) = 0;
+  // Prepares transactions from distinct outputs, signing them in parallel. They are created as delayed transactions, in order.
+  virtual std::vector<size_t> makeTransactions(const std::vector<TransactionParameters>& sendingTransactions) = 0;
   virtual void commitTransaction(size_t transactionId) = 0;
   virtual void rollbackUncommitedTransaction(size_t transactionId) = 0;
 
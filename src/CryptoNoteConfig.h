@@ -99,6 +99,10 @@ const uint8_t  BLOCK_MINOR_VERSION_1                         =  1;
 
 const size_t   BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT        =  10000;  //by default, blocks ids count in synchronizing
 const size_t   BLOCKS_SYNCHRONIZING_DEFAULT_COUNT            =  100;    //by default, blocks count in blocks downloading
+const size_t   BLOCKS_SYNCHRONIZING_MIN_COUNT                =  1;      //minimal blocks count in one blocks downloading request
+const size_t   BLOCKS_SYNCHRONIZING_MAX_COUNT                =  1000;   //maximal blocks count in one blocks downloading request
+const size_t   BLOCKS_SYNCHRONIZING_TARGET_SIZE              =  4000000; //bytes, desired size of blocks downloading response
+const uint64_t BLOCKS_SYNCHRONIZING_TARGET_TIME              =  2000;   //milliseconds, desired duration of blocks downloading request
 const size_t   COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT         =  1000;
 
 const int      P2P_DEFAULT_PORT                              =  8080;
@@ -0,0 +1,276 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "BlockFilter.h"
+
+#include <algorithm>
+
+#include "Common/int-util.h"
+#include "CachedBlock.h"
+#include "CryptoNoteTools.h"
+#include "TransactionExtra.h"
+#include "Serialization/ISerializer.h"
+#include "Serialization/SerializationOverloads.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+uint64_t readLittleEndian64(const uint8_t* bytes) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < sizeof(value); ++i) {
+    value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+  }
+
+  return value;
+}
+
+uint64_t mix64(uint64_t value) {
+  value ^= value >> 30;
+  value *= 0xbf58476d1ce4e5b9;
+  value ^= value >> 27;
+  value *= 0x94d049bb133111eb;
+  value ^= value >> 31;
+  return value;
+}
+
+// Keys and key images are uniformly distributed already, keying by block hash only decorrelates false positives of different blocks
+uint64_t hashElement(const Crypto::Hash& blockHash, const uint8_t* element) {
+  static_assert(sizeof(Crypto::PublicKey) == sizeof(Crypto::Hash) && sizeof(Crypto::KeyImage) == sizeof(Crypto::Hash), "unexpected key size");
+
+  uint64_t hash = 0;
+  for (size_t offset = 0; offset < sizeof(Crypto::Hash); offset += sizeof(uint64_t)) {
+    hash = mix64(hash ^ readLittleEndian64(element + offset) ^ readLittleEndian64(blockHash.data + offset));
+  }
+
+  return hash;
+}
+
+// maps hash uniformly to [0, range)
+uint64_t reduce(uint64_t hash, uint64_t range) {
+  uint64_t high;
+  mul128(hash, range, &high);
+  return high;
+}
+
+std::vector<uint64_t> hashElements(const Crypto::Hash& blockHash, uint64_t range, const std::vector<Crypto::PublicKey>& transactionPublicKeys,
+  const std::vector<Crypto::KeyImage>& keyImages) {
+  std::vector<uint64_t> values;
+  values.reserve(transactionPublicKeys.size() + keyImages.size());
+  for (const auto& key : transactionPublicKeys) {
+    values.push_back(reduce(hashElement(blockHash, key.data), range));
+  }
+
+  for (const auto& keyImage : keyImages) {
+    values.push_back(reduce(hashElement(blockHash, keyImage.data), range));
+  }
+
+  std::sort(values.begin(), values.end());
+  return values;
+}
+
+class BitWriter {
+public:
+  explicit BitWriter(BinaryArray& data) : data(data), usedBits(8) {
+  }
+
+  void writeBit(bool bit) {
+    if (usedBits == 8) {
+      data.push_back(0);
+      usedBits = 0;
+    }
+
+    if (bit) {
+      data.back() |= static_cast<uint8_t>(0x80 >> usedBits);
+    }
+
+    ++usedBits;
+  }
+
+  void writeBits(uint64_t value, uint8_t count) {
+    while (count > 0) {
+      --count;
+      writeBit(((value >> count) & 1) != 0);
+    }
+  }
+
+private:
+  BinaryArray& data;
+  uint8_t usedBits;
+};
+
+class BitReader {
+public:
+  explicit BitReader(const BinaryArray& data) : data(data), position(0) {
+  }
+
+  bool readBit() {
+    if (position == data.size() * 8) {
+      throw std::runtime_error("Block filter data is truncated");
+    }
+
+    bool bit = ((data[position / 8] << (position % 8)) & 0x80) != 0;
+    ++position;
+    return bit;
+  }
+
+  uint64_t readBits(uint8_t count) {
+    uint64_t value = 0;
+    while (count > 0) {
+      --count;
+      value = (value << 1) | (readBit() ? 1 : 0);
+    }
+
+    return value;
+  }
+
+private:
+  const BinaryArray& data;
+  size_t position;
+};
+
+void collectElements(const TransactionPrefix& transaction, std::vector<Crypto::PublicKey>& transactionPublicKeys,
+  std::vector<Crypto::KeyImage>& keyImages) {
+  Crypto::PublicKey transactionPublicKey = getTransactionPublicKeyFromExtra(transaction.extra);
+  if (transactionPublicKey != NULL_PUBLIC_KEY) {
+    transactionPublicKeys.push_back(transactionPublicKey);
+  }
+
+  for (const auto& input : transaction.inputs) {
+    if (input.type() == typeid(KeyInput)) {
+      keyImages.push_back(boost::get<KeyInput>(input).keyImage);
+    }
+  }
+}
+
+}
+
+BlockFilter::BlockFilter() : blockHash(NULL_HASH), elementCount(0) {
+}
+
+BlockFilter::BlockFilter(const Crypto::Hash& blockHash, const std::vector<Crypto::PublicKey>& transactionPublicKeys,
+  const std::vector<Crypto::KeyImage>& keyImages) :
+  blockHash(blockHash), elementCount(static_cast<uint32_t>(transactionPublicKeys.size() + keyImages.size())) {
+
+  std::vector<uint64_t> values = hashElements(blockHash, getRange(), transactionPublicKeys, keyImages);
+
+  BitWriter writer(data);
+  uint64_t previous = 0;
+  for (uint64_t value : values) {
+    uint64_t delta = value - previous;
+    for (uint64_t quotient = delta >> REMAINDER_BITS; quotient > 0; --quotient) {
+      writer.writeBit(true);
+    }
+
+    writer.writeBit(false);
+    writer.writeBits(delta, REMAINDER_BITS);
+    previous = value;
+  }
+}
+
+BlockFilter BlockFilter::fromTransactions(const Crypto::Hash& blockHash, const Transaction& baseTransaction,
+  const std::vector<CachedTransaction>& transactions) {
+  std::vector<Crypto::PublicKey> transactionPublicKeys;
+  std::vector<Crypto::KeyImage> keyImages;
+
+  collectElements(baseTransaction, transactionPublicKeys, keyImages);
+  for (const auto& transaction : transactions) {
+    collectElements(transaction.getTransaction(), transactionPublicKeys, keyImages);
+  }
+
+  return BlockFilter(blockHash, transactionPublicKeys, keyImages);
+}
+
+BlockFilter BlockFilter::fromRawBlock(const RawBlock& rawBlock) {
+  BlockTemplate block;
+  if (!fromBinaryArray(block, rawBlock.block)) {
+    throw std::runtime_error("Couldn't deserialize block for block filter");
+  }
+
+  std::vector<Crypto::PublicKey> transactionPublicKeys;
+  std::vector<Crypto::KeyImage> keyImages;
+
+  collectElements(block.baseTransaction, transactionPublicKeys, keyImages);
+  for (const auto& rawTransaction : rawBlock.transactions) {
+    Transaction transaction;
+    if (!fromBinaryArray(transaction, rawTransaction)) {
+      throw std::runtime_error("Couldn't deserialize transaction for block filter");
+    }
+
+    collectElements(transaction, transactionPublicKeys, keyImages);
+  }
+
+  return BlockFilter(CachedBlock(block).getBlockHash(), transactionPublicKeys, keyImages);
+}
+
+const Crypto::Hash& BlockFilter::getBlockHash() const {
+  return blockHash;
+}
+
+uint32_t BlockFilter::getElementCount() const {
+  return elementCount;
+}
+
+const BinaryArray& BlockFilter::getData() const {
+  return data;
+}
+
+bool BlockFilter::matchAny(const std::vector<Crypto::PublicKey>& transactionPublicKeys, const std::vector<Crypto::KeyImage>& keyImages) const {
+  if (elementCount == 0) {
+    return false;
+  }
+
+  std::vector<uint64_t> queries = hashElements(blockHash, getRange(), transactionPublicKeys, keyImages);
+  if (queries.empty()) {
+    return false;
+  }
+
+  BitReader reader(data);
+  auto query = queries.begin();
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < elementCount; ++i) {
+    uint64_t quotient = 0;
+    while (reader.readBit()) {
+      ++quotient;
+    }
+
+    value += (quotient << REMAINDER_BITS) | reader.readBits(REMAINDER_BITS);
+
+    while (*query < value) {
+      if (++query == queries.end()) {
+        return false;
+      }
+    }
+
+    if (*query == value) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void BlockFilter::serialize(ISerializer& s) {
+  s(blockHash, "block_hash");
+  s(elementCount, "element_count");
+  serializeAsBinary(data, "data", s);
+}
+
+uint64_t BlockFilter::getRange() const {
+  return static_cast<uint64_t>(elementCount) * INVERSE_FALSE_POSITIVE_RATE;
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <vector>
+
+#include "CachedTransaction.h"
+#include "CryptoNote.h"
+
+namespace CryptoNote {
+
+class ISerializer;
+
+// Compact filter over transaction public keys and key images of a block, encoded as a Golomb-coded set.
+// Matching never misses an element of the block, an absent element matches with probability about 1 / INVERSE_FALSE_POSITIVE_RATE.
+class BlockFilter {
+public:
+  static const uint8_t REMAINDER_BITS = 19;
+  static const uint64_t INVERSE_FALSE_POSITIVE_RATE = 784931;
+
+  BlockFilter();
+  BlockFilter(const Crypto::Hash& blockHash, const std::vector<Crypto::PublicKey>& transactionPublicKeys,
+    const std::vector<Crypto::KeyImage>& keyImages);
+
+  static BlockFilter fromTransactions(const Crypto::Hash& blockHash, const Transaction& baseTransaction,
+    const std::vector<CachedTransaction>& transactions);
+  static BlockFilter fromRawBlock(const RawBlock& rawBlock);
+
+  const Crypto::Hash& getBlockHash() const;
+  uint32_t getElementCount() const;
+  const BinaryArray& getData() const;
+
+  // true if any of the keys may belong to the block, throws std::runtime_error if the filter data is malformed
+  bool matchAny(const std::vector<Crypto::PublicKey>& transactionPublicKeys, const std::vector<Crypto::KeyImage>& keyImages) const;
+
+  void serialize(ISerializer& s);
+
+private:
+  Crypto::Hash blockHash;
+  uint32_t elementCount;
+  BinaryArray data;
+
+  uint64_t getRange() const;
+};
+
+}
@@ -0,0 +1,105 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "BlockMiningHasher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "CachedBlock.h"
+
+namespace CryptoNote {
+
+namespace {
+
+BinaryArray getBlockLongHashingBlob(const BlockTemplate& block, uint32_t nonce) {
+  BlockTemplate blockWithNonce = block;
+  blockWithNonce.nonce = nonce;
+  return CachedBlock(blockWithNonce).getBlockLongHashingBinaryArray();
+}
+
+}
+
+BlockMiningHasher::BlockMiningHasher(size_t ways) : nonceOffset(0) {
+  if (ways == 0) {
+    throw std::invalid_argument("BlockMiningHasher needs at least one way");
+  }
+
+  for (size_t i = 0; i < ways; ++i) {
+    contexts.emplace_back(new Crypto::cn_context());
+    contextPointers.push_back(contexts.back().get());
+  }
+}
+
+size_t BlockMiningHasher::getWays() const {
+  return contexts.size();
+}
+
+Crypto::cn_pages BlockMiningHasher::getPages() const {
+  Crypto::cn_pages pages = Crypto::cn_pages::huge;
+  for (auto& context : contexts) {
+    pages = std::min(pages, context->pages());
+  }
+
+  return pages;
+}
+
+void BlockMiningHasher::setBlock(const BlockTemplate& block) {
+  // nonce is written as raw 4 bytes into hashing blob of every block version, its offset is found by
+  // serializing the blob with two nonces which differ in every byte
+  BinaryArray zeroNonceBlob = getBlockLongHashingBlob(block, 0);
+  BinaryArray fullNonceBlob = getBlockLongHashingBlob(block, UINT32_MAX);
+  if (zeroNonceBlob.size() != fullNonceBlob.size() || zeroNonceBlob.size() < sizeof(uint32_t)) {
+    throw std::runtime_error("Nonce isn't found in block hashing blob");
+  }
+
+  size_t offset = 0;
+  while (offset < zeroNonceBlob.size() && zeroNonceBlob[offset] == fullNonceBlob[offset]) {
+    ++offset;
+  }
+
+  if (offset + sizeof(uint32_t) > zeroNonceBlob.size() ||
+    !std::equal(zeroNonceBlob.begin() + offset + sizeof(uint32_t), zeroNonceBlob.end(), fullNonceBlob.begin() + offset + sizeof(uint32_t))) {
+    throw std::runtime_error("Nonce isn't found in block hashing blob");
+  }
+
+  nonceOffset = offset;
+  blobs.assign(contexts.size(), zeroNonceBlob);
+  blobPointers.clear();
+  blobSizes.clear();
+  for (auto& blob : blobs) {
+    blobPointers.push_back(blob.data());
+    blobSizes.push_back(blob.size());
+  }
+}
+
+void BlockMiningHasher::hash(const uint32_t* nonces, Crypto::Hash* hashes) {
+  if (blobs.empty()) {
+    throw std::runtime_error("Block isn't set");
+  }
+
+  for (size_t i = 0; i < blobs.size(); ++i) {
+    std::memcpy(&blobs[i][nonceOffset], &nonces[i], sizeof(uint32_t));
+  }
+
+  // cn_slow_hash_multi splits the inputs by the way count of the CPU
+  Crypto::cn_slow_hash_multi(contextPointers.data(), blobPointers.data(), blobSizes.data(), hashes, blobs.size());
+}
+
+}
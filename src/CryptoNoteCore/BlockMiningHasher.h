@@ -0,0 +1,53 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "CryptoNote.h"
+#include "crypto/hash.h"
+
+namespace CryptoNote {
+
+// Computes long hashes of a block template for different nonces. Hashing blob is serialized once per
+// template and only the nonce is patched in it, several nonces are hashed at once with Crypto::cn_slow_hash_multi.
+class BlockMiningHasher {
+public:
+  explicit BlockMiningHasher(size_t ways = Crypto::cn_slow_hash_get_multi_ways());
+
+  // number of nonces hashed by one hash() call
+  size_t getWays() const;
+  // the least efficient pages among the scratchpads
+  Crypto::cn_pages getPages() const;
+
+  void setBlock(const BlockTemplate& block);
+  // nonces and hashes have getWays() elements
+  void hash(const uint32_t* nonces, Crypto::Hash* hashes);
+
+private:
+  std::vector<std::unique_ptr<Crypto::cn_context>> contexts;
+  std::vector<Crypto::cn_context*> contextPointers;
+  std::vector<BinaryArray> blobs;
+  std::vector<const void*> blobPointers;
+  std::vector<size_t> blobSizes;
+  size_t nonceOffset;
+};
+
+}
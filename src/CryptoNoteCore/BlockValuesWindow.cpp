@@ -0,0 +1,219 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "BlockValuesWindow.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "Common/Math.h"
+
+namespace CryptoNote {
+
+namespace {
+
+// reading a few values directly is cheaper than keeping a window for them
+const size_t MIN_WINDOW_COUNT = 16;
+
+}
+
+BlockValuesWindow::BlockValuesWindow(size_t count, UseGenesis useGenesis) :
+  count(count), useGenesis(useGenesis), valid(false), topBlockIndex(0) {
+}
+
+size_t BlockValuesWindow::getCount() const {
+  return count;
+}
+
+bool BlockValuesWindow::usesGenesis() const {
+  return useGenesis;
+}
+
+void BlockValuesWindow::moveTo(uint32_t blockIndex, const ValuesReader& reader) {
+  if (valid && blockIndex == topBlockIndex) {
+    return;
+  }
+
+  if (valid && blockIndex > topBlockIndex && blockIndex - topBlockIndex < count) {
+    // added blocks can't be genesis one
+    auto addedValues = reader(blockIndex - topBlockIndex, blockIndex, UseGenesis(true));
+    assert(addedValues.size() == blockIndex - topBlockIndex);
+    for (auto value : addedValues) {
+      pushBack(value);
+    }
+
+    size_t windowSize = getWindowSize(blockIndex);
+    while (values.size() > windowSize) {
+      popFront();
+    }
+
+    topBlockIndex = blockIndex;
+    return;
+  }
+
+  clear();
+  for (auto value : reader(count, blockIndex, UseGenesis(useGenesis))) {
+    pushBack(value);
+  }
+
+  assert(values.size() == getWindowSize(blockIndex));
+  topBlockIndex = blockIndex;
+  valid = true;
+}
+
+std::vector<uint64_t> BlockValuesWindow::getValues() const {
+  assert(valid);
+  return std::vector<uint64_t>(values.begin(), values.end());
+}
+
+uint64_t BlockValuesWindow::getMedian() const {
+  assert(valid);
+  if (lowerHalf.empty()) {
+    return 0;
+  }
+
+  if (lowerHalf.size() > upperHalf.size()) {
+    return *lowerHalf.rbegin();
+  }
+
+  return (*lowerHalf.rbegin() + *upperHalf.begin()) / 2;
+}
+
+void BlockValuesWindow::invalidateFrom(uint32_t blockIndex) {
+  if (valid && topBlockIndex >= blockIndex) {
+    clear();
+  }
+}
+
+size_t BlockValuesWindow::getWindowSize(uint32_t blockIndex) const {
+  if (static_cast<size_t>(blockIndex) + 1 > count) {
+    return count;
+  }
+
+  return useGenesis ? blockIndex + 1 : blockIndex;
+}
+
+void BlockValuesWindow::pushBack(uint64_t value) {
+  values.push_back(value);
+  if (lowerHalf.empty() || value <= *lowerHalf.rbegin()) {
+    lowerHalf.insert(value);
+  } else {
+    upperHalf.insert(value);
+  }
+
+  balance();
+}
+
+void BlockValuesWindow::popFront() {
+  assert(!values.empty());
+  uint64_t value = values.front();
+  values.pop_front();
+
+  if (value <= *lowerHalf.rbegin()) {
+    lowerHalf.erase(lowerHalf.find(value));
+  } else {
+    upperHalf.erase(upperHalf.find(value));
+  }
+
+  balance();
+}
+
+void BlockValuesWindow::balance() {
+  if (lowerHalf.size() > upperHalf.size() + 1) {
+    auto it = std::prev(lowerHalf.end());
+    upperHalf.insert(*it);
+    lowerHalf.erase(it);
+  } else if (upperHalf.size() > lowerHalf.size()) {
+    auto it = upperHalf.begin();
+    lowerHalf.insert(*it);
+    upperHalf.erase(it);
+  }
+}
+
+void BlockValuesWindow::clear() {
+  valid = false;
+  values.clear();
+  lowerHalf.clear();
+  upperHalf.clear();
+}
+
+BlockValuesWindow::ValuesReader makeBlockValuesReader(const IBlockchainCache& cache, std::function<uint64_t(const CachedBlockInfo&)> getValue) {
+  return [&cache, getValue](size_t count, uint32_t blockIndex, UseGenesis useGenesis) {
+    return cache.getLastUnits(count, blockIndex, useGenesis, getValue);
+  };
+}
+
+BlockValuesWindows::BlockValuesWindows(size_t maxWindowsCount) : maxWindowsCount(maxWindowsCount) {
+}
+
+std::vector<uint64_t> BlockValuesWindows::getValues(size_t count, uint32_t blockIndex, UseGenesis useGenesis,
+  const BlockValuesWindow::ValuesReader& reader) {
+  std::unique_lock<std::mutex> lock(mutex);
+  auto window = findWindow(count, useGenesis);
+  if (window == nullptr) {
+    return reader(count, blockIndex, useGenesis);
+  }
+
+  window->moveTo(blockIndex, reader);
+  return window->getValues();
+}
+
+uint64_t BlockValuesWindows::getMedian(size_t count, uint32_t blockIndex, UseGenesis useGenesis,
+  const BlockValuesWindow::ValuesReader& reader) {
+  std::unique_lock<std::mutex> lock(mutex);
+  auto window = findWindow(count, useGenesis);
+  if (window == nullptr) {
+    auto values = reader(count, blockIndex, useGenesis);
+    return Common::medianValue(values);
+  }
+
+  window->moveTo(blockIndex, reader);
+  return window->getMedian();
+}
+
+void BlockValuesWindows::invalidateFrom(uint32_t blockIndex) {
+  std::unique_lock<std::mutex> lock(mutex);
+  for (auto& window : windows) {
+    window.invalidateFrom(blockIndex);
+  }
+}
+
+BlockValuesWindow* BlockValuesWindows::findWindow(size_t count, UseGenesis useGenesis) {
+  if (count < MIN_WINDOW_COUNT || maxWindowsCount == 0) {
+    return nullptr;
+  }
+
+  bool genesis = useGenesis;
+  auto it = std::find_if(windows.begin(), windows.end(), [&](const BlockValuesWindow& window) {
+    return window.getCount() == count && window.usesGenesis() == genesis;
+  });
+
+  if (it != windows.end()) {
+    windows.splice(windows.begin(), windows, it);
+  } else {
+    if (windows.size() == maxWindowsCount) {
+      windows.pop_back();
+    }
+
+    windows.emplace_front(count, useGenesis);
+  }
+
+  return &windows.front();
+}
+
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "IBlockchainCache.h"
+
+namespace CryptoNote {
+
+// Values of a block property (size, timestamp, cumulative difficulty) of the last blocks up to some block, laid out
+// like IBlockchainCache::getLastUnits returns them. The window slides forward as blocks are added or consecutive
+// blocks are queried, so only values of new blocks are read. Values are kept in two ordered halves, sliding costs
+// O(log n) per value and the median is read from the halves' boundary. Not thread safe.
+class BlockValuesWindow {
+public:
+  // reads values like IBlockchainCache::getLastUnits
+  typedef std::function<std::vector<uint64_t>(size_t count, uint32_t blockIndex, UseGenesis useGenesis)> ValuesReader;
+
+  BlockValuesWindow(size_t count, UseGenesis useGenesis);
+
+  size_t getCount() const;
+  bool usesGenesis() const;
+
+  // makes window end at blockIndex
+  void moveTo(uint32_t blockIndex, const ValuesReader& reader);
+  std::vector<uint64_t> getValues() const;
+  // same as Common::medianValue of getValues()
+  uint64_t getMedian() const;
+
+  // blocks starting from blockIndex are removed from the chain
+  void invalidateFrom(uint32_t blockIndex);
+
+private:
+  size_t getWindowSize(uint32_t blockIndex) const;
+  void pushBack(uint64_t value);
+  void popFront();
+  void balance();
+  void clear();
+
+  const size_t count;
+  const bool useGenesis;
+  bool valid;
+  uint32_t topBlockIndex;
+  std::deque<uint64_t> values;
+  // every value of lowerHalf is not greater than any of upperHalf, lowerHalf has the same number of values or one more
+  std::multiset<uint64_t> lowerHalf;
+  std::multiset<uint64_t> upperHalf;
+};
+
+// reads values with cache.getLastUnits
+BlockValuesWindow::ValuesReader makeBlockValuesReader(const IBlockchainCache& cache, std::function<uint64_t(const CachedBlockInfo&)> getValue);
+
+// Windows of one block property over a chain segment, one per requested window size.
+// Const getters of blockchain caches slide the windows, so all access is serialized with a mutex.
+class BlockValuesWindows {
+public:
+  explicit BlockValuesWindows(size_t maxWindowsCount = 4);
+
+  std::vector<uint64_t> getValues(size_t count, uint32_t blockIndex, UseGenesis useGenesis, const BlockValuesWindow::ValuesReader& reader);
+  uint64_t getMedian(size_t count, uint32_t blockIndex, UseGenesis useGenesis, const BlockValuesWindow::ValuesReader& reader);
+
+  void invalidateFrom(uint32_t blockIndex);
+
+private:
+  BlockValuesWindow* findWindow(size_t count, UseGenesis useGenesis);
+
+  const size_t maxWindowsCount;
+  std::mutex mutex;
+  // most recently used first
+  std::list<BlockValuesWindow> windows;
+};
+
+}
@@ -145,6 +145,13 @@ void BlockchainCache::pushBlock(const CachedBlock& cachedBlock,
   doPushBlock(cachedBlock, cachedTransactions, validatorState, blockSize, generatedCoins, blockDifficulty, std::move(rawBlock));
 }
 
+void BlockchainCache::pushBlocks(std::vector<PushedBlock>&& blocks) {
+  for (auto& block : blocks) {
+    doPushBlock(CachedBlock(block.block), block.transactions, block.info.validatorState, block.info.blockSize,
+                block.info.generatedCoins, block.info.blockDifficulty, std::move(block.info.rawBlock));
+  }
+}
+
 void BlockchainCache::doPushBlock(const CachedBlock& cachedBlock,
                                 const std::vector<CachedTransaction>& cachedTransactions,
                                 const TransactionValidatorState& validatorState, size_t blockSize,
@@ -266,6 +273,9 @@ std::unique_ptr<IBlockchainCache> BlockchainCache::split(uint32_t splitBlockInde
   splitTransactions(*newCache, splitBlockIndex);
   splitBlocks(*newCache, splitBlockIndex);
   splitKeyOutputsGlobalIndexes(*newCache, splitBlockIndex);
+  timestampsWindows.invalidateFrom(splitBlockIndex);
+  blockSizesWindows.invalidateFrom(splitBlockIndex);
+  cumulativeDifficultiesWindows.invalidateFrom(splitBlockIndex);
 
   fixChildrenParent(newCache.get());
   newCache->children = children;
@@ -571,6 +581,56 @@ RawBlock BlockchainCache::getBlockByIndex(uint32_t index) const {
   return index < startIndex ? parent->getBlockByIndex(index) : storage->getBlockByIndex(index - startIndex);
 }
 
+std::vector<RawBlock> BlockchainCache::getBlocksByIndexRange(uint32_t rangeStartIndex, uint32_t count) const {
+  assert(count == 0 || rangeStartIndex + count - 1 <= getTopBlockIndex());
+
+  std::vector<RawBlock> blocks;
+  if (rangeStartIndex < startIndex && count != 0) {
+    blocks = parent->getBlocksByIndexRange(rangeStartIndex, std::min(count, startIndex - rangeStartIndex));
+  }
+
+  blocks.reserve(count);
+  for (uint32_t index = std::max(rangeStartIndex, startIndex); index < rangeStartIndex + count; ++index) {
+    blocks.push_back(storage->getBlockByIndex(index - startIndex));
+  }
+
+  return blocks;
+}
+
+std::vector<CachedBlockInfo> BlockchainCache::getBlockInfosByIndexRange(uint32_t rangeStartIndex, uint32_t count) const {
+  assert(count == 0 || rangeStartIndex + count - 1 <= getTopBlockIndex());
+
+  std::vector<CachedBlockInfo> infos;
+  if (rangeStartIndex < startIndex && count != 0) {
+    infos = parent->getBlockInfosByIndexRange(rangeStartIndex, std::min(count, startIndex - rangeStartIndex));
+  }
+
+  infos.reserve(count);
+  auto& blocksIndex = blockInfos.get<BlockIndexTag>();
+  for (uint32_t index = std::max(rangeStartIndex, startIndex); index < rangeStartIndex + count; ++index) {
+    infos.push_back(blocksIndex[index - startIndex]);
+  }
+
+  return infos;
+}
+
+// filters of blocks held in memory are not stored, they are built on request
+std::vector<BlockFilter> BlockchainCache::getBlockFiltersByIndexRange(uint32_t rangeStartIndex, uint32_t count) const {
+  assert(count == 0 || rangeStartIndex + count - 1 <= getTopBlockIndex());
+
+  std::vector<BlockFilter> filters;
+  if (rangeStartIndex < startIndex && count != 0) {
+    filters = parent->getBlockFiltersByIndexRange(rangeStartIndex, std::min(count, startIndex - rangeStartIndex));
+  }
+
+  filters.reserve(count);
+  for (uint32_t index = std::max(rangeStartIndex, startIndex); index < rangeStartIndex + count; ++index) {
+    filters.push_back(BlockFilter::fromRawBlock(storage->getBlockByIndex(index - startIndex)));
+  }
+
+  return filters;
+}
+
 BinaryArray BlockchainCache::getRawTransaction(uint32_t index, uint32_t transactionIndex) const {
   if (index < startIndex) {
     return parent->getRawTransaction(index, transactionIndex);
@@ -904,13 +964,28 @@ std::vector<uint64_t> BlockchainCache::getLastTimestamps(size_t count) const {
 
 std::vector<uint64_t> BlockchainCache::getLastTimestamps(size_t count, uint32_t blockIndex,
                                                          UseGenesis useGenesis) const {
-  return getLastUnits(count, blockIndex, useGenesis, [](const CachedBlockInfo& inf) { return inf.timestamp; });
+  return timestampsWindows.getValues(count, blockIndex, useGenesis,
+                                     makeBlockValuesReader(*this, [](const CachedBlockInfo& inf) { return inf.timestamp; }));
+}
+
+uint64_t BlockchainCache::getLastTimestampsMedian(size_t count, uint32_t blockIndex, UseGenesis useGenesis) const {
+  return timestampsWindows.getMedian(count, blockIndex, useGenesis,
+                                     makeBlockValuesReader(*this, [](const CachedBlockInfo& inf) { return inf.timestamp; }));
 }
 
 std::vector<uint64_t> BlockchainCache::getLastBlocksSizes(size_t count) const {
   return getLastBlocksSizes(count, getTopBlockIndex(), skipGenesisBlock);
 }
 
+uint64_t BlockchainCache::getLastBlocksSizesMedian(size_t count) const {
+  return getLastBlocksSizesMedian(count, getTopBlockIndex(), skipGenesisBlock);
+}
+
+uint64_t BlockchainCache::getLastBlocksSizesMedian(size_t count, uint32_t blockIndex, UseGenesis useGenesis) const {
+  return blockSizesWindows.getMedian(count, blockIndex, useGenesis,
+                                     makeBlockValuesReader(*this, [](const CachedBlockInfo& cb) { return cb.blockSize; }));
+}
+
 std::vector<uint64_t> BlockchainCache::getLastUnits(size_t count, uint32_t blockIndex, UseGenesis useGenesis,
                                                     std::function<uint64_t(const CachedBlockInfo&)> pred) const {
   assert(blockIndex <= getTopBlockIndex());
@@ -938,7 +1013,8 @@ std::vector<uint64_t> BlockchainCache::getLastUnits(size_t count, uint32_t block
 
 std::vector<uint64_t> BlockchainCache::getLastBlocksSizes(size_t count, uint32_t blockIndex,
                                                           UseGenesis useGenesis) const {
-  return getLastUnits(count, blockIndex, useGenesis, [](const CachedBlockInfo& cb) { return cb.blockSize; });
+  return blockSizesWindows.getValues(count, blockIndex, useGenesis,
+                                     makeBlockValuesReader(*this, [](const CachedBlockInfo& cb) { return cb.blockSize; }));
 }
 
 Difficulty BlockchainCache::getDifficultyForNextBlock() const {
@@ -988,8 +1064,8 @@ uint64_t BlockchainCache::getAlreadyGeneratedTransactions(uint32_t blockIndex) c
 
 std::vector<Difficulty> BlockchainCache::getLastCumulativeDifficulties(size_t count, uint32_t blockIndex,
                                                                        UseGenesis useGenesis) const {
-  return getLastUnits(count, blockIndex, useGenesis,
-                      [](const CachedBlockInfo& info) { return info.cumulativeDifficulty; });
+  return cumulativeDifficultiesWindows.getValues(count, blockIndex, useGenesis,
+                                                 makeBlockValuesReader(*this, [](const CachedBlockInfo& info) { return info.cumulativeDifficulty; }));
 }
 
 std::vector<Difficulty> BlockchainCache::getLastCumulativeDifficulties(size_t count) const {
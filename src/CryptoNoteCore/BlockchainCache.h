@@ -32,6 +32,7 @@
 #include "Common/StringView.h"
 #include "Currency.h"
 #include "Difficulty.h"
+#include "BlockValuesWindow.h"
 #include "IBlockchainCache.h"
 
 namespace CryptoNote {
@@ -103,6 +104,7 @@ public:
     uint64_t generatedCoins,
     Difficulty blockDifficulty,
     RawBlock&& rawBlock) override;
+  virtual void pushBlocks(std::vector<PushedBlock>&& blocks) override;
 
   virtual PushedBlockInfo getPushedBlockInfo(uint32_t index) const override;
   bool checkIfSpent(const Crypto::KeyImage& keyImage, uint32_t blockIndex) const override;
@@ -131,6 +133,10 @@ public:
   std::vector<uint64_t> getLastBlocksSizes(size_t count) const override;
   std::vector<uint64_t> getLastBlocksSizes(size_t count, uint32_t blockIndex, UseGenesis) const override;
 
+  uint64_t getLastTimestampsMedian(size_t count, uint32_t blockIndex, UseGenesis) const override;
+  uint64_t getLastBlocksSizesMedian(size_t count) const override;
+  uint64_t getLastBlocksSizesMedian(size_t count, uint32_t blockIndex, UseGenesis) const override;
+
   std::vector<Difficulty> getLastCumulativeDifficulties(size_t count, uint32_t blockIndex, UseGenesis) const override;
   std::vector<Difficulty> getLastCumulativeDifficulties(size_t count) const override;
 
@@ -174,6 +180,9 @@ public:
     std::vector<BinaryArray> &foundTransactions,
     std::vector<Crypto::Hash> &missedTransactions) const override;
   virtual RawBlock getBlockByIndex(uint32_t index) const override;
+  virtual std::vector<RawBlock> getBlocksByIndexRange(uint32_t startIndex, uint32_t count) const override;
+  virtual std::vector<CachedBlockInfo> getBlockInfosByIndexRange(uint32_t startIndex, uint32_t count) const override;
+  virtual std::vector<BlockFilter> getBlockFiltersByIndexRange(uint32_t startIndex, uint32_t count) const override;
   virtual BinaryArray getRawTransaction(uint32_t blockIndex, uint32_t transactionIndex) const override;
   virtual std::vector<Crypto::Hash> getTransactionHashes() const override;
   virtual std::vector<uint32_t> getRandomOutsByAmount(uint64_t amount, size_t count, uint32_t blockIndex) const override;
@@ -283,6 +292,12 @@ private:
   std::unique_ptr<BlockchainStorage> storage;
 
   std::vector<IBlockchainCache*> children;
+
+  // windows over this segment and its parents, invalidated when blocks are split off;
+  // const getters slide them, BlockValuesWindows locks itself
+  mutable BlockValuesWindows timestampsWindows;
+  mutable BlockValuesWindows blockSizesWindows;
+  mutable BlockValuesWindows cumulativeDifficultiesWindows;
  
   void serialize(ISerializer& s);
 
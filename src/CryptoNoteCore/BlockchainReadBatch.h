@@ -22,6 +22,7 @@
 #include "IReadBatch.h"
 #include "CryptoNote.h"
 #include "BlockchainCache.h"
+#include "BlockFilter.h"
 #include "DatabaseCacheData.h"
 
 namespace std {
@@ -68,6 +69,7 @@ struct BlockchainReadState {
   std::unordered_map<std::pair<Crypto::Hash, uint32_t>, Crypto::Hash> transactionHashesByPaymentIds;
   std::unordered_map<uint64_t, std::vector<Crypto::Hash>> blockHashesByTimestamp;
   KeyOutputKeyResult keyOutputKeys;
+  std::unordered_map<uint32_t, BlockFilter> blockFilters;
 
   std::pair<uint32_t, bool> lastBlockIndex = { 0, false };
   std::pair<uint32_t, bool> keyOutputAmountsCount = { {}, false };
@@ -105,6 +107,7 @@ public:
   const std::unordered_map<uint64_t, std::vector<Crypto::Hash> >& getBlockHashesByTimestamp() const;
   const std::pair<uint64_t, bool>& getTransactionsCount() const;
   const KeyOutputKeyResult& getKeyOutputInfo() const;
+  const std::unordered_map<uint32_t, BlockFilter>& getBlockFilters() const;
 
 private:
   BlockchainReadState state;
@@ -133,6 +136,7 @@ public:
   BlockchainReadBatch& requestBlockHashesByTimestamp(uint64_t timestamp);
   BlockchainReadBatch& requestTransactionsCount();
   BlockchainReadBatch& requestKeyOutputInfo(IBlockchainCache::Amount amount, IBlockchainCache::GlobalOutputIndex globalIndex);
+  BlockchainReadBatch& requestBlockFilter(uint32_t blockIndex);
 
   std::vector<std::string> getRawKeys() const override;
   void submitRawResult(const std::vector<std::string>& values, const std::vector<bool>& resultStates) override;
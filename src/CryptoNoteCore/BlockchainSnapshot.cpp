@@ -0,0 +1,711 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "BlockchainSnapshot.h"
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <set>
+#include <unordered_set>
+
+#include <boost/filesystem.hpp>
+
+#include "Common/Math.h"
+#include "Common/ScopeExit.h"
+#include "Common/StringTools.h"
+#include "crypto/hash.h"
+#include "BlockchainReadBatch.h"
+#include "CachedBlock.h"
+#include "CachedTransaction.h"
+#include "Checkpoints.h"
+#include "CryptoNoteTools.h"
+#include "Currency.h"
+#include "DataBaseConfig.h"
+#include "DatabaseCacheData.h"
+#include "IMainChainStorage.h"
+#include "MainChainStorage.h"
+#include "RocksDBWrapper.h"
+#include "TransactionExtra.h"
+#include "Serialization/SerializationOverloads.h"
+#include "Serialization/SerializationTools.h"
+
+using namespace CryptoNote;
+using namespace Logging;
+
+namespace {
+
+const std::string MANIFEST_FILE_NAME = "snapshot.json";
+const std::string DB_DIR_NAME = "DB";
+const uint32_t BLOCKS_BATCH_SIZE = 1000;
+const uint32_t PROGRESS_LOG_INTERVAL = 100000;
+const size_t FILE_DIGEST_CHUNK_SIZE = 1 << 20;
+const uint64_t ONE_DAY_SECONDS = 60 * 60 * 24;
+
+Crypto::Hash getBlockHash(const RawBlock& rawBlock) {
+  BlockTemplate block;
+  if (!fromBinaryArray(block, rawBlock.block)) {
+    throw std::runtime_error("Couldn't deserialize block");
+  }
+
+  return CachedBlock(block).getBlockHash();
+}
+
+// database checkpoint directory is flat, its files are copied only if they stay inside database directory
+bool isPlainFileName(const std::string& name) {
+  return !name.empty() && name != "." && name != ".." && name.find_first_of("/\\") == std::string::npos;
+}
+
+// hash of chunk hashes, so files of any size are hashed in fixed memory; copies file if target is set
+Crypto::Hash digestFile(const boost::filesystem::path& source, const boost::filesystem::path* target, uint64_t& size) {
+  std::ifstream input(source.string(), std::ios::binary);
+  if (!input) {
+    throw std::runtime_error("Couldn't open file " + source.string());
+  }
+
+  std::ofstream output;
+  if (target != nullptr) {
+    output.open(target->string(), std::ios::binary | std::ios::trunc);
+    if (!output) {
+      throw std::runtime_error("Couldn't create file " + target->string());
+    }
+  }
+
+  std::vector<char> chunk(FILE_DIGEST_CHUNK_SIZE);
+  std::vector<Crypto::Hash> chunkHashes;
+  size = 0;
+  while (input) {
+    input.read(chunk.data(), chunk.size());
+    size_t readSize = static_cast<size_t>(input.gcount());
+    if (readSize == 0) {
+      break;
+    }
+
+    chunkHashes.push_back(Crypto::cn_fast_hash(chunk.data(), readSize));
+    size += readSize;
+    if (target != nullptr && !output.write(chunk.data(), readSize)) {
+      throw std::runtime_error("Couldn't write file " + target->string());
+    }
+  }
+
+  if (input.bad()) {
+    throw std::runtime_error("Couldn't read file " + source.string());
+  }
+
+  return Crypto::cn_fast_hash(chunkHashes.data(), chunkHashes.size() * sizeof(Crypto::Hash));
+}
+
+// block of main chain storage with the values its database entries are computed from
+struct SnapshotBlock {
+  SnapshotBlock(uint32_t index, const RawBlock& rawBlock);
+
+  uint32_t index;
+  BlockTemplate block;
+  Crypto::Hash blockHash;
+  // base transaction first, as database lists them
+  std::vector<CachedTransaction> transactions;
+  std::vector<Crypto::Hash> transactionHashes;
+  uint64_t cumulativeSize;
+  uint64_t cumulativeFee;
+};
+
+SnapshotBlock::SnapshotBlock(uint32_t index, const RawBlock& rawBlock) : index(index), cumulativeFee(0) {
+  if (!fromBinaryArray(block, rawBlock.block)) {
+    throw std::runtime_error("Couldn't deserialize snapshot block with index " + std::to_string(index));
+  }
+
+  blockHash = CachedBlock(block).getBlockHash();
+  if (rawBlock.transactions.size() != block.transactionHashes.size()) {
+    throw std::runtime_error("Snapshot block with index " + std::to_string(index) + " doesn't have its transactions");
+  }
+
+  transactions.emplace_back(block.baseTransaction);
+  transactionHashes.push_back(transactions.back().getTransactionHash());
+  cumulativeSize = getObjectBinarySize(block.baseTransaction);
+  for (size_t i = 0; i < rawBlock.transactions.size(); ++i) {
+    transactions.emplace_back(rawBlock.transactions[i]);
+    const CachedTransaction& transaction = transactions.back();
+    if (transaction.getTransactionHash() != block.transactionHashes[i]) {
+      throw std::runtime_error("Snapshot block with index " + std::to_string(index) + " doesn't have its transactions");
+    }
+
+    transactionHashes.push_back(transaction.getTransactionHash());
+    cumulativeSize += rawBlock.transactions[i].size();
+    cumulativeFee += transaction.getTransactionFee();
+  }
+}
+
+// counters of the indexes that span blocks, advanced in chain order as DatabaseBlockchainCache::pushBlockToBatch advances them.
+// Payment ids and timestamps are counted over the whole chain, so database counts can be checked once all blocks are verified
+struct SnapshotIndexCounters {
+  std::unordered_map<IBlockchainCache::Amount, uint32_t> keyOutputCounts;
+  // in the order amounts got their ids
+  std::vector<IBlockchainCache::Amount> keyOutputAmounts;
+  std::unordered_map<Crypto::Hash, uint32_t> transactionCountsByPaymentId;
+  std::unordered_map<uint64_t, uint32_t> blockCountsByTimestamp;
+  std::unordered_set<uint64_t> closestTimestamps;
+  uint64_t transactionCount = 0;
+};
+
+// database entries of a block besides its block info, as DatabaseBlockchainCache::pushBlockToBatch writes them
+struct SnapshotBlockEntries {
+  std::vector<ExtendedTransactionInfo> transactions;
+  std::unordered_set<Crypto::KeyImage> spentKeyImages;
+  // payment id and index of the transaction among those with it
+  std::vector<std::pair<std::pair<Crypto::Hash, uint32_t>, Crypto::Hash>> transactionsByPaymentId;
+  // index of the block among those with its timestamp, genesis block isn't indexed by timestamp
+  uint32_t timestampIndex = 0;
+  bool isClosestToMidnight = false;
+};
+
+SnapshotBlockEntries calculateBlockEntries(const SnapshotBlock& block, SnapshotIndexCounters& counters) {
+  SnapshotBlockEntries entries;
+  for (uint32_t transactionIndex = 0; transactionIndex < block.transactions.size(); ++transactionIndex) {
+    const CachedTransaction& cachedTransaction = block.transactions[transactionIndex];
+    const Transaction& transaction = cachedTransaction.getTransaction();
+    if (transactionIndex != 0) {
+      for (const TransactionInput& input : transaction.inputs) {
+        if (input.type() != typeid(KeyInput)) {
+          throw std::runtime_error("Snapshot transaction " + Common::podToHex(cachedTransaction.getTransactionHash()) + " has unexpected input");
+        }
+
+        if (!entries.spentKeyImages.insert(boost::get<KeyInput>(input).keyImage).second) {
+          throw std::runtime_error("Snapshot block with index " + std::to_string(block.index) + " spends key image twice");
+        }
+      }
+    }
+
+    ExtendedTransactionInfo info;
+    info.blockIndex = block.index;
+    info.transactionIndex = transactionIndex;
+    info.transactionHash = cachedTransaction.getTransactionHash();
+    info.unlockTime = transaction.unlockTime;
+
+    std::set<IBlockchainCache::Amount> newKeyAmounts;
+    for (const TransactionOutput& output : transaction.outputs) {
+      info.outputs.push_back(output.target);
+      if (output.target.type() == typeid(KeyOutput)) {
+        uint32_t globalIndex = counters.keyOutputCounts[output.amount]++;
+        if (globalIndex == 0) {
+          newKeyAmounts.insert(output.amount);
+        }
+
+        info.globalIndexes.push_back(globalIndex);
+        info.amountToKeyIndexes[output.amount].push_back(globalIndex);
+      }
+    }
+
+    counters.keyOutputAmounts.insert(counters.keyOutputAmounts.end(), newKeyAmounts.begin(), newKeyAmounts.end());
+
+    Crypto::Hash paymentId;
+    if (getPaymentIdFromTxExtra(transaction.extra, paymentId)) {
+      uint32_t paymentIdIndex = counters.transactionCountsByPaymentId[paymentId]++;
+      entries.transactionsByPaymentId.emplace_back(std::make_pair(paymentId, paymentIdIndex), info.transactionHash);
+    }
+
+    entries.transactions.push_back(std::move(info));
+  }
+
+  if (block.index != 0) {
+    entries.timestampIndex = counters.blockCountsByTimestamp[block.block.timestamp]++;
+  }
+
+  entries.isClosestToMidnight = counters.closestTimestamps.insert(block.block.timestamp / ONE_DAY_SECONDS * ONE_DAY_SECONDS).second;
+  counters.transactionCount += block.transactions.size();
+  return entries;
+}
+
+// values of the blocks before blockIndex as IBlockchainCache::getLastUnits returns them, lastBlocks end right before blockIndex
+std::vector<uint64_t> getLastValues(const std::deque<CachedBlockInfo>& lastBlocks, uint32_t blockIndex, size_t count, bool useGenesis,
+  std::function<uint64_t(const CachedBlockInfo&)> getValue) {
+  size_t valuesCount = blockIndex > count ? count : (useGenesis ? blockIndex : blockIndex - 1);
+  assert(valuesCount <= lastBlocks.size());
+
+  std::vector<uint64_t> values;
+  values.reserve(valuesCount);
+  for (auto it = lastBlocks.end() - valuesCount; it != lastBlocks.end(); ++it) {
+    values.push_back(getValue(*it));
+  }
+
+  return values;
+}
+
+// values a node stores when it imports the block from main chain storage, see Core::importBlocksFromStorage
+CachedBlockInfo calculateBlockInfo(const Currency& currency, const SnapshotBlock& block, const std::deque<CachedBlockInfo>& lastBlocks,
+  Crypto::cn_context& cryptoContext, const Checkpoints& checkpoints) {
+  uint64_t minerReward = 0;
+  for (const TransactionOutput& output : block.block.baseTransaction.outputs) {
+    minerReward += output.amount;
+  }
+
+  CachedBlockInfo blockInfo;
+  blockInfo.blockHash = block.blockHash;
+  blockInfo.timestamp = block.block.timestamp;
+  if (block.index == 0) {
+    blockInfo.cumulativeDifficulty = 1;
+    blockInfo.alreadyGeneratedCoins = minerReward;
+    blockInfo.alreadyGeneratedTransactions = 1;
+    blockInfo.blockSize = static_cast<uint32_t>(block.cumulativeSize);
+    return blockInfo;
+  }
+
+  const CachedBlockInfo& previousBlock = lastBlocks.back();
+  Difficulty difficulty = currency.nextDifficulty(
+    getLastValues(lastBlocks, block.index, currency.difficultyBlocksCount(), false, [](const CachedBlockInfo& info) { return info.timestamp; }),
+    getLastValues(lastBlocks, block.index, currency.difficultyBlocksCount(), false, [](const CachedBlockInfo& info) { return info.cumulativeDifficulty; }));
+  if (difficulty == 0) {
+    throw std::runtime_error("Snapshot block with index " + std::to_string(block.index) + " has difficulty overhead");
+  }
+
+  // checkpoints vouch for the blocks up to the last one, proof of work is checked after it as when the block is added
+  CachedBlock cachedBlock(block.block);
+  if (!checkpoints.isInCheckpointZone(block.index) && !currency.checkProofOfWork(cryptoContext, cachedBlock, difficulty)) {
+    throw std::runtime_error("Snapshot block with index " + std::to_string(block.index) + " has too weak proof of work");
+  }
+
+  auto blockSizes = getLastValues(lastBlocks, block.index, currency.rewardBlocksWindow(), true, [](const CachedBlockInfo& info) { return info.blockSize; });
+  uint64_t reward = 0;
+  int64_t emissionChange = 0;
+  if (!currency.getBlockReward(block.block.majorVersion, Common::medianValue(blockSizes), block.cumulativeSize, previousBlock.alreadyGeneratedCoins,
+    block.cumulativeFee, reward, emissionChange)) {
+    throw std::runtime_error("Snapshot block with index " + std::to_string(block.index) + " has too big cumulative size");
+  }
+
+  if (minerReward != reward) {
+    throw std::runtime_error("Snapshot block with index " + std::to_string(block.index) + " has wrong miner reward");
+  }
+
+  blockInfo.cumulativeDifficulty = previousBlock.cumulativeDifficulty + difficulty;
+  blockInfo.alreadyGeneratedCoins = previousBlock.alreadyGeneratedCoins + emissionChange;
+  blockInfo.alreadyGeneratedTransactions = previousBlock.alreadyGeneratedTransactions + block.transactionHashes.size();
+  blockInfo.blockSize = static_cast<uint32_t>(block.cumulativeSize);
+  return blockInfo;
+}
+
+void requestBlockEntries(BlockchainReadBatch& batch, const SnapshotBlock& block, const SnapshotBlockEntries& entries) {
+  for (const ExtendedTransactionInfo& transaction : entries.transactions) {
+    batch.requestCachedTransaction(transaction.transactionHash);
+    for (const auto& amountToIndexes : transaction.amountToKeyIndexes) {
+      for (uint32_t globalIndex : amountToIndexes.second) {
+        batch.requestKeyOutputGlobalIndexForAmount(amountToIndexes.first, globalIndex);
+        batch.requestKeyOutputInfo(amountToIndexes.first, globalIndex);
+      }
+    }
+  }
+
+  for (const Crypto::KeyImage& keyImage : entries.spentKeyImages) {
+    batch.requestBlockIndexBySpentKeyImage(keyImage);
+  }
+
+  for (const auto& transaction : entries.transactionsByPaymentId) {
+    batch.requestTransactionHashByPaymentId(transaction.first.first, transaction.first.second);
+  }
+
+  if (block.index != 0) {
+    batch.requestSpentKeyImagesByBlock(block.index);
+    batch.requestBlockHashesByTimestamp(block.block.timestamp);
+  }
+
+  if (entries.isClosestToMidnight) {
+    batch.requestClosestTimestampBlockIndex(block.block.timestamp / ONE_DAY_SECONDS * ONE_DAY_SECONDS);
+  }
+}
+
+void verifyBlockEntries(const BlockchainReadResult& result, const SnapshotBlock& block, const SnapshotBlockEntries& entries) {
+  std::string blockName = "block with index " + std::to_string(block.index);
+  for (const ExtendedTransactionInfo& transaction : entries.transactions) {
+    std::string transactionName = "transaction " + Common::podToHex(transaction.transactionHash) + " of " + blockName;
+    auto cachedTransaction = result.getCachedTransactions().find(transaction.transactionHash);
+    if (cachedTransaction == result.getCachedTransactions().end() || toBinaryArray(cachedTransaction->second) != toBinaryArray(transaction)) {
+      throw std::runtime_error("Snapshot database doesn't index " + transactionName);
+    }
+
+    for (uint16_t outputIndex = 0, keyOutputIndex = 0; outputIndex < transaction.outputs.size(); ++outputIndex) {
+      if (transaction.outputs[outputIndex].type() != typeid(KeyOutput)) {
+        continue;
+      }
+
+      PackedOutIndex packedIndex;
+      packedIndex.blockIndex = block.index;
+      packedIndex.transactionIndex = static_cast<uint16_t>(transaction.transactionIndex);
+      packedIndex.outputIndex = outputIndex;
+
+      auto outputId = std::make_pair(block.transactions[transaction.transactionIndex].getTransaction().outputs[outputIndex].amount,
+        transaction.globalIndexes[keyOutputIndex++]);
+      auto globalIndex = result.getKeyOutputGlobalIndexesForAmounts().find(outputId);
+      auto outputInfo = result.getKeyOutputInfo().find(outputId);
+      if (globalIndex == result.getKeyOutputGlobalIndexesForAmounts().end() || globalIndex->second.packedValue != packedIndex.packedValue ||
+        outputInfo == result.getKeyOutputInfo().end() ||
+        outputInfo->second.publicKey != boost::get<KeyOutput>(transaction.outputs[outputIndex]).key ||
+        outputInfo->second.transactionHash != transaction.transactionHash || outputInfo->second.unlockTime != transaction.unlockTime ||
+        outputInfo->second.outputIndex != outputIndex) {
+        throw std::runtime_error("Snapshot database doesn't index key output " + std::to_string(outputIndex) + " of " + transactionName);
+      }
+    }
+  }
+
+  for (const Crypto::KeyImage& keyImage : entries.spentKeyImages) {
+    auto blockIndex = result.getBlockIndexesBySpentKeyImages().find(keyImage);
+    if (blockIndex == result.getBlockIndexesBySpentKeyImages().end() || blockIndex->second != block.index) {
+      throw std::runtime_error("Snapshot database doesn't index key image " + Common::podToHex(keyImage) + " spent in " + blockName);
+    }
+  }
+
+  if (block.index != 0) {
+    auto keyImages = result.getSpentKeyImagesByBlock().find(block.index);
+    if (keyImages == result.getSpentKeyImagesByBlock().end() || keyImages->second.size() != entries.spentKeyImages.size() ||
+      !std::all_of(keyImages->second.begin(), keyImages->second.end(),
+        [&entries](const Crypto::KeyImage& keyImage) { return entries.spentKeyImages.count(keyImage) != 0; })) {
+      throw std::runtime_error("Snapshot database doesn't index key images spent in " + blockName);
+    }
+
+    auto blockHashes = result.getBlockHashesByTimestamp().find(block.block.timestamp);
+    if (blockHashes == result.getBlockHashesByTimestamp().end() || blockHashes->second.size() <= entries.timestampIndex ||
+      blockHashes->second[entries.timestampIndex] != block.blockHash) {
+      throw std::runtime_error("Snapshot database doesn't index timestamp of " + blockName);
+    }
+  }
+
+  if (entries.isClosestToMidnight) {
+    auto closestBlockIndex = result.getClosestTimestampBlockIndex().find(block.block.timestamp / ONE_DAY_SECONDS * ONE_DAY_SECONDS);
+    if (closestBlockIndex == result.getClosestTimestampBlockIndex().end() || closestBlockIndex->second != block.index) {
+      throw std::runtime_error("Snapshot database doesn't index " + blockName + " as the first one of its day");
+    }
+  }
+
+  for (const auto& transaction : entries.transactionsByPaymentId) {
+    auto transactionHash = result.getTransactionHashesByPaymentIds().find(transaction.first);
+    if (transactionHash == result.getTransactionHashesByPaymentIds().end() || transactionHash->second != transaction.second) {
+      throw std::runtime_error("Snapshot database doesn't index payment id of transaction " + Common::podToHex(transaction.second) + " of " +
+        blockName);
+    }
+  }
+}
+
+BlockchainReadResult readDatabase(IDataBase& database, BlockchainReadBatch& batch) {
+  auto ec = database.read(batch);
+  if (ec) {
+    throw std::system_error(ec);
+  }
+
+  return batch.extractResult();
+}
+
+// database counts of an index must be the replayed ones, entries past them are read by nobody
+template<typename Key, typename Request, typename HasCount>
+void verifyCounts(IDataBase& database, const std::unordered_map<Key, uint32_t>& counts, Request request, HasCount hasCount,
+  const std::string& indexName) {
+  auto it = counts.begin();
+  while (it != counts.end()) {
+    BlockchainReadBatch batch;
+    auto batchBegin = it;
+    for (uint32_t i = 0; i < BLOCKS_BATCH_SIZE && it != counts.end(); ++i, ++it) {
+      request(batch, it->first);
+    }
+
+    auto result = readDatabase(database, batch);
+    for (auto count = batchBegin; count != it; ++count) {
+      if (!hasCount(result, count->first, count->second)) {
+        throw std::runtime_error("Snapshot database " + indexName + " counts don't match blocks file");
+      }
+    }
+  }
+}
+
+void verifyIndexCounts(IDataBase& database, const SnapshotIndexCounters& counters) {
+  BlockchainReadBatch batch;
+  batch.requestTransactionsCount();
+  batch.requestKeyOutputAmountsCount();
+  for (uint32_t amountId = 0; amountId < counters.keyOutputAmounts.size(); ++amountId) {
+    batch.requestKeyOutputAmount(amountId);
+  }
+
+  auto result = readDatabase(database, batch);
+  if (!result.getTransactionsCount().second || result.getTransactionsCount().first != counters.transactionCount) {
+    throw std::runtime_error("Snapshot database transaction count doesn't match blocks file");
+  }
+
+  if (result.getKeyOutputAmountsCount() != counters.keyOutputAmounts.size()) {
+    throw std::runtime_error("Snapshot database key output amounts don't match blocks file");
+  }
+
+  for (uint32_t amountId = 0; amountId < counters.keyOutputAmounts.size(); ++amountId) {
+    auto amount = result.getKeyOutputAmounts().find(amountId);
+    if (amount == result.getKeyOutputAmounts().end() || amount->second != counters.keyOutputAmounts[amountId]) {
+      throw std::runtime_error("Snapshot database key output amounts don't match blocks file");
+    }
+  }
+
+  verifyCounts(database, counters.keyOutputCounts,
+    [](BlockchainReadBatch& batch, IBlockchainCache::Amount amount) { batch.requestKeyOutputGlobalIndexesCountForAmount(amount); },
+    [](const BlockchainReadResult& result, IBlockchainCache::Amount amount, uint32_t count) {
+      auto it = result.getKeyOutputGlobalIndexesCountForAmounts().find(amount);
+      return it != result.getKeyOutputGlobalIndexesCountForAmounts().end() && it->second == count;
+    }, "key output");
+
+  verifyCounts(database, counters.transactionCountsByPaymentId,
+    [](BlockchainReadBatch& batch, const Crypto::Hash& paymentId) { batch.requestTransactionCountByPaymentId(paymentId); },
+    [](const BlockchainReadResult& result, const Crypto::Hash& paymentId, uint32_t count) {
+      auto it = result.getTransactionCountByPaymentIds().find(paymentId);
+      return it != result.getTransactionCountByPaymentIds().end() && it->second == count;
+    }, "payment id");
+
+  verifyCounts(database, counters.blockCountsByTimestamp,
+    [](BlockchainReadBatch& batch, uint64_t timestamp) { batch.requestBlockHashesByTimestamp(timestamp); },
+    [](const BlockchainReadResult& result, uint64_t timestamp, uint32_t count) {
+      auto it = result.getBlockHashesByTimestamp().find(timestamp);
+      return it != result.getBlockHashesByTimestamp().end() && it->second.size() == count;
+    }, "timestamp");
+}
+
+bool isSameBlockInfo(const CachedBlockInfo& left, const CachedBlockInfo& right) {
+  return left.blockHash == right.blockHash && left.timestamp == right.timestamp && left.cumulativeDifficulty == right.cumulativeDifficulty &&
+    left.alreadyGeneratedCoins == right.alreadyGeneratedCoins && left.alreadyGeneratedTransactions == right.alreadyGeneratedTransactions &&
+    left.blockSize == right.blockSize;
+}
+
+}
+
+void SnapshotFileInfo::serialize(ISerializer& s) {
+  s(path, "path");
+  s(size, "size");
+  s(digest, "digest");
+}
+
+void BlockchainSnapshotManifest::serialize(ISerializer& s) {
+  s(topBlockIndex, "top_block_index");
+  s(topBlockHash, "top_block_hash");
+  s(files, "files");
+}
+
+BlockchainSnapshot::BlockchainSnapshot(const Currency& currency, Logging::ILogger& logger) : currency(currency), logger(logger, "BlockchainSnapshot") {
+}
+
+BlockchainSnapshotManifest BlockchainSnapshot::exportTo(const std::string& snapshotDir, RocksDBWrapper& database,
+  const IMainChainStorage& mainChainStorage) {
+  boost::filesystem::path snapshotPath(snapshotDir);
+  if (boost::filesystem::exists(snapshotPath)) {
+    throw std::runtime_error("Snapshot directory already exists: " + snapshotDir);
+  }
+
+  boost::filesystem::create_directories(snapshotPath);
+
+  uint32_t blockCount = mainChainStorage.getBlockCount();
+  assert(blockCount != 0);
+
+  BlockchainSnapshotManifest manifest;
+  manifest.topBlockIndex = blockCount - 1;
+  manifest.topBlockHash = getBlockHash(mainChainStorage.getBlockByIndex(manifest.topBlockIndex));
+  logger(INFO) << "Exporting blockchain snapshot at block index " << manifest.topBlockIndex << " to " << snapshotDir;
+
+  database.createCheckpoint((snapshotPath / DB_DIR_NAME).string());
+
+  {
+    MainChainStorage snapshotStorage((snapshotPath / currency.blocksFileName()).string(), (snapshotPath / currency.blockIndexesFileName()).string());
+    for (uint32_t startIndex = 0; startIndex < blockCount; startIndex += BLOCKS_BATCH_SIZE) {
+      std::vector<RawBlock> blocks;
+      blocks.reserve(std::min(BLOCKS_BATCH_SIZE, blockCount - startIndex));
+      for (uint32_t index = startIndex; index < blockCount && index < startIndex + BLOCKS_BATCH_SIZE; ++index) {
+        blocks.push_back(mainChainStorage.getBlockByIndex(index));
+      }
+
+      snapshotStorage.pushBlocks(blocks);
+      if ((startIndex + BLOCKS_BATCH_SIZE) % PROGRESS_LOG_INTERVAL == 0) {
+        logger(INFO) << "Exported block with index " << startIndex + BLOCKS_BATCH_SIZE - 1 << " / " << manifest.topBlockIndex;
+      }
+    }
+  }
+
+  std::string prefix = snapshotPath.generic_string() + '/';
+  for (boost::filesystem::recursive_directory_iterator it(snapshotPath), end; it != end; ++it) {
+    if (!boost::filesystem::is_regular_file(it->status())) {
+      continue;
+    }
+
+    SnapshotFileInfo file;
+    file.path = it->path().generic_string().substr(prefix.size());
+    file.digest = digestFile(it->path(), nullptr, file.size);
+    manifest.files.push_back(std::move(file));
+  }
+
+  std::sort(manifest.files.begin(), manifest.files.end(), [](const SnapshotFileInfo& left, const SnapshotFileInfo& right) {
+    return left.path < right.path;
+  });
+
+  std::ofstream manifestFile((snapshotPath / MANIFEST_FILE_NAME).string(), std::ios::trunc);
+  manifestFile << storeToJson(manifest);
+  if (!manifestFile.flush()) {
+    throw std::runtime_error("Couldn't write snapshot manifest in " + snapshotDir);
+  }
+
+  logger(INFO) << "Blockchain snapshot exported, top block " << manifest.topBlockHash << ", " << manifest.files.size() << " files";
+  return manifest;
+}
+
+BlockchainSnapshotManifest BlockchainSnapshot::importFrom(const std::string& snapshotDir, const std::string& dataDir, const DataBaseConfig& dbConfig,
+  const Checkpoints& checkpoints) {
+  boost::filesystem::path snapshotPath(snapshotDir);
+  std::ifstream manifestFile((snapshotPath / MANIFEST_FILE_NAME).string());
+  std::string manifestJson((std::istreambuf_iterator<char>(manifestFile)), std::istreambuf_iterator<char>());
+
+  BlockchainSnapshotManifest manifest;
+  if (!manifestFile || !loadFromJson(manifest, manifestJson)) {
+    throw std::runtime_error("Couldn't read snapshot manifest in " + snapshotDir);
+  }
+
+  RocksDBWrapper database(logger.getLogger());
+  boost::filesystem::path dbPath(database.getDataDir(dbConfig));
+  boost::filesystem::path blocksPath = boost::filesystem::path(dataDir) / currency.blocksFileName();
+  boost::filesystem::path indexesPath = boost::filesystem::path(dataDir) / currency.blockIndexesFileName();
+  if (boost::filesystem::exists(dbPath) || boost::filesystem::exists(blocksPath) || boost::filesystem::exists(indexesPath)) {
+    throw std::runtime_error("Data directory already contains blockchain, snapshot can be imported only into a new one: " + dataDir);
+  }
+
+  logger(INFO) << "Importing blockchain snapshot at block index " << manifest.topBlockIndex << " from " << snapshotDir;
+
+  Tools::ScopeExit removeOnFailure([&] {
+    boost::system::error_code ignore;
+    boost::filesystem::remove_all(dbPath, ignore);
+    boost::filesystem::remove(blocksPath, ignore);
+    boost::filesystem::remove(indexesPath, ignore);
+  });
+
+  boost::filesystem::create_directories(dbPath);
+
+  std::string dbPrefix = DB_DIR_NAME + '/';
+  bool hasBlocks = false;
+  bool hasIndexes = false;
+  for (const SnapshotFileInfo& file : manifest.files) {
+    boost::filesystem::path target;
+    if (file.path == currency.blocksFileName()) {
+      target = blocksPath;
+      hasBlocks = true;
+    } else if (file.path == currency.blockIndexesFileName()) {
+      target = indexesPath;
+      hasIndexes = true;
+    } else if (file.path.compare(0, dbPrefix.size(), dbPrefix) == 0 && isPlainFileName(file.path.substr(dbPrefix.size()))) {
+      target = dbPath / file.path.substr(dbPrefix.size());
+    } else {
+      throw std::runtime_error("Unexpected file in snapshot: " + file.path);
+    }
+
+    uint64_t size;
+    Crypto::Hash digest = digestFile(snapshotPath / file.path, &target, size);
+    if (size != file.size || digest != file.digest) {
+      throw std::runtime_error("Snapshot file is corrupted: " + file.path);
+    }
+  }
+
+  if (!hasBlocks || !hasIndexes) {
+    throw std::runtime_error("Snapshot has no main chain storage files");
+  }
+
+  database.init(dbConfig);
+  {
+    Tools::ScopeExit dbShutdownOnExit([&database] () { database.shutdown(); });
+    MainChainStorage mainChainStorage(blocksPath.string(), indexesPath.string());
+    verifyBlocks(manifest, mainChainStorage, database, checkpoints);
+  }
+
+  removeOnFailure.cancel();
+  logger(INFO) << "Blockchain snapshot imported, top block " << manifest.topBlockHash;
+  return manifest;
+}
+
+void BlockchainSnapshot::verifyBlocks(const BlockchainSnapshotManifest& manifest, const IMainChainStorage& mainChainStorage, IDataBase& database,
+  const Checkpoints& checkpoints) {
+  if (mainChainStorage.getBlockCount() != manifest.topBlockIndex + 1) {
+    throw std::runtime_error("Snapshot has " + std::to_string(mainChainStorage.getBlockCount()) + " blocks, expected top block index " +
+      std::to_string(manifest.topBlockIndex));
+  }
+
+  BlockchainReadBatch lastBlockIndexBatch;
+  lastBlockIndexBatch.requestLastBlockIndex();
+  auto lastBlockIndex = readDatabase(database, lastBlockIndexBatch).getLastBlockIndex();
+  if (!lastBlockIndex.second || lastBlockIndex.first != manifest.topBlockIndex) {
+    throw std::runtime_error("Snapshot database top block index doesn't match blocks file");
+  }
+
+  Crypto::cn_context cryptoContext;
+  size_t lastBlocksCount = std::max(currency.difficultyBlocksCount(), currency.rewardBlocksWindow());
+  std::deque<CachedBlockInfo> lastBlocks;
+  SnapshotIndexCounters counters;
+  Crypto::Hash previousBlockHash = NULL_HASH;
+  for (uint32_t startIndex = 0; startIndex <= manifest.topBlockIndex; startIndex += BLOCKS_BATCH_SIZE) {
+    uint32_t endIndex = std::min(manifest.topBlockIndex, startIndex + BLOCKS_BATCH_SIZE - 1);
+
+    std::vector<SnapshotBlock> blocks;
+    std::vector<SnapshotBlockEntries> blocksEntries;
+    blocks.reserve(endIndex - startIndex + 1);
+    blocksEntries.reserve(endIndex - startIndex + 1);
+    BlockchainReadBatch batch;
+    for (uint32_t index = startIndex; index <= endIndex; ++index) {
+      blocks.emplace_back(index, mainChainStorage.getBlockByIndex(index));
+      blocksEntries.push_back(calculateBlockEntries(blocks.back(), counters));
+      batch.requestCachedBlock(index);
+      batch.requestBlockIndexByBlockHash(blocks.back().blockHash);
+      batch.requestTransactionHashesByBlock(index);
+      requestBlockEntries(batch, blocks.back(), blocksEntries.back());
+    }
+
+    auto result = readDatabase(database, batch);
+    for (uint32_t index = startIndex; index <= endIndex; ++index) {
+      const SnapshotBlock& block = blocks[index - startIndex];
+      if (index == 0 ? block.blockHash != currency.genesisBlockHash() : block.block.previousBlockHash != previousBlockHash) {
+        throw std::runtime_error("Snapshot block with index " + std::to_string(index) + " doesn't link to previous block");
+      }
+
+      if (!checkpoints.checkBlock(index, block.blockHash)) {
+        throw std::runtime_error("Snapshot block with index " + std::to_string(index) + " doesn't match checkpoint");
+      }
+
+      CachedBlockInfo blockInfo = calculateBlockInfo(currency, block, lastBlocks, cryptoContext, checkpoints);
+      auto cachedBlock = result.getCachedBlocks().find(index);
+      auto blockIndex = result.getBlockIndexesByBlockHashes().find(block.blockHash);
+      if (cachedBlock == result.getCachedBlocks().end() || !isSameBlockInfo(blockInfo, cachedBlock->second) ||
+        blockIndex == result.getBlockIndexesByBlockHashes().end() || blockIndex->second != index) {
+        throw std::runtime_error("Snapshot database doesn't index block with index " + std::to_string(index) + " as computed from blocks file");
+      }
+
+      auto transactionHashes = result.getTransactionHashesByBlocks().find(index);
+      if (transactionHashes == result.getTransactionHashesByBlocks().end() || transactionHashes->second != block.transactionHashes) {
+        throw std::runtime_error("Snapshot database doesn't index transactions of block with index " + std::to_string(index));
+      }
+
+      verifyBlockEntries(result, block, blocksEntries[index - startIndex]);
+
+      lastBlocks.push_back(blockInfo);
+      if (lastBlocks.size() > lastBlocksCount) {
+        lastBlocks.pop_front();
+      }
+
+      previousBlockHash = block.blockHash;
+    }
+
+    if ((endIndex + 1) % PROGRESS_LOG_INTERVAL == 0) {
+      logger(INFO) << "Verified block with index " << endIndex << " / " << manifest.topBlockIndex;
+    }
+  }
+
+  if (previousBlockHash != manifest.topBlockHash) {
+    throw std::runtime_error("Snapshot top block hash doesn't match manifest");
+  }
+
+  verifyIndexCounts(database, counters);
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <CryptoNote.h>
+#include <IDataBase.h>
+
+#include <Logging/LoggerRef.h>
+
+namespace CryptoNote {
+
+class Checkpoints;
+class Currency;
+class DataBaseConfig;
+class IMainChainStorage;
+class ISerializer;
+class RocksDBWrapper;
+
+struct SnapshotFileInfo {
+  // relative to snapshot directory, '/' separated
+  std::string path;
+  uint64_t size;
+  Crypto::Hash digest;
+
+  void serialize(ISerializer& s);
+};
+
+struct BlockchainSnapshotManifest {
+  uint32_t topBlockIndex;
+  Crypto::Hash topBlockHash;
+  std::vector<SnapshotFileInfo> files;
+
+  void serialize(ISerializer& s);
+};
+
+// Copy of the database checkpoint and main chain storage at the same top block, new nodes start from it without importing blocks
+class BlockchainSnapshot {
+public:
+  BlockchainSnapshot(const Currency& currency, Logging::ILogger& logger);
+
+  // database and main chain storage must be at the same top block, as they are after Core::load
+  BlockchainSnapshotManifest exportTo(const std::string& snapshotDir, RocksDBWrapper& database, const IMainChainStorage& mainChainStorage);
+  // copies snapshot into data directory without blockchain, throws std::runtime_error and removes copied files if snapshot is not valid.
+  // Manifest digests come with the snapshot and only catch corrupted copies, blocks are verified with verifyBlocks
+  BlockchainSnapshotManifest importFrom(const std::string& snapshotDir, const std::string& dataDir, const DataBaseConfig& dbConfig,
+    const Checkpoints& checkpoints);
+
+  // checks that blocks link from genesis to the top block of manifest, pass checkpoints, have enough proof of work after the last checkpoint
+  // and that database has the block, transaction, key output, spent key image, payment id and timestamp entries Core writes when it
+  // imports them from main chain storage. Database can't be enumerated, so extra entries no block refers to aren't found
+  void verifyBlocks(const BlockchainSnapshotManifest& manifest, const IMainChainStorage& mainChainStorage, IDataBase& database,
+    const Checkpoints& checkpoints);
+
+private:
+  const Currency& currency;
+  Logging::LoggerRef logger;
+};
+
+}
@@ -24,13 +24,13 @@ bool restoreCachedTransactions(const std::vector<BinaryArray>& binaryTransaction
                                std::vector<CachedTransaction>& transactions) {
   transactions.reserve(binaryTransactions.size());
 
-  for (auto binaryTransaction : binaryTransactions) {
-    Transaction transaction;
-    if (!fromBinaryArray(transaction, binaryTransaction)) {
+  for (const auto& binaryTransaction : binaryTransactions) {
+    // keeps the binary, so transaction hash doesn't require serialization
+    try {
+      transactions.emplace_back(binaryTransaction);
+    } catch (std::exception&) {
       return false;
     }
-
-    transactions.emplace_back(std::move(transaction));
   }
 
   return true;
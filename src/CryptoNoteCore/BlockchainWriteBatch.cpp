@@ -106,6 +106,11 @@ BlockchainWriteBatch& BlockchainWriteBatch::insertKeyOutputInfo(IBlockchainCache
   return *this;
 }
 
+BlockchainWriteBatch& BlockchainWriteBatch::insertBlockFilter(uint32_t blockIndex, const BlockFilter& filter) {
+  rawDataToInsert.emplace_back(DB::serialize(DB::BLOCK_INDEX_TO_BLOCK_FILTER_PREFIX, blockIndex, filter));
+  return *this;
+}
+
 BlockchainWriteBatch& BlockchainWriteBatch::removeSpentKeyImages(uint32_t blockIndex, const std::vector<Crypto::KeyImage>& spentKeyImages) {
   rawKeysToRemove.reserve(rawKeysToRemove.size() + spentKeyImages.size() + 1);
   rawKeysToRemove.emplace_back(DB::serializeKey(DB::BLOCK_INDEX_TO_KEY_IMAGE_PREFIX, blockIndex));
@@ -176,6 +181,11 @@ BlockchainWriteBatch&BlockchainWriteBatch::removeKeyOutputInfo(IBlockchainCache:
   return *this;
 }
 
+BlockchainWriteBatch& BlockchainWriteBatch::removeBlockFilter(uint32_t blockIndex) {
+  rawKeysToRemove.emplace_back(DB::serializeKey(DB::BLOCK_INDEX_TO_BLOCK_FILTER_PREFIX, blockIndex));
+  return *this;
+}
+
 std::vector<std::pair<std::string, std::string>> BlockchainWriteBatch::extractRawDataToInsert() {
   return std::move(rawDataToInsert);
 }
@@ -20,6 +20,7 @@
 #include "IWriteBatch.h"
 
 #include "BlockchainCache.h"
+#include "BlockFilter.h"
 #include "CryptoNote.h"
 #include "DatabaseCacheData.h"
 
@@ -40,6 +41,7 @@ public:
   BlockchainWriteBatch& insertKeyOutputAmounts(const std::set<IBlockchainCache::Amount>& amounts, uint32_t totalKeyOutputAmountsCount);
   BlockchainWriteBatch& insertTimestamp(uint64_t timestamp, const std::vector<Crypto::Hash>& blockHashes);
   BlockchainWriteBatch& insertKeyOutputInfo(IBlockchainCache::Amount amount, IBlockchainCache::GlobalOutputIndex globalIndex, const KeyOutputInfo& outputInfo);
+  BlockchainWriteBatch& insertBlockFilter(uint32_t blockIndex, const BlockFilter& filter);
 
   BlockchainWriteBatch& removeSpentKeyImages(uint32_t blockIndex, const std::vector<Crypto::KeyImage>& spentKeyImages);
   BlockchainWriteBatch& removeCachedTransaction(const Crypto::Hash& transactionHash, uint64_t totalTxsCount);
@@ -51,6 +53,7 @@ public:
   BlockchainWriteBatch& removeTimestamp(uint64_t timestamp);
   BlockchainWriteBatch& removeKeyOutputAmounts(uint32_t keyOutputAmountsToRemoveCount, uint32_t totalKeyOutputAmountsCount);
   BlockchainWriteBatch& removeKeyOutputInfo(IBlockchainCache::Amount amount, IBlockchainCache::GlobalOutputIndex globalIndex);
+  BlockchainWriteBatch& removeBlockFilter(uint32_t blockIndex);
 
   std::vector<std::pair<std::string, std::string>> extractRawDataToInsert() override;
   std::vector<std::string> extractRawKeysToRemove() override;
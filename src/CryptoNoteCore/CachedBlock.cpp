@@ -59,22 +59,44 @@ const Crypto::Hash& CachedBlock::getBlockHash() const {
 
 const Crypto::Hash& CachedBlock::getBlockLongHash(cn_context& cryptoContext) const {
   if (!blockLongHash.is_initialized()) {
-    if (block.majorVersion == BLOCK_MAJOR_VERSION_1) {
-      const auto& rawHashingBlock = getBlockHashingBinaryArray();
-      blockLongHash = Hash();
-      cn_slow_hash(cryptoContext, rawHashingBlock.data(), rawHashingBlock.size(), blockLongHash.get());
-    } else if (block.majorVersion >= BLOCK_MAJOR_VERSION_2) {
-      const auto& rawHashingBlock = getParentBlockHashingBinaryArray(true);
-      blockLongHash = Hash();
-      cn_slow_hash(cryptoContext, rawHashingBlock.data(), rawHashingBlock.size(), blockLongHash.get());
-    } else {
-      throw std::runtime_error("Unknown block major version.");
-    }
+    const auto& rawHashingBlock = getBlockLongHashingBinaryArray();
+    blockLongHash = Hash();
+    cn_slow_hash(cryptoContext, rawHashingBlock.data(), rawHashingBlock.size(), blockLongHash.get());
   }
 
   return blockLongHash.get();
 }
 
+void CachedBlock::calculateBlockLongHashes(const CachedBlock* const* blocks, cn_context* const* contexts, size_t count) {
+  std::vector<const CachedBlock*> pendingBlocks;
+  std::vector<const void*> data;
+  std::vector<size_t> sizes;
+  for (size_t i = 0; i < count; ++i) {
+    if (!blocks[i]->blockLongHash.is_initialized()) {
+      const auto& rawHashingBlock = blocks[i]->getBlockLongHashingBinaryArray();
+      pendingBlocks.push_back(blocks[i]);
+      data.push_back(rawHashingBlock.data());
+      sizes.push_back(rawHashingBlock.size());
+    }
+  }
+
+  std::vector<Hash> hashes(pendingBlocks.size());
+  cn_slow_hash_multi(contexts, data.data(), sizes.data(), hashes.data(), hashes.size());
+  for (size_t i = 0; i < pendingBlocks.size(); ++i) {
+    pendingBlocks[i]->blockLongHash = hashes[i];
+  }
+}
+
+const BinaryArray& CachedBlock::getBlockLongHashingBinaryArray() const {
+  if (block.majorVersion == BLOCK_MAJOR_VERSION_1) {
+    return getBlockHashingBinaryArray();
+  } else if (block.majorVersion >= BLOCK_MAJOR_VERSION_2) {
+    return getParentBlockHashingBinaryArray(true);
+  } else {
+    throw std::runtime_error("Unknown block major version.");
+  }
+}
+
 const Crypto::Hash& CachedBlock::getAuxiliaryBlockHeaderHash() const {
   if (!auxiliaryBlockHeaderHash.is_initialized()) {
     auxiliaryBlockHeaderHash = getObjectHash(getBlockHashingBinaryArray());
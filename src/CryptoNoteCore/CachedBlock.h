@@ -41,6 +41,11 @@ public:
   const BinaryArray& getParentBlockHashingBinaryArray(bool headerOnly) const;
   uint32_t getBlockIndex() const;
 
+  // Computes long hashes of several blocks at once with Crypto::cn_slow_hash_multi, contexts[i] is used for blocks[i].
+  static void calculateBlockLongHashes(const CachedBlock* const* blocks, Crypto::cn_context* const* contexts, size_t count);
+  // Blob hashed by getBlockLongHash, depends on block major version
+  const BinaryArray& getBlockLongHashingBinaryArray() const;
+
 private:
   const BlockTemplate& block;
   mutable boost::optional<BinaryArray> blockHashingBinaryArray;
@@ -22,7 +22,6 @@
 
 #include "Core.h"
 #include "Common/ShuffleGenerator.h"
-#include "Common/Math.h"
 #include "Common/MemoryInputStream.h"
 #include "CryptoNoteTools.h"
 #include "CryptoNoteFormatUtils.h"
@@ -55,6 +54,8 @@ std::vector<T> preallocateVector(size_t elements) {
   return vect;
 }
 UseGenesis addGenesisBlock = UseGenesis(true);
+// blocks merged into the accepting segment per push, each push is one database write
+const size_t MERGE_SEGMENTS_BATCH_SIZE = 100;
 
 class TransactionSpentInputsChecker {
 public:
@@ -155,8 +156,7 @@ int64_t getEmissionChange(const Currency& currency, IBlockchainCache& segment, u
   uint64_t reward = 0;
   int64_t emissionChange = 0;
   auto alreadyGeneratedCoins = segment.getAlreadyGeneratedCoins(previousBlockIndex);
-  auto lastBlocksSizes = segment.getLastBlocksSizes(currency.rewardBlocksWindow(), previousBlockIndex, addGenesisBlock);
-  auto blocksSizeMedian = Common::medianValue(lastBlocksSizes);
+  auto blocksSizeMedian = segment.getLastBlocksSizesMedian(currency.rewardBlocksWindow(), previousBlockIndex, addGenesisBlock);
   if (!currency.getBlockReward(cachedBlock.getBlock().majorVersion, blocksSizeMedian,
                                cumulativeSize, alreadyGeneratedCoins, cumulativeFee, reward, emissionChange)) {
     throw std::system_error(make_error_code(error::BlockValidationError::CUMULATIVE_BLOCK_SIZE_TOO_BIG));
@@ -251,11 +251,10 @@ Crypto::Hash Core::getTopBlockHash() const {
 Crypto::Hash Core::getBlockHashByIndex(uint32_t blockIndex) const {
   assert(!chainsStorage.empty());
   assert(!chainsLeaves.empty());
-  assert(blockIndex <= getTopBlockIndex());
 
   throwIfNotInitialized();
 
-  return chainsLeaves[0]->getBlockHash(blockIndex);
+  return mainChainBlockHashes.getBlockHash(blockIndex); // throws
 }
 
 uint64_t Core::getBlockTimestampByIndex(uint32_t blockIndex) const {
@@ -306,8 +305,7 @@ BlockTemplate Core::getBlockByHash(const Crypto::Hash& blockHash) const {
 
 std::vector<Crypto::Hash> Core::buildSparseChain() const {
   throwIfNotInitialized();
-  Crypto::Hash topBlockHash = chainsLeaves[0]->getTopBlockHash();
-  return doBuildSparseChain(topBlockHash);
+  return mainChainBlockHashes.buildSparseChain();
 }
 
 std::vector<RawBlock> Core::getBlocks(uint32_t minIndex, uint32_t count) const {
@@ -316,32 +314,26 @@ std::vector<RawBlock> Core::getBlocks(uint32_t minIndex, uint32_t count) const {
 
   throwIfNotInitialized();
 
-  std::vector<RawBlock> blocks;
-  if (count > 0) {
-    auto cache = chainsLeaves[0];
-    auto maxIndex = std::min(minIndex + count - 1, cache->getTopBlockIndex());
-    blocks.reserve(count);
-    while (cache) {
-      if (cache->getTopBlockIndex() >= maxIndex) {
-        auto minChainIndex = std::max(minIndex, cache->getStartBlockIndex());
-        for (; minChainIndex <= maxIndex; --maxIndex) {
-          blocks.emplace_back(cache->getBlockByIndex(maxIndex));
-          if (maxIndex == 0) {
-            break;
-          }
-        }
-      }
+  auto cache = chainsLeaves[0];
+  if (count == 0 || minIndex > cache->getTopBlockIndex()) {
+    return {};
+  }
 
-      if (blocks.size() == count) {
-        break;
-      }
+  return cache->getBlocksByIndexRange(minIndex, std::min(count, cache->getTopBlockIndex() - minIndex + 1));
+}
 
-      cache = cache->getParent();
-    }
+std::vector<BlockFilter> Core::getBlockFilters(uint32_t startIndex, uint32_t count) const {
+  assert(!chainsStorage.empty());
+  assert(!chainsLeaves.empty());
+
+  throwIfNotInitialized();
+
+  auto cache = chainsLeaves[0];
+  if (count == 0 || startIndex > cache->getTopBlockIndex()) {
+    return {};
   }
-  std::reverse(blocks.begin(), blocks.end());
 
-  return blocks;
+  return cache->getBlockFiltersByIndexRange(startIndex, std::min(count, cache->getTopBlockIndex() - startIndex + 1));
 }
 
 void Core::getBlocks(const std::vector<Crypto::Hash>& blockHashes, std::vector<RawBlock>& blocks,
@@ -512,12 +504,10 @@ Difficulty Core::getDifficultyForNextBlock() const {
 std::vector<Crypto::Hash> Core::findBlockchainSupplement(const std::vector<Crypto::Hash>& remoteBlockIds,
                                                          size_t maxCount, uint32_t& totalBlockCount,
                                                          uint32_t& startBlockIndex) const {
-  assert(!remoteBlockIds.empty());
-  assert(remoteBlockIds.back() == getBlockHashByIndex(0));
   throwIfNotInitialized();
 
   totalBlockCount = getTopBlockIndex() + 1;
-  startBlockIndex = findBlockchainSupplement(remoteBlockIds);
+  startBlockIndex = findBlockchainSupplement(remoteBlockIds); // throws
 
   return getBlockHashes(startBlockIndex, static_cast<uint32_t>(maxCount));
 }
@@ -531,10 +521,29 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
     return error::AddBlockErrorCode::ALREADY_EXISTS;
   }
 
+  std::vector<CachedTransaction> transactions;
+  uint64_t cumulativeSize = 0;
+  if (!extractTransactions(rawBlock.transactions, transactions, cumulativeSize)) {
+    logger(Logging::WARNING) << "Couldn't deserialize raw block transactions in block " << cachedBlock.getBlockHash();
+    return error::AddBlockErrorCode::DESERIALIZATION_FAILED;
+  }
+
+  return addBlock(cachedBlock, std::move(transactions), std::move(rawBlock));
+}
+
+std::error_code Core::addBlock(const CachedBlock& cachedBlock, std::vector<CachedTransaction>&& transactions, RawBlock&& rawBlock) {
+  throwIfNotInitialized();
+
+  if (hasBlock(cachedBlock.getBlockHash())) {
+    logger(Logging::DEBUGGING) << "Block " << cachedBlock.getBlockHash() << " already exists";
+    return error::AddBlockErrorCode::ALREADY_EXISTS;
+  }
+
   const auto& blockTemplate = cachedBlock.getBlock();
   const auto& previousBlockHash = blockTemplate.previousBlockHash;
 
   assert(rawBlock.transactions.size() == blockTemplate.transactionHashes.size());
+  assert(transactions.size() == rawBlock.transactions.size());
 
   auto cache = findSegmentContainingBlock(previousBlockHash);
   if (cache == nullptr) {
@@ -542,11 +551,14 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
     return error::AddBlockErrorCode::REJECTED_AS_ORPHANED;
   }
 
-  std::vector<CachedTransaction> transactions;
   uint64_t cumulativeSize = 0;
-  if (!extractTransactions(rawBlock.transactions, transactions, cumulativeSize)) {
-    logger(Logging::WARNING) << "Couldn't deserialize raw block transactions in block " << cachedBlock.getBlockHash();
-    return error::AddBlockErrorCode::DESERIALIZATION_FAILED;
+  for (const auto& rawTransaction : rawBlock.transactions) {
+    if (rawTransaction.size() > currency.maxTxSize()) {
+      logger(Logging::WARNING) << "Raw transaction size " << rawTransaction.size() << " is too big in block " << cachedBlock.getBlockHash();
+      return error::AddBlockErrorCode::DESERIALIZATION_FAILED;
+    }
+
+    cumulativeSize += rawTransaction.size();
   }
 
   auto coinbaseTransactionSize = getObjectBinarySize(blockTemplate.baseTransaction);
@@ -591,8 +603,7 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
   uint64_t reward = 0;
   int64_t emissionChange = 0;
   auto alreadyGeneratedCoins = cache->getAlreadyGeneratedCoins(previousBlockIndex);
-  auto lastBlocksSizes = cache->getLastBlocksSizes(currency.rewardBlocksWindow(), previousBlockIndex, addGenesisBlock);
-  auto blocksSizeMedian = Common::medianValue(lastBlocksSizes);
+  auto blocksSizeMedian = cache->getLastBlocksSizesMedian(currency.rewardBlocksWindow(), previousBlockIndex, addGenesisBlock);
 
   if (!currency.getBlockReward(cachedBlock.getBlock().majorVersion, blocksSizeMedian,
                                cumulativeBlockSize, alreadyGeneratedCoins, cumulativeFee, reward, emissionChange)) {
@@ -611,7 +622,7 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
       logger(Logging::WARNING) << "Checkpoint block hash mismatch for block " << cachedBlock.getBlockHash();
       return error::BlockValidationError::CHECKPOINT_BLOCK_HASH_MISMATCH;
     }
-  } else if (!currency.checkProofOfWork(cryptoContext, cachedBlock, currentDifficulty)) {
+  } else if (!currency.checkProofOfWork(*cryptoContextPool.acquire(), cachedBlock, currentDifficulty)) {
     logger(Logging::WARNING) << "Proof of work too weak for block " << cachedBlock.getBlockHash();
     return error::BlockValidationError::PROOF_OF_WORK_TOO_WEAK;
   }
@@ -628,6 +639,7 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
         mainChainStorage->pushBlock(rawBlock);
 
         cache->pushBlock(cachedBlock, transactions, validatorState, cumulativeBlockSize, emissionChange, currentDifficulty, std::move(rawBlock));
+        mainChainBlockHashes.pushBlock(cachedBlock.getBlockHash());
 
         updateBlockMedianSize();
         actualizePoolTransactionsLite(validatorState);
@@ -753,14 +765,11 @@ void Core::actualizePoolTransactionsLite(const TransactionValidatorState& valida
 void Core::switchMainChainStorage(uint32_t splitBlockIndex, IBlockchainCache& newChain) {
   assert(mainChainStorage->getBlockCount() > splitBlockIndex);
 
-  auto blocksToPop = mainChainStorage->getBlockCount() - splitBlockIndex;
-  for (size_t i = 0; i < blocksToPop; ++i) {
-    mainChainStorage->popBlock();
-  }
+  mainChainStorage->popBlocks(mainChainStorage->getBlockCount() - splitBlockIndex);
+  mainChainStorage->pushBlocks(newChain.getBlocksByIndexRange(splitBlockIndex, newChain.getTopBlockIndex() - splitBlockIndex + 1));
 
-  for (uint32_t index = splitBlockIndex; index <= newChain.getTopBlockIndex(); ++index) {
-    mainChainStorage->pushBlock(newChain.getBlockByIndex(index));
-  }
+  mainChainBlockHashes.cutFrom(splitBlockIndex);
+  mainChainBlockHashes.pushBlocks(newChain.getBlockHashes(splitBlockIndex, newChain.getTopBlockIndex() - splitBlockIndex + 1));
 }
 
 void Core::notifyOnSuccess(error::AddBlockErrorCode opResult, uint32_t previousBlockIndex,
@@ -798,6 +807,10 @@ std::error_code Core::addBlock(RawBlock&& rawBlock) {
   return addBlock(cachedBlock, std::move(rawBlock));
 }
 
+bool Core::isInCheckpointZone(uint32_t blockIndex) const {
+  return checkpoints.isInCheckpointZone(blockIndex);
+}
+
 std::error_code Core::submitBlock(BinaryArray&& rawBlockTemplate) {
   throwIfNotInitialized();
 
@@ -958,6 +971,19 @@ std::vector<Crypto::Hash> Core::getPoolTransactionHashes() const {
   return transactionPool->getTransactionHashes();
 }
 
+void Core::getPoolTransactions(const std::vector<Crypto::Hash>& transactionHashes, std::vector<BinaryArray>& transactions,
+                               std::vector<Crypto::Hash>& missedHashes) const {
+  throwIfNotInitialized();
+
+  for (const auto& hash : transactionHashes) {
+    if (transactionPool->checkIfTransactionPresent(hash)) {
+      transactions.emplace_back(transactionPool->getTransaction(hash).getTransactionBinaryArray());
+    } else {
+      missedHashes.push_back(hash);
+    }
+  }
+}
+
 bool Core::getPoolChanges(const Crypto::Hash& lastBlockHash, const std::vector<Crypto::Hash>& knownHashes,
                           std::vector<BinaryArray>& addedTransactions,
                           std::vector<Crypto::Hash>& deletedTransactions) const {
@@ -1325,19 +1351,43 @@ std::error_code Core::validateSemantic(const Transaction& transaction, uint64_t&
 }
 
 uint32_t Core::findBlockchainSupplement(const std::vector<Crypto::Hash>& remoteBlockIds) const {
-  // TODO: check for genesis blocks match
-  for (auto& hash : remoteBlockIds) {
-    IBlockchainCache* blockchainSegment = findMainChainSegmentContainingBlock(hash);
-    if (blockchainSegment != nullptr) {
-      return blockchainSegment->getBlockIndex(hash);
+  // remote ids go from the remote top block down to genesis, so once an id is found in main chain
+  // all the following ids are found too and the first of them is found by binary search
+  if (remoteBlockIds.empty() || remoteBlockIds.back() != mainChainBlockHashes.getBlockHash(0)) {
+    throw std::runtime_error("Genesis block hash was not found.");
+  }
+
+  uint32_t blockIndex = 0;
+
+  size_t first = 0;
+  size_t last = remoteBlockIds.size() - 1;
+  while (first < last) {
+    size_t middle = first + (last - first) / 2;
+    uint32_t middleBlockIndex;
+    if (findMainChainBlockIndex(remoteBlockIds[middle], middleBlockIndex)) {
+      last = middle;
+      blockIndex = middleBlockIndex;
+    } else {
+      first = middle + 1;
     }
   }
 
-  throw std::runtime_error("Genesis block hash was not found.");
+  return blockIndex;
+}
+
+bool Core::findMainChainBlockIndex(const Crypto::Hash& blockHash, uint32_t& blockIndex) const {
+  IBlockchainCache* blockchainSegment = findMainChainSegmentContainingBlock(blockHash);
+  if (blockchainSegment == nullptr) {
+    return false;
+  }
+
+  blockIndex = blockchainSegment->getBlockIndex(blockHash);
+  assert(mainChainBlockHashes.hasBlock(blockIndex, blockHash));
+  return true;
 }
 
 std::vector<Crypto::Hash> CryptoNote::Core::getBlockHashes(uint32_t startBlockIndex, uint32_t maxCount) const {
-  return chainsLeaves[0]->getBlockHashes(startBlockIndex, maxCount);
+  return mainChainBlockHashes.getBlockHashes(startBlockIndex, maxCount);
 }
 
 std::error_code Core::validateBlock(const CachedBlock& cachedBlock, IBlockchainCache* cache, uint64_t& minerReward) {
@@ -1368,9 +1418,9 @@ std::error_code Core::validateBlock(const CachedBlock& cachedBlock, IBlockchainC
     return error::BlockValidationError::TIMESTAMP_TOO_FAR_IN_FUTURE;
   }
 
-  auto timestamps = cache->getLastTimestamps(currency.timestampCheckWindow(), previousBlockIndex, addGenesisBlock);
-  if (timestamps.size() >= currency.timestampCheckWindow()) {
-    auto median_ts = Common::medianValue(timestamps);
+  // window includes genesis block, so it is full once there are timestampCheckWindow blocks
+  if (static_cast<size_t>(previousBlockIndex) + 1 >= currency.timestampCheckWindow()) {
+    auto median_ts = cache->getLastTimestampsMedian(currency.timestampCheckWindow(), previousBlockIndex, addGenesisBlock);
     if (block.timestamp < median_ts) {
       return error::BlockValidationError::TIMESTAMP_TOO_FAR_IN_PAST;
     }
@@ -1434,6 +1484,11 @@ void Core::save() {
 void Core::load() {
   initRootSegment();
 
+  {
+    auto cryptoContext = cryptoContextPool.acquire();
+    logger(Logging::INFO) << "Proof of work scratchpads are backed by " << Crypto::cn_pages_name(cryptoContext->pages());
+  }
+
   auto dbBlocksCount = chainsLeaves[0]->getTopBlockIndex() + 1;
   auto storageBlocksCount = mainChainStorage->getBlockCount();
 
@@ -1459,6 +1514,8 @@ void Core::load() {
     logger(Logging::DEBUGGING) << "Blockchain storage and root segment are on the same height and chain";
   }
 
+  loadMainChainBlockHashes();
+
   initialized = true;
 }
 
@@ -1523,6 +1580,18 @@ void Core::importBlocksFromStorage() {
   }
 }
 
+void Core::loadMainChainBlockHashes() {
+  const uint32_t BATCH_SIZE = 10000;
+
+  mainChainBlockHashes.clear();
+  auto blockCount = chainsLeaves[0]->getTopBlockIndex() + 1;
+  while (mainChainBlockHashes.getBlockCount() < blockCount) {
+    mainChainBlockHashes.pushBlocks(chainsLeaves[0]->getBlockHashes(mainChainBlockHashes.getBlockCount(), BATCH_SIZE));
+  }
+
+  logger(Logging::DEBUGGING) << "Loaded " << blockCount << " main chain block hashes";
+}
+
 void Core::cutSegment(IBlockchainCache& segment, uint32_t startIndex) {
   if (segment.getTopBlockIndex() < startIndex) {
     return;
@@ -1590,27 +1659,6 @@ BlockTemplate Core::restoreBlockTemplate(IBlockchainCache* blockchainCache, uint
   return block;
 }
 
-std::vector<Crypto::Hash> Core::doBuildSparseChain(const Crypto::Hash& blockHash) const {
-  IBlockchainCache* chain = findSegmentContainingBlock(blockHash);
-
-  uint32_t blockIndex = chain->getBlockIndex(blockHash);
-
-  // TODO reserve ceil(log(blockIndex))
-  std::vector<Crypto::Hash> sparseChain;
-  sparseChain.push_back(blockHash);
-
-  for (uint32_t i = 1; i < blockIndex; i *= 2) {
-    sparseChain.push_back(chain->getBlockHash(blockIndex - i));
-  }
-
-  auto genesisBlockHash = chain->getBlockHash(0);
-  if (sparseChain[0] != genesisBlockHash) {
-    sparseChain.push_back(genesisBlockHash);
-  }
-
-  return sparseChain;
-}
-
 RawBlock Core::getRawBlock(IBlockchainCache* segment, uint32_t blockIndex) const {
   assert(blockIndex >= segment->getStartBlockIndex() && blockIndex <= segment->getTopBlockIndex());
 
@@ -1748,8 +1796,7 @@ size_t Core::calculateCumulativeBlocksizeLimit(uint32_t height) const {
   assert(!chainsStorage.empty());
   assert(!chainsLeaves.empty());
   // FIXME: skip gensis here?
-  auto sizes = chainsLeaves[0]->getLastBlocksSizes(currency.rewardBlocksWindow());
-  uint64_t median = Common::medianValue(sizes);
+  uint64_t median = chainsLeaves[0]->getLastBlocksSizesMedian(currency.rewardBlocksWindow());
   if (median <= nextBlockGrantedFullRewardZone) {
     median = nextBlockGrantedFullRewardZone;
   }
@@ -1877,6 +1924,8 @@ void Core::mergeSegments(IBlockchainCache* acceptingSegment, IBlockchainCache* s
 
   auto startIndex = segment->getStartBlockIndex();
   auto blockCount = segment->getBlockCount();
+  std::vector<PushedBlock> blocks;
+  blocks.reserve(std::min<size_t>(blockCount, MERGE_SEGMENTS_BATCH_SIZE));
   for (auto blockIndex = startIndex; blockIndex < startIndex + blockCount; ++blockIndex) {
     PushedBlockInfo info = segment->getPushedBlockInfo(blockIndex);
 
@@ -1892,9 +1941,14 @@ void Core::mergeSegments(IBlockchainCache* acceptingSegment, IBlockchainCache* s
       throw std::runtime_error("Couldn't deserialize transactions");
     }
 
-    acceptingSegment->pushBlock(CachedBlock(block), transactions, info.validatorState, info.blockSize,
-                                info.generatedCoins, info.blockDifficulty, std::move(info.rawBlock));
+    blocks.push_back(PushedBlock{std::move(block), std::move(transactions), std::move(info)});
+    if (blocks.size() == MERGE_SEGMENTS_BATCH_SIZE) {
+      acceptingSegment->pushBlocks(std::move(blocks));
+      blocks.clear();
+    }
   }
+
+  acceptingSegment->pushBlocks(std::move(blocks));
 }
 
 BlockDetails Core::getBlockDetails(const Crypto::Hash& blockHash) const {
@@ -1906,15 +1960,99 @@ BlockDetails Core::getBlockDetails(const Crypto::Hash& blockHash) const {
   }
 
   uint32_t blockIndex = segment->getBlockIndex(blockHash);
-  BlockTemplate blockTemplate = restoreBlockTemplate(segment, blockIndex);
-  
+  uint32_t infosStartIndex = blockIndex == 0 ? 0 : blockIndex - 1;
+  auto blockInfos = segment->getBlockInfosByIndexRange(infosStartIndex, blockIndex - infosStartIndex + 1);
+
+  return getBlockDetails(segment, blockIndex, segment->getBlockByIndex(blockIndex), blockInfos.back(),
+                         blockIndex == 0 ? nullptr : &blockInfos.front());
+}
+
+std::vector<BlockDetails> Core::getBlocksDetails(uint32_t startIndex, uint32_t count) const {
+  throwIfNotInitialized();
+
+  IBlockchainCache* mainChain = chainsLeaves[0];
+  uint32_t topIndex = mainChain->getTopBlockIndex();
+  if (count == 0 || startIndex > topIndex) {
+    return {};
+  }
+
+  count = std::min(count, topIndex - startIndex + 1);
+
+  // infos of the whole range and its previous block and raw blocks are read at once,
+  // block size medians of consecutive blocks are computed by sliding one window
+  uint32_t infosStartIndex = startIndex == 0 ? 0 : startIndex - 1;
+  auto blockInfos = mainChain->getBlockInfosByIndexRange(infosStartIndex, startIndex + count - infosStartIndex);
+  auto rawBlocks = mainChain->getBlocksByIndexRange(startIndex, count);
+  assert(rawBlocks.size() == count);
+
+  std::vector<BlockDetails> blocksDetails;
+  blocksDetails.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t blockIndex = startIndex + i;
+    const CachedBlockInfo* previousBlockInfo = blockIndex == 0 ? nullptr : &blockInfos[blockIndex - 1 - infosStartIndex];
+    blocksDetails.push_back(getBlockDetails(mainChain, blockIndex, std::move(rawBlocks[i]), blockInfos[blockIndex - infosStartIndex], previousBlockInfo));
+  }
+
+  return blocksDetails;
+}
+
+std::vector<BlockDetails> Core::getBlocksDetails(const std::vector<Crypto::Hash>& blockHashes) const {
+  throwIfNotInitialized();
+
+  std::vector<BlockDetails> blocksDetails;
+  blocksDetails.reserve(blockHashes.size());
+
+  auto getMainChainIndex = [this](const Crypto::Hash& blockHash, uint32_t& blockIndex) {
+    IBlockchainCache* segment = findSegmentContainingBlock(blockHash);
+    if (segment == nullptr || mainChainSet.count(segment) == 0) {
+      return false;
+    }
+
+    blockIndex = segment->getBlockIndex(blockHash);
+    return true;
+  };
+
+  // hashes of consecutive main chain blocks are fetched as one range, alternative blocks one by one
+  size_t runStart = 0;
+  while (runStart < blockHashes.size()) {
+    uint32_t startIndex;
+    if (!getMainChainIndex(blockHashes[runStart], startIndex)) {
+      blocksDetails.push_back(getBlockDetails(blockHashes[runStart]));
+      ++runStart;
+      continue;
+    }
+
+    size_t runEnd = runStart + 1;
+    uint32_t blockIndex;
+    while (runEnd < blockHashes.size() && getMainChainIndex(blockHashes[runEnd], blockIndex) &&
+           blockIndex == startIndex + (runEnd - runStart)) {
+      ++runEnd;
+    }
+
+    auto runDetails = getBlocksDetails(startIndex, static_cast<uint32_t>(runEnd - runStart));
+    assert(runDetails.size() == runEnd - runStart);
+    std::move(runDetails.begin(), runDetails.end(), std::back_inserter(blocksDetails));
+
+    runStart = runEnd;
+  }
+
+  return blocksDetails;
+}
+
+BlockDetails Core::getBlockDetails(IBlockchainCache* segment, uint32_t blockIndex, RawBlock&& rawBlock, const CachedBlockInfo& blockInfo,
+                                   const CachedBlockInfo* previousBlockInfo) const {
+  BlockTemplate blockTemplate;
+  if (!fromBinaryArray(blockTemplate, rawBlock.block)) {
+    throw std::runtime_error("Coulnd't deserialize BlockTemplate");
+  }
+
   BlockDetails blockDetails;
   blockDetails.majorVersion = blockTemplate.majorVersion;
   blockDetails.minorVersion = blockTemplate.minorVersion;
   blockDetails.timestamp = blockTemplate.timestamp;
   blockDetails.prevBlockHash = blockTemplate.previousBlockHash;
   blockDetails.nonce = blockTemplate.nonce;
-  blockDetails.hash = blockHash;
+  blockDetails.hash = blockInfo.blockHash;
 
   blockDetails.reward = 0;
   for (const TransactionOutput& out : blockTemplate.baseTransaction.outputs) {
@@ -1924,25 +2062,22 @@ BlockDetails Core::getBlockDetails(const Crypto::Hash& blockHash) const {
   blockDetails.index = blockIndex;
   blockDetails.isAlternative = mainChainSet.count(segment) == 0;
 
-  blockDetails.difficulty = getBlockDifficulty(blockIndex);
+  blockDetails.difficulty = blockInfo.cumulativeDifficulty - (previousBlockInfo == nullptr ? 0 : previousBlockInfo->cumulativeDifficulty);
 
-  std::vector<uint64_t> sizes = segment->getLastBlocksSizes(1, blockDetails.index, addGenesisBlock);
-  assert(sizes.size() == 1);
-  blockDetails.transactionsCumulativeSize = sizes.front();
+  blockDetails.transactionsCumulativeSize = blockInfo.blockSize;
 
   uint64_t blockBlobSize = getObjectBinarySize(blockTemplate);
   uint64_t coinbaseTransactionSize = getObjectBinarySize(blockTemplate.baseTransaction);
   blockDetails.blockSize = blockBlobSize + blockDetails.transactionsCumulativeSize - coinbaseTransactionSize;
 
-  blockDetails.alreadyGeneratedCoins = segment->getAlreadyGeneratedCoins(blockDetails.index);
-  blockDetails.alreadyGeneratedTransactions = segment->getAlreadyGeneratedTransactions(blockDetails.index);
+  blockDetails.alreadyGeneratedCoins = blockInfo.alreadyGeneratedCoins;
+  blockDetails.alreadyGeneratedTransactions = blockInfo.alreadyGeneratedTransactions;
 
   uint64_t prevBlockGeneratedCoins = 0;
   blockDetails.sizeMedian = 0;
   if (blockDetails.index > 0) {
-    auto lastBlocksSizes = segment->getLastBlocksSizes(currency.rewardBlocksWindow(), blockDetails.index - 1, addGenesisBlock);
-    blockDetails.sizeMedian = Common::medianValue(lastBlocksSizes);
-    prevBlockGeneratedCoins = segment->getAlreadyGeneratedCoins(blockDetails.index - 1);
+    blockDetails.sizeMedian = segment->getLastBlocksSizesMedian(currency.rewardBlocksWindow(), blockDetails.index - 1, addGenesisBlock);
+    prevBlockGeneratedCoins = previousBlockInfo->alreadyGeneratedCoins;
   }
 
   int64_t emissionChange = 0;
@@ -1961,13 +2096,19 @@ BlockDetails Core::getBlockDetails(const Crypto::Hash& blockHash) const {
     blockDetails.penalty = static_cast<double>(blockDetails.baseReward - currentReward) / static_cast<double>(blockDetails.baseReward);
   }
 
-  blockDetails.transactions.reserve(blockTemplate.transactionHashes.size() + 1);
+  // transactions are taken from the raw block instead of looking each of them up
+  std::vector<CachedTransaction> transactions;
+  if (!Utils::restoreCachedTransactions(rawBlock.transactions, transactions)) {
+    throw std::runtime_error("Couldn't deserialize transactions");
+  }
+
+  blockDetails.transactions.reserve(transactions.size() + 1);
   CachedTransaction cachedBaseTx(std::move(blockTemplate.baseTransaction));
-  blockDetails.transactions.push_back(getTransactionDetails(cachedBaseTx.getTransactionHash(), segment, false));
+  blockDetails.transactions.push_back(getTransactionDetails(cachedBaseTx, segment, blockIndex, blockInfo.blockHash, blockInfo.timestamp));
 
   blockDetails.totalFeeAmount = 0;
-  for (const Crypto::Hash& transactionHash : blockTemplate.transactionHashes) {
-    blockDetails.transactions.push_back(getTransactionDetails(transactionHash, segment, false));
+  for (const CachedTransaction& transaction : transactions) {
+    blockDetails.transactions.push_back(getTransactionDetails(transaction, segment, blockIndex, blockInfo.blockHash, blockInfo.timestamp));
     blockDetails.totalFeeAmount += blockDetails.transactions.back().fee;
   }
 
@@ -1992,9 +2133,6 @@ TransactionDetails Core::getTransactionDetails(const Crypto::Hash& transactionHa
     segment = chainsLeaves[0];
   }
 
-  std::unique_ptr<ITransaction> transaction;
-  Transaction rawTransaction;
-  TransactionDetails transactionDetails;
   if (!foundInPool) {
     std::vector<Crypto::Hash> transactionsHashes;
     std::vector<BinaryArray> rawTransactions;
@@ -2009,31 +2147,44 @@ TransactionDetails Core::getTransactionDetails(const Crypto::Hash& transactionHa
     Utils::restoreCachedTransactions(rawTransactions, transactions);
     assert(transactions.size() == 1);
 
-    transactionDetails.inBlockchain = true;
-    transactionDetails.blockIndex = segment->getBlockIndexContainingTx(transactionHash);
-    transactionDetails.blockHash = segment->getBlockHash(transactionDetails.blockIndex);
-
-    auto timestamps = segment->getLastTimestamps(1, transactionDetails.blockIndex, addGenesisBlock);
+    uint32_t blockIndex = segment->getBlockIndexContainingTx(transactionHash);
+    auto timestamps = segment->getLastTimestamps(1, blockIndex, addGenesisBlock);
     assert(timestamps.size() == 1);
-    transactionDetails.timestamp = timestamps.back();
 
-    transactionDetails.size = transactions.back().getTransactionBinaryArray().size();
-    transactionDetails.fee = transactions.back().getTransactionFee();
+    return getTransactionDetails(transactions.back(), segment, blockIndex, segment->getBlockHash(blockIndex), timestamps.back());
+  }
 
-    rawTransaction = transactions.back().getTransaction();
-    transaction = createTransaction(rawTransaction);
-  } else {
-    transactionDetails.inBlockchain = false;
-    transactionDetails.timestamp = transactionPool->getTransactionReceiveTime(transactionHash);
+  TransactionDetails transactionDetails;
+  transactionDetails.inBlockchain = false;
+  transactionDetails.timestamp = transactionPool->getTransactionReceiveTime(transactionHash);
 
-    transactionDetails.size = transactionPool->getTransaction(transactionHash).getTransactionBinaryArray().size();
-    transactionDetails.fee = transactionPool->getTransaction(transactionHash).getTransactionFee();
+  transactionDetails.size = transactionPool->getTransaction(transactionHash).getTransactionBinaryArray().size();
+  transactionDetails.fee = transactionPool->getTransaction(transactionHash).getTransactionFee();
+  transactionDetails.hash = transactionHash;
 
-    rawTransaction = transactionPool->getTransaction(transactionHash).getTransaction();
-    transaction = createTransaction(rawTransaction);
-  }
+  fillTransactionDetails(transactionPool->getTransaction(transactionHash).getTransaction(), segment, transactionDetails);
+  return transactionDetails;
+}
+
+TransactionDetails Core::getTransactionDetails(const CachedTransaction& transaction, IBlockchainCache* segment, uint32_t blockIndex,
+                                               const Crypto::Hash& blockHash, uint64_t timestamp) const {
+  TransactionDetails transactionDetails;
+  transactionDetails.inBlockchain = true;
+  transactionDetails.blockIndex = blockIndex;
+  transactionDetails.blockHash = blockHash;
+  transactionDetails.timestamp = timestamp;
+
+  transactionDetails.size = transaction.getTransactionBinaryArray().size();
+  transactionDetails.fee = transaction.getTransactionFee();
+  transactionDetails.hash = transaction.getTransactionHash();
+
+  fillTransactionDetails(transaction.getTransaction(), segment, transactionDetails);
+  return transactionDetails;
+}
+
+void Core::fillTransactionDetails(const Transaction& rawTransaction, IBlockchainCache* segment, TransactionDetails& transactionDetails) const {
+  std::unique_ptr<ITransaction> transaction = createTransaction(rawTransaction);
 
-  transactionDetails.hash = transactionHash;
   transactionDetails.unlockTime = transaction->getUnlockTime();
 
   transactionDetails.totalOutputsAmount = transaction->getOutputTotalAmount();
@@ -2094,7 +2245,15 @@ TransactionDetails Core::getTransactionDetails(const Crypto::Hash& transactionHa
   transactionDetails.outputs.reserve(transaction->getOutputCount());
   std::vector<uint32_t> globalIndexes;
   globalIndexes.reserve(transaction->getOutputCount());
-  if (!transactionDetails.inBlockchain || !getTransactionGlobalIndexes(transactionDetails.hash, globalIndexes)) {
+  bool globalIndexesFound = false;
+  if (transactionDetails.inBlockchain) {
+    // transaction is in the segment or in one of its parents
+    for (auto chain = segment; chain != nullptr && !globalIndexesFound; chain = chain->getParent()) {
+      globalIndexesFound = chain->getTransactionGlobalIndexes(transactionDetails.hash, globalIndexes);
+    }
+  }
+
+  if (!globalIndexesFound) {
     for (size_t i = 0; i < transaction->getOutputCount(); ++i) {
       globalIndexes.push_back(0);
     }
@@ -2107,8 +2266,6 @@ TransactionDetails Core::getTransactionDetails(const Crypto::Hash& transactionHa
     txOutDetails.globalIndex = globalIndexes[i];
     transactionDetails.outputs.push_back(std::move(txOutDetails));
   }
-
-  return transactionDetails;
 }
 
 std::vector<Crypto::Hash> Core::getAlternativeBlockHashesByIndex(uint32_t blockIndex) const {
@@ -2233,9 +2390,9 @@ void Core::updateBlockMedianSize() {
 
   size_t nextBlockGrantedFullRewardZone = currency.blockGrantedFullRewardZoneByBlockVersion(upgradeManager->getBlockMajorVersion(mainChain->getTopBlockIndex() + 1));
 
-  auto lastBlockSizes = mainChain->getLastBlocksSizes(currency.rewardBlocksWindow());
+  auto lastBlocksSizesMedian = mainChain->getLastBlocksSizesMedian(currency.rewardBlocksWindow());
 
-  blockMedianSize = std::max(Common::medianValue(lastBlockSizes), static_cast<uint64_t>(nextBlockGrantedFullRewardZone));
+  blockMedianSize = std::max(lastBlocksSizesMedian, static_cast<uint64_t>(nextBlockGrantedFullRewardZone));
 }
 
 }
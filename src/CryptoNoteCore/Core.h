@@ -24,6 +24,7 @@
 #include "CachedTransaction.h"
 #include "Currency.h"
 #include "Checkpoints.h"
+#include "CryptoContextPool.h"
 #include "IBlockchainCache.h"
 #include "IBlockchainCacheFactory.h"
 #include "ICore.h"
@@ -32,6 +33,7 @@
 #include "ITransactionPool.h"
 #include "ITransactionPoolCleaner.h"
 #include "IUpgradeManager.h"
+#include "MainChainBlockHashes.h"
 #include <Logging/LoggerMessage.h>
 #include "MessageQueue.h"
 #include "TransactionValidatiorState.h"
@@ -79,7 +81,9 @@ public:
   virtual Difficulty getDifficultyForNextBlock() const override;
 
   virtual std::error_code addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlock) override;
+  virtual std::error_code addBlock(const CachedBlock& cachedBlock, std::vector<CachedTransaction>&& transactions, RawBlock&& rawBlock) override;
   virtual std::error_code addBlock(RawBlock&& rawBlock) override;
+  virtual bool isInCheckpointZone(uint32_t blockIndex) const override;
 
   virtual std::error_code submitBlock(BinaryArray&& rawBlockTemplate) override;
 
@@ -89,6 +93,8 @@ public:
   virtual bool addTransactionToPool(const BinaryArray& transactionBinaryArray) override;
 
   virtual std::vector<Crypto::Hash> getPoolTransactionHashes() const override;
+  virtual void getPoolTransactions(const std::vector<Crypto::Hash>& transactionHashes, std::vector<BinaryArray>& transactions,
+    std::vector<Crypto::Hash>& missedHashes) const override;
   virtual bool getPoolChanges(const Crypto::Hash& lastBlockHash, const std::vector<Crypto::Hash>& knownHashes, std::vector<BinaryArray>& addedTransactions,
     std::vector<Crypto::Hash>& deletedTransactions) const override;
   virtual bool getPoolChangesLite(const Crypto::Hash& lastBlockHash, const std::vector<Crypto::Hash>& knownHashes, std::vector<TransactionPrefixInfo>& addedTransactions,
@@ -107,11 +113,16 @@ public:
   virtual std::vector<Transaction> getPoolTransactions() const override;
 
   const Currency& getCurrency() const;
+  // filters of main chain blocks [startIndex, startIndex + count), range is clipped to the top block
+  std::vector<BlockFilter> getBlockFilters(uint32_t startIndex, uint32_t count) const;
 
   virtual void save() override;
   virtual void load() override;
 
   virtual BlockDetails getBlockDetails(const Crypto::Hash& blockHash) const override;
+  virtual std::vector<BlockDetails> getBlocksDetails(uint32_t startIndex, uint32_t count) const override;
+  // details in the order of the hashes, runs of consecutive main chain blocks are read as ranges
+  std::vector<BlockDetails> getBlocksDetails(const std::vector<Crypto::Hash>& blockHashes) const;
   virtual TransactionDetails getTransactionDetails(const Crypto::Hash& transactionHash) const override;
   virtual std::vector<Crypto::Hash> getAlternativeBlockHashesByIndex(uint32_t blockIndex) const override;
   virtual std::vector<Crypto::Hash> getBlockHashesByTimestamps(uint64_t timestampBegin, size_t secondsCount) const override;
@@ -122,7 +133,7 @@ private:
   System::Dispatcher& dispatcher;
   System::ContextGroup contextGroup;
   Logging::LoggerRef logger;
-  Crypto::cn_context cryptoContext;
+  CryptoContextPool cryptoContextPool;
   Checkpoints checkpoints;
   std::unique_ptr<IUpgradeManager> upgradeManager;
   std::vector<std::unique_ptr<IBlockchainCache>> chainsStorage;
@@ -135,6 +146,7 @@ private:
   IntrusiveLinkedList<MessageQueue<BlockchainMessage>> queueList;
   std::unique_ptr<IBlockchainCacheFactory> blockchainCacheFactory;
   std::unique_ptr<IMainChainStorage> mainChainStorage;
+  MainChainBlockHashes mainChainBlockHashes;
   bool initialized;
 
   size_t blockMedianSize;
@@ -162,7 +174,8 @@ private:
   IBlockchainCache* findSegmentContainingTransaction(const Crypto::Hash& transactionHash) const;
 
   BlockTemplate restoreBlockTemplate(IBlockchainCache* blockchainCache, uint32_t blockIndex) const;
-  std::vector<Crypto::Hash> doBuildSparseChain(const Crypto::Hash& blockHash) const;
+  bool findMainChainBlockIndex(const Crypto::Hash& blockHash, uint32_t& blockIndex) const;
+  void loadMainChainBlockHashes();
 
   RawBlock getRawBlock(IBlockchainCache* segment, uint32_t blockIndex) const;
 
@@ -181,7 +194,12 @@ private:
   void deleteLeaf(size_t leafIndex);
   void mergeMainChainSegments();
   void mergeSegments(IBlockchainCache* acceptingSegment, IBlockchainCache* segment);
+  BlockDetails getBlockDetails(IBlockchainCache* segment, uint32_t blockIndex, RawBlock&& rawBlock, const CachedBlockInfo& blockInfo,
+                               const CachedBlockInfo* previousBlockInfo) const;
   TransactionDetails getTransactionDetails(const Crypto::Hash& transactionHash, IBlockchainCache* segment, bool foundInPool) const;
+  TransactionDetails getTransactionDetails(const CachedTransaction& transaction, IBlockchainCache* segment, uint32_t blockIndex,
+                                           const Crypto::Hash& blockHash, uint64_t timestamp) const;
+  void fillTransactionDetails(const Transaction& rawTransaction, IBlockchainCache* segment, TransactionDetails& transactionDetails) const;
   void notifyOnSuccess(error::AddBlockErrorCode opResult, uint32_t previousBlockIndex, const CachedBlock& cachedBlock,
                        const IBlockchainCache& cache);
   void copyTransactionsToPool(IBlockchainCache* alt);
@@ -0,0 +1,74 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "CryptoContextPool.h"
+
+namespace CryptoNote {
+
+CryptoContextPool::ContextReleaser::ContextReleaser(CryptoContextPool* pool) : pool(pool) {
+}
+
+void CryptoContextPool::ContextReleaser::operator()(Crypto::cn_context* context) const {
+  if (pool != nullptr) {
+    pool->release(context);
+  } else {
+    delete context;
+  }
+}
+
+CryptoContextPool::CryptoContextPool(size_t maxIdleContexts) : maxIdleContexts(maxIdleContexts) {
+}
+
+CryptoContextPool::Context CryptoContextPool::acquire() {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!idleContexts.empty()) {
+      Context context(idleContexts.back().release(), ContextReleaser(this));
+      idleContexts.pop_back();
+      return context;
+    }
+  }
+
+  return Context(new Crypto::cn_context(), ContextReleaser(this));
+}
+
+std::vector<CryptoContextPool::Context> CryptoContextPool::acquire(size_t count) {
+  std::vector<Context> contexts;
+  contexts.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    contexts.push_back(acquire());
+  }
+
+  return contexts;
+}
+
+size_t CryptoContextPool::getIdleContextCount() const {
+  std::unique_lock<std::mutex> lock(mutex);
+  return idleContexts.size();
+}
+
+void CryptoContextPool::release(Crypto::cn_context* context) {
+  std::unique_ptr<Crypto::cn_context> releasedContext(context);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  if (idleContexts.size() < maxIdleContexts) {
+    idleContexts.push_back(std::move(releasedContext));
+  }
+}
+
+}
@@ -0,0 +1,61 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "crypto/hash.h"
+
+namespace CryptoNote {
+
+// Keeps slow hash contexts for reuse, so threads checking proof of work don't map and fault in a 2 MB scratchpad
+// for every batch. Contexts are returned to the pool when the acquired pointers are destroyed, pool must outlive them.
+class CryptoContextPool {
+public:
+  class ContextReleaser {
+  public:
+    explicit ContextReleaser(CryptoContextPool* pool = nullptr);
+    void operator()(Crypto::cn_context* context) const;
+
+  private:
+    CryptoContextPool* pool;
+  };
+
+  typedef std::unique_ptr<Crypto::cn_context, ContextReleaser> Context;
+
+  explicit CryptoContextPool(size_t maxIdleContexts = 64);
+  CryptoContextPool(const CryptoContextPool&) = delete;
+  CryptoContextPool& operator=(const CryptoContextPool&) = delete;
+
+  Context acquire();
+  std::vector<Context> acquire(size_t count);
+
+  size_t getIdleContextCount() const;
+
+private:
+  void release(Crypto::cn_context* context);
+
+  mutable std::mutex mutex;
+  std::vector<std::unique_ptr<Crypto::cn_context>> idleContexts;
+  const size_t maxIdleContexts;
+};
+
+}
@@ -109,22 +109,18 @@ bool serializePod(T& v, Common::StringView name, CryptoNote::ISerializer& serial
   return serializer.binary(&v, sizeof(v), name);
 }
 
-bool serializeVarintVector(std::vector<uint32_t>& vector, CryptoNote::ISerializer& serializer, Common::StringView name) {
-  size_t size = vector.size();
-  
-  if (!serializer.beginArray(size, name)) {
-    vector.clear();
-    return false;
+void serializeSignatures(std::vector<Crypto::Signature>& signatures, CryptoNote::ISerializer& serializer) {
+  if (signatures.empty() || serializer.binaryArray(signatures.data(), sizeof(Crypto::Signature), signatures.size())) {
+    return;
   }
 
-  vector.resize(size);
-
-  for (size_t i = 0; i < size; ++i) {
-    serializer(vector[i], "");
+  for (Crypto::Signature& sig : signatures) {
+    serializePod(sig, "", serializer);
   }
+}
 
-  serializer.endArray();
-  return true;
+bool serializeVarintVector(std::vector<uint32_t>& vector, CryptoNote::ISerializer& serializer, Common::StringView name) {
+  return serializer(vector, name);
 }
 
 }
@@ -225,15 +221,10 @@ void serialize(Transaction& tx, ISerializer& serializer) {
         throw std::runtime_error("Serialization error: unexpected signatures size");
       }
 
-      for (Crypto::Signature& sig : tx.signatures[i]) {
-        serializePod(sig, "", serializer);
-      }
-
+      serializeSignatures(tx.signatures[i], serializer);
     } else {
       std::vector<Crypto::Signature> signatures(signatureSize);
-      for (Crypto::Signature& sig : signatures) {
-        serializePod(sig, "", serializer);
-      }
+      serializeSignatures(signatures, serializer);
 
       tx.signatures[i] = std::move(signatures);
     }
@@ -20,6 +20,7 @@
 #include "CryptoNoteBasic.h"
 #include "crypto/chacha8.h"
 #include "Serialization/ISerializer.h"
+#include "Serialization/SerializationOverloads.h"
 #include "crypto/crypto.h"
 
 namespace Crypto {
@@ -147,6 +147,19 @@ inline bool getBaseTransactionHash(const BaseTransaction& tx, Crypto::Hash& hash
   }
 }
 
+// Order independent digest of transaction hashes, lets two sides compare pool contents cheaply
+template<class Iterator>
+Crypto::Hash getTransactionsSetDigest(Iterator begin, Iterator end) {
+  Crypto::Hash digest = NULL_HASH;
+  for (; begin != end; ++begin) {
+    for (size_t i = 0; i < sizeof(digest.data); ++i) {
+      digest.data[i] ^= begin->data[i];
+    }
+  }
+
+  return digest;
+}
+
 uint64_t getInputAmount(const Transaction& transaction);
 std::vector<uint64_t> getInputsAmounts(const Transaction& transaction);
 uint64_t getOutputAmount(const Transaction& transaction);
@@ -61,6 +61,8 @@ namespace DB {
 
   const std::string KEY_OUTPUT_KEY_PREFIX = "j";
 
+  const std::string BLOCK_INDEX_TO_BLOCK_FILTER_PREFIX = "k";
+
   template <class Value>
   std::string serialize(const Value& value, const std::string& name) {
     CryptoNote::KVBinaryOutputStreamSerializer serializer;
@@ -87,9 +89,7 @@ namespace DB {
 
   template <class Value>
   void deserialize(const std::string& serialized, Value& value, const std::string& name) {
-    std::stringstream ss(serialized);
-    Common::StdInputStream stream(ss);
-    CryptoNote::KVBinaryInputStreamSerializer serializer(stream);
+    CryptoNote::KVBinaryInputStreamSerializer serializer(serialized.data(), serialized.size());
     serializer(value, name);
   }
 
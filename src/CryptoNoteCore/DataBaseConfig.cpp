@@ -24,6 +24,7 @@
 #include "Common/StringTools.h"
 #include "crypto/crypto.h"
 #include "CryptoNoteConfig.h"
+#include "DatabaseTipCache.h"
 
 using namespace CryptoNote;
 
@@ -40,6 +41,7 @@ const command_line::arg_descriptor<uint16_t>    argBackgroundThreadsCount = { "d
 const command_line::arg_descriptor<uint32_t>    argMaxOpenFiles = { "db-max-open-files", "Number of open files that can be used by the DB", DEFAULT_MAX_OPEN_FILES};
 const command_line::arg_descriptor<uint64_t>    argWriteBufferSize = { "db-write-buffer-size", "Size of data base write buffer in megabytes", WRITE_BUFFER_MB_DEFAULT_SIZE};
 const command_line::arg_descriptor<uint64_t>    argReadCacheSize = { "db-read-cache-size", "Size of data base read cache in megabytes", READ_BUFFER_MB_DEFAULT_SIZE};
+const command_line::arg_descriptor<uint32_t>    argTipCacheBlockCount = { "db-tip-cache-blocks", "Number of last blocks which hashes, transactions and outputs are cached in memory", DatabaseTipCache::DEFAULT_MAX_BLOCK_COUNT};
 
 } //namespace
 
@@ -48,6 +50,7 @@ void DataBaseConfig::initOptions(boost::program_options::options_description& de
   command_line::add_arg(desc, argMaxOpenFiles);
   command_line::add_arg(desc, argWriteBufferSize);
   command_line::add_arg(desc, argReadCacheSize);
+  command_line::add_arg(desc, argTipCacheBlockCount);
 }
 
 DataBaseConfig::DataBaseConfig() :
@@ -56,6 +59,7 @@ DataBaseConfig::DataBaseConfig() :
   maxOpenFiles(DEFAULT_MAX_OPEN_FILES),
   writeBufferSize(WRITE_BUFFER_MB_DEFAULT_SIZE * MEGABYTE),
   readCacheSize(READ_BUFFER_MB_DEFAULT_SIZE * MEGABYTE),
+  tipCacheBlockCount(DatabaseTipCache::DEFAULT_MAX_BLOCK_COUNT),
   testnet(false) {
 }
 
@@ -76,6 +80,10 @@ bool DataBaseConfig::init(const boost::program_options::variables_map& vm) {
     readCacheSize = command_line::get_arg(vm, argReadCacheSize) * MEGABYTE;
   }
 
+  if (vm.count(argTipCacheBlockCount.name) != 0 && !vm[argTipCacheBlockCount.name].defaulted()) {
+    tipCacheBlockCount = command_line::get_arg(vm, argTipCacheBlockCount);
+  }
+
   if (vm.count(command_line::arg_data_dir.name) != 0 && (!vm[command_line::arg_data_dir.name].defaulted() || dataDir == Tools::getDefaultDataDirectory())) {
     dataDir = command_line::get_arg(vm, command_line::arg_data_dir);
   }
@@ -109,6 +117,10 @@ uint64_t DataBaseConfig::getReadCacheSize() const {
   return readCacheSize;
 }
 
+uint32_t DataBaseConfig::getTipCacheBlockCount() const {
+  return tipCacheBlockCount;
+}
+
 bool DataBaseConfig::getTestnet() const {
   return testnet;
 }
@@ -137,6 +149,10 @@ void DataBaseConfig::setReadCacheSize(uint64_t readCacheSize) {
   this->readCacheSize = readCacheSize;
 }
 
+void DataBaseConfig::setTipCacheBlockCount(uint32_t tipCacheBlockCount) {
+  this->tipCacheBlockCount = tipCacheBlockCount;
+}
+
 void DataBaseConfig::setTestnet(bool testnet) {
   this->testnet = testnet;
 }
@@ -39,6 +39,9 @@ namespace {
 
 const uint32_t ONE_DAY_SECONDS = 60 * 60 * 24;
 const CachedBlockInfo NULL_CACHED_BLOCK_INFO {NULL_HASH, 0, 0, 0, 0, 0};
+// tip cache hit rates are logged every that many pushed blocks
+const uint32_t TIP_CACHE_STATISTICS_LOG_INTERVAL = 1000;
+const uint32_t BLOCK_FILTERS_BACKFILL_BATCH_SIZE = 1000;
 
 bool requestPackedOutputs(IBlockchainCache::Amount amount, Common::ArrayView<uint32_t> globalIndexes, IDataBase& database, std::vector<PackedOutIndex>& result) {
   BlockchainReadBatch readBatch;
@@ -427,9 +430,21 @@ struct DatabaseBlockchainCache::ExtendedPushedBlockInfo {
   uint64_t timestamp;
 };
 
+struct DatabaseBlockchainCache::PendingWrites {
+  std::unordered_map<Crypto::Hash, uint32_t> transactionCountsByPaymentId;
+  std::unordered_map<uint64_t, std::vector<Crypto::Hash>> blockHashesByTimestamp;
+  std::unordered_set<uint64_t> closestTimestamps;
+  boost::optional<CachedBlockInfo> lastBlockInfo;
+  // moved into top block, units cache and tip cache once the batch is written
+  std::vector<std::pair<CachedBlockInfo, DatabaseTipCache::Block>> blocks;
+  uint64_t transactionCount = 0;
+};
+
 
-DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase& dataBase, IBlockchainCacheFactory& blockchainCacheFactory, Logging::ILogger& _logger)
-    : currency(curr), database(dataBase), blockchainCacheFactory(blockchainCacheFactory), logger(_logger, "DatabaseBlockchainCache") {
+DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase& dataBase, IBlockchainCacheFactory& blockchainCacheFactory, Logging::ILogger& _logger,
+                                                 size_t tipCacheBlockCount)
+    : currency(curr), database(dataBase), blockchainCacheFactory(blockchainCacheFactory), logger(_logger, "DatabaseBlockchainCache"),
+      tipCache(tipCacheBlockCount) {
   DatabaseVersionReadBatch readBatch;
   auto ec = database.read(readBatch);
   if (ec) {
@@ -452,6 +467,9 @@ DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase
   if (getTopBlockIndex() == 0) {
     logger(Logging::DEBUGGING) << "top block index is nill, add genesis block";
     addGenesisBlock(CachedBlock (currency.genesisBlock()));
+  } else {
+    backfillBlockFilters();
+    loadTipCache();
   }
 }
 
@@ -540,7 +558,7 @@ std::unique_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitB
     auto& validatorState = std::get<2>(*it);
     uint64_t timestamp = std::get<3>(*it);
 
-    writeBatch.removeCachedBlock(blockHash, blockIndex).removeRawBlock(blockIndex);
+    writeBatch.removeCachedBlock(blockHash, blockIndex).removeRawBlock(blockIndex).removeBlockFilter(blockIndex);
     requestDeleteSpentOutputs(writeBatch,
                               blockIndex,
                               validatorState);
@@ -577,6 +595,10 @@ std::unique_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitB
   }
 
   cutTail(unitsCache, currentTop + 1 - splitBlockIndex);
+  tipCache.cutFrom(splitBlockIndex);
+  timestampsWindows.invalidateFrom(splitBlockIndex);
+  blockSizesWindows.invalidateFrom(splitBlockIndex);
+  cumulativeDifficultiesWindows.invalidateFrom(splitBlockIndex);
 
   children.push_back(cache.get());
   logger(Logging::TRACE) << "Delete successfull";
@@ -734,7 +756,9 @@ void DatabaseBlockchainCache::requestRemoveTimestamp(BlockchainWriteBatch& batch
 void DatabaseBlockchainCache::pushTransaction(const CachedTransaction& cachedTransaction,
                                               uint32_t blockIndex,
                                               uint16_t transactionBlockIndex,
-                                              BlockchainWriteBatch& batch) {
+                                              BlockchainWriteBatch& batch,
+                                              PendingWrites& pendingWrites,
+                                              DatabaseTipCache::Block& tipCacheBlock) {
 
   logger(Logging::DEBUGGING) << "push transaction with hash " << cachedTransaction.getTransactionHash();
   const auto& tx = cachedTransaction.getTransaction();
@@ -782,6 +806,7 @@ void DatabaseBlockchainCache::pushTransaction(const CachedTransaction& cachedTra
       outputInfo.outputIndex = poi.outputIndex;
 
       batch.insertKeyOutputInfo(output.amount, globalIndex, outputInfo);
+      tipCacheBlock.keyOutputs.emplace_back(DatabaseTipCache::KeyOutputId{output.amount, globalIndex}, outputInfo);
     }
   }
 
@@ -797,11 +822,12 @@ void DatabaseBlockchainCache::pushTransaction(const CachedTransaction& cachedTra
 
   Crypto::Hash paymentId;
   if (getPaymentIdFromTxExtra(cachedTransaction.getTransaction().extra, paymentId)) {
-    insertPaymentId(batch, cachedTransaction.getTransactionHash(), paymentId);
+    insertPaymentId(batch, pendingWrites, cachedTransaction.getTransactionHash(), paymentId);
   }
 
-  batch.insertCachedTransaction(transactionCacheInfo, getCachedTransactionsCount() + 1);
-  transactionsCount = *transactionsCount + 1;
+  batch.insertCachedTransaction(transactionCacheInfo, getCachedTransactionsCount() + pendingWrites.transactionCount + 1);
+  ++pendingWrites.transactionCount;
+  tipCacheBlock.transactions.push_back(std::move(transactionCacheInfo));
   logger(Logging::DEBUGGING) << "push transaction with hash " << cachedTransaction.getTransactionHash() << " finished";
 }
 
@@ -835,34 +861,46 @@ uint32_t DatabaseBlockchainCache::updateKeyOutputCount(Amount amount, int32_t di
   return it->second;
 }
 
-void DatabaseBlockchainCache::insertPaymentId(BlockchainWriteBatch& batch, const Crypto::Hash& transactionHash, const Crypto::Hash& paymentId) {
-  BlockchainReadBatch readBatch;
-  uint32_t count = 0;
+void DatabaseBlockchainCache::insertPaymentId(BlockchainWriteBatch& batch, PendingWrites& pendingWrites, const Crypto::Hash& transactionHash,
+                                              const Crypto::Hash& paymentId) {
+  auto it = pendingWrites.transactionCountsByPaymentId.find(paymentId);
+  if (it == pendingWrites.transactionCountsByPaymentId.end()) {
+    BlockchainReadBatch readBatch;
+    uint32_t count = 0;
 
-  auto readResult = readDatabase(readBatch.requestTransactionCountByPaymentId(paymentId));
-  if (readResult.getTransactionCountByPaymentIds().count(paymentId) != 0) {
-    count = readResult.getTransactionCountByPaymentIds().at(paymentId);
+    auto readResult = readDatabase(readBatch.requestTransactionCountByPaymentId(paymentId));
+    if (readResult.getTransactionCountByPaymentIds().count(paymentId) != 0) {
+      count = readResult.getTransactionCountByPaymentIds().at(paymentId);
+    }
+
+    it = pendingWrites.transactionCountsByPaymentId.insert({paymentId, count}).first;
   }
 
-  count += 1;
+  it->second += 1;
 
-  batch.insertPaymentId(transactionHash, paymentId, count);
+  batch.insertPaymentId(transactionHash, paymentId, it->second);
 }
 
-void DatabaseBlockchainCache::insertBlockTimestamp(BlockchainWriteBatch& batch, uint64_t timestamp, const Crypto::Hash& blockHash) {
-  BlockchainReadBatch readBatch;
-  readBatch.requestBlockHashesByTimestamp(timestamp);
+void DatabaseBlockchainCache::insertBlockTimestamp(BlockchainWriteBatch& batch, PendingWrites& pendingWrites, uint64_t timestamp,
+                                                   const Crypto::Hash& blockHash) {
+  auto it = pendingWrites.blockHashesByTimestamp.find(timestamp);
+  if (it == pendingWrites.blockHashesByTimestamp.end()) {
+    BlockchainReadBatch readBatch;
+    readBatch.requestBlockHashesByTimestamp(timestamp);
 
-  std::vector<Crypto::Hash> blockHashes;
-  auto readResult = readDatabase(readBatch);
+    std::vector<Crypto::Hash> blockHashes;
+    auto readResult = readDatabase(readBatch);
+
+    if (readResult.getBlockHashesByTimestamp().count(timestamp) != 0) {
+      blockHashes = readResult.getBlockHashesByTimestamp().at(timestamp);
+    }
 
-  if (readResult.getBlockHashesByTimestamp().count(timestamp) != 0) {
-    blockHashes = readResult.getBlockHashesByTimestamp().at(timestamp);
+    it = pendingWrites.blockHashesByTimestamp.insert({timestamp, std::move(blockHashes)}).first;
   }
 
-  blockHashes.emplace_back(blockHash);
+  it->second.emplace_back(blockHash);
 
-  batch.insertTimestamp(timestamp, blockHashes);
+  batch.insertTimestamp(timestamp, it->second);
 }
 
 void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
@@ -870,11 +908,71 @@ void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
                                         const TransactionValidatorState& validatorState, size_t blockSize,
                                         uint64_t generatedCoins, Difficulty blockDifficulty, RawBlock&& rawBlock) {
   BlockchainWriteBatch batch;
+  PendingWrites pendingWrites;
+  pushBlockToBatch(cachedBlock, cachedTransactions, validatorState, blockSize, generatedCoins, blockDifficulty, std::move(rawBlock),
+                   batch, pendingWrites);
+  writePushedBlocks(batch, pendingWrites);
+}
+
+void DatabaseBlockchainCache::pushBlocks(std::vector<PushedBlock>&& blocks) {
+  if (blocks.empty()) {
+    return;
+  }
+
+  BlockchainWriteBatch batch;
+  PendingWrites pendingWrites;
+  for (auto& block : blocks) {
+    pushBlockToBatch(CachedBlock(block.block), block.transactions, block.info.validatorState, block.info.blockSize,
+                     block.info.generatedCoins, block.info.blockDifficulty, std::move(block.info.rawBlock), batch, pendingWrites);
+  }
+
+  writePushedBlocks(batch, pendingWrites);
+}
+
+void DatabaseBlockchainCache::writePushedBlocks(BlockchainWriteBatch& batch, PendingWrites& pendingWrites) {
+  assert(!pendingWrites.blocks.empty());
+  const Crypto::Hash& lastBlockHash = pendingWrites.blocks.back().first.blockHash;
+  auto res = database.write(batch);
+  if (res) {
+    // key output counts were moved while the batch was built, they are read from database again
+    keyOutputCountsForAmounts.clear();
+    keyOutputAmountsCount = boost::none;
+    logger(Logging::ERROR) << "push block " << lastBlockHash << " write failed: " << res.message();
+    throw std::runtime_error(res.message());
+  }
+
+  transactionsCount = *transactionsCount + pendingWrites.transactionCount;
+  for (auto& block : pendingWrites.blocks) {
+    topBlockIndex = *topBlockIndex + 1;
+    topBlockHash = block.first.blockHash;
+
+    unitsCache.push_back(block.first);
+    if (unitsCache.size() > unitsCacheSize) {
+      unitsCache.pop_front();
+    }
+
+    tipCache.pushBlock(std::move(block.second));
+    if (*topBlockIndex % TIP_CACHE_STATISTICS_LOG_INTERVAL == 0) {
+      logTipCacheStatistics();
+    }
+  }
+
+  logger(Logging::DEBUGGING) << "push block " << lastBlockHash << " completed";
+}
+
+void DatabaseBlockchainCache::pushBlockToBatch(const CachedBlock& cachedBlock,
+                                               const std::vector<CachedTransaction>& cachedTransactions,
+                                               const TransactionValidatorState& validatorState, size_t blockSize,
+                                               uint64_t generatedCoins, Difficulty blockDifficulty, RawBlock&& rawBlock,
+                                               BlockchainWriteBatch& batch, PendingWrites& pendingWrites) {
   logger(Logging::DEBUGGING) << "push block with hash " << cachedBlock.getBlockHash() << ", and "
                              << cachedTransactions.size() + 1 << " transactions"; //+1 for base transaction
 
+  // blocks pushed to the same batch are not on top yet
+  uint32_t blockIndex = getTopBlockIndex() + 1 + static_cast<uint32_t>(pendingWrites.blocks.size());
+
   // TODO: cache top block difficulty, size, timestamp, coins; use it here
-  auto lastBlockInfo = getCachedBlockInfo(getTopBlockIndex());
+  auto lastBlockInfo = pendingWrites.lastBlockInfo ? *pendingWrites.lastBlockInfo : getCachedBlockInfo(getTopBlockIndex());
   auto cumulativeDifficulty = lastBlockInfo.cumulativeDifficulty + blockDifficulty;
   auto alreadyGeneratedCoins = lastBlockInfo.alreadyGeneratedCoins + generatedCoins;
   auto alreadyGeneratedTransactions = lastBlockInfo.alreadyGeneratedTransactions + cachedTransactions.size() + 1;
@@ -887,7 +985,7 @@ void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
   blockInfo.blockSize = static_cast<uint32_t>(blockSize);
   blockInfo.timestamp = cachedBlock.getBlock().timestamp;
 
-  batch.insertSpentKeyImages(getTopBlockIndex() + 1, validatorState.spentKeyImages);
+  batch.insertSpentKeyImages(blockIndex, validatorState.spentKeyImages);
 
   auto txHashes = cachedBlock.getBlock().transactionHashes;
   auto baseTransaction = cachedBlock.getBlock().baseTransaction;
@@ -896,42 +994,42 @@ void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
   // base transaction's hash is always the first one in index for this block
   txHashes.insert(txHashes.begin(), cachedBaseTransaction.getTransactionHash());
 
-  batch.insertCachedBlock(blockInfo, getTopBlockIndex() + 1, txHashes);
-  batch.insertRawBlock(getTopBlockIndex() + 1, std::move(rawBlock));
+  batch.insertCachedBlock(blockInfo, blockIndex, txHashes);
+  batch.insertRawBlock(blockIndex, std::move(rawBlock));
+  batch.insertBlockFilter(blockIndex,
+    BlockFilter::fromTransactions(cachedBlock.getBlockHash(), cachedBlock.getBlock().baseTransaction, cachedTransactions));
+
+  DatabaseTipCache::Block tipCacheBlock;
+  tipCacheBlock.index = blockIndex;
+  tipCacheBlock.hash = cachedBlock.getBlockHash();
+  tipCacheBlock.transactions.reserve(cachedTransactions.size() + 1);
 
   auto transactionIndex = 0;
-  pushTransaction(cachedBaseTransaction, getTopBlockIndex() + 1, transactionIndex++, batch);
+  pushTransaction(cachedBaseTransaction, blockIndex, transactionIndex++, batch, pendingWrites, tipCacheBlock);
 
   for (const auto& transaction: cachedTransactions) {
-    pushTransaction(transaction, getTopBlockIndex() + 1, transactionIndex++, batch);
+    pushTransaction(transaction, blockIndex, transactionIndex++, batch, pendingWrites, tipCacheBlock);
   }
 
-  auto closestBlockIndexDb = requestClosestBlockIndexByTimestamp(roundToMidnight(cachedBlock.getBlock().timestamp), database);
-  if (!closestBlockIndexDb.second) {
-    logger(Logging::ERROR) << "push block " << cachedBlock.getBlockHash() << " request closest block index by timestamp failed";
-    throw std::runtime_error("Couldn't get closest to timestamp block index");
-  }
-
-  if (!closestBlockIndexDb.first) {
-    batch.insertClosestTimestampBlockIndex(roundToMidnight(cachedBlock.getBlock().timestamp), getTopBlockIndex() + 1);
-  }
+  auto midnight = roundToMidnight(cachedBlock.getBlock().timestamp);
+  if (pendingWrites.closestTimestamps.count(midnight) == 0) {
+    auto closestBlockIndexDb = requestClosestBlockIndexByTimestamp(midnight, database);
+    if (!closestBlockIndexDb.second) {
+      logger(Logging::ERROR) << "push block " << cachedBlock.getBlockHash() << " request closest block index by timestamp failed";
+      throw std::runtime_error("Couldn't get closest to timestamp block index");
+    }
 
-  insertBlockTimestamp(batch, cachedBlock.getBlock().timestamp, cachedBlock.getBlockHash());
+    if (!closestBlockIndexDb.first) {
+      batch.insertClosestTimestampBlockIndex(midnight, blockIndex);
+    }
 
-  auto res = database.write(batch);
-  if (res) {
-    logger(Logging::ERROR) << "push block " << cachedBlock.getBlockHash() << " write failed: " << res.message();
-    throw std::runtime_error(res.message());
+    pendingWrites.closestTimestamps.insert(midnight);
   }
 
-  topBlockIndex = *topBlockIndex + 1;
-  topBlockHash = cachedBlock.getBlockHash();
-  logger(Logging::DEBUGGING) << "push block " << cachedBlock.getBlockHash() << " completed";
+  insertBlockTimestamp(batch, pendingWrites, cachedBlock.getBlock().timestamp, cachedBlock.getBlockHash());
 
-  unitsCache.push_back(blockInfo);
-  if (unitsCache.size() > unitsCacheSize) {
-    unitsCache.pop_front();
-  }
+  pendingWrites.lastBlockInfo = blockInfo;
+  pendingWrites.blocks.emplace_back(blockInfo, std::move(tipCacheBlock));
 }
 
 PushedBlockInfo DatabaseBlockchainCache::getPushedBlockInfo(uint32_t blockIndex) const {
@@ -1073,6 +1171,11 @@ uint32_t DatabaseBlockchainCache::getBlockCount() const {
 }
 
 bool DatabaseBlockchainCache::hasBlock(const Crypto::Hash& blockHash) const {
+  uint32_t blockIndex;
+  if (tipCache.findBlockIndex(blockHash, blockIndex)) {
+    return true;
+  }
+
   auto batch = BlockchainReadBatch().requestBlockIndexByBlockHash(blockHash);
   auto result = database.read(batch);
   return !result && batch.extractResult().getBlockIndexesByBlockHashes().count(blockHash);
@@ -1083,12 +1186,21 @@ uint32_t DatabaseBlockchainCache::getBlockIndex(const Crypto::Hash& blockHash) c
     return getTopBlockIndex();
   }
 
+  uint32_t blockIndex;
+  if (tipCache.findBlockIndex(blockHash, blockIndex)) {
+    return blockIndex;
+  }
+
   auto batch = BlockchainReadBatch().requestBlockIndexByBlockHash(blockHash);
   auto result = readDatabase(batch);
   return result.getBlockIndexesByBlockHashes().at(blockHash);
 }
 
 bool DatabaseBlockchainCache::hasTransaction(const Crypto::Hash& transactionHash) const {
+  if (tipCache.findTransaction(transactionHash) != nullptr) {
+    return true;
+  }
+
   auto batch = BlockchainReadBatch().requestCachedTransaction(transactionHash);
   auto result = database.read(batch);
   return !result && batch.extractResult().getCachedTransactions().count(transactionHash);
@@ -1099,7 +1211,13 @@ std::vector<uint64_t> DatabaseBlockchainCache::getLastTimestamps(size_t count) c
 }
 std::vector<uint64_t> DatabaseBlockchainCache::getLastTimestamps(size_t count, uint32_t blockIndex,
                                                                  UseGenesis useGenesis) const {
-  return getLastUnits(count, blockIndex, useGenesis, [](const CachedBlockInfo& inf) { return inf.timestamp; });
+  return timestampsWindows.getValues(count, blockIndex, useGenesis,
+                                     makeBlockValuesReader(*this, [](const CachedBlockInfo& inf) { return inf.timestamp; }));
+}
+
+uint64_t DatabaseBlockchainCache::getLastTimestampsMedian(size_t count, uint32_t blockIndex, UseGenesis useGenesis) const {
+  return timestampsWindows.getMedian(count, blockIndex, useGenesis,
+                                     makeBlockValuesReader(*this, [](const CachedBlockInfo& inf) { return inf.timestamp; }));
 }
 
 std::vector<uint64_t> DatabaseBlockchainCache::getLastBlocksSizes(size_t count) const {
@@ -1108,13 +1226,23 @@ std::vector<uint64_t> DatabaseBlockchainCache::getLastBlocksSizes(size_t count)
 
 std::vector<uint64_t> DatabaseBlockchainCache::getLastBlocksSizes(size_t count, uint32_t blockIndex,
                                                                   UseGenesis useGenesis) const {
-  return getLastUnits(count, blockIndex, useGenesis, [](const CachedBlockInfo& cb) { return cb.blockSize; });
+  return blockSizesWindows.getValues(count, blockIndex, useGenesis,
+                                     makeBlockValuesReader(*this, [](const CachedBlockInfo& cb) { return cb.blockSize; }));
+}
+
+uint64_t DatabaseBlockchainCache::getLastBlocksSizesMedian(size_t count) const {
+  return getLastBlocksSizesMedian(count, getTopBlockIndex(), UseGenesis{true});
+}
+
+uint64_t DatabaseBlockchainCache::getLastBlocksSizesMedian(size_t count, uint32_t blockIndex, UseGenesis useGenesis) const {
+  return blockSizesWindows.getMedian(count, blockIndex, useGenesis,
+                                     makeBlockValuesReader(*this, [](const CachedBlockInfo& cb) { return cb.blockSize; }));
 }
 
 std::vector<Difficulty> DatabaseBlockchainCache::getLastCumulativeDifficulties(size_t count, uint32_t blockIndex,
                                                                                UseGenesis useGenesis) const {
-  return getLastUnits(count, blockIndex, useGenesis,
-                      [](const CachedBlockInfo& info) { return info.cumulativeDifficulty; });
+  return cumulativeDifficultiesWindows.getValues(count, blockIndex, useGenesis,
+                                                 makeBlockValuesReader(*this, [](const CachedBlockInfo& info) { return info.cumulativeDifficulty; }));
 }
 std::vector<Difficulty> DatabaseBlockchainCache::getLastCumulativeDifficulties(size_t count) const {
   return getLastCumulativeDifficulties(count, getTopBlockIndex(), UseGenesis{true});
@@ -1277,6 +1405,11 @@ Crypto::Hash DatabaseBlockchainCache::getBlockHash(uint32_t blockIndex) const {
     return getTopBlockHash();
   }
 
+  Crypto::Hash blockHash;
+  if (tipCache.findBlockHash(blockIndex, blockHash)) {
+    return blockHash;
+  }
+
   auto batch = BlockchainReadBatch().requestCachedBlock(blockIndex);
   auto result = readDatabase(batch);
   return result.getCachedBlocks().at(blockIndex).blockHash;
@@ -1291,6 +1424,11 @@ std::vector<Crypto::Hash> DatabaseBlockchainCache::getBlockHashes(uint32_t start
     return {};
   }
 
+  std::vector<Crypto::Hash> hashes;
+  if (tipCache.findBlockHashes(startIndex, count, hashes)) {
+    return hashes;
+  }
+
   BlockchainReadBatch request;
   auto index = startIndex;
   while (index != startIndex + count) {
@@ -1300,7 +1438,6 @@ std::vector<Crypto::Hash> DatabaseBlockchainCache::getBlockHashes(uint32_t start
   auto result = readDatabase(request);
   assert(result.getCachedBlocks().size() == count);
 
-  std::vector<Crypto::Hash> hashes;
   hashes.reserve(count);
 
   std::map<uint32_t, CachedBlockInfo> sortedResult(
@@ -1359,6 +1496,11 @@ uint32_t DatabaseBlockchainCache::getTimestampLowerBoundBlockIndex(uint64_t time
 
 bool DatabaseBlockchainCache::getTransactionGlobalIndexes(const Crypto::Hash& transactionHash,
                                                           std::vector<uint32_t>& globalIndexes) const {
+  if (auto transactionInfo = tipCache.findTransaction(transactionHash)) {
+    globalIndexes = transactionInfo->globalIndexes;
+    return true;
+  }
+
   auto batch = BlockchainReadBatch().requestCachedTransaction(transactionHash);
   auto result = database.read(batch);
   if (result) {
@@ -1382,6 +1524,10 @@ size_t DatabaseBlockchainCache::getTransactionCount() const {
 }
 
 uint32_t DatabaseBlockchainCache::getBlockIndexContainingTx(const Crypto::Hash& transactionHash) const {
+  if (auto transactionInfo = tipCache.findTransaction(transactionHash)) {
+    return transactionInfo->blockIndex;
+  }
+
   auto batch = BlockchainReadBatch().requestCachedTransaction(transactionHash);
   auto result = readDatabase(batch);
   return result.getCachedTransactions().at(transactionHash).blockIndex;
@@ -1462,6 +1608,66 @@ RawBlock DatabaseBlockchainCache::getBlockByIndex(uint32_t index) const {
   return std::move(res.getRawBlocks().at(index));
 }
 
+std::vector<RawBlock> DatabaseBlockchainCache::getBlocksByIndexRange(uint32_t startIndex, uint32_t count) const {
+  assert(count == 0 || startIndex + count - 1 <= getTopBlockIndex());
+
+  BlockchainReadBatch batch;
+  for (uint32_t index = startIndex; index < startIndex + count; ++index) {
+    batch.requestRawBlock(index);
+  }
+
+  auto res = readDatabase(batch);
+
+  std::vector<RawBlock> blocks;
+  blocks.reserve(count);
+  for (uint32_t index = startIndex; index < startIndex + count; ++index) {
+    blocks.push_back(std::move(res.getRawBlocks().at(index)));
+  }
+
+  return blocks;
+}
+
+std::vector<CachedBlockInfo> DatabaseBlockchainCache::getBlockInfosByIndexRange(uint32_t startIndex, uint32_t count) const {
+  if (count == 0) {
+    return {};
+  }
+
+  uint32_t lastIndex = startIndex + count - 1;
+  auto cachedUnits = getLastCachedUnits(lastIndex, count, UseGenesis{true});
+
+  std::vector<CachedBlockInfo> infos;
+  if (cachedUnits.size() < count) {
+    infos = getLastDbUnits(lastIndex - static_cast<uint32_t>(cachedUnits.size()), count - cachedUnits.size(), UseGenesis{true});
+  }
+
+  infos.insert(infos.end(), cachedUnits.begin(), cachedUnits.end());
+  assert(infos.size() == count);
+  return infos;
+}
+
+std::vector<BlockFilter> DatabaseBlockchainCache::getBlockFiltersByIndexRange(uint32_t startIndex, uint32_t count) const {
+  assert(count == 0 || startIndex + count - 1 <= getTopBlockIndex());
+  if (count == 0) {
+    return {};
+  }
+
+  BlockchainReadBatch batch;
+  for (uint32_t index = startIndex; index < startIndex + count; ++index) {
+    batch.requestBlockFilter(index);
+  }
+
+  auto res = readDatabase(batch);
+  const auto& storedFilters = res.getBlockFilters();
+
+  std::vector<BlockFilter> filters;
+  filters.reserve(count);
+  for (uint32_t index = startIndex; index < startIndex + count; ++index) {
+    filters.push_back(storedFilters.at(index));
+  }
+
+  return filters;
+}
+
 BinaryArray DatabaseBlockchainCache::getRawTransaction(uint32_t blockIndex, uint32_t transactionIndex) const {
   return getBlockByIndex(blockIndex).transactions.at(transactionIndex);
 }
@@ -1531,13 +1737,25 @@ ExtractOutputKeysResult DatabaseBlockchainCache::extractKeyOutputs(
     uint64_t amount, uint32_t blockIndex, Common::ArrayView<uint32_t> globalIndexes,
     std::function<ExtractOutputKeysResult(const CachedTransactionInfo& info, PackedOutIndex index,
                                           uint32_t globalIndex)> callback) const {
+  std::map<IBlockchainCache::GlobalOutputIndex, KeyOutputInfo> sortedResult;
   BlockchainReadBatch batch;
+  bool databaseReadRequired = false;
   for (auto it = globalIndexes.begin(); it != globalIndexes.end(); ++it) {
-    batch.requestKeyOutputInfo(amount, *it);
+    if (auto outputInfo = tipCache.findKeyOutput(amount, *it)) {
+      sortedResult.emplace(*it, *outputInfo);
+    } else {
+      batch.requestKeyOutputInfo(amount, *it);
+      databaseReadRequired = true;
+    }
+  }
+
+  if (databaseReadRequired) {
+    auto result = readDatabase(batch).getKeyOutputInfo();
+    for (const auto& kv: result) {
+      sortedResult.emplace(kv.first.second, kv.second);
+    }
   }
 
-  auto result = readDatabase(batch).getKeyOutputInfo();
-  std::map<std::pair<IBlockchainCache::Amount, IBlockchainCache::GlobalOutputIndex>, KeyOutputInfo> sortedResult(result.begin(), result.end());
   for (const auto& kv: sortedResult) {
     ExtendedTransactionInfo tx;
     tx.unlockTime = kv.second.unlockTime;
@@ -1548,7 +1766,7 @@ ExtractOutputKeysResult DatabaseBlockchainCache::extractKeyOutputs(
     fakePoi.outputIndex = kv.second.outputIndex;
 
     //TODO: change the interface of extractKeyOutputs to return vector of structures instead of passing callback as predicate
-    auto ret = callback(tx, fakePoi, kv.first.second);
+    auto ret = callback(tx, fakePoi, kv.first);
     if (ret != ExtractOutputKeysResult::SUCCESS) {
       logger(Logging::DEBUGGING) << "extractKeyOutputs failed : callback returned error";
       return ret;
@@ -1672,6 +1890,7 @@ void DatabaseBlockchainCache::addGenesisBlock(CachedBlock&& genesisBlock) {
   assert(baseTransactionSize < std::numeric_limits<uint32_t>::max());
 
   BlockchainWriteBatch batch;
+  PendingWrites pendingWrites;
 
   CachedBlockInfo blockInfo{genesisBlock.getBlockHash(), genesisBlock.getBlock().timestamp, 1,
                             minerReward, 1, uint32_t(baseTransactionSize)};
@@ -1679,10 +1898,14 @@ void DatabaseBlockchainCache::addGenesisBlock(CachedBlock&& genesisBlock) {
   auto baseTransaction = genesisBlock.getBlock().baseTransaction;
   auto cachedBaseTransaction = CachedTransaction{std::move(baseTransaction)};
 
-  pushTransaction(cachedBaseTransaction, 0, 0, batch);
+  DatabaseTipCache::Block tipCacheBlock;
+  tipCacheBlock.index = 0;
+  tipCacheBlock.hash = genesisBlock.getBlockHash();
+  pushTransaction(cachedBaseTransaction, 0, 0, batch, pendingWrites, tipCacheBlock);
 
   batch.insertCachedBlock(blockInfo, 0, {cachedBaseTransaction.getTransactionHash()});
   batch.insertRawBlock(0, {toBinaryArray(genesisBlock.getBlock()), {}});
+  batch.insertBlockFilter(0, BlockFilter::fromTransactions(genesisBlock.getBlockHash(), genesisBlock.getBlock().baseTransaction, {}));
   batch.insertClosestTimestampBlockIndex(roundToMidnight(genesisBlock.getBlock().timestamp), 0);
 
   auto res = database.write(batch);
@@ -1691,9 +1914,100 @@ void DatabaseBlockchainCache::addGenesisBlock(CachedBlock&& genesisBlock) {
     throw std::runtime_error(res.message());
   }
 
+  transactionsCount = *transactionsCount + pendingWrites.transactionCount;
   topBlockHash = genesisBlock.getBlockHash();
 
   unitsCache.push_back(blockInfo);
+  tipCache.pushBlock(std::move(tipCacheBlock));
+}
+
+// Only block hashes are loaded, transactions and outputs of blocks stored before start are read from database
+void DatabaseBlockchainCache::loadTipCache() {
+  if (tipCache.getMaxBlockCount() == 0) {
+    return;
+  }
+
+  uint32_t topIndex = getTopBlockIndex();
+  auto units = getLastDbUnits(topIndex, tipCache.getMaxBlockCount(), UseGenesis{true});
+  uint32_t blockIndex = topIndex + 1 - static_cast<uint32_t>(units.size());
+  for (const auto& unit : units) {
+    DatabaseTipCache::Block tipCacheBlock;
+    tipCacheBlock.index = blockIndex++;
+    tipCacheBlock.hash = unit.blockHash;
+    tipCache.pushBlock(std::move(tipCacheBlock));
+  }
+
+  logger(Logging::DEBUGGING) << "Tip cache loaded " << units.size() << " block hashes";
+}
+
+// databases created by older versions have no filters for their blocks, they are built once on load.
+// Genesis block filter is written last, so an interrupted backfill is resumed on next load
+void DatabaseBlockchainCache::backfillBlockFilters() {
+  auto genesisFilterBatch = BlockchainReadBatch().requestBlockFilter(0);
+  if (readDatabase(genesisFilterBatch).getBlockFilters().count(0) != 0) {
+    return;
+  }
+
+  auto writeFilters = [this] (BlockchainReadBatch& rawBlocksBatch) {
+    auto rawBlocksResult = readDatabase(rawBlocksBatch);
+    BlockchainWriteBatch writeBatch;
+    for (const auto& rawBlock : rawBlocksResult.getRawBlocks()) {
+      writeBatch.insertBlockFilter(rawBlock.first, BlockFilter::fromRawBlock(rawBlock.second));
+    }
+
+    auto err = database.write(writeBatch);
+    if (err) {
+      logger(Logging::ERROR) << "block filters write failed, " << err.message();
+      throw std::runtime_error(err.message());
+    }
+  };
+
+  uint32_t topIndex = getTopBlockIndex();
+  logger(Logging::INFO) << "Building block filters for " << topIndex + 1 << " blocks, it is done once";
+
+  for (uint32_t startIndex = 1; startIndex <= topIndex; startIndex += BLOCK_FILTERS_BACKFILL_BATCH_SIZE) {
+    uint32_t endIndex = std::min(topIndex + 1, startIndex + BLOCK_FILTERS_BACKFILL_BATCH_SIZE);
+
+    BlockchainReadBatch filtersBatch;
+    for (uint32_t index = startIndex; index < endIndex; ++index) {
+      filtersBatch.requestBlockFilter(index);
+    }
+
+    auto filtersResult = readDatabase(filtersBatch);
+    BlockchainReadBatch rawBlocksBatch;
+    bool hasMissingFilters = false;
+    for (uint32_t index = startIndex; index < endIndex; ++index) {
+      if (filtersResult.getBlockFilters().count(index) == 0) {
+        rawBlocksBatch.requestRawBlock(index);
+        hasMissingFilters = true;
+      }
+    }
+
+    if (hasMissingFilters) {
+      writeFilters(rawBlocksBatch);
+    }
+
+    logger(Logging::DEBUGGING) << "Block filters built up to block " << endIndex - 1;
+  }
+
+  auto genesisBlockBatch = BlockchainReadBatch().requestRawBlock(0);
+  writeFilters(genesisBlockBatch);
+  logger(Logging::INFO) << "Block filters built";
+}
+
+TipCacheStatistics DatabaseBlockchainCache::getTipCacheStatistics() const {
+  return tipCache.getStatistics();
+}
+
+void DatabaseBlockchainCache::logTipCacheStatistics() const {
+  auto hitRate = [] (uint64_t hits, uint64_t misses) {
+    return hits + misses == 0 ? 0 : hits * 100 / (hits + misses);
+  };
+
+  auto statistics = tipCache.getStatistics();
+  logger(Logging::DEBUGGING) << "Tip cache hit rate: blocks " << hitRate(statistics.blockHits, statistics.blockMisses)
+    << "%, transactions " << hitRate(statistics.transactionHits, statistics.transactionMisses)
+    << "%, outputs " << hitRate(statistics.outputHits, statistics.outputMisses) << "%";
 }
 
 }
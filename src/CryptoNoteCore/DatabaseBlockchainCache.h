@@ -20,6 +20,8 @@
 #include "Common/StringView.h"
 #include "Currency.h"
 #include "Difficulty.h"
+#include "BlockValuesWindow.h"
+#include "DatabaseTipCache.h"
 #include "IBlockchainCache.h"
 #include <IDataBase.h>
 #include <CryptoNoteCore/BlockchainReadBatch.h>
@@ -46,7 +48,8 @@ public:
    * BlockchainCache objects as children are supported.
    */
   DatabaseBlockchainCache(const Currency& currency, IDataBase& dataBase,
-                          IBlockchainCacheFactory& blockchainCacheFactory, Logging::ILogger& logger);
+                          IBlockchainCacheFactory& blockchainCacheFactory, Logging::ILogger& logger,
+                          size_t tipCacheBlockCount = DatabaseTipCache::DEFAULT_MAX_BLOCK_COUNT);
 
   static bool checkDBSchemeVersion(IDataBase& dataBase, Logging::ILogger& logger);
 
@@ -59,6 +62,7 @@ public:
   void pushBlock(const CachedBlock& cachedBlock, const std::vector<CachedTransaction>& cachedTransactions,
                  const TransactionValidatorState& validatorState, size_t blockSize, uint64_t generatedCoins,
                  Difficulty blockDifficulty, RawBlock&& rawBlock) override;
+  void pushBlocks(std::vector<PushedBlock>&& blocks) override;
   virtual PushedBlockInfo getPushedBlockInfo(uint32_t index) const override;
   bool checkIfSpent(const Crypto::KeyImage& keyImage, uint32_t blockIndex) const override;
   bool checkIfSpent(const Crypto::KeyImage& keyImage) const override;
@@ -92,6 +96,10 @@ public:
   std::vector<uint64_t> getLastBlocksSizes(size_t count) const override;
   std::vector<uint64_t> getLastBlocksSizes(size_t count, uint32_t blockIndex, UseGenesis) const override;
 
+  uint64_t getLastTimestampsMedian(size_t count, uint32_t blockIndex, UseGenesis) const override;
+  uint64_t getLastBlocksSizesMedian(size_t count) const override;
+  uint64_t getLastBlocksSizesMedian(size_t count, uint32_t blockIndex, UseGenesis) const override;
+
   std::vector<Difficulty> getLastCumulativeDifficulties(size_t count, uint32_t blockIndex, UseGenesis) const override;
   std::vector<Difficulty> getLastCumulativeDifficulties(size_t count) const override;
 
@@ -145,6 +153,9 @@ public:
   void getRawTransactions(const std::vector<Crypto::Hash>& transactions, std::vector<BinaryArray>& foundTransactions,
                           std::vector<Crypto::Hash>& missedTransactions) const override;
   virtual RawBlock getBlockByIndex(uint32_t index) const override;
+  virtual std::vector<RawBlock> getBlocksByIndexRange(uint32_t startIndex, uint32_t count) const override;
+  virtual std::vector<CachedBlockInfo> getBlockInfosByIndexRange(uint32_t startIndex, uint32_t count) const override;
+  virtual std::vector<BlockFilter> getBlockFiltersByIndexRange(uint32_t startIndex, uint32_t count) const override;
   virtual BinaryArray getRawTransaction(uint32_t blockIndex, uint32_t transactionIndex) const override;
   virtual std::vector<Crypto::Hash> getTransactionHashes() const override;
   virtual std::vector<uint32_t> getRandomOutsByAmount(uint64_t amount, size_t count,
@@ -157,6 +168,8 @@ public:
   virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash& paymentId) const override;
   virtual std::vector<Crypto::Hash> getBlockHashesByTimestamps(uint64_t timestampBegin, size_t secondsCount) const override;
 
+  TipCacheStatistics getTipCacheStatistics() const;
+
 private:
   const Currency& currency;
   IDataBase& database;
@@ -171,6 +184,14 @@ private:
   std::deque<CachedBlockInfo> unitsCache;
   const size_t unitsCacheSize = 1000;
 
+  // block hashes, transactions and key outputs of the last blocks, cut on split
+  DatabaseTipCache tipCache;
+
+  // windows are invalidated when blocks are split off; const getters slide them, BlockValuesWindows locks itself
+  mutable BlockValuesWindows timestampsWindows;
+  mutable BlockValuesWindows blockSizesWindows;
+  mutable BlockValuesWindows cumulativeDifficultiesWindows;
+
   struct ExtendedPushedBlockInfo;
   ExtendedPushedBlockInfo getExtendedPushedBlockInfo(uint32_t blockIndex) const;
 
@@ -178,16 +199,29 @@ private:
   CachedBlockInfo getCachedBlockInfo(uint32_t index) const;
   BlockchainReadResult readDatabase(BlockchainReadBatch& batch) const;
 
+  // values put to a write batch which aren't in database yet, later blocks of the batch read them from here
+  struct PendingWrites;
+  // adds block to the batch, top block, tip cache and counters move to it in writePushedBlocks once the batch is written
+  void pushBlockToBatch(const CachedBlock& cachedBlock, const std::vector<CachedTransaction>& cachedTransactions,
+                        const TransactionValidatorState& validatorState, size_t blockSize, uint64_t generatedCoins,
+                        Difficulty blockDifficulty, RawBlock&& rawBlock, BlockchainWriteBatch& batch, PendingWrites& pendingWrites);
+  void writePushedBlocks(BlockchainWriteBatch& batch, PendingWrites& pendingWrites);
+
   void addSpentKeyImage(const Crypto::KeyImage& keyImage, uint32_t blockIndex);
   void pushTransaction(const CachedTransaction& cachedTransaction,
                        uint32_t blockIndex,
                        uint16_t transactionBlockIndex,
-                       BlockchainWriteBatch& batch);
+                       BlockchainWriteBatch& batch,
+                       PendingWrites& pendingWrites,
+                       DatabaseTipCache::Block& tipCacheBlock);
+  void loadTipCache();
+  void logTipCacheStatistics() const;
+  void backfillBlockFilters();
 
   uint32_t insertKeyOutputToGlobalIndex(uint64_t amount, PackedOutIndex output); //TODO not implemented. Should it be removed?
   uint32_t updateKeyOutputCount(Amount amount, int32_t diff) const;
-  void insertPaymentId(BlockchainWriteBatch& batch, const Crypto::Hash& transactionHash, const Crypto::Hash& paymentId);
-  void insertBlockTimestamp(BlockchainWriteBatch& batch, uint64_t timestamp, const Crypto::Hash& blockHash);
+  void insertPaymentId(BlockchainWriteBatch& batch, PendingWrites& pendingWrites, const Crypto::Hash& transactionHash, const Crypto::Hash& paymentId);
+  void insertBlockTimestamp(BlockchainWriteBatch& batch, PendingWrites& pendingWrites, uint64_t timestamp, const Crypto::Hash& blockHash);
 
   void addGenesisBlock(CachedBlock&& genesisBlock);
 
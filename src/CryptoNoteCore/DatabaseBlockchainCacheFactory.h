@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "DatabaseTipCache.h"
 #include "IBlockchainCacheFactory.h"
 #include <Logging/LoggerMessage.h>
 
@@ -26,7 +27,8 @@ class IDataBase;
 
 class DatabaseBlockchainCacheFactory: public IBlockchainCacheFactory {
 public:
-  explicit DatabaseBlockchainCacheFactory(IDataBase& database, Logging::ILogger& logger);
+  explicit DatabaseBlockchainCacheFactory(IDataBase& database, Logging::ILogger& logger,
+                                          size_t tipCacheBlockCount = DatabaseTipCache::DEFAULT_MAX_BLOCK_COUNT);
   virtual ~DatabaseBlockchainCacheFactory();
 
   virtual std::unique_ptr<IBlockchainCache> createRootBlockchainCache(const Currency& currency) override;
@@ -35,6 +37,7 @@ public:
 private:
   IDataBase& database;
   Logging::ILogger& logger;
+  size_t tipCacheBlockCount;
 };
 
 } //namespace CryptoNote
@@ -0,0 +1,182 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "DatabaseTipCache.h"
+
+#include <cassert>
+
+namespace CryptoNote {
+
+DatabaseTipCache::DatabaseTipCache(size_t maxBlockCount) : maxBlockCount(maxBlockCount), startIndex(0), statistics(new StatisticsCounters()) {
+}
+
+size_t DatabaseTipCache::getMaxBlockCount() const {
+  return maxBlockCount;
+}
+
+size_t DatabaseTipCache::getBlockCount() const {
+  return blocks.size();
+}
+
+void DatabaseTipCache::pushBlock(Block&& block) {
+  if (maxBlockCount == 0) {
+    return;
+  }
+
+  if (!blocks.empty() && block.index != startIndex + blocks.size()) {
+    // not a continuation of cached blocks, start over
+    clear();
+  }
+
+  if (blocks.empty()) {
+    startIndex = block.index;
+  }
+
+  BlockEntry entry;
+  entry.hash = block.hash;
+  entry.transactions.reserve(block.transactions.size());
+  for (auto& transaction : block.transactions) {
+    entry.transactions.push_back(transaction.transactionHash);
+    transactions[transaction.transactionHash] = std::move(transaction);
+  }
+
+  entry.keyOutputs.reserve(block.keyOutputs.size());
+  for (auto& keyOutput : block.keyOutputs) {
+    entry.keyOutputs.push_back(keyOutput.first);
+    keyOutputs[keyOutput.first] = keyOutput.second;
+  }
+
+  blockIndexes[block.hash] = block.index;
+  blocks.push_back(std::move(entry));
+
+  if (blocks.size() > maxBlockCount) {
+    popFront();
+  }
+}
+
+void DatabaseTipCache::cutFrom(uint32_t splitBlockIndex) {
+  while (!blocks.empty() && startIndex + blocks.size() > splitBlockIndex) {
+    popBack();
+  }
+}
+
+void DatabaseTipCache::clear() {
+  blocks.clear();
+  blockIndexes.clear();
+  transactions.clear();
+  keyOutputs.clear();
+  startIndex = 0;
+}
+
+bool DatabaseTipCache::findBlockIndex(const Crypto::Hash& blockHash, uint32_t& blockIndex) const {
+  auto it = blockIndexes.find(blockHash);
+  if (it == blockIndexes.end()) {
+    statistics->blockMisses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  statistics->blockHits.fetch_add(1, std::memory_order_relaxed);
+  blockIndex = it->second;
+  return true;
+}
+
+bool DatabaseTipCache::findBlockHash(uint32_t blockIndex, Crypto::Hash& blockHash) const {
+  if (blockIndex < startIndex || blockIndex - startIndex >= blocks.size()) {
+    statistics->blockMisses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  statistics->blockHits.fetch_add(1, std::memory_order_relaxed);
+  blockHash = blocks[blockIndex - startIndex].hash;
+  return true;
+}
+
+bool DatabaseTipCache::findBlockHashes(uint32_t rangeStartIndex, uint32_t count, std::vector<Crypto::Hash>& blockHashes) const {
+  if (rangeStartIndex < startIndex || rangeStartIndex - startIndex + static_cast<size_t>(count) > blocks.size()) {
+    statistics->blockMisses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  statistics->blockHits.fetch_add(1, std::memory_order_relaxed);
+  blockHashes.reserve(blockHashes.size() + count);
+  auto begin = blocks.begin() + (rangeStartIndex - startIndex);
+  for (auto it = begin; it != begin + count; ++it) {
+    blockHashes.push_back(it->hash);
+  }
+
+  return true;
+}
+
+const ExtendedTransactionInfo* DatabaseTipCache::findTransaction(const Crypto::Hash& transactionHash) const {
+  auto it = transactions.find(transactionHash);
+  if (it == transactions.end()) {
+    statistics->transactionMisses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  statistics->transactionHits.fetch_add(1, std::memory_order_relaxed);
+  return &it->second;
+}
+
+const KeyOutputInfo* DatabaseTipCache::findKeyOutput(IBlockchainCache::Amount amount, IBlockchainCache::GlobalOutputIndex globalIndex) const {
+  auto it = keyOutputs.find({amount, globalIndex});
+  if (it == keyOutputs.end()) {
+    statistics->outputMisses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  statistics->outputHits.fetch_add(1, std::memory_order_relaxed);
+  return &it->second;
+}
+
+TipCacheStatistics DatabaseTipCache::getStatistics() const {
+  TipCacheStatistics result;
+  result.blockHits = statistics->blockHits.load(std::memory_order_relaxed);
+  result.blockMisses = statistics->blockMisses.load(std::memory_order_relaxed);
+  result.transactionHits = statistics->transactionHits.load(std::memory_order_relaxed);
+  result.transactionMisses = statistics->transactionMisses.load(std::memory_order_relaxed);
+  result.outputHits = statistics->outputHits.load(std::memory_order_relaxed);
+  result.outputMisses = statistics->outputMisses.load(std::memory_order_relaxed);
+  return result;
+}
+
+void DatabaseTipCache::popFront() {
+  assert(!blocks.empty());
+  eraseEntries(blocks.front());
+  blocks.pop_front();
+  ++startIndex;
+}
+
+void DatabaseTipCache::popBack() {
+  assert(!blocks.empty());
+  eraseEntries(blocks.back());
+  blocks.pop_back();
+}
+
+void DatabaseTipCache::eraseEntries(const BlockEntry& entry) {
+  blockIndexes.erase(entry.hash);
+  for (const auto& transactionHash : entry.transactions) {
+    transactions.erase(transactionHash);
+  }
+
+  for (const auto& keyOutput : entry.keyOutputs) {
+    keyOutputs.erase(keyOutput);
+  }
+}
+
+}
@@ -0,0 +1,108 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "crypto/hash.h"
+#include "CryptoNoteCore/DatabaseCacheData.h"
+
+namespace CryptoNote {
+
+struct TipCacheStatistics {
+  uint64_t blockHits = 0;
+  uint64_t blockMisses = 0;
+  uint64_t transactionHits = 0;
+  uint64_t transactionMisses = 0;
+  uint64_t outputHits = 0;
+  uint64_t outputMisses = 0;
+};
+
+// Keeps block hashes, transaction infos and key outputs of the last blocks stored in database,
+// so lookups near the chain tip don't go to database. Blocks must be pushed in order, oldest
+// blocks are evicted when the limit is exceeded, blocks cut from the chain are dropped by cutFrom.
+class DatabaseTipCache {
+public:
+  typedef std::pair<IBlockchainCache::Amount, IBlockchainCache::GlobalOutputIndex> KeyOutputId;
+
+  struct Block {
+    uint32_t index;
+    Crypto::Hash hash;
+    std::vector<ExtendedTransactionInfo> transactions;
+    std::vector<std::pair<KeyOutputId, KeyOutputInfo>> keyOutputs;
+  };
+
+  static const size_t DEFAULT_MAX_BLOCK_COUNT = 2000;
+
+  explicit DatabaseTipCache(size_t maxBlockCount = DEFAULT_MAX_BLOCK_COUNT);
+
+  size_t getMaxBlockCount() const;
+  size_t getBlockCount() const;
+
+  void pushBlock(Block&& block);
+  // drops blocks with index greater or equal to splitBlockIndex
+  void cutFrom(uint32_t splitBlockIndex);
+  void clear();
+
+  bool findBlockIndex(const Crypto::Hash& blockHash, uint32_t& blockIndex) const;
+  bool findBlockHash(uint32_t blockIndex, Crypto::Hash& blockHash) const;
+  bool findBlockHashes(uint32_t startIndex, uint32_t count, std::vector<Crypto::Hash>& blockHashes) const;
+  const ExtendedTransactionInfo* findTransaction(const Crypto::Hash& transactionHash) const;
+  const KeyOutputInfo* findKeyOutput(IBlockchainCache::Amount amount, IBlockchainCache::GlobalOutputIndex globalIndex) const;
+
+  TipCacheStatistics getStatistics() const;
+
+private:
+  struct BlockEntry {
+    Crypto::Hash hash;
+    std::vector<Crypto::Hash> transactions;
+    std::vector<KeyOutputId> keyOutputs;
+  };
+
+  // lookups are const and may run concurrently, so hit and miss counters are atomic
+  struct StatisticsCounters {
+    std::atomic<uint64_t> blockHits{0};
+    std::atomic<uint64_t> blockMisses{0};
+    std::atomic<uint64_t> transactionHits{0};
+    std::atomic<uint64_t> transactionMisses{0};
+    std::atomic<uint64_t> outputHits{0};
+    std::atomic<uint64_t> outputMisses{0};
+  };
+
+  void popFront();
+  void popBack();
+  void eraseEntries(const BlockEntry& entry);
+
+  const size_t maxBlockCount;
+  uint32_t startIndex;
+  std::deque<BlockEntry> blocks;
+  std::unordered_map<Crypto::Hash, uint32_t> blockIndexes;
+  std::unordered_map<Crypto::Hash, ExtendedTransactionInfo> transactions;
+  std::map<KeyOutputId, KeyOutputInfo> keyOutputs;
+
+  std::unique_ptr<StatisticsCounters> statistics;
+};
+
+}
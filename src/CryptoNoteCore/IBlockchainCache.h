@@ -21,6 +21,7 @@
 
 #include <CryptoNote.h>
 
+#include "CryptoNoteCore/BlockFilter.h"
 #include "CryptoNoteCore/CachedBlock.h"
 #include "CryptoNoteCore/CachedTransaction.h"
 #include "CryptoNoteCore/Difficulty.h"
@@ -59,6 +60,13 @@ struct PushedBlockInfo {
   Difficulty blockDifficulty;
 };
 
+// block and its transactions restored from PushedBlockInfo::rawBlock
+struct PushedBlock {
+  BlockTemplate block;
+  std::vector<CachedTransaction> transactions;
+  PushedBlockInfo info;
+};
+
 class UseGenesis {
 public:
   explicit UseGenesis(bool u) : use(u) {}
@@ -84,6 +92,10 @@ public:
   virtual ~IBlockchainCache() {}
 
   virtual RawBlock getBlockByIndex(uint32_t index) const = 0;
+  // blocks [startIndex, startIndex + count) of the chain ending at this segment, read at once
+  virtual std::vector<RawBlock> getBlocksByIndexRange(uint32_t startIndex, uint32_t count) const = 0;
+  virtual std::vector<CachedBlockInfo> getBlockInfosByIndexRange(uint32_t startIndex, uint32_t count) const = 0;
+  virtual std::vector<BlockFilter> getBlockFiltersByIndexRange(uint32_t startIndex, uint32_t count) const = 0;
   virtual BinaryArray getRawTransaction(uint32_t blockIndex, uint32_t transactionIndex) const = 0;
   virtual std::unique_ptr<IBlockchainCache> split(uint32_t splitBlockIndex) = 0;
   virtual void pushBlock(
@@ -94,6 +106,8 @@ public:
       uint64_t generatedCoins,
       Difficulty blockDifficulty,
       RawBlock&& rawBlock) = 0;
+  // pushes consecutive blocks, a database backed segment writes them in one batch
+  virtual void pushBlocks(std::vector<PushedBlock>&& blocks) = 0;
   virtual PushedBlockInfo getPushedBlockInfo(uint32_t index) const = 0;
   virtual bool checkIfSpent(const Crypto::KeyImage& keyImage, uint32_t blockIndex) const = 0;
   virtual bool checkIfSpent(const Crypto::KeyImage& keyImage) const = 0;
@@ -125,6 +139,11 @@ public:
   virtual std::vector<uint64_t> getLastBlocksSizes(size_t count) const = 0;
   virtual std::vector<uint64_t> getLastBlocksSizes(size_t count, uint32_t blockIndex, UseGenesis) const = 0;
 
+  // Common::medianValue of getLastTimestamps/getLastBlocksSizes, kept in sliding windows instead of sorting them every time
+  virtual uint64_t getLastTimestampsMedian(size_t count, uint32_t blockIndex, UseGenesis) const = 0;
+  virtual uint64_t getLastBlocksSizesMedian(size_t count) const = 0;
+  virtual uint64_t getLastBlocksSizesMedian(size_t count, uint32_t blockIndex, UseGenesis) const = 0;
+
   virtual std::vector<Difficulty> getLastCumulativeDifficulties(size_t count, uint32_t blockIndex, UseGenesis) const = 0;
   virtual std::vector<Difficulty> getLastCumulativeDifficulties(size_t count) const = 0;
 
@@ -75,7 +75,11 @@ public:
   virtual Difficulty getDifficultyForNextBlock() const = 0;
 
   virtual std::error_code addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlock) = 0;
+  // transactions are already deserialized from rawBlock.transactions, in the same order
+  virtual std::error_code addBlock(const CachedBlock& cachedBlock, std::vector<CachedTransaction>&& transactions, RawBlock&& rawBlock) = 0;
   virtual std::error_code addBlock(RawBlock&& rawBlock) = 0;
+  // proof of work isn't checked for blocks in checkpoint zone
+  virtual bool isInCheckpointZone(uint32_t blockIndex) const = 0;
 
   virtual std::error_code submitBlock(BinaryArray&& rawBlockTemplate) = 0;
 
@@ -87,6 +91,9 @@ public:
   virtual bool addTransactionToPool(const BinaryArray& transactionBinaryArray) = 0;
 
   virtual std::vector<Crypto::Hash> getPoolTransactionHashes() const = 0;
+  virtual void getPoolTransactions(const std::vector<Crypto::Hash>& transactionHashes,
+                                   std::vector<BinaryArray>& transactions,
+                                   std::vector<Crypto::Hash>& missedHashes) const = 0;
   virtual bool getPoolChanges(const Crypto::Hash& lastBlockHash, const std::vector<Crypto::Hash>& knownHashes,
                               std::vector<BinaryArray>& addedTransactions,
                               std::vector<Crypto::Hash>& deletedTransactions) const = 0;
@@ -103,6 +110,8 @@ public:
   virtual void load() = 0;
 
   virtual BlockDetails getBlockDetails(const Crypto::Hash& blockHash) const = 0;
+  // details of main chain blocks [startIndex, startIndex + count), blocks above the top one are skipped
+  virtual std::vector<BlockDetails> getBlocksDetails(uint32_t startIndex, uint32_t count) const = 0;
   virtual TransactionDetails getTransactionDetails(const Crypto::Hash& transactionHash) const = 0;
   virtual std::vector<Crypto::Hash> getAlternativeBlockHashesByIndex(uint32_t blockIndex) const = 0;
   virtual std::vector<Crypto::Hash> getBlockHashesByTimestamps(uint64_t timestampBegin, size_t secondsCount) const = 0;
@@ -27,6 +27,8 @@ public:
 
   virtual void pushBlock(const RawBlock& rawBlock) = 0;
   virtual void popBlock() = 0;
+  virtual void pushBlocks(const std::vector<RawBlock>& rawBlocks) = 0;
+  virtual void popBlocks(uint32_t count) = 0;
 
   virtual RawBlock getBlockByIndex(uint32_t index) const = 0;
   virtual uint32_t getBlockCount() const = 0;
@@ -0,0 +1,88 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "MainChainBlockHashes.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+
+namespace CryptoNote {
+
+uint32_t MainChainBlockHashes::getBlockCount() const {
+  return static_cast<uint32_t>(hashes.size());
+}
+
+void MainChainBlockHashes::pushBlock(const Crypto::Hash& blockHash) {
+  hashes.push_back(blockHash);
+}
+
+void MainChainBlockHashes::pushBlocks(const std::vector<Crypto::Hash>& blockHashes) {
+  hashes.insert(hashes.end(), blockHashes.begin(), blockHashes.end());
+}
+
+void MainChainBlockHashes::cutFrom(uint32_t splitBlockIndex) {
+  if (splitBlockIndex < hashes.size()) {
+    hashes.resize(splitBlockIndex);
+  }
+}
+
+void MainChainBlockHashes::clear() {
+  hashes.clear();
+}
+
+const Crypto::Hash& MainChainBlockHashes::getBlockHash(uint32_t blockIndex) const {
+  if (blockIndex >= hashes.size()) {
+    throw std::out_of_range("Block index " + std::to_string(blockIndex) + " is out of range. Blocks count: " + std::to_string(hashes.size()));
+  }
+
+  return hashes[blockIndex];
+}
+
+bool MainChainBlockHashes::hasBlock(uint32_t blockIndex, const Crypto::Hash& blockHash) const {
+  return blockIndex < hashes.size() && hashes[blockIndex] == blockHash;
+}
+
+std::vector<Crypto::Hash> MainChainBlockHashes::getBlockHashes(uint32_t startIndex, uint32_t maxCount) const {
+  if (startIndex >= hashes.size()) {
+    return {};
+  }
+
+  auto count = std::min(static_cast<size_t>(maxCount), hashes.size() - startIndex);
+  return std::vector<Crypto::Hash>(hashes.begin() + startIndex, hashes.begin() + startIndex + count);
+}
+
+std::vector<Crypto::Hash> MainChainBlockHashes::buildSparseChain() const {
+  assert(!hashes.empty());
+
+  uint32_t topIndex = getBlockCount() - 1;
+  std::vector<Crypto::Hash> sparseChain;
+  sparseChain.push_back(hashes[topIndex]);
+
+  for (uint32_t i = 1; i < topIndex; i *= 2) {
+    sparseChain.push_back(hashes[topIndex - i]);
+  }
+
+  if (topIndex != 0) {
+    sparseChain.push_back(hashes[0]);
+  }
+
+  return sparseChain;
+}
+
+}
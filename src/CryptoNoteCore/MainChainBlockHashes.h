@@ -0,0 +1,50 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "crypto/hash.h"
+
+namespace CryptoNote {
+
+// Hashes of main chain blocks by block index. Core keeps it in step with main chain storage,
+// so sparse chains and hash ranges are served from memory instead of walking chain segments.
+class MainChainBlockHashes {
+public:
+  uint32_t getBlockCount() const;
+
+  void pushBlock(const Crypto::Hash& blockHash);
+  void pushBlocks(const std::vector<Crypto::Hash>& blockHashes);
+  // drops blocks with index greater or equal to splitBlockIndex
+  void cutFrom(uint32_t splitBlockIndex);
+  void clear();
+
+  // throws std::out_of_range if there is no such block
+  const Crypto::Hash& getBlockHash(uint32_t blockIndex) const;
+  bool hasBlock(uint32_t blockIndex, const Crypto::Hash& blockHash) const;
+  std::vector<Crypto::Hash> getBlockHashes(uint32_t startIndex, uint32_t maxCount) const;
+  // top block, then blocks 1, 2, 4, 8... below the top, then genesis
+  std::vector<Crypto::Hash> buildSparseChain() const;
+
+private:
+  std::vector<Crypto::Hash> hashes;
+};
+
+}
@@ -43,6 +43,18 @@ void MainChainStorage::popBlock() {
   storage.pop_back();
 }
 
+void MainChainStorage::pushBlocks(const std::vector<RawBlock>& rawBlocks) {
+  storage.push_back(rawBlocks);
+}
+
+void MainChainStorage::popBlocks(uint32_t count) {
+  if (count > storage.size()) {
+    throw std::out_of_range("Can't pop " + std::to_string(count) + " blocks. Blocks count: " + std::to_string(storage.size()));
+  }
+
+  storage.pop_back(count);
+}
+
 RawBlock MainChainStorage::getBlockByIndex(uint32_t index) const {
   if (index >= storage.size()) {
     throw std::out_of_range("Block index " + std::to_string(index) + " is out of range. Blocks count: " + std::to_string(storage.size()));
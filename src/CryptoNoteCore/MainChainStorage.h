@@ -30,6 +30,8 @@ public:
 
   virtual void pushBlock(const RawBlock& rawBlock) override;
   virtual void popBlock() override;
+  virtual void pushBlocks(const std::vector<RawBlock>& rawBlocks) override;
+  virtual void popBlocks(uint32_t count) override;
 
   virtual RawBlock getBlockByIndex(uint32_t index) const override;
   virtual uint32_t getBlockCount() const override;
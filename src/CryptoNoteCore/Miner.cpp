@@ -34,6 +34,7 @@
 #include "Common/StringTools.h"
 #include "Serialization/SerializationTools.h"
 
+#include "BlockMiningHasher.h"
 #include "CryptoNoteFormatUtils.h"
 #include "TransactionExtra.h"
 
@@ -290,26 +291,29 @@ namespace CryptoNote
 
       for (unsigned i = 0; i < nthreads; ++i) {
         threads[i] = std::async(std::launch::async, [&, i]() {
-          Crypto::cn_context localctx;
-          Crypto::Hash h;
-
-          BlockTemplate lb(bl); // copy to local block
-
-          for (uint32_t nonce = startNonce + i; !found; nonce += nthreads) {
-            lb.nonce = nonce;
-
-            CachedBlock cb(lb);
-            try {
-              h = cb.getBlockLongHash(localctx);
-            } catch (std::exception&) {
-              return;
-            }
-
-            if (check_hash(h, diffic)) {
-              foundNonce = nonce;
-              found = true;
-              return;
+          try {
+            BlockMiningHasher hasher;
+            hasher.setBlock(bl);
+
+            const size_t ways = hasher.getWays();
+            std::vector<uint32_t> nonces(ways);
+            std::vector<Crypto::Hash> hashes(ways);
+            for (uint32_t nonce = startNonce + i; !found; nonce += static_cast<uint32_t>(ways) * nthreads) {
+              for (size_t way = 0; way < ways; ++way) {
+                nonces[way] = nonce + static_cast<uint32_t>(way) * nthreads;
+              }
+
+              hasher.hash(nonces.data(), hashes.data());
+              for (size_t way = 0; way < ways; ++way) {
+                if (check_hash(hashes[way], diffic)) {
+                  foundNonce = nonces[way];
+                  found = true;
+                  return;
+                }
+              }
             }
+          } catch (std::exception&) {
+            return;
           }
         });
       }
@@ -372,12 +376,16 @@ namespace CryptoNote
   //-----------------------------------------------------------------------------------------------------
   bool miner::worker_thread(uint32_t th_local_index)
   {
-    logger(INFO) << "Miner thread was started ["<< th_local_index << "]";
     uint32_t nonce = m_starter_nonce + th_local_index;
     Difficulty local_diff = 0;
     uint32_t local_template_ver = 0;
-    Crypto::cn_context context;
-    BlockTemplate b;
+
+    BlockMiningHasher hasher;
+    const size_t ways = hasher.getWays();
+    logger(INFO) << "Miner thread was started ["<< th_local_index << "], scratchpads are backed by " << Crypto::cn_pages_name(hasher.getPages());
+    std::vector<uint32_t> nonces(ways);
+    std::vector<Crypto::Hash> hashes(ways);
+    BlockTemplate block;
 
     while(!m_stop)
     {
@@ -389,10 +397,18 @@ namespace CryptoNote
 
       if(local_template_ver != m_template_no) {
         std::unique_lock<std::mutex> lk(m_template_lock);
-        b = m_template;
+        block = m_template;
         local_diff = m_diffic;
         lk.unlock();
 
+        try {
+          hasher.setBlock(block);
+        } catch (std::exception& e) {
+          logger(ERROR) << "Failed to prepare block hashing blob: " << e.what();
+          m_stop = true;
+          break;
+        }
+
         local_template_ver = m_template_no;
         nonce = m_starter_nonce + th_local_index;
       }
@@ -404,27 +420,31 @@ namespace CryptoNote
         continue;
       }
 
-      b.nonce = nonce;
-      Crypto::Hash h;
+      for (size_t i = 0; i < ways; ++i) {
+        nonces[i] = nonce + static_cast<uint32_t>(i) * m_threads_total;
+      }
 
-      CachedBlock cb(b);
       if (!m_stop) {
         try {
-          h = cb.getBlockLongHash(context);
+          hasher.hash(nonces.data(), hashes.data());
         } catch (std::exception& e) {
           logger(ERROR) << "getBlockLongHash failed: " << e.what();
           m_stop = true;
         }
       }
 
-      if (!m_stop && check_hash(h, local_diff))
-      {
+      for (size_t i = 0; i < ways && !m_stop; ++i) {
+        if (!check_hash(hashes[i], local_diff)) {
+          continue;
+        }
+
         //we lucky!
         ++m_config.current_extra_message_index;
 
         logger(INFO, GREEN) << "Found block for difficulty: " << local_diff;
 
-        if(!m_handler.handle_block_found(b)) {
+        block.nonce = nonces[i];
+        if(!m_handler.handle_block_found(block)) {
           --m_config.current_extra_message_index;
         } else {
           //success update, lets update config
@@ -432,8 +452,8 @@ namespace CryptoNote
         }
       }
 
-      nonce += m_threads_total;
-      ++m_hashes;
+      nonce += static_cast<uint32_t>(ways) * m_threads_total;
+      m_hashes += ways;
     }
     logger(INFO) << "Miner thread stopped ["<< th_local_index << "]";
     return true;
@@ -21,6 +21,7 @@
 #include "rocksdb/table.h"
 #include "rocksdb/db.h"
 #include "rocksdb/utilities/backupable_db.h"
+#include "rocksdb/utilities/checkpoint.h"
 
 #include "DataBaseErrors.h"
 
@@ -107,6 +108,26 @@ void RocksDBWrapper::destoy(const DataBaseConfig& config) {
   }
 }
 
+void RocksDBWrapper::createCheckpoint(const std::string& checkpointDir) {
+  if (state.load() != INITIALIZED) {
+    throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::NOT_INITIALIZED));
+  }
+
+  logger(INFO) << "Creating DB checkpoint in " << checkpointDir;
+
+  rocksdb::Checkpoint* checkpointPtr = nullptr;
+  rocksdb::Status status = rocksdb::Checkpoint::Create(db.get(), &checkpointPtr);
+  std::unique_ptr<rocksdb::Checkpoint> checkpoint(checkpointPtr);
+  if (status.ok()) {
+    status = checkpoint->CreateCheckpoint(checkpointDir);
+  }
+
+  if (!status.ok()) {
+    logger(ERROR) << "DB Error. Checkpoint can't be created in " << checkpointDir << ". Error: " << status.ToString();
+    throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR));
+  }
+}
+
 std::error_code RocksDBWrapper::write(IWriteBatch& batch) {
   if (state.load() != INITIALIZED) {
     throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::NOT_INITIALIZED));
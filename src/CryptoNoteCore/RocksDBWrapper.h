@@ -44,6 +44,9 @@ public:
   void init(const DataBaseConfig& config);
   void shutdown();
   void destoy(const DataBaseConfig& config); //Be careful with this method!
+  // consistent copy of the database, made of hard links where possible, checkpointDir must not exist
+  void createCheckpoint(const std::string& checkpointDir);
+  std::string getDataDir(const DataBaseConfig& config);
 
   std::error_code write(IWriteBatch& batch) override;
   std::error_code writeSync(IWriteBatch& batch) override;
@@ -53,7 +56,6 @@ private:
   std::error_code write(IWriteBatch& batch, bool sync);
 
   rocksdb::Options getDBOptions(const DataBaseConfig& config);
-  std::string getDataDir(const DataBaseConfig& config);
 
   enum State {
     NOT_INITIALIZED,
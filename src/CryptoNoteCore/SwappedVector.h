@@ -160,7 +160,11 @@ public:
   const T& back();
   void clear();
   void pop_back();
+  // removes last count items, index file is updated once
+  void pop_back(uint64_t count);
   void push_back(const T& item);
+  // appends items, index file is updated once
+  void push_back(const std::vector<T>& items);
 
 private:
   struct ItemEntry;
@@ -330,23 +334,30 @@ template<class T> void SwappedVector<T>::clear() {
 }
 
 template<class T> void SwappedVector<T>::pop_back() {
-  if (!m_indexesFile) {
+  pop_back(1);
+}
+
+template<class T> void SwappedVector<T>::pop_back(uint64_t count) {
+  if (!m_indexesFile || count > m_offsets.size()) {
     throw std::runtime_error("SwappedVector::pop_back");
   }
 
+  if (count == 0) {
+    return;
+  }
+
   m_indexesFile.seekp(0);
-  uint64_t count = m_offsets.size() - 1;
-  m_indexesFile.write(reinterpret_cast<char*>(&count), sizeof count);
+  uint64_t newCount = m_offsets.size() - count;
+  m_indexesFile.write(reinterpret_cast<char*>(&newCount), sizeof newCount);
   if (!m_indexesFile) {
     throw std::runtime_error("SwappedVector::pop_back");
   }
 
-  m_itemsFileSize = m_offsets.back();
-  m_offsets.pop_back();
-  auto itemIter = m_items.find(m_offsets.size());
-  if (itemIter != m_items.end()) {
+  m_itemsFileSize = m_offsets[newCount];
+  m_offsets.resize(newCount);
+  for (auto itemIter = m_items.lower_bound(newCount); itemIter != m_items.end();) {
     m_cache.erase(itemIter->second.cacheIter);
-    m_items.erase(itemIter);
+    itemIter = m_items.erase(itemIter);
   }
 }
 
@@ -394,6 +405,66 @@ template<class T> void SwappedVector<T>::push_back(const T& item) {
   *newItem = item;
 }
 
+template<class T> void SwappedVector<T>::push_back(const std::vector<T>& items) {
+  if (items.empty()) {
+    return;
+  }
+
+  std::vector<uint32_t> itemSizes;
+  itemSizes.reserve(items.size());
+  uint64_t itemsFileSize = m_itemsFileSize;
+
+  {
+    if (!m_itemsFile) {
+      throw std::runtime_error("SwappedVector::push_back");
+    }
+
+    m_itemsFile.seekp(m_itemsFileSize);
+
+    Common::StdOutputStream stream(m_itemsFile);
+    CryptoNote::BinaryOutputStreamSerializer archive(stream);
+    for (const T& item : items) {
+      serialize(const_cast<T&>(item), archive);
+
+      uint64_t itemEnd = m_itemsFile.tellp();
+      itemSizes.push_back(static_cast<uint32_t>(itemEnd - itemsFileSize));
+      itemsFileSize = itemEnd;
+    }
+  }
+
+  {
+    if (!m_indexesFile) {
+      throw std::runtime_error("SwappedVector::push_back");
+    }
+
+    m_indexesFile.seekp(sizeof(uint64_t) + sizeof(uint32_t) * m_offsets.size());
+    m_indexesFile.write(reinterpret_cast<char*>(itemSizes.data()), sizeof(uint32_t) * itemSizes.size());
+    if (!m_indexesFile) {
+      throw std::runtime_error("SwappedVector::push_back");
+    }
+
+    m_indexesFile.seekp(0);
+    uint64_t count = m_offsets.size() + items.size();
+    m_indexesFile.write(reinterpret_cast<char*>(&count), sizeof count);
+    if (!m_indexesFile) {
+      throw std::runtime_error("SwappedVector::push_back");
+    }
+  }
+
+  uint64_t firstIndex = m_offsets.size();
+  for (uint32_t itemSize : itemSizes) {
+    m_offsets.push_back(m_itemsFileSize);
+    m_itemsFileSize += itemSize;
+  }
+
+  // only the tail fits into the cache anyway
+  size_t firstCached = items.size() > m_poolSize ? items.size() - m_poolSize : 0;
+  for (size_t i = firstCached; i < items.size(); ++i) {
+    T* newItem = prepare(firstIndex + i);
+    *newItem = items[i];
+  }
+}
+
 template<class T> T* SwappedVector<T>::prepare(uint64_t index) {
   if (m_items.size() == m_poolSize) {
     auto cacheIter = m_cache.begin();
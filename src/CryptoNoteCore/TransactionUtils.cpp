@@ -153,4 +153,34 @@ bool findOutputsToAccount(const CryptoNote::TransactionPrefix& transaction, cons
   return true;
 }
 
+void findMyOutputs(const ITransactionReader& tx, const SecretKey& viewSecretKey, const std::unordered_set<PublicKey>& spendKeys,
+  std::unordered_map<PublicKey, std::vector<uint32_t>>& outputs) {
+
+  auto txPublicKey = tx.getTransactionPublicKey();
+  KeyDerivation derivation;
+
+  if (!generate_key_derivation(txPublicKey, viewSecretKey, derivation)) {
+    return;
+  }
+
+  size_t keyIndex = 0;
+  size_t outputCount = tx.getOutputCount();
+
+  for (size_t idx = 0; idx < outputCount; ++idx) {
+    if (tx.getOutputType(idx) == TransactionTypes::OutputType::Key) {
+      uint64_t amount;
+      KeyOutput out;
+      tx.getOutput(idx, out, amount);
+
+      PublicKey spendKey;
+      underive_public_key(derivation, keyIndex, out.key, spendKey);
+      if (spendKeys.find(spendKey) != spendKeys.end()) {
+        outputs[spendKey].push_back(static_cast<uint32_t>(idx));
+      }
+
+      ++keyIndex;
+    }
+  }
+}
+
 }
@@ -15,6 +15,9 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <unordered_map>
+#include <unordered_set>
+
 #include "CryptoNoteCore/CryptoNoteBasic.h"
 #include "ITransaction.h"
 
@@ -39,4 +42,8 @@ const TransactionOutput& getOutputChecked(const CryptoNote::TransactionPrefix& t
 bool findOutputsToAccount(const CryptoNote::TransactionPrefix& transaction, const AccountPublicAddress& addr,
         const Crypto::SecretKey& viewSecretKey, std::vector<uint32_t>& out, uint64_t& amount);
 
+// Finds key outputs of tx sent to any of spendKeys sharing one view key, outputs are grouped by spend key
+void findMyOutputs(const ITransactionReader& tx, const Crypto::SecretKey& viewSecretKey,
+        const std::unordered_set<Crypto::PublicKey>& spendKeys, std::unordered_map<Crypto::PublicKey, std::vector<uint32_t>>& outputs);
+
 } //namespace CryptoNote
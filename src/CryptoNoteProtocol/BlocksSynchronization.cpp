@@ -0,0 +1,75 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "BlocksSynchronization.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "CryptoNoteConfig.h"
+
+namespace CryptoNote {
+
+namespace {
+
+// weight of the last measurement in exponential moving averages of peer synchronization statistics
+const double SYNCHRONIZATION_STATISTICS_SMOOTHING = 0.3;
+
+double updateMovingAverage(double average, double value) {
+  return average == 0 ? value : average + SYNCHRONIZATION_STATISTICS_SMOOTHING * (value - average);
+}
+
+}
+
+void updateBlocksSynchronizationStatistics(BlocksSynchronizationStatistics& statistics, size_t blockCount, uint64_t responseSize, double roundTripTime) {
+  assert(blockCount != 0);
+
+  statistics.requestedCount = 0;
+  statistics.receivedBlocks += blockCount;
+  statistics.receivedBytes += responseSize;
+  statistics.averageBlockSize = updateMovingAverage(statistics.averageBlockSize, static_cast<double>(responseSize) / blockCount);
+  statistics.roundTripTime = updateMovingAverage(statistics.roundTripTime, roundTripTime);
+  if (roundTripTime > 0) {
+    statistics.throughput = updateMovingAverage(statistics.throughput, responseSize * 1000 / roundTripTime);
+  }
+}
+
+size_t getBlocksRequestCount(const BlocksSynchronizationStatistics& statistics) {
+  if (statistics.averageBlockSize == 0) {
+    return BLOCKS_SYNCHRONIZING_DEFAULT_COUNT;
+  }
+
+  // Response should arrive in BLOCKS_SYNCHRONIZING_TARGET_TIME at the peer's measured rate, but not exceed BLOCKS_SYNCHRONIZING_TARGET_SIZE.
+  // Measured rate includes round trip latency, so with target time above latency request size keeps growing up to the limit.
+  double targetSize = static_cast<double>(BLOCKS_SYNCHRONIZING_TARGET_SIZE);
+  if (statistics.throughput > 0) {
+    targetSize = std::min(targetSize, statistics.throughput * BLOCKS_SYNCHRONIZING_TARGET_TIME / 1000);
+  }
+
+  double count = targetSize / statistics.averageBlockSize;
+  if (count < BLOCKS_SYNCHRONIZING_MIN_COUNT) {
+    return BLOCKS_SYNCHRONIZING_MIN_COUNT;
+  }
+
+  if (count > BLOCKS_SYNCHRONIZING_MAX_COUNT) {
+    return BLOCKS_SYNCHRONIZING_MAX_COUNT;
+  }
+
+  return static_cast<size_t>(count);
+}
+
+}
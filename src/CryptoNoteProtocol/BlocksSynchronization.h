@@ -0,0 +1,32 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "P2p/ConnectionContext.h"
+
+namespace CryptoNote {
+
+// Adds a blocks downloading response of responseSize bytes, received roundTripTime milliseconds after the request
+void updateBlocksSynchronizationStatistics(BlocksSynchronizationStatistics& statistics, size_t blockCount, uint64_t responseSize, double roundTripTime);
+// Blocks count of the next downloading request to the peer
+size_t getBlocksRequestCount(const BlocksSynchronizationStatistics& statistics);
+
+}
@@ -149,4 +149,35 @@ namespace CryptoNote
     const static int ID = BC_COMMANDS_POOL_BASE + 8;
     typedef NOTIFY_REQUEST_TX_POOL_request request;
   };
+
+  /************************************************************************/
+  /*                                                                      */
+  /************************************************************************/
+  //announces transaction hashes instead of blobs, supported since P2PProtocolVersion::V2
+  struct NOTIFY_TRANSACTIONS_INVENTORY_request {
+    std::vector<Crypto::Hash> txs;
+
+    void serialize(ISerializer& s) {
+      serializeAsBinary(txs, "txs", s);
+    }
+  };
+
+  struct NOTIFY_TRANSACTIONS_INVENTORY {
+    const static int ID = BC_COMMANDS_POOL_BASE + 9;
+    typedef NOTIFY_TRANSACTIONS_INVENTORY_request request;
+  };
+
+  //requested transactions are sent back with NOTIFY_NEW_TRANSACTIONS
+  struct NOTIFY_REQUEST_TRANSACTIONS_request {
+    std::vector<Crypto::Hash> txs;
+
+    void serialize(ISerializer& s) {
+      serializeAsBinary(txs, "txs", s);
+    }
+  };
+
+  struct NOTIFY_REQUEST_TRANSACTIONS {
+    const static int ID = BC_COMMANDS_POOL_BASE + 10;
+    typedef NOTIFY_REQUEST_TRANSACTIONS_request request;
+  };
 }
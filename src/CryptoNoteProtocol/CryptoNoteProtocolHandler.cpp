@@ -17,16 +17,22 @@
 
 #include "CryptoNoteProtocolHandler.h"
 
-#include <future>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <boost/scope_exit.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <System/Dispatcher.h>
+#include <System/InterruptedException.h>
+#include <System/Event.h>
+#include <System/Timer.h>
 
 #include "CryptoNoteCore/CryptoNoteBasicImpl.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "CryptoNoteCore/Currency.h"
 #include "CryptoNoteCore/VerificationContext.h"
+#include "CryptoNoteProtocol/BlocksSynchronization.h"
 #include "P2p/LevinProtocol.h"
 
 using namespace Logging;
@@ -36,6 +42,11 @@ namespace CryptoNote {
 
 namespace {
 
+const std::chrono::milliseconds TRANSACTIONS_ANNOUNCEMENT_INTERVAL = std::chrono::milliseconds(200);
+const std::chrono::seconds TRANSACTION_REQUEST_TIMEOUT = std::chrono::seconds(30);
+const std::chrono::seconds TRANSACTION_REQUESTS_EXPIRATION_INTERVAL = std::chrono::seconds(5);
+// hashes of a larger inventory are ignored, announcements are flushed every TRANSACTIONS_ANNOUNCEMENT_INTERVAL
+const size_t MAX_INVENTORY_TRANSACTIONS = 10000;
 template<class t_parametr>
 bool post_notify(IP2pEndpoint& p2p, typename t_parametr::request& arg, const CryptoNoteConnectionContext& context) {
   return p2p.invoke_notify_to_peer(t_parametr::ID, LevinProtocol::encode(arg), context);
@@ -135,6 +146,13 @@ CryptoNoteProtocolHandler::CryptoNoteProtocolHandler(const Currency& currency, S
   m_stop(false),
   m_observedHeight(0),
   m_peersCount(0),
+  m_transactionRequests(TRANSACTION_REQUEST_TIMEOUT),
+  m_announcementScheduled(false),
+  m_requestsExpirationScheduled(false),
+  m_announcementContext(dispatcher),
+  m_blockPreparationThreadCount(std::max<size_t>(std::thread::hardware_concurrency(), 1)),
+  m_blockPreparationPool(m_blockPreparationThreadCount),
+  m_proofOfWorkContextPool(m_blockPreparationThreadCount * Crypto::cn_slow_hash_get_multi_ways()),
   logger(log, "protocol") {
   
   if (!m_p2p) {
@@ -157,6 +175,8 @@ void CryptoNoteProtocolHandler::onConnectionOpened(CryptoNoteConnectionContext&
 }
 
 void CryptoNoteProtocolHandler::onConnectionClosed(CryptoNoteConnectionContext& context) {
+  m_transactionRequests.removePeer(context.m_connection_id);
+
   bool updated = false;
   {
     std::lock_guard<std::mutex> lock(m_observedHeightMutex);
@@ -180,6 +200,7 @@ void CryptoNoteProtocolHandler::onConnectionClosed(CryptoNoteConnectionContext&
 
 void CryptoNoteProtocolHandler::stop() {
   m_stop = true;
+  m_announcementContext.interrupt();
 }
     
 bool CryptoNoteProtocolHandler::start_sync(CryptoNoteConnectionContext& context) {
@@ -209,7 +230,11 @@ void CryptoNoteProtocolHandler::log_connections() {
     << std::setw(20) << "Peer id"
     << std::setw(25) << "Recv/Sent (inactive,sec)"
     << std::setw(25) << "State"
-    << std::setw(20) << "Lifetime(seconds)" << ENDL;
+    << std::setw(20) << "Lifetime(seconds)"
+    << std::setw(12) << "Batch"
+    << std::setw(18) << "Throughput(KB/s)"
+    << std::setw(12) << "RTT(ms)"
+    << std::setw(16) << "Received(MB)" << ENDL;
 
   m_p2p->for_each_connection([&](const CryptoNoteConnectionContext& cntxt, PeerIdType peer_id) {
     ss << std::setw(25) << std::left << std::string(cntxt.m_is_income ? "[INC]" : "[OUT]") +
@@ -217,7 +242,11 @@ void CryptoNoteProtocolHandler::log_connections() {
       << std::setw(20) << std::hex << peer_id
       // << std::setw(25) << std::to_string(cntxt.m_recv_cnt) + "(" + std::to_string(time(NULL) - cntxt.m_last_recv) + ")" + "/" + std::to_string(cntxt.m_send_cnt) + "(" + std::to_string(time(NULL) - cntxt.m_last_send) + ")"
       << std::setw(25) << get_protocol_state_string(cntxt.m_state)
-      << std::setw(20) << std::to_string(time(NULL) - cntxt.m_started) << ENDL;
+      << std::setw(20) << std::to_string(time(NULL) - cntxt.m_started)
+      << std::setw(12) << std::dec << getBlocksRequestCount(cntxt.m_sync_statistics)
+      << std::setw(18) << static_cast<uint64_t>(cntxt.m_sync_statistics.throughput / 1024)
+      << std::setw(12) << static_cast<uint64_t>(cntxt.m_sync_statistics.roundTripTime)
+      << std::setw(16) << cntxt.m_sync_statistics.receivedBytes / (1024 * 1024) << ENDL;
   });
   logger(INFO) << "Connections: " << ENDL << ss.str();
 }
@@ -298,6 +327,8 @@ int CryptoNoteProtocolHandler::handleCommand(bool is_notify, int command, const
     HANDLE_NOTIFY(NOTIFY_REQUEST_CHAIN, handle_request_chain)
     HANDLE_NOTIFY(NOTIFY_RESPONSE_CHAIN_ENTRY, handle_response_chain_entry)
     HANDLE_NOTIFY(NOTIFY_REQUEST_TX_POOL, handleRequestTxPool)
+    HANDLE_NOTIFY(NOTIFY_TRANSACTIONS_INVENTORY, handleTransactionsInventory)
+    HANDLE_NOTIFY(NOTIFY_REQUEST_TRANSACTIONS, handleRequestTransactions)
 
   default:
     handled = false;
@@ -354,20 +385,17 @@ int CryptoNoteProtocolHandler::handle_notify_new_transactions(int command, NOTIF
   if (context.m_state != CryptoNoteConnectionContext::state_normal)
     return 1;
 
-  for (auto tx_blob_it = arg.txs.begin(); tx_blob_it != arg.txs.end();) {
-    if (!m_core.addTransactionToPool(*tx_blob_it)) {
+  for (const auto& transaction : arg.txs) {
+    Crypto::Hash transactionHash = getBinaryArrayHash(transaction);
+    m_transactionRequests.removeTransaction(transactionHash);
+
+    if (!m_core.addTransactionToPool(transaction)) {
       logger(Logging::INFO) << context << "Tx verification failed";
-      tx_blob_it = arg.txs.erase(tx_blob_it);
     } else {
-      ++tx_blob_it;
+      queueTransactionAnnouncement(transactionHash, transaction, context.m_connection_id);
     }
   }
 
-  if (arg.txs.size()) {
-    //TODO: add announce usage here
-    relay_post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, arg, &context.m_connection_id);
-  }
-
   return true;
 }
 
@@ -406,24 +434,34 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
 
   updateObservedHeight(arg.current_blockchain_height, context);
   context.m_remote_blockchain_height = arg.current_blockchain_height;
+  updateSynchronizationStatistics(context, arg);
+
   std::vector<BlockTemplate> blockTemplates;
   std::vector<CachedBlock> cachedBlocks;
+  std::vector<PreparedTransactions> transactions;
   blockTemplates.resize(arg.blocks.size());
   cachedBlocks.reserve(arg.blocks.size());
 
   std::vector<RawBlock> rawBlocks = convertRawBlocksLegacyToRawBlocks(arg.blocks);
+  for (const auto& blockTemplate : blockTemplates) {
+    cachedBlocks.emplace_back(blockTemplate);
+  }
+
+  prepareBlocks(rawBlocks, blockTemplates, cachedBlocks, transactions);
+  if (m_stop) {
+    return 1;
+  }
 
   for (size_t index = 0; index < rawBlocks.size(); ++index) {
-    if (!fromBinaryArray(blockTemplates[index], rawBlocks[index].block)) {
+    if (!transactions[index].blockParsed) {
       logger(Logging::ERROR) << context << "sent wrong block: failed to parse and validate block: \r\n"
         << toHex(rawBlocks[index].block) << "\r\n dropping connection";
       context.m_state = CryptoNoteConnectionContext::state_shutdown;
       return 1;
     }
 
-    cachedBlocks.emplace_back(blockTemplates[index]);
     if (index == 1) {
-      if (m_core.hasBlock(cachedBlocks.back().getBlockHash())) { //TODO
+      if (m_core.hasBlock(cachedBlocks[index].getBlockHash())) { //TODO
         context.m_state = CryptoNoteConnectionContext::state_idle;
         context.m_needed_objects.clear();
         context.m_requested_objects.clear();
@@ -432,18 +470,18 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
       }
     }
 
-    auto req_it = context.m_requested_objects.find(cachedBlocks.back().getBlockHash());
+    auto req_it = context.m_requested_objects.find(cachedBlocks[index].getBlockHash());
     if (req_it == context.m_requested_objects.end()) {
-      logger(Logging::ERROR) << context << "sent wrong NOTIFY_RESPONSE_GET_OBJECTS: block with id=" << Common::podToHex(cachedBlocks.back().getBlockHash())
+      logger(Logging::ERROR) << context << "sent wrong NOTIFY_RESPONSE_GET_OBJECTS: block with id=" << Common::podToHex(cachedBlocks[index].getBlockHash())
         << " wasn't requested, dropping connection";
       context.m_state = CryptoNoteConnectionContext::state_shutdown;
       return 1;
     }
 
-    if (cachedBlocks.back().getBlock().transactionHashes.size() != rawBlocks[index].transactions.size()) {
+    if (cachedBlocks[index].getBlock().transactionHashes.size() != rawBlocks[index].transactions.size()) {
       logger(Logging::ERROR) << context
-        << "sent wrong NOTIFY_RESPONSE_GET_OBJECTS: block with id=" << Common::podToHex(cachedBlocks.back().getBlockHash())
-        << ", transactionHashes.size()=" << cachedBlocks.back().getBlock().transactionHashes.size()
+        << "sent wrong NOTIFY_RESPONSE_GET_OBJECTS: block with id=" << Common::podToHex(cachedBlocks[index].getBlockHash())
+        << ", transactionHashes.size()=" << cachedBlocks[index].getBlock().transactionHashes.size()
         << " mismatch with block_complete_entry.m_txs.size()=" << rawBlocks[index].transactions.size()
         << ", dropping connection";
       context.m_state = CryptoNoteConnectionContext::state_shutdown;
@@ -461,8 +499,13 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
     return 1;
   }
 
+  calculateProofOfWork(cachedBlocks);
+  if (m_stop) {
+    return 1;
+  }
+
   {
-    int result = processObjects(context, std::move(rawBlocks), cachedBlocks);
+    int result = processObjects(context, std::move(rawBlocks), cachedBlocks, std::move(transactions));
     if (result != 0) {
       return result;
     }
@@ -476,14 +519,155 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
   return 1;
 }
 
-int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext& context, std::vector<RawBlock>&& rawBlocks, const std::vector<CachedBlock>& cachedBlocks) {
+void CryptoNoteProtocolHandler::prepareBlocks(const std::vector<RawBlock>& rawBlocks, std::vector<BlockTemplate>& blockTemplates,
+  const std::vector<CachedBlock>& cachedBlocks, std::vector<PreparedTransactions>& transactions) {
+  assert(rawBlocks.size() == blockTemplates.size());
+  assert(rawBlocks.size() == cachedBlocks.size());
+  transactions.resize(rawBlocks.size());
+
+  // Each thread parses every threadCount-th block, computes block hash and hashes of all its transactions.
+  // Lazily computed hashes are cached in CachedBlock and CachedTransaction, so they are not recalculated on dispatcher thread.
+  auto prepare = [&](size_t firstIndex, size_t step) {
+    for (size_t index = firstIndex; index < rawBlocks.size(); index += step) {
+      PreparedTransactions& prepared = transactions[index];
+      prepared.blockParsed = fromBinaryArray(blockTemplates[index], rawBlocks[index].block);
+      prepared.transactionsParsed = false;
+      if (!prepared.blockParsed) {
+        continue;
+      }
+
+      cachedBlocks[index].getBlockHash();
+      if (blockTemplates[index].transactionHashes.size() != rawBlocks[index].transactions.size()) {
+        continue;
+      }
+
+      // oversized transactions are not parsed, core rejects the block when it is added
+      const auto& rawTransactions = rawBlocks[index].transactions;
+      if (std::any_of(rawTransactions.begin(), rawTransactions.end(), [&](const BinaryArray& rawTransaction) {
+            return rawTransaction.size() > m_currency.maxTxSize(); })) {
+        continue;
+      }
+
+      try {
+        prepared.transactions.reserve(rawBlocks[index].transactions.size());
+        for (const auto& rawTransaction : rawBlocks[index].transactions) {
+          prepared.transactions.emplace_back(rawTransaction);
+          prepared.transactions.back().getTransactionHash();
+          prepared.transactions.back().getTransactionPrefixHash();
+        }
+
+        prepared.transactionsParsed = true;
+      } catch (std::exception&) {
+        // core reports deserialization error when block is added
+        prepared.transactions.clear();
+      }
+    }
+  };
+
+  runBlockPreparationWorkers(rawBlocks.size(), prepare);
+}
+
+void CryptoNoteProtocolHandler::calculateProofOfWork(const std::vector<CachedBlock>& cachedBlocks) {
+  // Proof of work doesn't depend on chain state, so long hashes of new blocks above checkpoints are computed here
+  // and cached in CachedBlock, Core only compares them with difficulty.
+  std::vector<size_t> proofOfWorkBlocks;
+  for (size_t index = 0; index < cachedBlocks.size(); ++index) {
+    if (!m_core.isInCheckpointZone(cachedBlocks[index].getBlockIndex()) && !m_core.hasBlock(cachedBlocks[index].getBlockHash())) {
+      proofOfWorkBlocks.push_back(index);
+    }
+  }
+
+  if (proofOfWorkBlocks.empty()) {
+    return;
+  }
+
+  // every thread hashes several of its blocks at once, in scratchpads acquired for this call only,
+  // so calculateProofOfWork may run concurrently for several connections
+  size_t ways = Crypto::cn_slow_hash_get_multi_ways();
+  runBlockPreparationWorkers(proofOfWorkBlocks.size(), [&](size_t firstIndex, size_t step) {
+    std::vector<CryptoContextPool::Context> pooledContexts = m_proofOfWorkContextPool.acquire(ways);
+    std::vector<Crypto::cn_context*> contexts;
+    for (auto& context : pooledContexts) {
+      contexts.push_back(context.get());
+    }
+
+    std::vector<const CachedBlock*> blocks;
+    auto hashBlocks = [&] {
+      try {
+        CachedBlock::calculateBlockLongHashes(blocks.data(), contexts.data(), blocks.size());
+      } catch (std::exception&) {
+        // core reports invalid block when it is added
+      }
+
+      blocks.clear();
+    };
+
+    for (size_t i = firstIndex; i < proofOfWorkBlocks.size(); i += step) {
+      blocks.push_back(&cachedBlocks[proofOfWorkBlocks[i]]);
+      if (blocks.size() == ways) {
+        hashBlocks();
+      }
+    }
+
+    if (!blocks.empty()) {
+      hashBlocks();
+    }
+  });
+}
+
+void CryptoNoteProtocolHandler::runBlockPreparationWorkers(size_t itemCount, const std::function<void(size_t, size_t)>& job) {
+  size_t threadCount = std::min(m_blockPreparationThreadCount, itemCount);
+  if (threadCount == 0) {
+    return;
+  }
+
+  std::atomic<size_t> runningCount(threadCount);
+  System::Event finished(m_dispatcher);
+  for (size_t i = 0; i < threadCount; ++i) {
+    m_blockPreparationPool.spawn(i, [&, i] {
+      try {
+        job(i, threadCount);
+      } catch (std::exception&) {
+        // jobs report errors through their results
+      }
+
+      if (--runningCount == 0) {
+        m_dispatcher.remoteSpawn([&finished] { finished.set(); });
+      }
+    });
+  }
+
+  // workers use the caller's data, so they are waited for even if the caller is interrupted
+  bool interrupted = false;
+  while (!finished.get()) {
+    try {
+      finished.wait();
+    } catch (System::InterruptedException&) {
+      interrupted = true;
+    }
+  }
+
+  if (interrupted) {
+    m_dispatcher.interrupt();
+  }
+}
+
+int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext& context, std::vector<RawBlock>&& rawBlocks, const std::vector<CachedBlock>& cachedBlocks,
+  std::vector<PreparedTransactions>&& transactions) {
   assert(rawBlocks.size() == cachedBlocks.size());
+  assert(rawBlocks.size() == transactions.size());
   for (size_t index = 0; index < rawBlocks.size(); ++index) {
     if (m_stop) {
       break;
     }
 
-    auto addResult = m_core.addBlock(cachedBlocks[index], std::move(rawBlocks[index]));
+    std::error_code addResult;
+    if (transactions[index].transactionsParsed) {
+      addResult = m_core.addBlock(cachedBlocks[index], std::move(transactions[index].transactions), std::move(rawBlocks[index]));
+    } else {
+      addResult = m_core.addBlock(cachedBlocks[index], std::move(rawBlocks[index]));
+    }
+
     if (addResult == error::AddBlockErrorCondition::BLOCK_VALIDATION_FAILED ||
         addResult == error::AddBlockErrorCondition::TRANSACTION_VALIDATION_FAILED ||
         addResult == error::AddBlockErrorCondition::DESERIALIZATION_FAILED) {
@@ -536,9 +720,10 @@ bool CryptoNoteProtocolHandler::request_missing_objects(CryptoNoteConnectionCont
     //we know objects that we need, request this objects
     NOTIFY_REQUEST_GET_OBJECTS::request req;
     size_t count = 0;
+    size_t maxCount = getBlocksRequestCount(context.m_sync_statistics);
     auto it = context.m_needed_objects.begin();
 
-    while (it != context.m_needed_objects.end() && count < BLOCKS_SYNCHRONIZING_DEFAULT_COUNT) {
+    while (it != context.m_needed_objects.end() && count < maxCount) {
       if (!(check_having_blocks && m_core.hasBlock(*it))) {
         req.blocks.push_back(*it);
         ++count;
@@ -547,6 +732,8 @@ bool CryptoNoteProtocolHandler::request_missing_objects(CryptoNoteConnectionCont
       it = context.m_needed_objects.erase(it);
     }
     logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_GET_OBJECTS: blocks.size()=" << req.blocks.size() << ", txs.size()=" << req.txs.size();
+    context.m_sync_statistics.requestedCount = req.blocks.size();
+    context.m_sync_statistics.requestTime = std::chrono::steady_clock::now();
     post_notify<NOTIFY_REQUEST_GET_OBJECTS>(*m_p2p, req, context);
   } else if (context.m_last_response_height < context.m_remote_blockchain_height - 1) {//we have to fetch more objects ids, request blockchain entry
 
@@ -578,6 +765,27 @@ bool CryptoNoteProtocolHandler::request_missing_objects(CryptoNoteConnectionCont
   return true;
 }
 
+void CryptoNoteProtocolHandler::updateSynchronizationStatistics(CryptoNoteConnectionContext& context, const NOTIFY_RESPONSE_GET_OBJECTS::request& response) {
+  BlocksSynchronizationStatistics& statistics = context.m_sync_statistics;
+  if (statistics.requestedCount == 0 || response.blocks.empty()) {
+    return;
+  }
+
+  uint64_t responseSize = 0;
+  for (const auto& block : response.blocks) {
+    responseSize += block.block.size();
+    for (const auto& transaction : block.transactions) {
+      responseSize += transaction.size();
+    }
+  }
+
+  auto roundTripTime = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(std::chrono::steady_clock::now() - statistics.requestTime).count();
+  updateBlocksSynchronizationStatistics(statistics, response.blocks.size(), responseSize, roundTripTime);
+
+  logger(Logging::TRACE) << context << "Blocks downloading statistics: " << response.blocks.size() << " blocks, " << responseSize << " bytes in "
+    << static_cast<uint64_t>(roundTripTime) << " ms, next request size " << getBlocksRequestCount(context.m_sync_statistics) << " blocks";
+}
+
 bool CryptoNoteProtocolHandler::on_connection_synchronized() {
   bool val_expected = false;
   if (m_synchronized.compare_exchange_strong(val_expected, true)) {
@@ -658,6 +866,73 @@ int CryptoNoteProtocolHandler::handleRequestTxPool(int command, NOTIFY_REQUEST_T
   return 1;
 }
 
+int CryptoNoteProtocolHandler::handleTransactionsInventory(int command, NOTIFY_TRANSACTIONS_INVENTORY::request& arg,
+                                                           CryptoNoteConnectionContext& context) {
+  logger(Logging::TRACE) << context << "NOTIFY_TRANSACTIONS_INVENTORY: txs.size() = " << arg.txs.size();
+
+  if (context.m_state != CryptoNoteConnectionContext::state_normal) {
+    return 1;
+  }
+
+  if (arg.txs.size() > MAX_INVENTORY_TRANSACTIONS) {
+    logger(Logging::DEBUGGING) << context << "NOTIFY_TRANSACTIONS_INVENTORY: only first " << MAX_INVENTORY_TRANSACTIONS << " of " << arg.txs.size() << " hashes are processed";
+    arg.txs.resize(MAX_INVENTORY_TRANSACTIONS);
+  }
+
+  std::vector<Crypto::Hash> unknownTransactions;
+  for (const auto& hash : arg.txs) {
+    if (m_transactionRequests.isTracked(hash) || !m_core.hasTransaction(hash)) {
+      unknownTransactions.push_back(hash);
+    }
+  }
+
+  NOTIFY_REQUEST_TRANSACTIONS::request request;
+  request.txs = m_transactionRequests.addAnnouncement(context.m_connection_id, unknownTransactions, std::chrono::steady_clock::now());
+  scheduleTransactionRequestsExpiration();
+
+  if (!request.txs.empty()) {
+    logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_TRANSACTIONS: txs.size() = " << request.txs.size();
+    bool ok = post_notify<NOTIFY_REQUEST_TRANSACTIONS>(*m_p2p, request, context);
+    if (!ok) {
+      logger(Logging::WARNING, Logging::BRIGHT_YELLOW) << "Failed to post notification NOTIFY_REQUEST_TRANSACTIONS to " << context.m_connection_id;
+    }
+  }
+
+  return 1;
+}
+
+int CryptoNoteProtocolHandler::handleRequestTransactions(int command, NOTIFY_REQUEST_TRANSACTIONS::request& arg,
+                                                         CryptoNoteConnectionContext& context) {
+  logger(Logging::TRACE) << context << "NOTIFY_REQUEST_TRANSACTIONS: txs.size() = " << arg.txs.size();
+
+  if (context.m_state != CryptoNoteConnectionContext::state_normal) {
+    return 1;
+  }
+
+  // requests are split into MAX_REQUEST_TRANSACTIONS chunks by the tracker, a larger one doesn't come from a node that follows protocol
+  if (arg.txs.size() > TransactionRequestTracker::MAX_REQUEST_TRANSACTIONS) {
+    logger(Logging::DEBUGGING) << context << "NOTIFY_REQUEST_TRANSACTIONS: " << arg.txs.size() << " hashes requested, more than "
+                               << TransactionRequestTracker::MAX_REQUEST_TRANSACTIONS << ", dropping connection";
+    context.m_state = CryptoNoteConnectionContext::state_shutdown;
+    return 1;
+  }
+
+  NOTIFY_NEW_TRANSACTIONS::request notification;
+  std::vector<Crypto::Hash> missedTransactions;
+  m_core.getPoolTransactions(arg.txs, notification.txs, missedTransactions);
+  if (!missedTransactions.empty()) {
+    logger(Logging::DEBUGGING) << context << "NOTIFY_REQUEST_TRANSACTIONS: " << missedTransactions.size() << " transactions are not in pool";
+  }
+
+  if (!notification.txs.empty()) {
+    bool ok = post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, notification, context);
+    if (!ok) {
+      logger(Logging::WARNING, Logging::BRIGHT_YELLOW) << "Failed to post notification NOTIFY_NEW_TRANSACTIONS to " << context.m_connection_id;
+    }
+  }
+
+  return 1;
+}
 
 void CryptoNoteProtocolHandler::relayBlock(NOTIFY_NEW_BLOCK::request& arg) {
   auto buf = LevinProtocol::encode(arg);
@@ -665,8 +940,116 @@ void CryptoNoteProtocolHandler::relayBlock(NOTIFY_NEW_BLOCK::request& arg) {
 }
 
 void CryptoNoteProtocolHandler::relayTransactions(const std::vector<BinaryArray>& transactions) {
-  auto buf = LevinProtocol::encode(NOTIFY_NEW_TRANSACTIONS::request{transactions});
-  m_p2p->externalRelayNotifyToAll(NOTIFY_NEW_TRANSACTIONS::ID, buf);
+  // can be called from external threads, so the announcement queue is touched in dispatcher context only
+  m_dispatcher.remoteSpawn([this, transactions] {
+    for (const auto& transaction : transactions) {
+      queueTransactionAnnouncement(getBinaryArrayHash(transaction), transaction, boost::value_initialized<net_connection_id>());
+    }
+  });
+}
+
+void CryptoNoteProtocolHandler::queueTransactionAnnouncement(const Crypto::Hash& transactionHash, const BinaryArray& transaction, const net_connection_id& source) {
+  if (m_stop) {
+    return;
+  }
+
+  m_pendingTransactions.emplace_back(PendingTransaction{transactionHash, transaction, source});
+  if (m_announcementScheduled) {
+    return;
+  }
+
+  m_announcementScheduled = true;
+  m_announcementContext.spawn([this] {
+    try {
+      System::Timer(m_dispatcher).sleep(TRANSACTIONS_ANNOUNCEMENT_INTERVAL);
+    } catch (System::InterruptedException&) {
+      m_announcementScheduled = false;
+      return;
+    }
+
+    m_announcementScheduled = false;
+    announceTransactions();
+  });
+}
+
+void CryptoNoteProtocolHandler::scheduleTransactionRequestsExpiration() {
+  if (m_stop || m_requestsExpirationScheduled || m_transactionRequests.size() == 0) {
+    return;
+  }
+
+  m_requestsExpirationScheduled = true;
+  m_announcementContext.spawn([this] {
+    try {
+      while (m_transactionRequests.size() != 0) {
+        System::Timer(m_dispatcher).sleep(TRANSACTION_REQUESTS_EXPIRATION_INTERVAL);
+        retryTransactionRequests(m_transactionRequests.expireRequests(std::chrono::steady_clock::now()));
+      }
+    } catch (System::InterruptedException&) {
+    }
+
+    m_requestsExpirationScheduled = false;
+  });
+}
+
+void CryptoNoteProtocolHandler::retryTransactionRequests(const std::map<net_connection_id, std::vector<Crypto::Hash>>& retries) {
+  if (retries.empty()) {
+    return;
+  }
+
+  m_p2p->for_each_connection([&](CryptoNoteConnectionContext& context, PeerIdType peerId) {
+    auto it = retries.find(context.m_connection_id);
+    if (it == retries.end()) {
+      return;
+    }
+
+    for (size_t offset = 0; offset < it->second.size(); offset += TransactionRequestTracker::MAX_REQUEST_TRANSACTIONS) {
+      auto end = std::min(offset + TransactionRequestTracker::MAX_REQUEST_TRANSACTIONS, it->second.size());
+
+      NOTIFY_REQUEST_TRANSACTIONS::request request;
+      request.txs.assign(it->second.begin() + offset, it->second.begin() + end);
+      logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_TRANSACTIONS (retry): txs.size() = " << request.txs.size();
+      if (!post_notify<NOTIFY_REQUEST_TRANSACTIONS>(*m_p2p, request, context)) {
+        logger(Logging::WARNING, Logging::BRIGHT_YELLOW) << "Failed to post notification NOTIFY_REQUEST_TRANSACTIONS to " << context.m_connection_id;
+      }
+    }
+  });
+}
+
+void CryptoNoteProtocolHandler::announceTransactions() {
+  std::vector<PendingTransaction> pendingTransactions = std::move(m_pendingTransactions);
+  m_pendingTransactions.clear();
+
+  m_p2p->for_each_connection([&](CryptoNoteConnectionContext& context, PeerIdType peerId) {
+    if (peerId == 0 || (context.m_state != CryptoNoteConnectionContext::state_normal &&
+                        context.m_state != CryptoNoteConnectionContext::state_synchronizing)) {
+      return;
+    }
+
+    if (context.version >= P2PProtocolVersion::V2) {
+      NOTIFY_TRANSACTIONS_INVENTORY::request inventory;
+      for (const auto& pending : pendingTransactions) {
+        if (pending.source != context.m_connection_id) {
+          inventory.txs.push_back(pending.hash);
+        }
+      }
+
+      if (!inventory.txs.empty()) {
+        post_notify<NOTIFY_TRANSACTIONS_INVENTORY>(*m_p2p, inventory, context);
+      }
+    } else {
+      // legacy peers don't understand inventory, so they still receive full transactions
+      NOTIFY_NEW_TRANSACTIONS::request notification;
+      for (const auto& pending : pendingTransactions) {
+        if (pending.source != context.m_connection_id) {
+          notification.txs.push_back(pending.transaction);
+        }
+      }
+
+      if (!notification.txs.empty()) {
+        post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, notification, context);
+      }
+    }
+  });
 }
 
 void CryptoNoteProtocolHandler::requestMissingPoolTransactions(const CryptoNoteConnectionContext& context) {
@@ -18,15 +18,22 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <functional>
+#include <unordered_map>
 
 #include <Common/ObserverManager.h>
+#include <System/ContextGroup.h>
+#include <System/DispatcherPool.h>
 
+#include "CryptoNoteCore/CryptoContextPool.h"
 #include "CryptoNoteCore/ICore.h"
 
 #include "CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h"
 #include "CryptoNoteProtocol/CryptoNoteProtocolHandlerCommon.h"
 #include "CryptoNoteProtocol/ICryptoNoteProtocolObserver.h"
 #include "CryptoNoteProtocol/ICryptoNoteProtocolQuery.h"
+#include "CryptoNoteProtocol/TransactionRequestTracker.h"
 
 #include "P2p/P2pProtocolDefinitions.h"
 #include "P2p/NetNodeCommon.h"
@@ -70,6 +77,13 @@ namespace CryptoNote
     void requestMissingPoolTransactions(const CryptoNoteConnectionContext& context);
 
   private:
+    // Transactions of a received block, deserialized and hashed outside of dispatcher thread
+    struct PreparedTransactions {
+      bool blockParsed;
+      bool transactionsParsed;
+      std::vector<CachedTransaction> transactions;
+    };
+
     //----------------- commands handlers ----------------------------------------------
     int handle_notify_new_block(int command, NOTIFY_NEW_BLOCK::request& arg, CryptoNoteConnectionContext& context);
     int handle_notify_new_transactions(int command, NOTIFY_NEW_TRANSACTIONS::request& arg, CryptoNoteConnectionContext& context);
@@ -78,6 +92,8 @@ namespace CryptoNote
     int handle_request_chain(int command, NOTIFY_REQUEST_CHAIN::request& arg, CryptoNoteConnectionContext& context);
     int handle_response_chain_entry(int command, NOTIFY_RESPONSE_CHAIN_ENTRY::request& arg, CryptoNoteConnectionContext& context);
     int handleRequestTxPool(int command, NOTIFY_REQUEST_TX_POOL::request& arg, CryptoNoteConnectionContext& context);
+    int handleTransactionsInventory(int command, NOTIFY_TRANSACTIONS_INVENTORY::request& arg, CryptoNoteConnectionContext& context);
+    int handleRequestTransactions(int command, NOTIFY_REQUEST_TRANSACTIONS::request& arg, CryptoNoteConnectionContext& context);
 
     //----------------- i_cryptonote_protocol ----------------------------------
     virtual void relayBlock(NOTIFY_NEW_BLOCK::request& arg) override;
@@ -86,13 +102,30 @@ namespace CryptoNote
     //----------------------------------------------------------------------------------
     uint32_t get_current_blockchain_height();
     bool request_missing_objects(CryptoNoteConnectionContext& context, bool check_having_blocks);
+    void updateSynchronizationStatistics(CryptoNoteConnectionContext& context, const NOTIFY_RESPONSE_GET_OBJECTS::request& response);
     bool on_connection_synchronized();
     void updateObservedHeight(uint32_t peerHeight, const CryptoNoteConnectionContext& context);
     void recalculateMaxObservedHeight(const CryptoNoteConnectionContext& context);
-    int processObjects(CryptoNoteConnectionContext& context, std::vector<RawBlock>&& rawBlocks, const std::vector<CachedBlock>& cachedBlocks);
+    int processObjects(CryptoNoteConnectionContext& context, std::vector<RawBlock>&& rawBlocks, const std::vector<CachedBlock>& cachedBlocks,
+      std::vector<PreparedTransactions>&& transactions);
+    void prepareBlocks(const std::vector<RawBlock>& rawBlocks, std::vector<BlockTemplate>& blockTemplates, const std::vector<CachedBlock>& cachedBlocks,
+      std::vector<PreparedTransactions>& transactions);
+    // blocks must be parsed and requested, only those core doesn't have are hashed
+    void calculateProofOfWork(const std::vector<CachedBlock>& cachedBlocks);
+    // runs job(firstIndex, step) on up to m_blockPreparationThreadCount pool threads, each processes every step-th item
+    void runBlockPreparationWorkers(size_t itemCount, const std::function<void(size_t, size_t)>& job);
+    void queueTransactionAnnouncement(const Crypto::Hash& transactionHash, const BinaryArray& transaction, const net_connection_id& source);
+    void announceTransactions();
+    void scheduleTransactionRequestsExpiration();
+    void retryTransactionRequests(const std::map<net_connection_id, std::vector<Crypto::Hash>>& retries);
     Logging::LoggerRef logger;
 
   private:
+    struct PendingTransaction {
+      Crypto::Hash hash;
+      BinaryArray transaction;
+      net_connection_id source;
+    };
 
     System::Dispatcher& m_dispatcher;
     ICore& m_core;
@@ -108,5 +141,17 @@ namespace CryptoNote
 
     std::atomic<size_t> m_peersCount;
     Tools::ObserverManager<ICryptoNoteProtocolObserver> m_observerManager;
+
+    // transactions waiting for the next batched announcement, accessed from dispatcher thread only
+    std::vector<PendingTransaction> m_pendingTransactions;
+    TransactionRequestTracker m_transactionRequests;
+    bool m_announcementScheduled;
+    bool m_requestsExpirationScheduled;
+    System::ContextGroup m_announcementContext;
+
+    size_t m_blockPreparationThreadCount;
+    System::DispatcherPool m_blockPreparationPool;
+    // scratchpads for proof of work checks, reused by preparation threads
+    CryptoContextPool m_proofOfWorkContextPool;
   };
 }
@@ -0,0 +1,103 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "TransactionRequestTracker.h"
+
+#include <algorithm>
+
+namespace CryptoNote {
+
+const size_t TransactionRequestTracker::MAX_TRACKED_TRANSACTIONS;
+const size_t TransactionRequestTracker::MAX_REQUEST_TRANSACTIONS;
+const size_t TransactionRequestTracker::MAX_ANNOUNCERS;
+
+TransactionRequestTracker::TransactionRequestTracker(Duration requestTimeout) : requestTimeout(requestTimeout) {
+}
+
+std::vector<Crypto::Hash> TransactionRequestTracker::addAnnouncement(const net_connection_id& peer, const std::vector<Crypto::Hash>& transactionHashes,
+                                                                     TimePoint now) {
+  std::vector<Crypto::Hash> newRequests;
+  for (const auto& hash : transactionHashes) {
+    auto it = requests.find(hash);
+    if (it != requests.end()) {
+      auto& request = it->second;
+      if (request.peer != peer && request.announcers.size() < MAX_ANNOUNCERS &&
+          std::find(request.announcers.begin(), request.announcers.end(), peer) == request.announcers.end()) {
+        request.announcers.push_back(peer);
+      }
+
+      continue;
+    }
+
+    if (newRequests.size() == MAX_REQUEST_TRANSACTIONS || requests.size() == MAX_TRACKED_TRANSACTIONS) {
+      continue;
+    }
+
+    requests.emplace(hash, Request{peer, now, {}});
+    newRequests.push_back(hash);
+  }
+
+  return newRequests;
+}
+
+void TransactionRequestTracker::removeTransaction(const Crypto::Hash& transactionHash) {
+  requests.erase(transactionHash);
+}
+
+void TransactionRequestTracker::removePeer(const net_connection_id& peer) {
+  for (auto& pair : requests) {
+    auto& request = pair.second;
+    request.announcers.erase(std::remove(request.announcers.begin(), request.announcers.end(), peer), request.announcers.end());
+    if (request.peer == peer) {
+      request.time = TimePoint();
+    }
+  }
+}
+
+std::map<net_connection_id, std::vector<Crypto::Hash>> TransactionRequestTracker::expireRequests(TimePoint now) {
+  std::map<net_connection_id, std::vector<Crypto::Hash>> retries;
+  for (auto it = requests.begin(); it != requests.end();) {
+    auto& request = it->second;
+    if (now - request.time <= requestTimeout) {
+      ++it;
+      continue;
+    }
+
+    if (request.announcers.empty()) {
+      it = requests.erase(it);
+      continue;
+    }
+
+    request.peer = request.announcers.front();
+    request.announcers.pop_front();
+    request.time = now;
+    retries[request.peer].push_back(it->first);
+    ++it;
+  }
+
+  return retries;
+}
+
+bool TransactionRequestTracker::isTracked(const Crypto::Hash& transactionHash) const {
+  return requests.count(transactionHash) != 0;
+}
+
+size_t TransactionRequestTracker::size() const {
+  return requests.size();
+}
+
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "crypto/hash.h"
+#include "P2p/P2pProtocolTypes.h"
+
+namespace CryptoNote {
+
+// Transactions requested from peers after their inventory announcements. A transaction is requested
+// from one announcer at a time, other announcers are remembered and asked in turn when the request times out.
+class TransactionRequestTracker {
+public:
+  typedef std::chrono::steady_clock::time_point TimePoint;
+  typedef std::chrono::steady_clock::duration Duration;
+
+  static const size_t MAX_TRACKED_TRANSACTIONS = 50000;
+  static const size_t MAX_REQUEST_TRANSACTIONS = 1000;
+  static const size_t MAX_ANNOUNCERS = 8;
+
+  explicit TransactionRequestTracker(Duration requestTimeout);
+
+  // returns transactions to request from the peer now, at most MAX_REQUEST_TRANSACTIONS of them
+  std::vector<Crypto::Hash> addAnnouncement(const net_connection_id& peer, const std::vector<Crypto::Hash>& transactionHashes, TimePoint now);
+  void removeTransaction(const Crypto::Hash& transactionHash);
+  // requests to the peer are retried from other announcers on the next expiration
+  void removePeer(const net_connection_id& peer);
+  // moves timed out requests to the next announcers and returns them grouped by peer, drops transactions without announcers left
+  std::map<net_connection_id, std::vector<Crypto::Hash>> expireRequests(TimePoint now);
+
+  bool isTracked(const Crypto::Hash& transactionHash) const;
+  size_t size() const;
+
+private:
+  struct Request {
+    net_connection_id peer;
+    TimePoint time;
+    std::deque<net_connection_id> announcers;
+  };
+
+  const Duration requestTimeout;
+  std::unordered_map<Crypto::Hash, Request> requests;
+};
+
+}
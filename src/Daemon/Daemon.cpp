@@ -16,6 +16,7 @@
 // along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <fstream>
+#include <thread>
 
 #include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
@@ -29,6 +30,7 @@
 #include "Common/PathTools.h"
 #include "Common/Util.h"
 #include "crypto/hash.h"
+#include "CryptoNoteCore/BlockchainSnapshot.h"
 #include "CryptoNoteCore/Core.h"
 #include "CryptoNoteCore/Currency.h"
 #include "CryptoNoteCore/DatabaseBlockchainCache.h"
@@ -66,6 +68,10 @@ namespace
   const command_line::arg_descriptor<bool>        arg_console     = {"no-console", "Disable daemon console commands"};
   const command_line::arg_descriptor<bool>        arg_testnet_on  = {"testnet", "Used to deploy test nets. Checkpoints and hardcoded seeds are ignored, "
     "network id is changed. Use it with --data-dir flag. The wallet must be launched with --testnet flag.", false};
+  const command_line::arg_descriptor<std::string> arg_export_snapshot = {"export-snapshot", "Export blockchain snapshot into a new directory and exit", ""};
+  const command_line::arg_descriptor<std::string> arg_import_snapshot = {"import-snapshot", "Verify blockchain snapshot from a directory and "
+    "start from it. Blocks and the database entries they refer to are verified, other database entries are trusted to the snapshot source. "
+    "Data directory must not contain blockchain yet", ""};
 }
 
 bool command_line_preprocessor(const boost::program_options::variables_map& vm, LoggerRef& logger);
@@ -109,6 +115,8 @@ int main(int argc, char* argv[])
     // tools::get_default_data_dir() can't be called during static initialization
     command_line::add_arg(desc_cmd_only, command_line::arg_data_dir, Tools::getDefaultDataDirectory());
     command_line::add_arg(desc_cmd_only, arg_config_file);
+    command_line::add_arg(desc_cmd_only, arg_export_snapshot);
+    command_line::add_arg(desc_cmd_only, arg_import_snapshot);
 
     command_line::add_arg(desc_cmd_sett, arg_log_file);
     command_line::add_arg(desc_cmd_sett, arg_log_level);
@@ -216,6 +224,11 @@ int main(int argc, char* argv[])
       }
     }
 
+    std::string importSnapshotDir = command_line::get_arg(vm, arg_import_snapshot);
+    if (!importSnapshotDir.empty()) {
+      BlockchainSnapshot(currency, logManager).importFrom(importSnapshotDir, data_dir_path.string(), dbConfig, checkpoints);
+    }
+
     RocksDBWrapper database(logManager);
     database.init(dbConfig);
     Tools::ScopeExit dbShutdownOnExit([&database] () { database.shutdown(); });
@@ -233,20 +246,33 @@ int main(int argc, char* argv[])
 
     System::Dispatcher dispatcher;
     logger(INFO) << "Initializing core...";
+    std::unique_ptr<IMainChainStorage> mainChainStorage = createSwappedMainChainStorage(data_dir_path.string(), currency);
+    const IMainChainStorage& mainChainStorageRef = *mainChainStorage;
     CryptoNote::Core ccore(
       currency,
       logManager,
       std::move(checkpoints),
       dispatcher,
-      std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(database, logger.getLogger())),
-      createSwappedMainChainStorage(data_dir_path.string(), currency));
+      std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(database, logger.getLogger(), dbConfig.getTipCacheBlockCount())),
+      std::move(mainChainStorage));
 
     ccore.load();
     logger(INFO) << "Core initialized OK";
 
+    // database and main chain storage are at the same top block after load and nothing writes to them before p2p starts
+    std::string exportSnapshotDir = command_line::get_arg(vm, arg_export_snapshot);
+    if (!exportSnapshotDir.empty()) {
+      BlockchainSnapshot(currency, logManager).exportTo(exportSnapshotDir, database, mainChainStorageRef);
+      return 0;
+    }
+
     CryptoNote::CryptoNoteProtocolHandler cprotocol(currency, dispatcher, ccore, nullptr, logManager);
     CryptoNote::NodeServer p2psrv(dispatcher, cprotocol, logManager);
     CryptoNote::RpcServer rpcServer(dispatcher, logManager, ccore, p2psrv, cprotocol);
+    if (rpcConfig.enableViewKeyScanning) {
+      logger(WARNING) << "View key scanning is enabled, any RPC client can register view keys and get transactions of all registered accounts";
+      rpcServer.enableViewKeyScanning(std::thread::hardware_concurrency());
+    }
 
     cprotocol.set_p2p_endpoint(&p2psrv);
     DaemonCommandsHandler dch(ccore, p2psrv, logManager);
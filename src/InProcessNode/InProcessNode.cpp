@@ -776,18 +776,36 @@ std::error_code InProcessNode::doGetBlocks(const std::vector<uint32_t>& blockInd
       if (index > topIndex) {
         return make_error_code(CryptoNote::error::REQUEST_ERROR);
       }
-      Crypto::Hash hash = core.getBlockHashByIndex(index);
-      BlockDetails blockDetails = core.getBlockDetails(hash);
-      std::vector<BlockDetails> blocksOnSameIndex;
-      blocksOnSameIndex.push_back(std::move(blockDetails));
-
-      // Getting alternative blocks
-      std::vector<Crypto::Hash> alternativeBlocks = core.getAlternativeBlockHashesByIndex(index);
-      for (const auto& alternativeBlockHash : alternativeBlocks) {
-        BlockDetails alternativeBlockDetails = core.getBlockDetails(alternativeBlockHash);
-        blocksOnSameIndex.push_back(std::move(alternativeBlockDetails));
+    }
+
+    // Consecutive indexes are fetched as one range
+    size_t runStart = 0;
+    while (runStart < blockIndexes.size()) {
+      size_t runEnd = runStart + 1;
+      while (runEnd < blockIndexes.size() && blockIndexes[runEnd] == blockIndexes[runEnd - 1] + 1) {
+        ++runEnd;
+      }
+
+      std::vector<BlockDetails> mainChainBlocks =
+        core.getBlocksDetails(blockIndexes[runStart], static_cast<uint32_t>(runEnd - runStart));
+      if (mainChainBlocks.size() != runEnd - runStart) {
+        return make_error_code(CryptoNote::error::INTERNAL_NODE_ERROR);
+      }
+
+      for (size_t i = runStart; i < runEnd; ++i) {
+        std::vector<BlockDetails> blocksOnSameIndex;
+        blocksOnSameIndex.push_back(std::move(mainChainBlocks[i - runStart]));
+
+        // Getting alternative blocks
+        std::vector<Crypto::Hash> alternativeBlocks = core.getAlternativeBlockHashesByIndex(blockIndexes[i]);
+        for (const auto& alternativeBlockHash : alternativeBlocks) {
+          BlockDetails alternativeBlockDetails = core.getBlockDetails(alternativeBlockHash);
+          blocksOnSameIndex.push_back(std::move(alternativeBlockDetails));
+        }
+        blocks.push_back(std::move(blocksOnSameIndex));
       }
-      blocks.push_back(std::move(blocksOnSameIndex));
+
+      runStart = runEnd;
     }
   } catch (std::system_error& e) {
     return e.code();
@@ -20,7 +20,7 @@
 #include <functional>
 
 #include "crypto/crypto.h"
-#include "CryptoNoteCore/CachedBlock.h"
+#include "CryptoNoteCore/BlockMiningHasher.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
 
 #include <System/InterruptedException.h>
@@ -99,25 +99,37 @@ void Miner::runWorkers(BlockMiningParameters blockMiningParameters, size_t threa
 
 void Miner::workerFunc(const BlockTemplate& blockTemplate, Difficulty difficulty, uint32_t nonceStep) {
   try {
-    BlockTemplate block = blockTemplate;
-    Crypto::cn_context cryptoContext;
+    BlockMiningHasher hasher;
+    hasher.setBlock(blockTemplate);
+    m_logger(Logging::DEBUGGING) << "Worker scratchpads are backed by " << Crypto::cn_pages_name(hasher.getPages());
+
+    const size_t ways = hasher.getWays();
+    std::vector<uint32_t> nonces(ways);
+    std::vector<Crypto::Hash> hashes(ways);
+    for (size_t i = 0; i < ways; ++i) {
+      nonces[i] = blockTemplate.nonce + static_cast<uint32_t>(i) * nonceStep;
+    }
 
     while (m_state == MiningState::MINING_IN_PROGRESS) {
-      CachedBlock cachedBlock(block);
-      Crypto::Hash hash = cachedBlock.getBlockLongHash(cryptoContext);
-      if (check_hash(hash, difficulty)) {
-        m_logger(Logging::INFO) << "Found block for difficulty " << difficulty;
-
-        if (!setStateBlockFound()) {
-          m_logger(Logging::DEBUGGING) << "block is already found or mining stopped";
+      hasher.hash(nonces.data(), hashes.data());
+      for (size_t i = 0; i < ways; ++i) {
+        if (check_hash(hashes[i], difficulty)) {
+          m_logger(Logging::INFO) << "Found block for difficulty " << difficulty;
+
+          if (!setStateBlockFound()) {
+            m_logger(Logging::DEBUGGING) << "block is already found or mining stopped";
+            return;
+          }
+
+          m_block = blockTemplate;
+          m_block.nonce = nonces[i];
           return;
         }
-
-        m_block = block;
-        return;
       }
 
-      block.nonce += nonceStep;
+      for (auto& nonce : nonces) {
+        nonce += static_cast<uint32_t>(ways) * nonceStep;
+      }
     }
   } catch (std::exception& e) {
     m_logger(Logging::ERROR) << "Miner got error: " << e.what();
@@ -27,7 +27,6 @@
 #include <System/ContextGroup.h>
 #include <System/Dispatcher.h>
 #include <System/Event.h>
-#include <System/EventLock.h>
 #include <System/Timer.h>
 #include <CryptoNoteCore/TransactionApi.h>
 
@@ -51,6 +50,8 @@ namespace CryptoNote {
 
 namespace {
 
+const size_t HTTP_CONNECTIONS_COUNT = 4;
+
 std::error_code interpretResponseStatus(const std::string& status) {
   if (CORE_RPC_STATUS_BUSY == status) {
     return make_error_code(error::NODE_BUSY);
@@ -66,6 +67,7 @@ NodeRpcProxy::NodeRpcProxy(const std::string& nodeHost, unsigned short nodePort,
     m_logger(logger, "NodeRpcProxy"),
     m_rpcTimeout(10000),
     m_pullInterval(5000),
+    m_changesWaitTimeout(30000),
     m_nodeHost(nodeHost),
     m_nodePort(nodePort),
     m_connected(true) {
@@ -117,8 +119,8 @@ bool NodeRpcProxy::shutdown() {
 
   if (m_state == STATE_NOT_INITIALIZED) {
     return true;
-  } else if (m_state == STATE_INITIALIZING) {
-    m_cv_initialized.wait(lock, [this] { return m_state != STATE_INITIALIZING; });
+  } else if (m_state == STATE_INITIALIZING || m_state == STATE_SHUTTING_DOWN) {
+    m_cv_initialized.wait(lock, [this] { return m_state == STATE_INITIALIZED || m_state == STATE_NOT_INITIALIZED; });
     if (m_state == STATE_NOT_INITIALIZED) {
       return true;
     }
@@ -129,14 +131,21 @@ bool NodeRpcProxy::shutdown() {
 
   m_dispatcher->remoteSpawn([this]() {
     m_stop = true;
+    m_statusContextGroup->interrupt();
     // Run all spawned contexts
     m_dispatcher->yield();
   });
 
+  // status updates lock m_mutex on the worker thread, so it is released until the thread finishes
+  m_state = STATE_SHUTTING_DOWN;
+  lock.unlock();
   if (m_workerThread.joinable()) {
     m_workerThread.join();
   }
+
+  lock.lock();
   m_state = STATE_NOT_INITIALIZED;
+  m_cv_initialized.notify_all();
 
   return true;
 }
@@ -145,13 +154,15 @@ void NodeRpcProxy::workerThread(const INode::Callback& initialized_callback) {
   try {
     Dispatcher dispatcher;
     m_dispatcher = &dispatcher;
+    // declared before context groups, so requests are finished before their clients are destroyed
+    HttpClientPool httpClientPool(dispatcher, m_nodeHost, m_nodePort, HTTP_CONNECTIONS_COUNT);
+    m_httpClientPool = &httpClientPool;
     ContextGroup contextGroup(dispatcher);
     m_context_group = &contextGroup;
-    HttpClient httpClient(dispatcher, m_nodeHost, m_nodePort);
-    m_httpClient = &httpClient;
-    Event httpEvent(dispatcher);
-    m_httpEvent = &httpEvent;
-    m_httpEvent->set();
+    HttpClient notificationClient(dispatcher, m_nodeHost, m_nodePort);
+    m_notificationClient = &notificationClient;
+    ContextGroup statusContextGroup(dispatcher);
+    m_statusContextGroup = &statusContextGroup;
 
     {
       std::lock_guard<std::mutex> lock(m_mutex);
@@ -162,16 +173,24 @@ void NodeRpcProxy::workerThread(const INode::Callback& initialized_callback) {
 
     initialized_callback(std::error_code());
 
-    contextGroup.spawn([this]() {
+    statusContextGroup.spawn([this]() {
       Timer pullTimer(*m_dispatcher);
+      COMMAND_RPC_WAIT_FOR_CHANGES::response changes = AUTO_VAL_INIT(changes);
+      bool polled = false;
       while (!m_stop) {
-        updateNodeStatus();
-        if (!m_stop) {
+        bool updated = updateNodeStatus();
+        // node answers a long poll at once while local state differs from its own, so long poll only after
+        // a refresh that succeeded and caught up with the state reported by the previous long poll
+        bool caughtUp = updated && (!polled || isNodeStateKnown(changes.topBlockId, changes.poolDigest));
+        polled = !m_stop && caughtUp && waitForNodeChanges(changes);
+        // falls back to polling if node doesn't support long poll or is unreachable
+        if (!m_stop && !polled) {
           pullTimer.sleep(std::chrono::milliseconds(m_pullInterval));
         }
       }
     });
 
+    statusContextGroup.wait();
     contextGroup.wait();
     // Make sure all remote spawns are executed
     m_dispatcher->yield();
@@ -180,35 +199,79 @@ void NodeRpcProxy::workerThread(const INode::Callback& initialized_callback) {
 
   m_dispatcher = nullptr;
   m_context_group = nullptr;
-  m_httpClient = nullptr;
-  m_httpEvent = nullptr;
+  m_httpClientPool = nullptr;
+  m_notificationClient = nullptr;
+  m_statusContextGroup = nullptr;
   m_connected = false;
   m_rpcProxyObserverManager.notify(&INodeRpcProxyObserver::connectionStatusUpdated, m_connected);
 }
 
-void NodeRpcProxy::updateNodeStatus() {
-  bool updateBlockchain = true;
-  while (updateBlockchain) {
-    updateBlockchainStatus();
-    updateBlockchain = !updatePoolStatus();
+bool NodeRpcProxy::updateNodeStatus() {
+  for (;;) {
+    if (!updateBlockchainStatus()) {
+      return false;
+    }
+
+    bool isBcActual = false;
+    if (updatePoolStatus(isBcActual)) {
+      return false;
+    }
+
+    if (isBcActual) {
+      return true;
+    }
+  }
+}
+
+bool NodeRpcProxy::waitForNodeChanges(COMMAND_RPC_WAIT_FOR_CHANGES::response& changes) {
+  CryptoNote::COMMAND_RPC_WAIT_FOR_CHANGES::request req = AUTO_VAL_INIT(req);
+  CryptoNote::COMMAND_RPC_WAIT_FOR_CHANGES::response rsp = AUTO_VAL_INIT(rsp);
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    req.knownBlockId = lastLocalBlockHeaderInfo.hash;
+  }
+
+  req.knownPoolDigest = getTransactionsSetDigest(m_knownTxs.begin(), m_knownTxs.end());
+  req.timeout = static_cast<uint32_t>(m_changesWaitTimeout);
+
+  try {
+    m_logger(TRACE) << "Send /wait_for_changes.bin request";
+    invokeBinaryCommand(*m_notificationClient, "/wait_for_changes.bin", req, rsp);
+  } catch (const std::exception& e) {
+    m_logger(TRACE) << "/wait_for_changes.bin request failed: " << e.what();
+    return false;
+  }
+
+  if (interpretResponseStatus(rsp.status)) {
+    return false;
+  }
+
+  changes = std::move(rsp);
+  return true;
+}
+
+bool NodeRpcProxy::isNodeStateKnown(const Crypto::Hash& topBlockId, const Crypto::Hash& poolDigest) const {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (lastLocalBlockHeaderInfo.hash != topBlockId) {
+      return false;
+    }
   }
+
+  return getTransactionsSetDigest(m_knownTxs.begin(), m_knownTxs.end()) == poolDigest;
 }
 
-bool NodeRpcProxy::updatePoolStatus() {
+std::error_code NodeRpcProxy::updatePoolStatus(bool& isBcActual) {
   std::vector<Crypto::Hash> knownTxs = getKnownTxsVector();
   Crypto::Hash tailBlock = lastLocalBlockHeaderInfo.hash;
 
-  bool isBcActual = false;
   std::vector<std::unique_ptr<ITransactionReader>> addedTxs;
   std::vector<Crypto::Hash> deletedTxsIds;
 
   std::error_code ec = doGetPoolSymmetricDifference(std::move(knownTxs), tailBlock, isBcActual, addedTxs, deletedTxsIds);
-  if (ec) {
-    return true;
-  }
-
-  if (!isBcActual) {
-    return false;
+  if (ec || !isBcActual) {
+    return ec;
   }
 
   if (!addedTxs.empty() || !deletedTxsIds.empty()) {
@@ -216,20 +279,21 @@ bool NodeRpcProxy::updatePoolStatus() {
     m_observerManager.notify(&INodeObserver::poolChanged);
   }
 
-  return true;
+  return ec;
 }
 
-void NodeRpcProxy::updateBlockchainStatus() {
+bool NodeRpcProxy::updateBlockchainStatus() {
   CryptoNote::COMMAND_RPC_GET_LAST_BLOCK_HEADER::request req = AUTO_VAL_INIT(req);
   CryptoNote::COMMAND_RPC_GET_LAST_BLOCK_HEADER::response rsp = AUTO_VAL_INIT(rsp);
 
   std::error_code ec = jsonRpcCommand("getlastblockheader", req, rsp);
+  bool updated = !ec;
 
   if (!ec) {
     Crypto::Hash blockHash;
     Crypto::Hash prevBlockHash;
     if (!parse_hash256(rsp.block_header.hash, blockHash) || !parse_hash256(rsp.block_header.prev_hash, prevBlockHash)) {
-      return;
+      return false;
     }
 
     std::unique_lock<std::mutex> lock(m_mutex);
@@ -269,10 +333,12 @@ void NodeRpcProxy::updateBlockchainStatus() {
     updatePeerCount(getInfoResp.incoming_connections_count + getInfoResp.outgoing_connections_count);
   }
 
-  if (m_connected != m_httpClient->isConnected()) {
-    m_connected = m_httpClient->isConnected();
+  if (m_connected != m_httpClientPool->isConnected()) {
+    m_connected = m_httpClientPool->isConnected();
     m_rpcProxyObserverManager.notify(&INodeRpcProxyObserver::connectionStatusUpdated, m_connected);
   }
+
+  return updated;
 }
 
 void NodeRpcProxy::updatePeerCount(size_t peerCount) {
@@ -373,7 +439,7 @@ std::error_code NodeRpcProxy::doGetBlockHashesByTimestamps(uint64_t timestampBeg
   req.timestampBegin = timestampBegin;
   req.secondsCount = secondsCount;
 
-  std::error_code ec = binaryCommand("/get_blocks_hashes_by_timestamps.bin", req, rsp);
+  std::error_code ec = binaryCommand("/get_blocks_hashes_by_timestamps.bin", req, rsp, HttpClientPool::Priority::LOW);
   if (!ec) {
     blockHashes = std::move(rsp.blockHashes);
   }
@@ -538,7 +604,7 @@ std::error_code NodeRpcProxy::doGetNewBlocks(std::vector<Crypto::Hash>& knownBlo
   req.block_ids = std::move(knownBlockIds);
 
   m_logger(TRACE) << "Send getblocks.bin request";
-  std::error_code ec = binaryCommand("/getblocks.bin", req, rsp);
+  std::error_code ec = binaryCommand("/getblocks.bin", req, rsp, HttpClientPool::Priority::LOW);
   if (!ec) {
     m_logger(TRACE) << "getblocks.bin compete, start_height " << rsp.start_height << ", block count " << rsp.blocks.size();
     newBlocks = std::move(rsp.blocks);
@@ -580,7 +646,7 @@ std::error_code NodeRpcProxy::doQueryBlocksLite(const std::vector<Crypto::Hash>&
   req.timestamp = timestamp;
 
   m_logger(TRACE) << "Send queryblockslite.bin request, timestamp " << req.timestamp;
-  std::error_code ec = binaryCommand("/queryblockslite.bin", req, rsp);
+  std::error_code ec = binaryCommand("/queryblockslite.bin", req, rsp, HttpClientPool::Priority::LOW);
   if (ec) {
     m_logger(TRACE) << "queryblockslite.bin failed: " << ec << ", " << ec.message();
     return ec;
@@ -649,7 +715,7 @@ std::error_code NodeRpcProxy::doGetBlocks(const std::vector<Crypto::Hash>& block
 
   req.blockHashes = blockHashes;
 
-  std::error_code ec = binaryCommand("/get_blocks_details_by_hashes.bin", req, resp);
+  std::error_code ec = binaryCommand("/get_blocks_details_by_hashes.bin", req, resp, HttpClientPool::Priority::LOW);
   if (ec) {
     return ec;
   }
@@ -663,7 +729,7 @@ std::error_code NodeRpcProxy::doGetTransactionHashesByPaymentId(const Crypto::Ha
   COMMAND_RPC_GET_TRANSACTION_HASHES_BY_PAYMENT_ID::response resp = AUTO_VAL_INIT(resp);
 
   req.paymentId = paymentId;
-  std::error_code ec = binaryCommand("/get_transaction_hashes_by_payment_id.bin", req, resp);
+  std::error_code ec = binaryCommand("/get_transaction_hashes_by_payment_id.bin", req, resp, HttpClientPool::Priority::LOW);
   if (ec) {
     return ec;
   }
@@ -677,7 +743,7 @@ std::error_code NodeRpcProxy::doGetTransactions(const std::vector<Crypto::Hash>&
   COMMAND_RPC_GET_TRANSACTION_DETAILS_BY_HASHES::response resp = AUTO_VAL_INIT(resp);
 
   req.transactionHashes = transactionHashes;
-  std::error_code ec = binaryCommand("/get_transaction_details_by_hashes.bin", req, resp);
+  std::error_code ec = binaryCommand("/get_transaction_details_by_hashes.bin", req, resp, HttpClientPool::Priority::LOW);
   if (ec) {
     return ec;
   }
@@ -715,8 +781,8 @@ void NodeRpcProxy::scheduleRequest(std::function<std::error_code()>&& procedure,
           callback(std::make_error_code(std::errc::operation_canceled));
         } else {
           std::error_code ec = procedure();
-          if (m_connected != m_httpClient->isConnected()) {
-            m_connected = m_httpClient->isConnected();
+          if (m_connected != m_httpClientPool->isConnected()) {
+            m_connected = m_httpClientPool->isConnected();
             m_rpcProxyObserverManager.notify(&INodeRpcProxyObserver::connectionStatusUpdated, m_connected);
           }
           callback(m_stop ? std::make_error_code(std::errc::operation_canceled) : ec);
@@ -726,12 +792,13 @@ void NodeRpcProxy::scheduleRequest(std::function<std::error_code()>&& procedure,
 }
 
 template <typename Request, typename Response>
-std::error_code NodeRpcProxy::binaryCommand(const std::string& url, const Request& req, Response& res) {
+std::error_code NodeRpcProxy::binaryCommand(const std::string& url, const Request& req, Response& res,
+  HttpClientPool::Priority priority) {
   std::error_code ec;
 
   try {
-    EventLock eventLock(*m_httpEvent);
-    invokeBinaryCommand(*m_httpClient, url, req, res);
+    auto httpClient = m_httpClientPool->acquire(priority);
+    invokeBinaryCommand(*httpClient, url, req, res);
     ec = interpretResponseStatus(res.status);
   } catch (const ConnectException&) {
     ec = make_error_code(error::CONNECT_ERROR);
@@ -743,13 +810,14 @@ std::error_code NodeRpcProxy::binaryCommand(const std::string& url, const Reques
 }
 
 template <typename Request, typename Response>
-std::error_code NodeRpcProxy::jsonCommand(const std::string& url, const Request& req, Response& res) {
+std::error_code NodeRpcProxy::jsonCommand(const std::string& url, const Request& req, Response& res,
+  HttpClientPool::Priority priority) {
   std::error_code ec;
 
   try {
     m_logger(TRACE) << "Send " << url << " JSON request";
-    EventLock eventLock(*m_httpEvent);
-    invokeJsonCommand(*m_httpClient, url, req, res);
+    auto httpClient = m_httpClientPool->acquire(priority);
+    invokeJsonCommand(*httpClient, url, req, res);
     ec = interpretResponseStatus(res.status);
   } catch (const ConnectException&) {
     ec = make_error_code(error::CONNECT_ERROR);
@@ -767,12 +835,13 @@ std::error_code NodeRpcProxy::jsonCommand(const std::string& url, const Request&
 }
 
 template <typename Request, typename Response>
-std::error_code NodeRpcProxy::jsonRpcCommand(const std::string& method, const Request& req, Response& res) {
+std::error_code NodeRpcProxy::jsonRpcCommand(const std::string& method, const Request& req, Response& res,
+  HttpClientPool::Priority priority) {
   std::error_code ec = make_error_code(error::INTERNAL_NODE_ERROR);
 
   try {
     m_logger(TRACE) << "Send " << method << " JSON RPC request";
-    EventLock eventLock(*m_httpEvent);
+    auto httpClient = m_httpClientPool->acquire(priority);
 
     JsonRpc::JsonRpcRequest jsReq;
 
@@ -785,7 +854,7 @@ std::error_code NodeRpcProxy::jsonRpcCommand(const std::string& method, const Re
     httpReq.setUrl("/json_rpc");
     httpReq.setBody(jsReq.getBody());
 
-    m_httpClient->request(httpReq, httpRes);
+    httpClient->request(httpReq, httpRes);
 
     JsonRpc::JsonRpcResponse jsRes;
 
@@ -26,18 +26,16 @@
 
 #include "Common/ObserverManager.h"
 #include "Logging/LoggerRef.h"
+#include "Rpc/HttpClientPool.h"
 #include "INode.h"
 
 namespace System {
   class ContextGroup;
   class Dispatcher;
-  class Event;
 }
 
 namespace CryptoNote {
 
-class HttpClient;
-
 class INodeRpcProxyObserver {
 public:
   virtual ~INodeRpcProxyObserver() {}
@@ -84,6 +82,10 @@ public:
 
   unsigned int rpcTimeout() const { return m_rpcTimeout; }
   void rpcTimeout(unsigned int val) { m_rpcTimeout = val; }
+  uint64_t pullInterval() const { return m_pullInterval; }
+  void pullInterval(uint64_t val) { m_pullInterval = val; }
+  uint64_t changesWaitTimeout() const { return m_changesWaitTimeout; }
+  void changesWaitTimeout(uint64_t val) { m_changesWaitTimeout = val; }
 
 private:
   void resetInternalState();
@@ -91,9 +93,11 @@ private:
 
   std::vector<Crypto::Hash> getKnownTxsVector() const;
   void pullNodeStatusAndScheduleTheNext();
-  void updateNodeStatus();
-  void updateBlockchainStatus();
-  bool updatePoolStatus();
+  bool updateNodeStatus();
+  bool waitForNodeChanges(COMMAND_RPC_WAIT_FOR_CHANGES::response& changes);
+  bool isNodeStateKnown(const Crypto::Hash& topBlockId, const Crypto::Hash& poolDigest) const;
+  bool updateBlockchainStatus();
+  std::error_code updatePoolStatus(bool& isBcActual);
   void updatePeerCount(size_t peerCount);
   void updatePoolState(const std::vector<std::unique_ptr<ITransactionReader>>& addedTxs, const std::vector<Crypto::Hash>& deletedTxsIds);
 
@@ -114,17 +118,22 @@ private:
   std::error_code doGetTransactions(const std::vector<Crypto::Hash>& transactionHashes, std::vector<TransactionDetails>& transactions);
 
   void scheduleRequest(std::function<std::error_code()>&& procedure, const Callback& callback);
+  // bulk synchronization requests use LOW priority, so they don't delay relays and status updates
   template <typename Request, typename Response>
-  std::error_code binaryCommand(const std::string& url, const Request& req, Response& res);
+  std::error_code binaryCommand(const std::string& url, const Request& req, Response& res,
+    HttpClientPool::Priority priority = HttpClientPool::Priority::HIGH);
   template <typename Request, typename Response>
-  std::error_code jsonCommand(const std::string& url, const Request& req, Response& res);
+  std::error_code jsonCommand(const std::string& url, const Request& req, Response& res,
+    HttpClientPool::Priority priority = HttpClientPool::Priority::HIGH);
   template <typename Request, typename Response>
-  std::error_code jsonRpcCommand(const std::string& method, const Request& req, Response& res);
+  std::error_code jsonRpcCommand(const std::string& method, const Request& req, Response& res,
+    HttpClientPool::Priority priority = HttpClientPool::Priority::HIGH);
 
   enum State {
     STATE_NOT_INITIALIZED,
     STATE_INITIALIZING,
-    STATE_INITIALIZED
+    STATE_INITIALIZED,
+    STATE_SHUTTING_DOWN
   };
 
 private:
@@ -141,10 +150,13 @@ private:
   const std::string m_nodeHost;
   const unsigned short m_nodePort;
   unsigned int m_rpcTimeout;
-  HttpClient* m_httpClient = nullptr;
-  System::Event* m_httpEvent = nullptr;
+  HttpClientPool* m_httpClientPool = nullptr;
+  // long poll requests occupy a connection of their own
+  HttpClient* m_notificationClient = nullptr;
+  System::ContextGroup* m_statusContextGroup = nullptr;
 
   uint64_t m_pullInterval;
+  uint64_t m_changesWaitTimeout;
 
   // Internal state
   bool m_stop = false;
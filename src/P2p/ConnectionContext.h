@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <list>
 #include <ostream>
 #include <unordered_set>
@@ -27,6 +28,17 @@
 
 namespace CryptoNote {
 
+// Measured by blocks downloading requests, used to size next request
+struct BlocksSynchronizationStatistics {
+  size_t requestedCount = 0;
+  std::chrono::steady_clock::time_point requestTime;
+  uint64_t receivedBlocks = 0;
+  uint64_t receivedBytes = 0;
+  double averageBlockSize = 0; // bytes
+  double throughput = 0; // bytes per second
+  double roundTripTime = 0; // milliseconds
+};
+
 struct CryptoNoteConnectionContext {
   uint8_t version;
   boost::uuids::uuid m_connection_id;
@@ -50,6 +62,7 @@ struct CryptoNoteConnectionContext {
   std::unordered_set<Crypto::Hash> m_requested_objects;
   uint32_t m_remote_blockchain_height = 0;
   uint32_t m_last_response_height = 0;
+  BlocksSynchronizationStatistics m_sync_statistics;
 };
 
 inline std::string get_protocol_state_string(CryptoNoteConnectionContext::state s) {
@@ -20,6 +20,7 @@
 
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
+#include <sys/mman.h>
 #include <sys/timerfd.h>
 #include <fcntl.h>
 #include <string.h>
@@ -27,6 +28,112 @@
 #include <unistd.h>
 #include "ErrorMessage.h"
 
+#if defined(__x86_64__) || defined(__aarch64__)
+#define SYSTEM_NATIVE_CONTEXT_SWITCH
+#endif
+
+#ifdef SYSTEM_NATIVE_CONTEXT_SWITCH
+// Context switch without syscalls: unlike swapcontext it doesn't save and restore signal mask.
+// System_switchContext pushes callee-saved registers to the current stack, stores stack pointer to *from,
+// switches to stack 'to' and pops registers saved there. New context starts in System_startContext,
+// which calls a procedure kept in a callee-saved register with an argument kept in another one.
+extern "C" void System_switchContext(void** from, void* to);
+extern "C" void System_startContext();
+
+#if defined(__x86_64__)
+asm(R"(
+.text
+.globl System_switchContext
+.hidden System_switchContext
+.type System_switchContext,@function
+.align 16
+System_switchContext:
+  pushq %rbp
+  pushq %rbx
+  pushq %r12
+  pushq %r13
+  pushq %r14
+  pushq %r15
+  subq $8, %rsp
+  stmxcsr (%rsp)
+  fnstcw 4(%rsp)
+  movq %rsp, (%rdi)
+  movq %rsi, %rsp
+  ldmxcsr (%rsp)
+  fldcw 4(%rsp)
+  addq $8, %rsp
+  popq %r15
+  popq %r14
+  popq %r13
+  popq %r12
+  popq %rbx
+  popq %rbp
+  ret
+.size System_switchContext,.-System_switchContext
+
+.globl System_startContext
+.hidden System_startContext
+.type System_startContext,@function
+.align 16
+System_startContext:
+  movq %r13, %rdi
+  callq *%r12
+  ud2
+.size System_startContext,.-System_startContext
+)");
+#else
+asm(R"(
+.text
+.globl System_switchContext
+.hidden System_switchContext
+.type System_switchContext,%function
+.align 4
+System_switchContext:
+  sub sp, sp, #0xb0
+  stp x19, x20, [sp, #0x00]
+  stp x21, x22, [sp, #0x10]
+  stp x23, x24, [sp, #0x20]
+  stp x25, x26, [sp, #0x30]
+  stp x27, x28, [sp, #0x40]
+  stp x29, x30, [sp, #0x50]
+  stp d8, d9, [sp, #0x60]
+  stp d10, d11, [sp, #0x70]
+  stp d12, d13, [sp, #0x80]
+  stp d14, d15, [sp, #0x90]
+  mrs x9, fpcr
+  str x9, [sp, #0xa0]
+  mov x9, sp
+  str x9, [x0]
+  mov sp, x1
+  ldp x19, x20, [sp, #0x00]
+  ldp x21, x22, [sp, #0x10]
+  ldp x23, x24, [sp, #0x20]
+  ldp x25, x26, [sp, #0x30]
+  ldp x27, x28, [sp, #0x40]
+  ldp x29, x30, [sp, #0x50]
+  ldp d8, d9, [sp, #0x60]
+  ldp d10, d11, [sp, #0x70]
+  ldp d12, d13, [sp, #0x80]
+  ldp d14, d15, [sp, #0x90]
+  ldr x9, [sp, #0xa0]
+  msr fpcr, x9
+  add sp, sp, #0xb0
+  ret
+.size System_switchContext,.-System_switchContext
+
+.globl System_startContext
+.hidden System_startContext
+.type System_startContext,%function
+.align 4
+System_startContext:
+  mov x0, x20
+  blr x19
+  brk #0
+.size System_startContext,.-System_startContext
+)");
+#endif
+#endif
+
 namespace System {
 
 namespace {
@@ -57,6 +164,102 @@ static_assert(Dispatcher::SIZEOF_PTHREAD_MUTEX_T == sizeof(pthread_mutex_t), "in
 
 const size_t STACK_SIZE = 64 * 1024;
 
+// Stacks are allocated with a protected page below them, so stack overflow crashes instead of corrupting memory
+size_t getGuardSize() {
+  static const size_t guardSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return guardSize;
+}
+
+uint8_t* allocateStack() {
+  size_t guardSize = getGuardSize();
+  void* memory = mmap(nullptr, guardSize + STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+  if (memory == MAP_FAILED) {
+    throw std::runtime_error("Dispatcher::allocateStack, mmap failed, " + lastErrorMessage());
+  }
+
+  if (mprotect(memory, guardSize, PROT_NONE) == -1) {
+    std::string message = "Dispatcher::allocateStack, mprotect failed, " + lastErrorMessage();
+    munmap(memory, guardSize + STACK_SIZE);
+    throw std::runtime_error(message);
+  }
+
+  return static_cast<uint8_t*>(memory) + guardSize;
+}
+
+void freeStack(void* stackPtr) {
+  size_t guardSize = getGuardSize();
+  int result = munmap(static_cast<uint8_t*>(stackPtr) - guardSize, guardSize + STACK_SIZE);
+  assert(result == 0);
+}
+
+#ifdef SYSTEM_NATIVE_CONTEXT_SWITCH
+// Machine context is a stack pointer saved by System_switchContext
+void* createMainContext() {
+  return nullptr;
+}
+
+void destroyContext(void* ucontext) {
+}
+
+void* createContext(uint8_t* stack, void (*procedure)(void*), void* argument) {
+  uint64_t* frame = reinterpret_cast<uint64_t*>((reinterpret_cast<uintptr_t>(stack) + STACK_SIZE) & ~static_cast<uintptr_t>(15));
+#if defined(__x86_64__)
+  *--frame = reinterpret_cast<uint64_t>(&System_startContext); // return address, stack is 16-aligned after ret
+  *--frame = 0; // rbp
+  *--frame = 0; // rbx
+  *--frame = reinterpret_cast<uint64_t>(procedure); // r12
+  *--frame = reinterpret_cast<uint64_t>(argument); // r13
+  *--frame = 0; // r14
+  *--frame = 0; // r15
+  *--frame = (UINT64_C(0x037f) << 32) | UINT64_C(0x1f80); // default x87 control word and mxcsr
+#else
+  frame -= 22;
+  memset(frame, 0, 22 * sizeof(uint64_t)); // FPCR at frame[20] is 0: round to nearest, no traps
+  frame[0] = reinterpret_cast<uint64_t>(procedure); // x19
+  frame[1] = reinterpret_cast<uint64_t>(argument); // x20
+  frame[11] = reinterpret_cast<uint64_t>(&System_startContext); // x30
+#endif
+  return frame;
+}
+
+void switchContext(NativeContext& from, NativeContext& to) {
+  System_switchContext(&from.ucontext, to.ucontext);
+}
+#else
+void* createMainContext() {
+  ucontext_t* ucontext = new ucontext_t;
+  if (getcontext(ucontext) == -1) {
+    delete ucontext;
+    throw std::runtime_error("getcontext failed, " + lastErrorMessage());
+  }
+
+  return ucontext;
+}
+
+void destroyContext(void* ucontext) {
+  delete static_cast<ucontext_t*>(ucontext);
+}
+
+void* createContext(uint8_t* stack, void (*procedure)(void*), void* argument) {
+  ucontext_t* ucontext = new ucontext_t;
+  if (getcontext(ucontext) == -1) { //makecontext precondition
+    delete ucontext;
+    throw std::runtime_error("Dispatcher::getReusableContext, getcontext failed, " + lastErrorMessage());
+  }
+
+  ucontext->uc_stack.ss_sp = stack;
+  ucontext->uc_stack.ss_size = STACK_SIZE;
+  makecontext(ucontext, (void(*)())procedure, 1, reinterpret_cast<int*>(argument));
+  return ucontext;
+}
+
+void switchContext(NativeContext& from, NativeContext& to) {
+  if (swapcontext(static_cast<ucontext_t*>(from.ucontext), static_cast<ucontext_t*>(to.ucontext)) == -1) {
+    throw std::runtime_error("Dispatcher, swapcontext failed, " + lastErrorMessage());
+  }
+}
+#endif
+
 };
 
 Dispatcher::Dispatcher() {
@@ -65,10 +268,13 @@ Dispatcher::Dispatcher() {
   if (epoll == -1) {
     message = "epoll_create1 failed, " + lastErrorMessage();
   } else {
-    mainContext.ucontext = new ucontext_t;
-    if (getcontext(reinterpret_cast<ucontext_t*>(mainContext.ucontext)) == -1) {
-      message = "getcontext failed, " + lastErrorMessage();
-    } else {
+    try {
+      mainContext.ucontext = createMainContext();
+    } catch (std::exception& e) {
+      message = e.what();
+    }
+
+    if (message.empty()) {
       remoteSpawnEvent = eventfd(0, O_NONBLOCK);
       if(remoteSpawnEvent == -1) {
         message = "eventfd failed, " + lastErrorMessage();
@@ -104,6 +310,8 @@ Dispatcher::Dispatcher() {
         auto result = close(remoteSpawnEvent);
         assert(result == 0);
       }
+
+      destroyContext(mainContext.ucontext);
     }
 
     auto result = close(epoll);
@@ -124,11 +332,11 @@ Dispatcher::~Dispatcher() {
   assert(firstResumingContext == nullptr);
   assert(runningContextCount == 0);
   while (firstReusableContext != nullptr) {
-    auto ucontext = static_cast<ucontext_t*>(firstReusableContext->ucontext);
-    auto stackPtr = static_cast<uint8_t *>(firstReusableContext->stackPtr);
+    auto ucontext = firstReusableContext->ucontext;
+    auto stackPtr = firstReusableContext->stackPtr;
     firstReusableContext = firstReusableContext->next;
-    delete[] stackPtr;
-    delete ucontext;
+    freeStack(stackPtr);
+    destroyContext(ucontext);
   }
 
   while (!timers.empty()) {
@@ -143,15 +351,16 @@ Dispatcher::~Dispatcher() {
   assert(result == 0);
   result = pthread_mutex_destroy(reinterpret_cast<pthread_mutex_t*>(this->mutex));
   assert(result == 0);
+  destroyContext(mainContext.ucontext);
 }
 
 void Dispatcher::clear() {
   while (firstReusableContext != nullptr) {
-    auto ucontext = static_cast<ucontext_t*>(firstReusableContext->ucontext);
-    auto stackPtr = static_cast<uint8_t *>(firstReusableContext->stackPtr);
+    auto ucontext = firstReusableContext->ucontext;
+    auto stackPtr = firstReusableContext->stackPtr;
     firstReusableContext = firstReusableContext->next;
-    delete[] stackPtr;
-    delete ucontext;
+    freeStack(stackPtr);
+    destroyContext(ucontext);
   }
 
   while (!timers.empty()) {
@@ -217,11 +426,9 @@ void Dispatcher::dispatch() {
   }
 
   if (context != currentContext) {
-    ucontext_t* oldContext = static_cast<ucontext_t*>(currentContext->ucontext);
+    NativeContext* oldContext = currentContext;
     currentContext = context;
-    if (swapcontext(oldContext, static_cast<ucontext_t *>(context->ucontext)) == -1) {
-      throw std::runtime_error("Dispatcher::dispatch, swapcontext failed, " + lastErrorMessage());
-    }
+    switchContext(*oldContext, *context);
   }
 }
 
@@ -363,25 +570,20 @@ int Dispatcher::getEpoll() const {
 
 NativeContext& Dispatcher::getReusableContext() {
   if(firstReusableContext == nullptr) {
-    ucontext_t* newlyCreatedContext = new ucontext_t;
-    if (getcontext(newlyCreatedContext) == -1) { //makecontext precondition
-      throw std::runtime_error("Dispatcher::getReusableContext, getcontext failed, " + lastErrorMessage());
+    auto stackPointer = allocateStack();
+    ContextMakingData makingContextData {this, nullptr};
+    NativeContext newlyCreatedContext;
+    try {
+      newlyCreatedContext.ucontext = createContext(stackPointer, contextProcedureStatic, &makingContextData);
+    } catch (...) {
+      freeStack(stackPointer);
+      throw;
     }
 
-    auto stackPointer = new uint8_t[STACK_SIZE];
-    newlyCreatedContext->uc_stack.ss_sp = stackPointer;
-    newlyCreatedContext->uc_stack.ss_size = STACK_SIZE;
-
-    ContextMakingData makingContextData {this, newlyCreatedContext};
-    makecontext(newlyCreatedContext, (void(*)())contextProcedureStatic, 1, reinterpret_cast<int*>(&makingContextData));
-
-    ucontext_t* oldContext = static_cast<ucontext_t*>(currentContext->ucontext);
-    if (swapcontext(oldContext, newlyCreatedContext) == -1) {
-      throw std::runtime_error("Dispatcher::getReusableContext, swapcontext failed, " + lastErrorMessage());
-    }
+    makingContextData.ucontext = newlyCreatedContext.ucontext;
+    switchContext(*currentContext, newlyCreatedContext);
 
     assert(firstReusableContext != nullptr);
-    assert(firstReusableContext->ucontext == newlyCreatedContext);
     firstReusableContext->stackPtr = stackPointer;
   };
 
@@ -427,10 +629,7 @@ void Dispatcher::contextProcedure(void* ucontext) {
   context.next = nullptr;
   context.inExecutionQueue = false;
   firstReusableContext = &context;
-  ucontext_t* oldContext = static_cast<ucontext_t*>(context.ucontext);
-  if (swapcontext(oldContext, static_cast<ucontext_t*>(currentContext->ucontext)) == -1) {
-    throw std::runtime_error("Dispatcher::contextProcedure, swapcontext failed, " + lastErrorMessage());
-  }
+  switchContext(context, *currentContext);
 
   for (;;) {
     ++runningContextCount;
@@ -118,6 +118,11 @@ TcpListener& TcpListener::operator=(TcpListener&& other) {
 }
 
 TcpConnection TcpListener::accept() {
+  assert(dispatcher != nullptr);
+  return accept(*dispatcher);
+}
+
+TcpConnection TcpListener::accept(Dispatcher& connectionDispatcher) {
   assert(dispatcher != nullptr);
   assert(context == nullptr);
   if (dispatcher->interrupted()) {
@@ -196,10 +201,10 @@ TcpConnection TcpListener::accept() {
           if (setsockopt(connection, SOL_SOCKET, SO_UPDATE_ACCEPT_CONTEXT, reinterpret_cast<char*>(&listener), sizeof listener) != 0) {
             message = "setsockopt failed, " + errorMessage(WSAGetLastError());
           } else {
-            if (CreateIoCompletionPort(reinterpret_cast<HANDLE>(connection), dispatcher->getCompletionPort(), 0, 0) != dispatcher->getCompletionPort()) {
+            if (CreateIoCompletionPort(reinterpret_cast<HANDLE>(connection), connectionDispatcher.getCompletionPort(), 0, 0) != connectionDispatcher.getCompletionPort()) {
               message = "CreateIoCompletionPort failed, " + lastErrorMessage();
             } else {
-              return TcpConnection(*dispatcher, connection);
+              return TcpConnection(connectionDispatcher, connection);
             }
           }
         }
@@ -36,6 +36,8 @@ public:
   TcpListener& operator=(const TcpListener&) = delete;
   TcpListener& operator=(TcpListener&& other);
   TcpConnection accept();
+  // Accepted connection is bound to connectionDispatcher and must be used from its thread only
+  TcpConnection accept(Dispatcher& connectionDispatcher);
 
 private:
   Dispatcher* dispatcher;
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h"
+#include "CryptoNoteCore/BlockFilter.h"
 #include "CryptoNoteCore/CryptoNoteBasic.h"
 #include "CryptoNoteCore/Difficulty.h"
 #include "crypto/hash.h"
@@ -151,6 +152,33 @@ struct COMMAND_RPC_GET_POOL_CHANGES_LITE {
   };
 };
 
+// Long poll: returns as soon as top block or pool differs from the known state, or after timeout
+struct COMMAND_RPC_WAIT_FOR_CHANGES {
+  struct request {
+    Crypto::Hash knownBlockId;
+    Crypto::Hash knownPoolDigest;
+    uint32_t timeout; // milliseconds
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(knownBlockId)
+      KV_MEMBER(knownPoolDigest)
+      KV_MEMBER(timeout)
+    }
+  };
+
+  struct response {
+    Crypto::Hash topBlockId;
+    Crypto::Hash poolDigest;
+    std::string status;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(topBlockId)
+      KV_MEMBER(poolDigest)
+      KV_MEMBER(status)
+    }
+  };
+};
+
 //-----------------------------------------------
 struct COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES {
   
@@ -575,4 +603,110 @@ struct COMMAND_RPC_GET_TRANSACTION_DETAILS_BY_HASHES {
   };
 };
 
+//-----------------------------------------------
+// Server side scanning for registered view keys, enabled on trusted nodes only
+struct ViewKeyAccount {
+  AccountPublicAddress address;
+  Crypto::SecretKey viewSecretKey;
+
+  void serialize(ISerializer &s) {
+    KV_MEMBER(address)
+    KV_MEMBER(viewSecretKey)
+  }
+};
+
+struct ScannedOutput {
+  Crypto::PublicKey spendPublicKey;
+  uint32_t outputIndex;
+
+  void serialize(ISerializer &s) {
+    KV_MEMBER(spendPublicKey)
+    KV_MEMBER(outputIndex)
+  }
+};
+
+struct ScannedTransaction {
+  uint32_t blockIndex;
+  Crypto::Hash blockHash;
+  TransactionPrefixInfo transaction;
+  std::vector<ScannedOutput> outputs;
+
+  void serialize(ISerializer &s) {
+    KV_MEMBER(blockIndex)
+    KV_MEMBER(blockHash)
+    KV_MEMBER(transaction)
+    KV_MEMBER(outputs)
+  }
+};
+
+struct COMMAND_RPC_REGISTER_VIEW_KEYS {
+  struct request {
+    std::vector<ViewKeyAccount> accounts;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(accounts)
+    }
+  };
+
+  typedef STATUS_STRUCT response;
+};
+
+struct COMMAND_RPC_UNREGISTER_VIEW_KEYS {
+  struct request {
+    std::vector<AccountPublicAddress> addresses;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(addresses)
+    }
+  };
+
+  typedef STATUS_STRUCT response;
+};
+
+struct COMMAND_RPC_SCAN_BLOCKS {
+  struct request {
+    uint32_t startIndex;
+    uint32_t count;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(startIndex)
+      KV_MEMBER(count)
+    }
+  };
+
+  struct response {
+    std::vector<ScannedTransaction> transactions;
+    uint32_t scannedCount;
+    std::string status;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(transactions)
+      KV_MEMBER(scannedCount)
+      KV_MEMBER(status)
+    }
+  };
+};
+
+struct COMMAND_RPC_GET_BLOCK_FILTERS {
+  struct request {
+    uint32_t startIndex;
+    uint32_t count;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(startIndex)
+      KV_MEMBER(count)
+    }
+  };
+
+  struct response {
+    std::vector<BlockFilter> filters;
+    std::string status;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(filters)
+      KV_MEMBER(status)
+    }
+  };
+};
+
 }
@@ -0,0 +1,123 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "HttpClientPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include <System/Dispatcher.h>
+#include <System/Event.h>
+#include <System/InterruptedException.h>
+
+namespace CryptoNote {
+
+HttpClientPool::ClientReleaser::ClientReleaser(HttpClientPool* pool, Priority priority) : pool(pool), priority(priority) {
+}
+
+void HttpClientPool::ClientReleaser::operator()(HttpClient* client) const {
+  if (pool != nullptr) {
+    pool->release(client, priority);
+  }
+}
+
+HttpClientPool::HttpClientPool(System::Dispatcher& dispatcher, const std::string& address, uint16_t port, size_t maxConnections) :
+  m_lowPriorityClientCount(0), m_dispatcher(dispatcher), m_connected(true) {
+  assert(maxConnections > 0);
+
+  for (size_t i = 0; i < maxConnections; ++i) {
+    m_clients.emplace_back(new HttpClient(dispatcher, address, port));
+    m_idleClients.push_back(m_clients.back().get());
+  }
+}
+
+HttpClientPool::Client HttpClientPool::acquire(Priority priority) {
+  auto& waiters = m_waiters[static_cast<size_t>(priority)];
+  if (waiters.empty() && canTake(priority)) {
+    return take(priority);
+  }
+
+  System::Event event(m_dispatcher);
+  Waiter waiter = { &event, nullptr };
+  waiters.push_back(&waiter);
+
+  try {
+    event.wait();
+  } catch (System::InterruptedException&) {
+    if (waiter.client != nullptr) {
+      // client was handed over while the waiting context was being interrupted
+      release(waiter.client, priority);
+    } else {
+      waiters.erase(std::find(waiters.begin(), waiters.end(), &waiter));
+    }
+
+    throw;
+  }
+
+  assert(waiter.client != nullptr);
+  return Client(waiter.client, ClientReleaser(this, priority));
+}
+
+bool HttpClientPool::isConnected() const {
+  return m_connected;
+}
+
+size_t HttpClientPool::getIdleClientCount() const {
+  return m_idleClients.size();
+}
+
+bool HttpClientPool::canTake(Priority priority) const {
+  if (m_idleClients.empty()) {
+    return false;
+  }
+
+  return priority == Priority::HIGH || m_clients.size() == 1 || m_lowPriorityClientCount + 1 < m_clients.size();
+}
+
+HttpClientPool::Client HttpClientPool::take(Priority priority) {
+  assert(canTake(priority));
+
+  HttpClient* client = m_idleClients.back();
+  m_idleClients.pop_back();
+  if (priority == Priority::LOW) {
+    ++m_lowPriorityClientCount;
+  }
+
+  return Client(client, ClientReleaser(this, priority));
+}
+
+void HttpClientPool::release(HttpClient* client, Priority priority) {
+  m_connected = client->isConnected();
+  m_idleClients.push_back(client);
+  if (priority == Priority::LOW) {
+    assert(m_lowPriorityClientCount > 0);
+    --m_lowPriorityClientCount;
+  }
+
+  for (Priority waiterPriority : { Priority::HIGH, Priority::LOW }) {
+    auto& waiters = m_waiters[static_cast<size_t>(waiterPriority)];
+    if (!waiters.empty() && canTake(waiterPriority)) {
+      Waiter* waiter = waiters.front();
+      waiters.pop_front();
+      waiter->client = take(waiterPriority).release();
+      waiter->event->set();
+      return;
+    }
+  }
+}
+
+}
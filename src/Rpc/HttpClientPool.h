@@ -0,0 +1,87 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <array>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "HttpClient.h"
+
+namespace System {
+class Dispatcher;
+class Event;
+}
+
+namespace CryptoNote {
+
+// Keeps several connections to one node, so independent requests don't wait for each other.
+// Waiting requests get a client by priority, then in arrival order. Low priority requests never take the last
+// connection, so relays and status requests aren't stuck behind bulk downloads. Use from dispatcher thread only,
+// clients are returned to the pool when the acquired pointers are destroyed, pool must outlive them.
+class HttpClientPool {
+public:
+  enum class Priority {
+    HIGH,
+    LOW
+  };
+
+  class ClientReleaser {
+  public:
+    explicit ClientReleaser(HttpClientPool* pool = nullptr, Priority priority = Priority::HIGH);
+    void operator()(HttpClient* client) const;
+
+  private:
+    HttpClientPool* pool;
+    Priority priority;
+  };
+
+  typedef std::unique_ptr<HttpClient, ClientReleaser> Client;
+
+  HttpClientPool(System::Dispatcher& dispatcher, const std::string& address, uint16_t port, size_t maxConnections);
+  HttpClientPool(const HttpClientPool&) = delete;
+  HttpClientPool& operator=(const HttpClientPool&) = delete;
+
+  // waits until a client is available, throws System::InterruptedException if interrupted
+  Client acquire(Priority priority);
+
+  // connection state observed by the last finished request
+  bool isConnected() const;
+  size_t getIdleClientCount() const;
+
+private:
+  struct Waiter {
+    System::Event* event;
+    HttpClient* client;
+  };
+
+  bool canTake(Priority priority) const;
+  Client take(Priority priority);
+  void release(HttpClient* client, Priority priority);
+
+  std::vector<std::unique_ptr<HttpClient>> m_clients;
+  std::vector<HttpClient*> m_idleClients;
+  std::array<std::deque<Waiter*>, 2> m_waiters;
+  size_t m_lowPriorityClientCount;
+  System::Dispatcher& m_dispatcher;
+  bool m_connected;
+};
+
+}
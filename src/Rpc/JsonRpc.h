@@ -17,9 +17,11 @@
 
 #pragma once
 
+#include <cassert>
 #include <boost/optional.hpp>
 #include <boost/foreach.hpp>
 #include <functional>
+#include <memory>
 
 #include "CoreRpcServerCommandsDefinitions.h"
 #include <Common/JsonValue.h>
@@ -63,6 +65,22 @@ public:
 
 typedef boost::optional<Common::JsonValue> OptionalId;
 
+// Params and result are serialized directly to JSON text and appended to the non-empty envelope object
+inline std::string appendMember(std::string object, const char* name, const std::string& valueJson) {
+  if (valueJson.empty()) {
+    return object;
+  }
+
+  assert(object.size() > 2 && object.back() == '}');
+  object.pop_back();
+  object += ",\"";
+  object += name;
+  object += "\":";
+  object += valueJson;
+  object += '}';
+  return object;
+}
+
 class JsonRpcRequest {
 public:
   
@@ -70,19 +88,23 @@ public:
 
   bool parseRequest(const std::string& requestBody) {
     try {
-      psReq = Common::JsonValue::fromString(requestBody);
+      input.reset(new JsonInputStreamSerializer(std::string(requestBody)));
     } catch (std::exception&) {
       throw JsonRpcError(errParseError);
     }
 
-    if (!psReq.contains("method")) {
+    if (!(*input)(method, "method")) {
       throw JsonRpcError(errInvalidRequest);
     }
 
-    method = psReq("method").getString();
-
-    if (psReq.contains("id")) {
-      id = psReq("id");
+    std::string idJson;
+    try {
+      if (input->scalarJson(idJson, "id")) {
+        id = Common::JsonValue::fromString(idJson);
+      }
+    } catch (std::exception&) {
+      // id must be string, number or null
+      throw JsonRpcError(errInvalidRequest);
     }
 
     return true;
@@ -90,14 +112,16 @@ public:
 
   template <typename T>
   bool loadParams(T& v) const {
-    loadFromJsonValue(v, psReq.contains("params") ? 
-      psReq("params") : Common::JsonValue(Common::JsonValue::NIL));
+    if (input) {
+      (*input)(v, "params");
+    }
+
     return true;
   }
 
   template <typename T>
   bool setParams(const T& v) {
-    psReq.set("params", storeToJsonValue(v));
+    params = storeToJson(v);
     return true;
   }
 
@@ -116,14 +140,17 @@ public:
   std::string getBody() {
     psReq.set("jsonrpc", std::string("2.0"));
     psReq.set("method", method);
-    return psReq.toString();
+    return appendMember(psReq.toString(), "params", params);
   }
 
 private:
 
+  // parsed request, members are read from it without building Common::JsonValue
+  std::unique_ptr<JsonInputStreamSerializer> input;
   Common::JsonValue psReq;
   OptionalId id;
   std::string method;
+  std::string params;
 };
 
 
@@ -134,7 +161,7 @@ public:
 
   void parse(const std::string& responseBody) {
     try {
-      psResp = Common::JsonValue::fromString(responseBody);
+      input.reset(new JsonInputStreamSerializer(std::string(responseBody)));
     } catch (std::exception&) {
       throw JsonRpcError(errParseError);
     }
@@ -151,37 +178,30 @@ public:
   }
 
   bool getError(JsonRpcError& err) const {
-    if (!psResp.contains("error")) {
-      return false;
-    }
-
-    loadFromJsonValue(err, psResp("error"));
-    return true;
+    return input && (*input)(err, "error");
   }
 
   std::string getBody() {
     psResp.set("jsonrpc", std::string("2.0"));
-    return psResp.toString();
+    return appendMember(psResp.toString(), "result", result);
   }
 
   template <typename T>
   bool setResult(const T& v) {
-    psResp.set("result", storeToJsonValue(v));
+    result = storeToJson(v);
     return true;
   }
 
   template <typename T>
   bool getResult(T& v) const {
-    if (!psResp.contains("result")) {
-      return false;
-    }
-
-    loadFromJsonValue(v, psResp("result"));
-    return true;
+    return input && (*input)(v, "result");
   }
 
 private:
+  // parsed response, the envelope being built is kept in psResp
+  std::unique_ptr<JsonInputStreamSerializer> input;
   Common::JsonValue psResp;
+  std::string result;
 };
 
 
@@ -20,10 +20,15 @@
 #include <future>
 #include <unordered_map>
 
+#include <System/ContextGroup.h>
+#include <System/InterruptedException.h>
+#include <System/Timer.h>
+
 // CryptoNote
 #include "Common/StringTools.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/MessageQueue.h"
 #include "CryptoNoteCore/Miner.h"
 #include "CryptoNoteCore/TransactionExtra.h"
 
@@ -68,6 +73,15 @@ void serialize(BlockShortInfo& blockShortInfo, ISerializer& s) {
 
 namespace {
 
+// upper bound for long poll requests, so idle connections are recycled
+const uint32_t MAX_WAIT_FOR_CHANGES_TIMEOUT = 60000;
+const uint32_t MAX_SCANNED_BLOCKS_COUNT = 1000;
+const uint32_t MAX_BLOCK_FILTERS_COUNT = 10000;
+const size_t VIEW_KEY_SCANNER_CACHED_BLOCKS = 10000;
+// every registered account costs a key derivation per scanned transaction
+const size_t VIEW_KEY_SCANNER_MAX_ACCOUNTS = 1000;
+const char VIEW_KEY_SCANNING_DISABLED[] = "View key scanning is disabled";
+
 template <typename Command>
 RpcServer::HandlerFunction binMethod(bool (RpcServer::*handler)(typename Command::request const&, typename Command::response&)) {
   return [handler](RpcServer* obj, const HttpRequest& request, HttpResponse& response) {
@@ -115,6 +129,11 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
   { "/getrandom_outs.bin", { binMethod<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS>(&RpcServer::on_get_random_outs), false } },
   { "/get_pool_changes.bin", { binMethod<COMMAND_RPC_GET_POOL_CHANGES>(&RpcServer::onGetPoolChanges), false } },
   { "/get_pool_changes_lite.bin", { binMethod<COMMAND_RPC_GET_POOL_CHANGES_LITE>(&RpcServer::onGetPoolChangesLite), false } },
+  { "/wait_for_changes.bin", { binMethod<COMMAND_RPC_WAIT_FOR_CHANGES>(&RpcServer::onWaitForChanges), false } },
+  { "/register_view_keys.bin", { binMethod<COMMAND_RPC_REGISTER_VIEW_KEYS>(&RpcServer::onRegisterViewKeys), true } },
+  { "/unregister_view_keys.bin", { binMethod<COMMAND_RPC_UNREGISTER_VIEW_KEYS>(&RpcServer::onUnregisterViewKeys), true } },
+  { "/scan_blocks.bin", { binMethod<COMMAND_RPC_SCAN_BLOCKS>(&RpcServer::onScanBlocks), false } },
+  { "/get_block_filters.bin", { binMethod<COMMAND_RPC_GET_BLOCK_FILTERS>(&RpcServer::onGetBlockFilters), false } },
   { "/get_blocks_details_by_hashes.bin", { binMethod<COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES>(&RpcServer::onGetBlocksDetailsByHashes), false } },
   { "/get_blocks_hashes_by_timestamps.bin", { binMethod<COMMAND_RPC_GET_BLOCKS_HASHES_BY_TIMESTAMPS>(&RpcServer::onGetBlocksHashesByTimestamps), false } },
   { "/get_transaction_details_by_hashes.bin", { binMethod<COMMAND_RPC_GET_TRANSACTION_DETAILS_BY_HASHES>(&RpcServer::onGetTransactionDetailsByHashes), false } },
@@ -135,6 +154,10 @@ RpcServer::RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, Core
   HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocol(protocol) {
 }
 
+void RpcServer::enableViewKeyScanning(size_t threadCount) {
+  m_viewKeyScanner.reset(new ViewKeyScanner(m_dispatcher, threadCount, VIEW_KEY_SCANNER_CACHED_BLOCKS, VIEW_KEY_SCANNER_MAX_ACCOUNTS));
+}
+
 void RpcServer::processRequest(const HttpRequest& request, HttpResponse& response) {
   auto url = request.getUrl();
   if (url.find(".bin") == std::string::npos) {
@@ -341,14 +364,117 @@ bool RpcServer::onGetPoolChangesLite(const COMMAND_RPC_GET_POOL_CHANGES_LITE::re
   return true;
 }
 
-bool RpcServer::onGetBlocksDetailsByHashes(const COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES::request& req, COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES::response& rsp) {
+bool RpcServer::onWaitForChanges(const COMMAND_RPC_WAIT_FOR_CHANGES::request& req, COMMAND_RPC_WAIT_FOR_CHANGES::response& rsp) {
+  // subscribe before checking the state, so no change is missed in between
+  MessageQueue<BlockchainMessage> messageQueue(m_dispatcher);
+  MesageQueueGuard<Core, BlockchainMessage> messageQueueGuard(m_core, messageQueue);
+
+  auto getPoolDigest = [this] {
+    auto poolTransactions = m_core.getPoolTransactionHashes();
+    return getTransactionsSetDigest(poolTransactions.begin(), poolTransactions.end());
+  };
+
+  if (m_core.getTopBlockHash() == req.knownBlockId && getPoolDigest() == req.knownPoolDigest) {
+    bool timedOut = false;
+    System::ContextGroup timeoutContext(m_dispatcher);
+    timeoutContext.spawn([&] {
+      System::Timer(m_dispatcher).sleep(std::chrono::milliseconds(std::min(req.timeout, MAX_WAIT_FOR_CHANGES_TIMEOUT)));
+      timedOut = true;
+      messageQueue.stop();
+    });
+
+    try {
+      // alternative blocks change neither top block nor pool
+      while (messageQueue.front().getType() == BlockchainMessage::Type::NewAlternativeBlock) {
+        messageQueue.pop();
+      }
+    } catch (System::InterruptedException&) {
+      if (!timedOut) {
+        throw;
+      }
+    }
+  }
+
+  rsp.topBlockId = m_core.getTopBlockHash();
+  rsp.poolDigest = getPoolDigest();
+  rsp.status = CORE_RPC_STATUS_OK;
+  return true;
+}
+
+bool RpcServer::onRegisterViewKeys(const COMMAND_RPC_REGISTER_VIEW_KEYS::request& req, COMMAND_RPC_REGISTER_VIEW_KEYS::response& rsp) {
+  if (!m_viewKeyScanner) {
+    rsp.status = VIEW_KEY_SCANNING_DISABLED;
+    return false;
+  }
+
   try {
-    std::vector<BlockDetails> blockDetails;
-    for (const Crypto::Hash& hash : req.blockHashes) {
-      blockDetails.push_back(m_core.getBlockDetails(hash));
+    for (const auto& account : req.accounts) {
+      m_viewKeyScanner->addAccount(account.address, account.viewSecretKey);
     }
+  } catch (std::exception& e) {
+    rsp.status = "Error: " + std::string(e.what());
+    return false;
+  }
+
+  logger(DEBUGGING) << "View key scanning accounts registered: " << m_viewKeyScanner->getAccountCount();
+  rsp.status = CORE_RPC_STATUS_OK;
+  return true;
+}
+
+bool RpcServer::onUnregisterViewKeys(const COMMAND_RPC_UNREGISTER_VIEW_KEYS::request& req, COMMAND_RPC_UNREGISTER_VIEW_KEYS::response& rsp) {
+  if (!m_viewKeyScanner) {
+    rsp.status = VIEW_KEY_SCANNING_DISABLED;
+    return false;
+  }
 
-    rsp.blocks = std::move(blockDetails);
+  for (const auto& address : req.addresses) {
+    m_viewKeyScanner->removeAccount(address);
+  }
+
+  rsp.status = CORE_RPC_STATUS_OK;
+  return true;
+}
+
+bool RpcServer::onScanBlocks(const COMMAND_RPC_SCAN_BLOCKS::request& req, COMMAND_RPC_SCAN_BLOCKS::response& rsp) {
+  if (!m_viewKeyScanner) {
+    rsp.status = VIEW_KEY_SCANNING_DISABLED;
+    return false;
+  }
+
+  rsp.scannedCount = 0;
+  uint32_t topIndex = m_core.getTopBlockIndex();
+  if (req.startIndex <= topIndex && req.count != 0) {
+    uint32_t count = std::min(std::min(req.count, MAX_SCANNED_BLOCKS_COUNT), topIndex - req.startIndex + 1);
+
+    try {
+      auto blocks = m_core.getBlocks(req.startIndex, count);
+      rsp.transactions = m_viewKeyScanner->scan(req.startIndex, blocks);
+      rsp.scannedCount = static_cast<uint32_t>(blocks.size());
+    } catch (std::exception& e) {
+      rsp.status = "Error: " + std::string(e.what());
+      return false;
+    }
+  }
+
+  rsp.status = CORE_RPC_STATUS_OK;
+  return true;
+}
+
+bool RpcServer::onGetBlockFilters(const COMMAND_RPC_GET_BLOCK_FILTERS::request& req, COMMAND_RPC_GET_BLOCK_FILTERS::response& rsp) {
+  try {
+    rsp.filters = m_core.getBlockFilters(req.startIndex, std::min(req.count, MAX_BLOCK_FILTERS_COUNT));
+  } catch (std::exception& e) {
+    rsp.status = "Error: " + std::string(e.what());
+    return false;
+  }
+
+  rsp.status = CORE_RPC_STATUS_OK;
+  return true;
+}
+
+bool RpcServer::onGetBlocksDetailsByHashes(const COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES::request& req, COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES::response& rsp) {
+  try {
+    rsp.blocks = m_core.getBlocksDetails(req.blockHashes);
   } catch (std::system_error& e) {
     rsp.status = e.what();
     return false;
@@ -18,10 +18,12 @@
 #include "HttpServer.h"
 
 #include <functional>
+#include <memory>
 #include <unordered_map>
 
 #include <Logging/LoggerRef.h>
 #include "CoreRpcServerCommandsDefinitions.h"
+#include "ViewKeyScanner.h"
 
 namespace CryptoNote {
 
@@ -35,6 +37,9 @@ public:
 
   typedef std::function<bool(RpcServer*, const HttpRequest& request, HttpResponse& response)> HandlerFunction;
 
+  // view key scanning endpoints answer with an error until enabled
+  void enableViewKeyScanning(size_t threadCount);
+
 private:
 
   template <class Handler>
@@ -58,6 +63,11 @@ private:
   bool on_get_random_outs(const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request& req, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::response& res);
   bool onGetPoolChanges(const COMMAND_RPC_GET_POOL_CHANGES::request& req, COMMAND_RPC_GET_POOL_CHANGES::response& rsp);
   bool onGetPoolChangesLite(const COMMAND_RPC_GET_POOL_CHANGES_LITE::request& req, COMMAND_RPC_GET_POOL_CHANGES_LITE::response& rsp);
+  bool onWaitForChanges(const COMMAND_RPC_WAIT_FOR_CHANGES::request& req, COMMAND_RPC_WAIT_FOR_CHANGES::response& rsp);
+  bool onRegisterViewKeys(const COMMAND_RPC_REGISTER_VIEW_KEYS::request& req, COMMAND_RPC_REGISTER_VIEW_KEYS::response& rsp);
+  bool onUnregisterViewKeys(const COMMAND_RPC_UNREGISTER_VIEW_KEYS::request& req, COMMAND_RPC_UNREGISTER_VIEW_KEYS::response& rsp);
+  bool onScanBlocks(const COMMAND_RPC_SCAN_BLOCKS::request& req, COMMAND_RPC_SCAN_BLOCKS::response& rsp);
+  bool onGetBlockFilters(const COMMAND_RPC_GET_BLOCK_FILTERS::request& req, COMMAND_RPC_GET_BLOCK_FILTERS::response& rsp);
   bool onGetBlocksDetailsByHashes(const COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES::request& req, COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES::response& rsp);
   bool onGetBlocksHashesByTimestamps(const COMMAND_RPC_GET_BLOCKS_HASHES_BY_TIMESTAMPS::request& req, COMMAND_RPC_GET_BLOCKS_HASHES_BY_TIMESTAMPS::response& rsp);
   bool onGetTransactionDetailsByHashes(const COMMAND_RPC_GET_TRANSACTION_DETAILS_BY_HASHES::request& req, COMMAND_RPC_GET_TRANSACTION_DETAILS_BY_HASHES::response& rsp);
@@ -87,6 +97,7 @@ private:
   Core& m_core;
   NodeServer& m_p2p;
   ICryptoNoteProtocolHandler& m_protocol;
+  std::unique_ptr<ViewKeyScanner> m_viewKeyScanner;
 };
 
 }
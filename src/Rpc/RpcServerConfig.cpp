@@ -28,10 +28,13 @@ namespace CryptoNote {
 
     const command_line::arg_descriptor<std::string> arg_rpc_bind_ip = { "rpc-bind-ip", "", DEFAULT_RPC_IP };
     const command_line::arg_descriptor<uint16_t> arg_rpc_bind_port = { "rpc-bind-port", "", DEFAULT_RPC_PORT };
+    const command_line::arg_descriptor<bool> arg_enable_view_key_scanning = { "enable-view-key-scanning",
+      "Allow RPC clients to register view keys and scan blocks for them on the node. Registered accounts are shared, "
+      "any RPC client gets transactions of all of them from /scan_blocks.bin. For trusted private nodes only", false };
   }
 
 
-  RpcServerConfig::RpcServerConfig() : bindIp(DEFAULT_RPC_IP), bindPort(DEFAULT_RPC_PORT) {
+  RpcServerConfig::RpcServerConfig() : bindIp(DEFAULT_RPC_IP), bindPort(DEFAULT_RPC_PORT), enableViewKeyScanning(false) {
   }
 
   std::string RpcServerConfig::getBindAddress() const {
@@ -41,11 +44,13 @@ namespace CryptoNote {
   void RpcServerConfig::initOptions(boost::program_options::options_description& desc) {
     command_line::add_arg(desc, arg_rpc_bind_ip);
     command_line::add_arg(desc, arg_rpc_bind_port);
+    command_line::add_arg(desc, arg_enable_view_key_scanning);
   }
 
   void RpcServerConfig::init(const boost::program_options::variables_map& vm)  {
     bindIp = command_line::get_arg(vm, arg_rpc_bind_ip);
     bindPort = command_line::get_arg(vm, arg_rpc_bind_port);
+    enableViewKeyScanning = command_line::get_arg(vm, arg_enable_view_key_scanning);
   }
 
 }
@@ -0,0 +1,219 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "ViewKeyScanner.h"
+
+#include <algorithm>
+#include <functional>
+
+#include <System/Dispatcher.h>
+#include <System/RemoteContext.h>
+
+#include "CryptoNoteCore/CachedBlock.h"
+#include "CryptoNoteCore/CachedTransaction.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/TransactionApi.h"
+#include "CryptoNoteCore/TransactionUtils.h"
+
+namespace CryptoNote {
+
+ViewKeyScanner::ViewKeyScanner(System::Dispatcher& dispatcher, size_t threadCount, size_t maxCachedBlocks, size_t maxAccounts) :
+  m_dispatcher(dispatcher), m_threadCount(std::max<size_t>(threadCount, 1)), m_maxCachedBlocks(maxCachedBlocks),
+  m_maxAccounts(maxAccounts), m_accounts(std::make_shared<const Accounts>()), m_accountsVersion(0) {
+}
+
+void ViewKeyScanner::addAccount(const AccountPublicAddress& address, const Crypto::SecretKey& viewSecretKey) {
+  Crypto::PublicKey viewPublicKey;
+  if (!Crypto::secret_key_to_public_key(viewSecretKey, viewPublicKey) || viewPublicKey != address.viewPublicKey) {
+    throw std::invalid_argument("View secret key doesn't match address");
+  }
+
+  Accounts accounts(*m_accounts);
+  auto it = std::find_if(accounts.begin(), accounts.end(), [&](const ViewKeyAccounts& viewKeyAccounts) {
+    return viewKeyAccounts.viewSecretKey == viewSecretKey;
+  });
+
+  if (it != accounts.end() && it->spendPublicKeys.count(address.spendPublicKey) != 0) {
+    return;
+  }
+
+  if (getAccountCount() >= m_maxAccounts) {
+    throw std::runtime_error("Too many registered accounts, limit is " + std::to_string(m_maxAccounts));
+  }
+
+  if (it == accounts.end()) {
+    accounts.push_back({ viewSecretKey, { address.spendPublicKey } });
+  } else {
+    it->spendPublicKeys.insert(address.spendPublicKey);
+  }
+
+  updateAccounts(std::move(accounts));
+}
+
+bool ViewKeyScanner::removeAccount(const AccountPublicAddress& address) {
+  Accounts accounts(*m_accounts);
+  for (auto it = accounts.begin(); it != accounts.end(); ++it) {
+    if (it->spendPublicKeys.erase(address.spendPublicKey) != 0) {
+      if (it->spendPublicKeys.empty()) {
+        accounts.erase(it);
+      }
+
+      updateAccounts(std::move(accounts));
+      return true;
+    }
+  }
+
+  return false;
+}
+
+size_t ViewKeyScanner::getAccountCount() const {
+  size_t count = 0;
+  for (const auto& viewKeyAccounts : *m_accounts) {
+    count += viewKeyAccounts.spendPublicKeys.size();
+  }
+
+  return count;
+}
+
+size_t ViewKeyScanner::getCachedBlockCount() const {
+  std::lock_guard<std::mutex> lock(m_cacheMutex);
+  return m_cache.size();
+}
+
+std::vector<ScannedTransaction> ViewKeyScanner::scan(uint32_t startIndex, const std::vector<RawBlock>& blocks) {
+  std::shared_ptr<const Accounts> accounts = m_accounts;
+  uint64_t accountsVersion = m_accountsVersion;
+
+  std::vector<std::vector<ScannedTransaction>> blockTransactions(blocks.size());
+  auto job = [&](size_t firstIndex, size_t step) {
+    for (size_t i = firstIndex; i < blocks.size(); i += step) {
+      blockTransactions[i] = scanBlock(*accounts, accountsVersion, startIndex + static_cast<uint32_t>(i), blocks[i]);
+    }
+  };
+
+  size_t threadCount = std::min(m_threadCount, blocks.size());
+  std::vector<std::unique_ptr<System::RemoteContext<>>> workers;
+  workers.reserve(threadCount);
+  for (size_t i = 0; i < threadCount; ++i) {
+    workers.emplace_back(new System::RemoteContext<>(m_dispatcher, std::bind(job, i, threadCount)));
+  }
+
+  for (auto& worker : workers) {
+    worker->get();
+  }
+
+  std::vector<ScannedTransaction> transactions;
+  for (auto& scannedTransactions : blockTransactions) {
+    std::move(scannedTransactions.begin(), scannedTransactions.end(), std::back_inserter(transactions));
+  }
+
+  return transactions;
+}
+
+std::vector<ScannedTransaction> ViewKeyScanner::scanBlock(const Accounts& accounts, uint64_t accountsVersion, uint32_t blockIndex,
+  const RawBlock& rawBlock) {
+  BlockTemplate block;
+  if (!fromBinaryArray(block, rawBlock.block)) {
+    throw std::runtime_error("Couldn't deserialize block " + std::to_string(blockIndex));
+  }
+
+  Crypto::Hash blockHash = CachedBlock(block).getBlockHash();
+
+  std::vector<ScannedTransaction> transactions;
+  if (accounts.empty() || findCachedScan(blockHash, accountsVersion, transactions)) {
+    return transactions;
+  }
+
+  auto scanTransaction = [&](const TransactionPrefix& prefix, const Crypto::Hash& transactionHash) {
+    auto transaction = createTransactionPrefix(prefix, transactionHash);
+
+    ScannedTransaction scannedTransaction;
+    for (const auto& viewKeyAccounts : accounts) {
+      std::unordered_map<Crypto::PublicKey, std::vector<uint32_t>> outputs;
+      findMyOutputs(*transaction, viewKeyAccounts.viewSecretKey, viewKeyAccounts.spendPublicKeys, outputs);
+      for (const auto& accountOutputs : outputs) {
+        for (uint32_t outputIndex : accountOutputs.second) {
+          scannedTransaction.outputs.push_back({ accountOutputs.first, outputIndex });
+        }
+      }
+    }
+
+    if (!scannedTransaction.outputs.empty()) {
+      std::sort(scannedTransaction.outputs.begin(), scannedTransaction.outputs.end(), [](const ScannedOutput& a, const ScannedOutput& b) {
+        return a.outputIndex < b.outputIndex;
+      });
+
+      scannedTransaction.blockIndex = blockIndex;
+      scannedTransaction.blockHash = blockHash;
+      scannedTransaction.transaction.txHash = transactionHash;
+      scannedTransaction.transaction.txPrefix = prefix;
+      transactions.push_back(std::move(scannedTransaction));
+    }
+  };
+
+  scanTransaction(block.baseTransaction, getObjectHash(block.baseTransaction));
+  for (const auto& binaryTransaction : rawBlock.transactions) {
+    CachedTransaction transaction(binaryTransaction);
+    scanTransaction(transaction.getTransaction(), transaction.getTransactionHash());
+  }
+
+  cacheScan(blockHash, accountsVersion, transactions);
+  return transactions;
+}
+
+bool ViewKeyScanner::findCachedScan(const Crypto::Hash& blockHash, uint64_t accountsVersion, std::vector<ScannedTransaction>& transactions) {
+  std::lock_guard<std::mutex> lock(m_cacheMutex);
+  auto it = m_cache.find(blockHash);
+  if (it == m_cache.end() || it->second.accountsVersion != accountsVersion) {
+    return false;
+  }
+
+  m_cacheLru.splice(m_cacheLru.end(), m_cacheLru, it->second.lruIterator);
+  transactions = it->second.transactions;
+  return true;
+}
+
+void ViewKeyScanner::cacheScan(const Crypto::Hash& blockHash, uint64_t accountsVersion, const std::vector<ScannedTransaction>& transactions) {
+  std::lock_guard<std::mutex> lock(m_cacheMutex);
+  if (m_maxCachedBlocks == 0 || accountsVersion != m_accountsVersion) {
+    return;
+  }
+
+  auto it = m_cache.find(blockHash);
+  if (it != m_cache.end()) {
+    m_cacheLru.erase(it->second.lruIterator);
+    m_cache.erase(it);
+  } else if (m_cache.size() == m_maxCachedBlocks) {
+    m_cache.erase(m_cacheLru.front());
+    m_cacheLru.pop_front();
+  }
+
+  auto lruIterator = m_cacheLru.insert(m_cacheLru.end(), blockHash);
+  m_cache.emplace(blockHash, CachedBlockScan{ accountsVersion, transactions, lruIterator });
+}
+
+void ViewKeyScanner::updateAccounts(Accounts&& accounts) {
+  m_accounts = std::make_shared<const Accounts>(std::move(accounts));
+
+  // cached results were found for the previous accounts
+  std::lock_guard<std::mutex> lock(m_cacheMutex);
+  ++m_accountsVersion;
+  m_cache.clear();
+  m_cacheLru.clear();
+}
+
+}
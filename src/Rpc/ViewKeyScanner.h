@@ -0,0 +1,87 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "CoreRpcServerCommandsDefinitions.h"
+
+namespace System {
+class Dispatcher;
+}
+
+namespace CryptoNote {
+
+// Finds transactions with outputs to registered accounts. Blocks are scanned by worker threads and results are cached
+// by block hash, so clients requesting the same range don't repeat key derivations. Accounts are registered and blocks
+// are scanned from dispatcher thread. Accounts aren't tied to the client that registered them, every scan reports
+// transactions of all registered accounts.
+class ViewKeyScanner {
+public:
+  ViewKeyScanner(System::Dispatcher& dispatcher, size_t threadCount, size_t maxCachedBlocks, size_t maxAccounts);
+
+  // throws std::invalid_argument if view secret key doesn't match the address,
+  // std::runtime_error if a new account would exceed maxAccounts
+  void addAccount(const AccountPublicAddress& address, const Crypto::SecretKey& viewSecretKey);
+  bool removeAccount(const AccountPublicAddress& address);
+  size_t getAccountCount() const;
+  size_t getCachedBlockCount() const;
+
+  // blocks[i] has index startIndex + i, throws std::runtime_error if a block can't be parsed
+  std::vector<ScannedTransaction> scan(uint32_t startIndex, const std::vector<RawBlock>& blocks);
+
+private:
+  // accounts sharing one view key are checked with one key derivation per transaction
+  struct ViewKeyAccounts {
+    Crypto::SecretKey viewSecretKey;
+    std::unordered_set<Crypto::PublicKey> spendPublicKeys;
+  };
+
+  typedef std::vector<ViewKeyAccounts> Accounts;
+
+  struct CachedBlockScan {
+    uint64_t accountsVersion;
+    std::vector<ScannedTransaction> transactions;
+    std::list<Crypto::Hash>::iterator lruIterator;
+  };
+
+  std::vector<ScannedTransaction> scanBlock(const Accounts& accounts, uint64_t accountsVersion, uint32_t blockIndex, const RawBlock& block);
+  bool findCachedScan(const Crypto::Hash& blockHash, uint64_t accountsVersion, std::vector<ScannedTransaction>& transactions);
+  void cacheScan(const Crypto::Hash& blockHash, uint64_t accountsVersion, const std::vector<ScannedTransaction>& transactions);
+  void updateAccounts(Accounts&& accounts);
+
+  System::Dispatcher& m_dispatcher;
+  const size_t m_threadCount;
+  const size_t m_maxCachedBlocks;
+  const size_t m_maxAccounts;
+
+  // replaced on every change, so scans in progress keep a consistent copy
+  std::shared_ptr<const Accounts> m_accounts;
+  uint64_t m_accountsVersion;
+
+  mutable std::mutex m_cacheMutex;
+  std::unordered_map<Crypto::Hash, CachedBlockScan> m_cache;
+  std::list<Crypto::Hash> m_cacheLru;
+};
+
+}
@@ -121,12 +121,34 @@ bool BinaryInputStreamSerializer::binary(std::string& value, Common::StringView
   return (*this)(value, name);
 }
 
+bool BinaryInputStreamSerializer::binaryArray(void* value, size_t elementSize, size_t count) {
+  checkedRead(static_cast<char*>(value), elementSize * count);
+  return true;
+}
+
+bool BinaryInputStreamSerializer::varintArray(uint32_t* value, size_t count) {
+  readVarintArray(value, count);
+  return true;
+}
+
+bool BinaryInputStreamSerializer::varintArray(uint64_t* value, size_t count) {
+  readVarintArray(value, count);
+  return true;
+}
+
 bool BinaryInputStreamSerializer::operator()(double& value, Common::StringView name) {
   assert(false); //the method is not supported for this type of serialization
   throw std::runtime_error("double serialization is not supported in BinaryInputStreamSerializer");
   return false;
 }
 
+template<typename T>
+void BinaryInputStreamSerializer::readVarintArray(T* value, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    readVarint(stream, value[i]);
+  }
+}
+
 void BinaryInputStreamSerializer::checkedRead(char* buf, size_t size) {
   read(stream, buf, size);
 }
@@ -48,6 +48,9 @@ public:
   virtual bool operator()(std::string& value, Common::StringView name) override;
   virtual bool binary(void* value, size_t size, Common::StringView name) override;
   virtual bool binary(std::string& value, Common::StringView name) override;
+  virtual bool binaryArray(void* value, size_t elementSize, size_t count) override;
+  virtual bool varintArray(uint32_t* value, size_t count) override;
+  virtual bool varintArray(uint64_t* value, size_t count) override;
 
   template<typename T>
   bool operator()(T& value, Common::StringView name) {
@@ -55,7 +58,7 @@ public:
   }
 
 private:
-
+  template<typename T> void readVarintArray(T* value, size_t count);
   void checkedRead(char* buf, size_t size);
   Common::IInputStream& stream;
 };
@@ -17,9 +17,12 @@
 
 #include "BinaryOutputStreamSerializer.h"
 
+#include <algorithm>
 #include <cassert>
+#include <limits>
 #include <stdexcept>
 #include "Common/StreamTools.h"
+#include "Common/Varint.h"
 
 using namespace Common;
 
@@ -101,12 +104,46 @@ bool BinaryOutputStreamSerializer::binary(std::string& value, Common::StringView
   return (*this)(value, name);
 }
 
+bool BinaryOutputStreamSerializer::binaryArray(void* value, size_t elementSize, size_t count) {
+  checkedWrite(static_cast<const char*>(value), elementSize * count);
+  return true;
+}
+
+bool BinaryOutputStreamSerializer::varintArray(uint32_t* value, size_t count) {
+  writeVarintArray(value, count);
+  return true;
+}
+
+bool BinaryOutputStreamSerializer::varintArray(uint64_t* value, size_t count) {
+  writeVarintArray(value, count);
+  return true;
+}
+
 bool BinaryOutputStreamSerializer::operator()(double& value, Common::StringView name) {
   assert(false); //the method is not supported for this type of serialization
   throw std::runtime_error("double serialization is not supported in BinaryOutputStreamSerializer");
   return false;
 }
 
+template<typename T>
+void BinaryOutputStreamSerializer::writeVarintArray(const T* value, size_t count) {
+  const size_t MAX_VARINT_SIZE = (std::numeric_limits<T>::digits + 6) / 7;
+  const size_t CHUNK_SIZE = 256;
+
+  char buffer[CHUNK_SIZE * MAX_VARINT_SIZE];
+  while (count > 0) {
+    size_t chunk = std::min(count, CHUNK_SIZE);
+    char* end = buffer;
+    for (size_t i = 0; i < chunk; ++i) {
+      Tools::write_varint(end, value[i]);
+    }
+
+    checkedWrite(buffer, end - buffer);
+    value += chunk;
+    count -= chunk;
+  }
+}
+
 void BinaryOutputStreamSerializer::checkedWrite(const char* buf, size_t size) {
   write(stream, buf, size);
 }
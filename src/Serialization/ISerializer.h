@@ -56,6 +56,11 @@ public:
   virtual bool binary(void* value, size_t size, Common::StringView name) = 0;
   virtual bool binary(std::string& value, Common::StringView name) = 0;
 
+  // read/write contiguous array elements at once, return false if they have to be serialized one by one
+  virtual bool binaryArray(void* value, size_t elementSize, size_t count) { return false; }
+  virtual bool varintArray(uint32_t* value, size_t count) { return false; }
+  virtual bool varintArray(uint64_t* value, size_t count) { return false; }
+
   template<typename T>
   bool operator()(T& value, Common::StringView name);
 };
@@ -15,27 +15,553 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
 
+
 #include "Serialization/JsonInputStreamSerializer.h"
 
-#include <ctype.h>
-#include <exception>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <istream>
+#include <limits>
+#include <stdexcept>
+
+#include "Common/StringTools.h"
 
 namespace CryptoNote {
 
 namespace {
 
-Common::JsonValue getJsonValueFromStreamHelper(std::istream& stream) {
-  Common::JsonValue value;
-  stream >> value;
-  return value;
+const size_t MAX_NESTING_DEPTH = 100;
+const uint64_t ONES = UINT64_C(0x0101010101010101);
+const uint64_t HIGH_BITS = UINT64_C(0x8080808080808080);
+
+// Checks 8 bytes at once whether any of them equals 'character'
+bool containsByte(uint64_t word, char character) {
+  uint64_t value = word ^ (ONES * static_cast<uint8_t>(character));
+  return ((value - ONES) & ~value & HIGH_BITS) != 0;
+}
+
+void throwUnexpectedEnd() {
+  throw std::runtime_error("Unable to parse: unexpected end of data");
+}
+
+void skipWhitespace(const char*& position, const char* end) {
+  while (position != end && (*position == ' ' || *position == '\n' || *position == '\r' || *position == '\t')) {
+    ++position;
+  }
+}
+
+char readNonWsChar(const char*& position, const char* end) {
+  skipWhitespace(position, end);
+  if (position == end) {
+    throwUnexpectedEnd();
+  }
+
+  return *position++;
+}
+
+void readLiteral(const char*& position, const char* end, const char* literal, size_t size) {
+  if (static_cast<size_t>(end - position) < size || memcmp(position, literal, size) != 0) {
+    throw std::runtime_error("Unable to parse");
+  }
+
+  position += size;
+}
+
+// Position is after opening quote, returns string contents without quotes
+Common::StringView readStringToken(const char*& position, const char* end) {
+  const char* start = position;
+  for (;;) {
+    while (end - position >= 8) {
+      uint64_t word;
+      memcpy(&word, position, sizeof(word));
+      if (containsByte(word, '"') || containsByte(word, '\\')) {
+        break;
+      }
+
+      position += 8;
+    }
+
+    if (position == end) {
+      throwUnexpectedEnd();
+    }
+
+    char c = *position++;
+    if (c == '"') {
+      return Common::StringView(start, position - 1 - start);
+    }
+
+    if (c == '\\') {
+      if (position == end) {
+        throwUnexpectedEnd();
+      }
+
+      ++position;
+    }
+  }
+}
+
+bool isDigit(const char* position, const char* end) {
+  return position != end && *position >= '0' && *position <= '9';
+}
+
+void readDigits(const char*& position, const char* end) {
+  if (!isDigit(position, end)) {
+    throw std::runtime_error("Unable to parse");
+  }
+
+  do {
+    ++position;
+  } while (isDigit(position, end));
+}
+
+int64_t parseInteger(const char* data, size_t size) {
+  const char* position = data;
+  const char* end = data + size;
+  bool negative = *position == '-';
+  if (negative) {
+    ++position;
+  }
+
+  uint64_t value = 0;
+  for (; position != end; ++position) {
+    uint64_t digit = *position - '0';
+    if (value > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+      throw std::runtime_error("Integer value is out of range");
+    }
+
+    value = value * 10 + digit;
+  }
+
+  if (negative) {
+    if (value > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1) {
+      throw std::runtime_error("Integer value is out of range");
+    }
+
+    return static_cast<int64_t>(0 - value);
+  }
+
+  // values above int64 maximum are kept as their two's complement, as unsigned fields are written
+  return static_cast<int64_t>(value);
+}
+
+void fromHex(const char* text, size_t textSize, void* data, size_t bufferSize) {
+  if ((textSize & 1) != 0) {
+    throw std::runtime_error("fromHex: invalid string size");
+  }
+
+  if (textSize >> 1 > bufferSize) {
+    throw std::runtime_error("fromHex: invalid buffer size");
+  }
+
+  for (size_t i = 0; i < textSize >> 1; ++i) {
+    static_cast<uint8_t*>(data)[i] = Common::fromHex(text[i << 1]) << 4 | Common::fromHex(text[(i << 1) + 1]);
+  }
+}
+
+}
+
+JsonInputStreamSerializer::JsonInputStreamSerializer(std::istream& stream) :
+  buffer(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()) {
+  parse(buffer.data(), buffer.size());
 }
 
+JsonInputStreamSerializer::JsonInputStreamSerializer(std::string&& data) : buffer(std::move(data)) {
+  parse(buffer.data(), buffer.size());
 }
 
-JsonInputStreamSerializer::JsonInputStreamSerializer(std::istream& stream) : JsonInputValueSerializer(getJsonValueFromStreamHelper(stream)) {
+JsonInputStreamSerializer::JsonInputStreamSerializer(const char* data, size_t size) {
+  parse(data, size);
 }
 
 JsonInputStreamSerializer::~JsonInputStreamSerializer() {
 }
 
+ISerializer::SerializerType JsonInputStreamSerializer::type() const {
+  return ISerializer::INPUT;
+}
+
+void JsonInputStreamSerializer::parse(const char* data, size_t size) {
+  const char* position = data;
+  parseValue(position, data + size, Common::StringView(), 0);
+  skipWhitespace(position, data + size);
+  if (position != data + size) {
+    throw std::runtime_error("Unable to parse: unexpected data after value");
+  }
+
+  if (values.front().type != OBJECT) {
+    throw std::runtime_error("Serializer doesn't support this type of serialization: Object expected.");
+  }
+
+  chain.push_back(Level{0, 1});
+}
+
+void JsonInputStreamSerializer::parseValue(const char*& position, const char* end, Common::StringView name, size_t depth) {
+  if (depth > MAX_NESTING_DEPTH) {
+    throw std::runtime_error("Unable to parse: nesting is too deep");
+  }
+
+  char c = readNonWsChar(position, end);
+  switch (c) {
+  case '{':
+    parseObject(position, end, name, depth);
+    break;
+
+  case '[':
+    parseArray(position, end, name, depth);
+    break;
+
+  case '"': {
+    Common::StringView text = readStringToken(position, end);
+    values.push_back(Value{name, STRING, text.getData(), text.getSize(), values.size() + 1});
+    break;
+  }
+
+  case 't':
+    readLiteral(position, end, "rue", 3);
+    values.push_back(Value{name, BOOL, nullptr, 1, values.size() + 1});
+    break;
+
+  case 'f':
+    readLiteral(position, end, "alse", 4);
+    values.push_back(Value{name, BOOL, nullptr, 0, values.size() + 1});
+    break;
+
+  case 'n':
+    readLiteral(position, end, "ull", 3);
+    values.push_back(Value{name, NIL, nullptr, 0, values.size() + 1});
+    break;
+
+  default: {
+    if (c != '-' && (c < '0' || c > '9')) {
+      throw std::runtime_error("Unable to parse");
+    }
+
+    const char* start = position - 1;
+    if (c == '-') {
+      readDigits(position, end);
+    } else {
+      while (isDigit(position, end)) {
+        ++position;
+      }
+    }
+
+    const char* digits = *start == '-' ? start + 1 : start;
+    if (*digits == '0' && position - digits > 1) {
+      throw std::runtime_error("Unable to parse");
+    }
+
+    ValueType type = INTEGER;
+    if (position != end && *position == '.') {
+      ++position;
+      readDigits(position, end);
+      type = REAL;
+    }
+
+    if (position != end && (*position == 'e' || *position == 'E')) {
+      ++position;
+      if (position != end && (*position == '+' || *position == '-')) {
+        ++position;
+      }
+
+      readDigits(position, end);
+      type = REAL;
+    }
+
+    values.push_back(Value{name, type, start, static_cast<size_t>(position - start), values.size() + 1});
+    break;
+  }
+  }
+}
+
+void JsonInputStreamSerializer::parseObject(const char*& position, const char* end, Common::StringView name, size_t depth) {
+  size_t index = values.size();
+  values.push_back(Value{name, OBJECT, nullptr, 0, 0});
+
+  char c = readNonWsChar(position, end);
+  if (c != '}') {
+    for (;;) {
+      if (c != '"') {
+        throw std::runtime_error("Unable to parse");
+      }
+
+      Common::StringView memberName = readStringToken(position, end);
+      if (readNonWsChar(position, end) != ':') {
+        throw std::runtime_error("Unable to parse");
+      }
+
+      parseValue(position, end, memberName, depth + 1);
+      ++values[index].size;
+
+      c = readNonWsChar(position, end);
+      if (c == '}') {
+        break;
+      }
+
+      if (c != ',') {
+        throw std::runtime_error("Unable to parse");
+      }
+
+      c = readNonWsChar(position, end);
+    }
+  }
+
+  values[index].next = values.size();
+}
+
+void JsonInputStreamSerializer::parseArray(const char*& position, const char* end, Common::StringView name, size_t depth) {
+  size_t index = values.size();
+  values.push_back(Value{name, ARRAY, nullptr, 0, 0});
+
+  skipWhitespace(position, end);
+  if (position != end && *position == ']') {
+    ++position;
+  } else {
+    for (;;) {
+      parseValue(position, end, Common::StringView(), depth + 1);
+      ++values[index].size;
+
+      char c = readNonWsChar(position, end);
+      if (c == ']') {
+        break;
+      }
+
+      if (c != ',') {
+        throw std::runtime_error("Unable to parse");
+      }
+    }
+  }
+
+  values[index].next = values.size();
+}
+
+bool JsonInputStreamSerializer::beginObject(Common::StringView name) {
+  const Value* value = getValue(name);
+  if (value == nullptr) {
+    return false;
+  }
+
+  if (value->type != OBJECT) {
+    throw std::runtime_error("JsonValue type is not OBJECT");
+  }
+
+  size_t index = value - values.data();
+  chain.push_back(Level{index, index + 1});
+  return true;
+}
+
+void JsonInputStreamSerializer::endObject() {
+  assert(!chain.empty());
+  chain.pop_back();
+}
+
+bool JsonInputStreamSerializer::beginArray(size_t& size, Common::StringView name) {
+  if (values[chain.back().value].type != OBJECT) {
+    throw std::runtime_error("JsonValue type is not OBJECT");
+  }
+
+  const Value* value = getValue(name);
+  if (value == nullptr) {
+    size = 0;
+    return false;
+  }
+
+  if (value->type != ARRAY) {
+    throw std::runtime_error("JsonValue type is not ARRAY");
+  }
+
+  size_t index = value - values.data();
+  size = value->size;
+  chain.push_back(Level{index, index + 1});
+  return true;
+}
+
+void JsonInputStreamSerializer::endArray() {
+  assert(!chain.empty());
+  chain.pop_back();
+}
+
+bool JsonInputStreamSerializer::operator()(uint16_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputStreamSerializer::operator()(int16_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputStreamSerializer::operator()(uint32_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputStreamSerializer::operator()(int32_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputStreamSerializer::operator()(int64_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputStreamSerializer::operator()(uint64_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputStreamSerializer::operator()(double& value, Common::StringView name) {
+  const Value* ptr = getValue(name);
+  if (ptr == nullptr) {
+    return false;
+  }
+
+  if (ptr->type == INTEGER) {
+    value = static_cast<double>(parseInteger(ptr->data, ptr->size));
+  } else if (ptr->type == REAL) {
+    value = std::strtod(std::string(ptr->data, ptr->size).c_str(), nullptr);
+  } else {
+    throw std::runtime_error("JsonValue type is not REAL");
+  }
+
+  return true;
+}
+
+bool JsonInputStreamSerializer::operator()(uint8_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputStreamSerializer::operator()(std::string& value, Common::StringView name) {
+  const Value* ptr = getValue(name);
+  if (ptr == nullptr) {
+    return false;
+  }
+
+  if (ptr->type != STRING) {
+    throw std::runtime_error("JsonValue type is not STRING");
+  }
+
+  value.assign(ptr->data, ptr->size);
+  return true;
+}
+
+bool JsonInputStreamSerializer::operator()(bool& value, Common::StringView name) {
+  const Value* ptr = getValue(name);
+  if (ptr == nullptr) {
+    return false;
+  }
+
+  if (ptr->type != BOOL) {
+    throw std::runtime_error("JsonValue type is not BOOL");
+  }
+
+  value = ptr->size != 0;
+  return true;
+}
+
+bool JsonInputStreamSerializer::binary(void* value, size_t size, Common::StringView name) {
+  const Value* ptr = getValue(name);
+  if (ptr == nullptr) {
+    return false;
+  }
+
+  if (ptr->type != STRING) {
+    throw std::runtime_error("JsonValue type is not STRING");
+  }
+
+  fromHex(ptr->data, ptr->size, value, size);
+  return true;
+}
+
+bool JsonInputStreamSerializer::binary(std::string& value, Common::StringView name) {
+  const Value* ptr = getValue(name);
+  if (ptr == nullptr) {
+    return false;
+  }
+
+  if (ptr->type != STRING) {
+    throw std::runtime_error("JsonValue type is not STRING");
+  }
+
+  value.resize(ptr->size >> 1);
+  if (!value.empty()) {
+    fromHex(ptr->data, ptr->size, &value[0], value.size());
+  }
+
+  return true;
+}
+
+bool JsonInputStreamSerializer::scalarJson(std::string& json, Common::StringView name) {
+  const Value* ptr = getValue(name);
+  if (ptr == nullptr) {
+    return false;
+  }
+
+  switch (ptr->type) {
+  case NIL:
+    json = "null";
+    break;
+  case BOOL:
+    json = ptr->size != 0 ? "true" : "false";
+    break;
+  case INTEGER:
+  case REAL:
+    json.assign(ptr->data, ptr->size);
+    break;
+  case STRING:
+    // escape sequences are kept in the buffer, so quoting restores the original text
+    json.assign(1, '"');
+    json.append(ptr->data, ptr->size);
+    json += '"';
+    break;
+  default:
+    throw std::runtime_error("JsonValue type is not scalar");
+  }
+
+  return true;
+}
+
+const JsonInputStreamSerializer::Value* JsonInputStreamSerializer::getValue(Common::StringView name) {
+  assert(!chain.empty());
+  Level& level = chain.back();
+  const Value& parent = values[level.value];
+
+  if (parent.type == ARRAY) {
+    if (level.cursor == parent.next) {
+      throw std::out_of_range("JsonValue error. Index out of range");
+    }
+
+    const Value* value = &values[level.cursor];
+    level.cursor = value->next;
+    return value;
+  }
+
+  // Members are usually read in the order they were written, so search starts after the previously found one
+  for (size_t index = level.cursor; index != parent.next; index = values[index].next) {
+    if (values[index].name == name) {
+      level.cursor = values[index].next;
+      return &values[index];
+    }
+  }
+
+  for (size_t index = level.value + 1; index != level.cursor; index = values[index].next) {
+    if (values[index].name == name) {
+      level.cursor = values[index].next;
+      return &values[index];
+    }
+  }
+
+  return nullptr;
+}
+
+bool JsonInputStreamSerializer::getInteger(Common::StringView name, int64_t& value) {
+  const Value* ptr = getValue(name);
+  if (ptr == nullptr) {
+    return false;
+  }
+
+  if (ptr->type != INTEGER) {
+    throw std::runtime_error("JsonValue type is not INTEGER");
+  }
+
+  value = parseInteger(ptr->data, ptr->size);
+  return true;
+}
+
 } //namespace CryptoNote
@@ -15,21 +15,107 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
 
+
 #pragma once
 
 #include <iosfwd>
 #include <string>
 #include <vector>
-#include "../Common/JsonValue.h"
-#include "JsonInputValueSerializer.h"
+#include "ISerializer.h"
 
 namespace CryptoNote {
 
 //deserialization
-class JsonInputStreamSerializer : public JsonInputValueSerializer {
+// Parses JSON in one pass over contiguous buffer into flat index of values without building Common::JsonValue.
+// String values and member names are referenced in the buffer; like Common::JsonValue, escape sequences are kept as is.
+class JsonInputStreamSerializer : public ISerializer {
 public:
+  // Reads the whole stream to the internal buffer
   JsonInputStreamSerializer(std::istream& stream);
+  // Takes ownership of the text
+  JsonInputStreamSerializer(std::string&& data);
+  // Buffer is not copied and must outlive serializer
+  JsonInputStreamSerializer(const char* data, size_t size);
   virtual ~JsonInputStreamSerializer();
+
+  SerializerType type() const override;
+
+  virtual bool beginObject(Common::StringView name) override;
+  virtual void endObject() override;
+
+  virtual bool beginArray(size_t& size, Common::StringView name) override;
+  virtual void endArray() override;
+
+  virtual bool operator()(uint8_t& value, Common::StringView name) override;
+  virtual bool operator()(int16_t& value, Common::StringView name) override;
+  virtual bool operator()(uint16_t& value, Common::StringView name) override;
+  virtual bool operator()(int32_t& value, Common::StringView name) override;
+  virtual bool operator()(uint32_t& value, Common::StringView name) override;
+  virtual bool operator()(int64_t& value, Common::StringView name) override;
+  virtual bool operator()(uint64_t& value, Common::StringView name) override;
+  virtual bool operator()(double& value, Common::StringView name) override;
+  virtual bool operator()(bool& value, Common::StringView name) override;
+  virtual bool operator()(std::string& value, Common::StringView name) override;
+  virtual bool binary(void* value, size_t size, Common::StringView name) override;
+  virtual bool binary(std::string& value, Common::StringView name) override;
+
+  template<typename T>
+  bool operator()(T& value, Common::StringView name) {
+    return ISerializer::operator()(value, name);
+  }
+
+  // Returns JSON text of string, number, bool or null member; throws for objects and arrays
+  bool scalarJson(std::string& json, Common::StringView name);
+
+private:
+  enum ValueType : uint8_t {
+    NIL,
+    BOOL,
+    INTEGER,
+    REAL,
+    STRING,
+    ARRAY,
+    OBJECT
+  };
+
+  struct Value {
+    Common::StringView name;
+    ValueType type;
+    // text of number or string, child count of object and array, 0 or 1 for bool
+    const char* data;
+    size_t size;
+    // index of the value following this one and all its children
+    size_t next;
+  };
+
+  struct Level {
+    size_t value;
+    // next child to look at
+    size_t cursor;
+  };
+
+  void parse(const char* data, size_t size);
+  void parseValue(const char*& position, const char* end, Common::StringView name, size_t depth);
+  void parseObject(const char*& position, const char* end, Common::StringView name, size_t depth);
+  void parseArray(const char*& position, const char* end, Common::StringView name, size_t depth);
+
+  const Value* getValue(Common::StringView name);
+  bool getInteger(Common::StringView name, int64_t& value);
+
+  template <typename T>
+  bool getNumber(Common::StringView name, T& v) {
+    int64_t value;
+    if (!getInteger(name, value)) {
+      return false;
+    }
+
+    v = static_cast<T>(value);
+    return true;
+  }
+
+  std::string buffer;
+  std::vector<Value> values;
+  std::vector<Level> chain;
 };
 
 }
@@ -0,0 +1,193 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "JsonOutputStringSerializer.h"
+
+#include <cassert>
+#include <cinttypes>
+#include <cstdio>
+
+using namespace CryptoNote;
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+void appendInteger(std::string& json, int64_t value) {
+  char text[24];
+  int size = snprintf(text, sizeof(text), "%" PRId64, value);
+  json.append(text, size);
+}
+
+// Same format as Common::JsonValue uses for REAL values
+void appendReal(std::string& json, double value) {
+  char text[512];
+  int size = snprintf(text, sizeof(text), "%.11f", value);
+  while (size > 1 && text[size - 2] != '.' && text[size - 1] == '0') {
+    --size;
+  }
+
+  json.append(text, size);
+}
+
+}
+
+JsonOutputStringSerializer::JsonOutputStringSerializer() {
+  json.push_back('{');
+  chain.push_back(Level{false, true});
+}
+
+JsonOutputStringSerializer::~JsonOutputStringSerializer() {
+}
+
+ISerializer::SerializerType JsonOutputStringSerializer::type() const {
+  return ISerializer::OUTPUT;
+}
+
+const std::string& JsonOutputStringSerializer::getJson() {
+  // the first call closes the root object
+  if (!chain.empty()) {
+    assert(chain.size() == 1);
+    chain.pop_back();
+    json.push_back('}');
+  }
+
+  return json;
+}
+
+bool JsonOutputStringSerializer::beginObject(Common::StringView name) {
+  writeName(name);
+  json.push_back('{');
+  chain.push_back(Level{false, true});
+  return true;
+}
+
+void JsonOutputStringSerializer::endObject() {
+  assert(chain.size() > 1);
+  assert(!chain.back().isArray);
+  chain.pop_back();
+  json.push_back('}');
+}
+
+bool JsonOutputStringSerializer::beginArray(size_t& size, Common::StringView name) {
+  writeName(name);
+  json.push_back('[');
+  chain.push_back(Level{true, true});
+  return true;
+}
+
+void JsonOutputStringSerializer::endArray() {
+  assert(chain.size() > 1);
+  assert(chain.back().isArray);
+  chain.pop_back();
+  json.push_back(']');
+}
+
+bool JsonOutputStringSerializer::operator()(uint64_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputStringSerializer::operator()(uint16_t& value, Common::StringView name) {
+  uint64_t v = static_cast<uint64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputStringSerializer::operator()(int16_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputStringSerializer::operator()(uint32_t& value, Common::StringView name) {
+  uint64_t v = static_cast<uint64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputStringSerializer::operator()(int32_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputStringSerializer::operator()(int64_t& value, Common::StringView name) {
+  writeName(name);
+  appendInteger(json, value);
+  return true;
+}
+
+bool JsonOutputStringSerializer::operator()(double& value, Common::StringView name) {
+  writeName(name);
+  appendReal(json, value);
+  return true;
+}
+
+bool JsonOutputStringSerializer::operator()(std::string& value, Common::StringView name) {
+  writeName(name);
+  writeString(value.data(), value.size());
+  return true;
+}
+
+bool JsonOutputStringSerializer::operator()(uint8_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputStringSerializer::operator()(bool& value, Common::StringView name) {
+  writeName(name);
+  json.append(value ? "true" : "false");
+  return true;
+}
+
+bool JsonOutputStringSerializer::binary(void* value, size_t size, Common::StringView name) {
+  writeName(name);
+  json.push_back('"');
+  size_t offset = json.size();
+  json.resize(offset + size * 2);
+  for (size_t i = 0; i < size; ++i) {
+    uint8_t byte = static_cast<const uint8_t*>(value)[i];
+    json[offset + i * 2] = HEX_DIGITS[byte >> 4];
+    json[offset + i * 2 + 1] = HEX_DIGITS[byte & 15];
+  }
+
+  json.push_back('"');
+  return true;
+}
+
+bool JsonOutputStringSerializer::binary(std::string& value, Common::StringView name) {
+  return binary(const_cast<char*>(value.data()), value.size(), name);
+}
+
+void JsonOutputStringSerializer::writeName(Common::StringView name) {
+  assert(!chain.empty());
+  Level& level = chain.back();
+  if (!level.empty) {
+    json.push_back(',');
+  }
+
+  level.empty = false;
+  if (!level.isArray) {
+    writeString(name.getData(), name.getSize());
+    json.push_back(':');
+  }
+}
+
+void JsonOutputStringSerializer::writeString(const char* data, size_t size) {
+  // Like Common::JsonValue, strings are written as is
+  json.push_back('"');
+  json.append(data, size);
+  json.push_back('"');
+}
@@ -15,13 +15,12 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
 
+
 #include "KVBinaryInputStreamSerializer.h"
 
-#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <stdexcept>
-#include <Common/StreamTools.h>
 #include "KVBinaryCommon.h"
 
 using namespace Common;
@@ -29,27 +28,22 @@ using namespace CryptoNote;
 
 namespace {
 
-template <typename T>
-T readPod(Common::IInputStream& s) {
-  T v;
-  read(s, &v, sizeof(T));
-  return v;
-}
+const size_t READ_CHUNK_SIZE = 64 * 1024;
+const size_t MAX_NESTING_DEPTH = 100;
 
-template <typename T, typename JsonT = T>
-JsonValue readPodJson(Common::IInputStream& s) {
-  JsonValue jv;
-  jv = static_cast<JsonT>(readPod<T>(s));
-  return jv;
+void checkAvailable(const char* position, const char* end, size_t size) {
+  if (static_cast<size_t>(end - position) < size) {
+    throw std::runtime_error("Unexpected end of KV-binary data");
+  }
 }
 
-template <typename T>
-JsonValue readIntegerJson(Common::IInputStream& s) {
-  return readPodJson<T, int64_t>(s);
+uint8_t readByte(const char*& position, const char* end) {
+  checkAvailable(position, end, 1);
+  return static_cast<uint8_t>(*position++);
 }
 
-size_t readVarint(Common::IInputStream& s) {
-  uint8_t b = read<uint8_t>(s);
+size_t readVarint(const char*& position, const char* end) {
+  uint8_t b = readByte(position, end);
   uint8_t size_mask = b & PORTABLE_RAW_SIZE_MARK_MASK;
   size_t bytesLeft = 0;
 
@@ -71,7 +65,7 @@ size_t readVarint(Common::IInputStream& s) {
   size_t value = b;
 
   for (size_t i = 1; i <= bytesLeft; ++i) {
-    size_t n = read<uint8_t>(s);
+    size_t n = readByte(position, end);
     value |= n << (i * 8);
   }
 
@@ -79,124 +73,294 @@ size_t readVarint(Common::IInputStream& s) {
   return value;
 }
 
-std::string readString(Common::IInputStream& s) {
-  auto size = readVarint(s);
-  std::string str;
-  str.resize(size);
-  if (size) {
-    read(s, &str[0], size);
+size_t getScalarSize(uint8_t type) {
+  switch (type) {
+  case BIN_KV_SERIALIZE_TYPE_INT64:
+  case BIN_KV_SERIALIZE_TYPE_UINT64:
+  case BIN_KV_SERIALIZE_TYPE_DOUBLE:
+    return 8;
+  case BIN_KV_SERIALIZE_TYPE_INT32:
+  case BIN_KV_SERIALIZE_TYPE_UINT32:
+    return 4;
+  case BIN_KV_SERIALIZE_TYPE_INT16:
+  case BIN_KV_SERIALIZE_TYPE_UINT16:
+    return 2;
+  case BIN_KV_SERIALIZE_TYPE_INT8:
+  case BIN_KV_SERIALIZE_TYPE_UINT8:
+  case BIN_KV_SERIALIZE_TYPE_BOOL:
+    return 1;
+  default:
+    return 0;
   }
-  return str;
 }
 
-JsonValue readStringJson(Common::IInputStream& s) {
-  return JsonValue(readString(s));
+template <typename T>
+int64_t readInteger(const char* data) {
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return static_cast<int64_t>(value);
 }
 
-void readName(Common::IInputStream& s, std::string& name) {
-  uint8_t len = readPod<uint8_t>(s);
-  if (len) {
-    name.resize(len);
-    read(s, &name[0], len);
+}
+
+KVBinaryInputStreamSerializer::KVBinaryInputStreamSerializer(Common::IInputStream& strm) {
+  for (;;) {
+    size_t offset = buffer.size();
+    buffer.resize(offset + READ_CHUNK_SIZE);
+    size_t readSize = strm.readSome(&buffer[offset], READ_CHUNK_SIZE);
+    buffer.resize(offset + readSize);
+    if (readSize == 0) {
+      break;
+    }
   }
+
+  parse(buffer.data(), buffer.size());
+}
+
+KVBinaryInputStreamSerializer::KVBinaryInputStreamSerializer(const void* data, size_t size) {
+  parse(static_cast<const char*>(data), size);
+}
+
+ISerializer::SerializerType KVBinaryInputStreamSerializer::type() const {
+  return ISerializer::INPUT;
 }
 
-JsonValue loadValue(Common::IInputStream& stream, uint8_t type);
-JsonValue loadSection(Common::IInputStream& stream);
-JsonValue loadEntry(Common::IInputStream& stream);
-JsonValue loadArray(Common::IInputStream& stream, uint8_t itemType);
+void KVBinaryInputStreamSerializer::parse(const char* data, size_t size) {
+  const char* position = data;
+  const char* end = data + size;
 
+  KVBinaryStorageBlockHeader hdr;
+  checkAvailable(position, end, sizeof(hdr));
+  memcpy(&hdr, position, sizeof(hdr));
+  position += sizeof(hdr);
+
+  if (
+    hdr.m_signature_a != PORTABLE_STORAGE_SIGNATUREA ||
+    hdr.m_signature_b != PORTABLE_STORAGE_SIGNATUREB) {
+    throw std::runtime_error("Invalid binary storage signature");
+  }
+
+  if (hdr.m_ver != PORTABLE_STORAGE_FORMAT_VER) {
+    throw std::runtime_error("Unknown binary storage format version");
+  }
+
+  parseSection(position, end, Common::StringView(), 0);
+  chain.push_back(Level{0, 1});
+}
+
+void KVBinaryInputStreamSerializer::parseSection(const char*& position, const char* end, Common::StringView name, size_t depth) {
+  if (depth > MAX_NESTING_DEPTH) {
+    throw std::runtime_error("KV-binary data nesting is too deep");
+  }
 
-JsonValue loadSection(Common::IInputStream& stream) {
-  JsonValue sec(JsonValue::OBJECT);
-  size_t count = readVarint(stream);
-  std::string name;
+  size_t index = values.size();
+  size_t count = readVarint(position, end);
+  values.push_back(Value{name, BIN_KV_SERIALIZE_TYPE_OBJECT, nullptr, count, 0});
 
   while (count--) {
-    readName(stream, name);
-    sec.insert(name, loadEntry(stream));
+    uint8_t nameSize = readByte(position, end);
+    checkAvailable(position, end, nameSize);
+    Common::StringView entryName(position, nameSize);
+    position += nameSize;
+
+    uint8_t type = readByte(position, end);
+    if (type & BIN_KV_SERIALIZE_FLAG_ARRAY) {
+      type &= ~BIN_KV_SERIALIZE_FLAG_ARRAY;
+      parseArray(position, end, type, entryName, depth + 1);
+    } else {
+      parseValue(position, end, type, entryName, depth + 1);
+    }
   }
 
-  return sec;
+  values[index].next = values.size();
 }
 
-JsonValue loadValue(Common::IInputStream& stream, uint8_t type) {
+void KVBinaryInputStreamSerializer::parseValue(const char*& position, const char* end, uint8_t type, Common::StringView name, size_t depth) {
   switch (type) {
-  case BIN_KV_SERIALIZE_TYPE_INT64:  return readIntegerJson<int64_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_INT32:  return readIntegerJson<int32_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_INT16:  return readIntegerJson<int16_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_INT8:   return readIntegerJson<int8_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_UINT64: return readIntegerJson<uint64_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_UINT32: return readIntegerJson<uint32_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_UINT16: return readIntegerJson<uint16_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_UINT8:  return readIntegerJson<uint8_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_DOUBLE: return readPodJson<double>(stream);
-  case BIN_KV_SERIALIZE_TYPE_BOOL:   return JsonValue(read<uint8_t>(stream) != 0);
-  case BIN_KV_SERIALIZE_TYPE_STRING: return readStringJson(stream);
-  case BIN_KV_SERIALIZE_TYPE_OBJECT: return loadSection(stream);
-  case BIN_KV_SERIALIZE_TYPE_ARRAY:  return loadArray(stream, type);
-  default:
-    throw std::runtime_error("Unknown data type");
+  case BIN_KV_SERIALIZE_TYPE_STRING: {
+    size_t size = readVarint(position, end);
+    checkAvailable(position, end, size);
+    values.push_back(Value{name, type, position, size, values.size() + 1});
+    position += size;
     break;
   }
-}
 
-JsonValue loadEntry(Common::IInputStream& stream) {
-  uint8_t type = readPod<uint8_t>(stream);
+  case BIN_KV_SERIALIZE_TYPE_OBJECT:
+    parseSection(position, end, name, depth);
+    break;
+
+  case BIN_KV_SERIALIZE_TYPE_ARRAY: {
+    // nested array starts with its own item type, as in epee portable storage
+    uint8_t itemType = readByte(position, end);
+    if ((itemType & BIN_KV_SERIALIZE_FLAG_ARRAY) == 0) {
+      throw std::runtime_error("KV-binary nested array type expected");
+    }
 
-  if (type & BIN_KV_SERIALIZE_FLAG_ARRAY) {
-    type &= ~BIN_KV_SERIALIZE_FLAG_ARRAY;
-    return loadArray(stream, type);
+    parseArray(position, end, itemType & ~BIN_KV_SERIALIZE_FLAG_ARRAY, name, depth + 1);
+    break;
   }
 
-  return loadValue(stream, type);
+  default: {
+    size_t size = getScalarSize(type);
+    if (size == 0) {
+      throw std::runtime_error("Unknown data type");
+    }
+
+    checkAvailable(position, end, size);
+    values.push_back(Value{name, type, position, size, values.size() + 1});
+    position += size;
+    break;
+  }
+  }
 }
 
-JsonValue loadArray(Common::IInputStream& stream, uint8_t itemType) {
-  JsonValue arr(JsonValue::ARRAY);
-  size_t count = readVarint(stream);
+void KVBinaryInputStreamSerializer::parseArray(const char*& position, const char* end, uint8_t itemType, Common::StringView name, size_t depth) {
+  if (depth > MAX_NESTING_DEPTH) {
+    throw std::runtime_error("KV-binary data nesting is too deep");
+  }
+
+  size_t index = values.size();
+  size_t count = readVarint(position, end);
+  values.push_back(Value{name, BIN_KV_SERIALIZE_TYPE_ARRAY, nullptr, count, 0});
 
   while (count--) {
-    arr.pushBack(loadValue(stream, itemType));
+    parseValue(position, end, itemType, Common::StringView(), depth);
   }
 
-  return arr;
+  values[index].next = values.size();
 }
 
+bool KVBinaryInputStreamSerializer::beginObject(Common::StringView name) {
+  const Value* value = getValue(name);
+  if (value == nullptr) {
+    return false;
+  }
+
+  if (value->type != BIN_KV_SERIALIZE_TYPE_OBJECT) {
+    throw std::runtime_error("KV-binary value type mismatch: object expected");
+  }
 
-JsonValue parseBinary(Common::IInputStream& stream) {
-  auto hdr = readPod<KVBinaryStorageBlockHeader>(stream);
+  size_t index = value - values.data();
+  chain.push_back(Level{index, index + 1});
+  return true;
+}
 
-  if (
-    hdr.m_signature_a != PORTABLE_STORAGE_SIGNATUREA ||
-    hdr.m_signature_b != PORTABLE_STORAGE_SIGNATUREB) {
-    throw std::runtime_error("Invalid binary storage signature");
+void KVBinaryInputStreamSerializer::endObject() {
+  assert(!chain.empty());
+  chain.pop_back();
+}
+
+bool KVBinaryInputStreamSerializer::beginArray(size_t& size, Common::StringView name) {
+  const Value* value = getValue(name);
+  if (value == nullptr) {
+    size = 0;
+    return false;
   }
 
-  if (hdr.m_ver != PORTABLE_STORAGE_FORMAT_VER) {
-    throw std::runtime_error("Unknown binary storage format version");
+  if (value->type != BIN_KV_SERIALIZE_TYPE_ARRAY) {
+    throw std::runtime_error("KV-binary value type mismatch: array expected");
   }
 
-  return loadSection(stream);
+  size_t index = value - values.data();
+  size = value->size;
+  chain.push_back(Level{index, index + 1});
+  return true;
 }
 
+void KVBinaryInputStreamSerializer::endArray() {
+  assert(!chain.empty());
+  chain.pop_back();
 }
 
-KVBinaryInputStreamSerializer::KVBinaryInputStreamSerializer(Common::IInputStream& strm) : JsonInputValueSerializer(parseBinary(strm)) {
+bool KVBinaryInputStreamSerializer::operator()(uint8_t& value, Common::StringView name) {
+  return getNumber(name, value);
 }
 
-bool KVBinaryInputStreamSerializer::binary(void* value, size_t size, Common::StringView name) {
-  std::string str;
+bool KVBinaryInputStreamSerializer::operator()(int16_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(uint16_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(int32_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(uint32_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
 
-  if (!(*this)(str, name)) {
+bool KVBinaryInputStreamSerializer::operator()(int64_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(uint64_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(double& value, Common::StringView name) {
+  const Value* ptr = getValue(name);
+  if (ptr == nullptr) {
     return false;
   }
 
-  if (str.size() != size) {
+  if (ptr->type == BIN_KV_SERIALIZE_TYPE_DOUBLE) {
+    memcpy(&value, ptr->data, sizeof(value));
+    return true;
+  }
+
+  // integers are accepted for compatibility with the previous implementation
+  int64_t integer;
+  getInteger(ptr, integer);
+  value = static_cast<double>(integer);
+  return true;
+}
+
+bool KVBinaryInputStreamSerializer::operator()(bool& value, Common::StringView name) {
+  const Value* ptr = getValue(name);
+  if (ptr == nullptr) {
+    return false;
+  }
+
+  if (ptr->type != BIN_KV_SERIALIZE_TYPE_BOOL) {
+    throw std::runtime_error("KV-binary value type mismatch: bool expected");
+  }
+
+  value = *ptr->data != 0;
+  return true;
+}
+
+bool KVBinaryInputStreamSerializer::operator()(std::string& value, Common::StringView name) {
+  const Value* ptr = getValue(name);
+  if (ptr == nullptr) {
+    return false;
+  }
+
+  if (ptr->type != BIN_KV_SERIALIZE_TYPE_STRING) {
+    throw std::runtime_error("KV-binary value type mismatch: string expected");
+  }
+
+  value.assign(ptr->data, ptr->size);
+  return true;
+}
+
+bool KVBinaryInputStreamSerializer::binary(void* value, size_t size, Common::StringView name) {
+  const Value* ptr = getValue(name);
+  if (ptr == nullptr) {
+    return false;
+  }
+
+  if (ptr->type != BIN_KV_SERIALIZE_TYPE_STRING) {
+    throw std::runtime_error("KV-binary value type mismatch: string expected");
+  }
+
+  if (ptr->size != size) {
     throw std::runtime_error("Binary block size mismatch");
   }
 
-  memcpy(value, str.data(), size);
+  memcpy(value, ptr->data, size);
   return true;
 }
 
@@ -204,3 +368,60 @@ bool KVBinaryInputStreamSerializer::binary(std::string& value, Common::StringVie
   return (*this)(value, name); // load as string
 }
 
+const KVBinaryInputStreamSerializer::Value* KVBinaryInputStreamSerializer::getValue(Common::StringView name) {
+  assert(!chain.empty());
+  Level& level = chain.back();
+  const Value& parent = values[level.value];
+
+  if (parent.type == BIN_KV_SERIALIZE_TYPE_ARRAY) {
+    if (level.cursor == parent.next) {
+      throw std::runtime_error("KV-binary array index out of range");
+    }
+
+    const Value* value = &values[level.cursor];
+    level.cursor = value->next;
+    return value;
+  }
+
+  // Fields are usually read in the order they were written, so search starts after the previously found one
+  for (size_t index = level.cursor; index != parent.next; index = values[index].next) {
+    if (values[index].name == name) {
+      level.cursor = values[index].next;
+      return &values[index];
+    }
+  }
+
+  for (size_t index = level.value + 1; index != level.cursor; index = values[index].next) {
+    if (values[index].name == name) {
+      level.cursor = values[index].next;
+      return &values[index];
+    }
+  }
+
+  return nullptr;
+}
+
+bool KVBinaryInputStreamSerializer::getInteger(Common::StringView name, int64_t& value) {
+  const Value* ptr = getValue(name);
+  if (ptr == nullptr) {
+    return false;
+  }
+
+  getInteger(ptr, value);
+  return true;
+}
+
+void KVBinaryInputStreamSerializer::getInteger(const Value* ptr, int64_t& value) {
+  switch (ptr->type) {
+  case BIN_KV_SERIALIZE_TYPE_INT64:  value = readInteger<int64_t>(ptr->data); break;
+  case BIN_KV_SERIALIZE_TYPE_INT32:  value = readInteger<int32_t>(ptr->data); break;
+  case BIN_KV_SERIALIZE_TYPE_INT16:  value = readInteger<int16_t>(ptr->data); break;
+  case BIN_KV_SERIALIZE_TYPE_INT8:   value = readInteger<int8_t>(ptr->data); break;
+  case BIN_KV_SERIALIZE_TYPE_UINT64: value = readInteger<uint64_t>(ptr->data); break;
+  case BIN_KV_SERIALIZE_TYPE_UINT32: value = readInteger<uint32_t>(ptr->data); break;
+  case BIN_KV_SERIALIZE_TYPE_UINT16: value = readInteger<uint16_t>(ptr->data); break;
+  case BIN_KV_SERIALIZE_TYPE_UINT8:  value = readInteger<uint8_t>(ptr->data); break;
+  default:
+    throw std::runtime_error("KV-binary value type mismatch: integer expected");
+  }
+}
@@ -15,20 +15,92 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
 
+
 #pragma once
 
+#include <string>
+#include <vector>
 #include <Common/IInputStream.h>
 #include "ISerializer.h"
-#include "JsonInputValueSerializer.h"
 
 namespace CryptoNote {
 
-class KVBinaryInputStreamSerializer : public JsonInputValueSerializer {
+// Reads KV-binary (portable storage) directly from the buffer. Single pass over the input builds flat index of values,
+// strings and blobs are referenced in the buffer and copied only to the destination object.
+class KVBinaryInputStreamSerializer : public ISerializer {
 public:
+  // Reads the whole stream to the internal buffer
   KVBinaryInputStreamSerializer(Common::IInputStream& strm);
+  // Buffer is not copied and must outlive serializer
+  KVBinaryInputStreamSerializer(const void* data, size_t size);
+  virtual ~KVBinaryInputStreamSerializer() {}
+
+  virtual SerializerType type() const override;
+
+  virtual bool beginObject(Common::StringView name) override;
+  virtual void endObject() override;
 
+  virtual bool beginArray(size_t& size, Common::StringView name) override;
+  virtual void endArray() override;
+
+  virtual bool operator()(uint8_t& value, Common::StringView name) override;
+  virtual bool operator()(int16_t& value, Common::StringView name) override;
+  virtual bool operator()(uint16_t& value, Common::StringView name) override;
+  virtual bool operator()(int32_t& value, Common::StringView name) override;
+  virtual bool operator()(uint32_t& value, Common::StringView name) override;
+  virtual bool operator()(int64_t& value, Common::StringView name) override;
+  virtual bool operator()(uint64_t& value, Common::StringView name) override;
+  virtual bool operator()(double& value, Common::StringView name) override;
+  virtual bool operator()(bool& value, Common::StringView name) override;
+  virtual bool operator()(std::string& value, Common::StringView name) override;
   virtual bool binary(void* value, size_t size, Common::StringView name) override;
   virtual bool binary(std::string& value, Common::StringView name) override;
+
+  template<typename T>
+  bool operator()(T& value, Common::StringView name) {
+    return ISerializer::operator()(value, name);
+  }
+
+private:
+  struct Value {
+    Common::StringView name;
+    uint8_t type;
+    // value of scalar type, string contents or child count of object and array
+    const char* data;
+    size_t size;
+    // index of the value following this one and all its children
+    size_t next;
+  };
+
+  struct Level {
+    size_t value;
+    // next child to look at
+    size_t cursor;
+  };
+
+  void parse(const char* data, size_t size);
+  void parseSection(const char*& position, const char* end, Common::StringView name, size_t depth);
+  void parseValue(const char*& position, const char* end, uint8_t type, Common::StringView name, size_t depth);
+  void parseArray(const char*& position, const char* end, uint8_t itemType, Common::StringView name, size_t depth);
+
+  const Value* getValue(Common::StringView name);
+  bool getInteger(Common::StringView name, int64_t& value);
+  void getInteger(const Value* ptr, int64_t& value);
+
+  template <typename T>
+  bool getNumber(Common::StringView name, T& v) {
+    int64_t value;
+    if (!getInteger(name, value)) {
+      return false;
+    }
+
+    v = static_cast<T>(value);
+    return true;
+  }
+
+  std::string buffer;
+  std::vector<Value> values;
+  std::vector<Level> chain;
 };
 
 }
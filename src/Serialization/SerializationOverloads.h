@@ -31,8 +31,60 @@
 #include <unordered_map>
 #include <unordered_set>
 
+namespace Crypto {
+
+struct chacha8_iv;
+struct EllipticCurvePoint;
+struct EllipticCurveScalar;
+struct Hash;
+struct KeyImage;
+struct PublicKey;
+struct SecretKey;
+struct Signature;
+
+}
+
 namespace CryptoNote {
 
+// Specialized for types whose serialize() writes raw object bytes with ISerializer::binary,
+// vectors of such types are read/written by binary serializers with a single call
+template<typename T>
+struct IsBinaryPod : std::false_type {};
+
+template<> struct IsBinaryPod<Crypto::PublicKey> : std::true_type {};
+template<> struct IsBinaryPod<Crypto::SecretKey> : std::true_type {};
+template<> struct IsBinaryPod<Crypto::Hash> : std::true_type {};
+template<> struct IsBinaryPod<Crypto::chacha8_iv> : std::true_type {};
+template<> struct IsBinaryPod<Crypto::KeyImage> : std::true_type {};
+template<> struct IsBinaryPod<Crypto::Signature> : std::true_type {};
+template<> struct IsBinaryPod<Crypto::EllipticCurveScalar> : std::true_type {};
+template<> struct IsBinaryPod<Crypto::EllipticCurvePoint> : std::true_type {};
+
+namespace Detail {
+
+template<typename T>
+typename std::enable_if<IsBinaryPod<T>::value, bool>::type
+serializeArrayElements(std::vector<T>& value, ISerializer& serializer) {
+  static_assert(std::is_pod<T>::value, "binary pod must be trivially copyable");
+  return serializer.binaryArray(value.data(), sizeof(T), value.size());
+}
+
+template<typename T>
+typename std::enable_if<!IsBinaryPod<T>::value, bool>::type
+serializeArrayElements(std::vector<T>& value, ISerializer& serializer) {
+  return false;
+}
+
+inline bool serializeArrayElements(std::vector<uint32_t>& value, ISerializer& serializer) {
+  return serializer.varintArray(value.data(), value.size());
+}
+
+inline bool serializeArrayElements(std::vector<uint64_t>& value, ISerializer& serializer) {
+  return serializer.varintArray(value.data(), value.size());
+}
+
+}
+
 template<typename T>
 typename std::enable_if<std::is_pod<T>::value>::type
 serializeAsBinary(std::vector<T>& value, Common::StringView name, CryptoNote::ISerializer& serializer) {
@@ -118,7 +170,25 @@ bool serializeEnumClass(E& value, Common::StringView name, CryptoNote::ISerializ
 
 template<typename T>
 bool serialize(std::vector<T>& value, Common::StringView name, CryptoNote::ISerializer& serializer) {
-  return serializeContainer(value, name, serializer);
+  size_t size = value.size();
+  if (!serializer.beginArray(size, name)) {
+    if (serializer.type() == ISerializer::INPUT) {
+      value.clear();
+    }
+
+    return false;
+  }
+
+  value.resize(size);
+
+  if (size != 0 && !Detail::serializeArrayElements(value, serializer)) {
+    for (auto& item : value) {
+      serializer(item, "");
+    }
+  }
+
+  serializer.endArray();
+  return true;
 }
 
 template<typename T>
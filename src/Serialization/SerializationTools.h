@@ -22,7 +22,9 @@
 #include <Common/MemoryInputStream.h>
 #include <Common/StringOutputStream.h>
 #include "JsonInputStreamSerializer.h"
+#include "JsonInputValueSerializer.h"
 #include "JsonOutputStreamSerializer.h"
+#include "JsonOutputStringSerializer.h"
 #include "KVBinaryInputStreamSerializer.h"
 #include "KVBinaryOutputStreamSerializer.h"
 
@@ -91,11 +93,37 @@ void loadFromJsonValue(std::list<T>& v, const Common::JsonValue& js) {
 
 template <typename T>
 std::string storeToJson(const T& v) {
-  return storeToJsonValue(v).toString();
+  JsonOutputStringSerializer s;
+  serialize(const_cast<T&>(v), s);
+  return s.getJson();
 }
 
+template <typename T>
+std::string storeToJson(const std::vector<T>& v) { return storeToJsonValue(v).toString(); }
+
+template <typename T>
+std::string storeToJson(const std::list<T>& v) { return storeToJsonValue(v).toString(); }
+
+template <>
+inline std::string storeToJson(const std::string& v) { return storeToJsonValue(v).toString(); }
+
 template <typename T>
 bool loadFromJson(T& v, const std::string& buf) {
+  try {
+    if (buf.empty()) {
+      return true;
+    }
+
+    JsonInputStreamSerializer s(buf.data(), buf.size());
+    serialize(v, s);
+  } catch (std::exception&) {
+    return false;
+  }
+  return true;
+}
+
+template <typename T>
+bool loadContainerFromJson(T& v, const std::string& buf) {
   try {
     if (buf.empty()) {
       return true;
@@ -108,6 +136,12 @@ bool loadFromJson(T& v, const std::string& buf) {
   return true;
 }
 
+template <typename T>
+bool loadFromJson(std::vector<T>& v, const std::string& buf) { return loadContainerFromJson(v, buf); }
+
+template <typename T>
+bool loadFromJson(std::list<T>& v, const std::string& buf) { return loadContainerFromJson(v, buf); }
+
 template <typename T>
 std::string storeToBinaryKeyValue(const T& v) {
   KVBinaryOutputStreamSerializer s;
@@ -122,8 +156,7 @@ std::string storeToBinaryKeyValue(const T& v) {
 template <typename T>
 bool loadFromBinaryKeyValue(T& v, const std::string& buf) {
   try {
-    Common::MemoryInputStream stream(buf.data(), buf.size());
-    KVBinaryInputStreamSerializer s(stream);
+    KVBinaryInputStreamSerializer s(buf.data(), buf.size());
     serialize(v, s);
     return true;
   } catch (std::exception&) {
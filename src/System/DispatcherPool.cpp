@@ -0,0 +1,193 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "DispatcherPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <System/ContextGroup.h>
+#include <System/Dispatcher.h>
+#include <System/Event.h>
+
+namespace System {
+
+struct DispatcherPool::Loop {
+  std::thread thread;
+  Dispatcher* dispatcher = nullptr;
+  // accessed from loop thread only
+  ContextGroup* contextGroup = nullptr;
+  Event* stopEvent = nullptr;
+  std::atomic<size_t> load;
+
+  Loop() : load(0) {
+  }
+};
+
+namespace {
+
+void pinCurrentThread(size_t coreIndex) {
+#ifdef __linux__
+  unsigned coreCount = std::thread::hardware_concurrency();
+  if (coreCount == 0) {
+    return;
+  }
+
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  CPU_SET(coreIndex % coreCount, &cpuSet);
+  // pinning is an optimization only, so failure is ignored
+  pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#endif
+}
+
+}
+
+DispatcherPool::DispatcherPool(size_t loopCount, bool pinToCores) : stopped(false) {
+  if (loopCount == 0) {
+    loopCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  }
+
+  loops.reserve(loopCount);
+  try {
+    for (size_t i = 0; i < loopCount; ++i) {
+      loops.emplace_back(new Loop);
+      Loop& loop = *loops.back();
+
+      std::promise<void> started;
+      std::future<void> startedFuture = started.get_future();
+      loop.thread = std::thread([&loop, &started, i, pinToCores] {
+        if (pinToCores) {
+          pinCurrentThread(i);
+        }
+
+        try {
+          Dispatcher dispatcher;
+          ContextGroup contextGroup(dispatcher);
+          Event stopEvent(dispatcher);
+          loop.dispatcher = &dispatcher;
+          loop.contextGroup = &contextGroup;
+          loop.stopEvent = &stopEvent;
+          started.set_value();
+
+          stopEvent.wait();
+          loop.contextGroup = nullptr;
+          contextGroup.interrupt();
+          contextGroup.wait();
+        } catch (...) {
+          if (loop.dispatcher == nullptr) {
+            started.set_exception(std::current_exception());
+          }
+        }
+      });
+
+      try {
+        startedFuture.get();
+      } catch (...) {
+        loop.thread.join();
+        loops.pop_back();
+        throw;
+      }
+    }
+  } catch (...) {
+    stop();
+    throw;
+  }
+}
+
+DispatcherPool::~DispatcherPool() {
+  stop();
+}
+
+size_t DispatcherPool::getLoopCount() const {
+  return loops.size();
+}
+
+Dispatcher& DispatcherPool::getDispatcher(size_t loopIndex) {
+  assert(loopIndex < loops.size());
+  return *loops[loopIndex]->dispatcher;
+}
+
+size_t DispatcherPool::getLoad(size_t loopIndex) const {
+  assert(loopIndex < loops.size());
+  return loops[loopIndex]->load;
+}
+
+size_t DispatcherPool::getLeastLoadedLoop() const {
+  assert(!loops.empty());
+  size_t leastLoaded = 0;
+  size_t leastLoad = loops[0]->load;
+  for (size_t i = 1; i < loops.size(); ++i) {
+    size_t load = loops[i]->load;
+    if (load < leastLoad) {
+      leastLoaded = i;
+      leastLoad = load;
+    }
+  }
+
+  return leastLoaded;
+}
+
+void DispatcherPool::spawn(size_t loopIndex, std::function<void()>&& procedure) {
+  assert(!stopped);
+  assert(loopIndex < loops.size());
+  Loop* loop = loops[loopIndex].get();
+  ++loop->load;
+  loop->dispatcher->remoteSpawn([loop, procedure] {
+    // remote procedures are spawned outside of any group, move it to the loop group to make it interruptible by stop()
+    if (loop->contextGroup == nullptr) {
+      --loop->load;
+      return;
+    }
+
+    loop->contextGroup->spawn([loop, procedure] {
+      try {
+        procedure();
+      } catch (...) {
+      }
+
+      --loop->load;
+    });
+  });
+}
+
+size_t DispatcherPool::spawn(std::function<void()>&& procedure) {
+  size_t loopIndex = getLeastLoadedLoop();
+  spawn(loopIndex, std::move(procedure));
+  return loopIndex;
+}
+
+void DispatcherPool::stop() {
+  stopped = true;
+  for (auto& loop : loops) {
+    if (loop->thread.joinable()) {
+      Event* stopEvent = loop->stopEvent;
+      loop->dispatcher->remoteSpawn([stopEvent] { stopEvent->set(); });
+      loop->thread.join();
+    }
+  }
+}
+
+}
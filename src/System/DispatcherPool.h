@@ -0,0 +1,65 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace System {
+
+class Dispatcher;
+
+// Runs several independent event loops, each one in its own thread with its own Dispatcher.
+// Procedures are passed to loops with Dispatcher::remoteSpawn, so a loop is woken up by its own event
+// (eventfd on Linux) and every procedure runs in a context of the loop it was spawned on.
+// Objects bound to a dispatcher (TcpConnection, Timer, Event, ...) must be used from that loop only;
+// TcpListener::accept(Dispatcher&) allows to distribute accepted connections between loops.
+class DispatcherPool {
+public:
+  // loopCount == 0 means one loop per hardware thread
+  explicit DispatcherPool(size_t loopCount = 0, bool pinToCores = false);
+  DispatcherPool(const DispatcherPool&) = delete;
+  ~DispatcherPool();
+  DispatcherPool& operator=(const DispatcherPool&) = delete;
+
+  size_t getLoopCount() const;
+  Dispatcher& getDispatcher(size_t loopIndex);
+
+  // Number of procedures spawned on the loop and not finished yet
+  size_t getLoad(size_t loopIndex) const;
+  size_t getLeastLoadedLoop() const;
+
+  // Can be called from any thread, but not concurrently with or after stop()
+  void spawn(size_t loopIndex, std::function<void()>&& procedure);
+  // Spawns procedure on the least loaded loop and returns its index
+  size_t spawn(std::function<void()>&& procedure);
+
+  // Interrupts running procedures, waits for them and joins loop threads
+  void stop();
+
+private:
+  struct Loop;
+
+  std::vector<std::unique_ptr<Loop>> loops;
+  std::atomic<bool> stopped;
+};
+
+}
@@ -151,6 +151,9 @@ size_t SpentOutputDescriptor::hash() const {
 
 TransfersContainer::TransfersContainer(const Currency& currency, Logging::ILogger& logger, size_t transactionSpendableAge) :
   m_currentHeight(0),
+  m_unlockedBalance(0),
+  m_lockedBalance(0),
+  m_softLockedBalance(0),
   m_currency(currency),
   m_logger(logger, "TransfersContainer"),
   m_transactionSpendableAge(transactionSpendableAge) {
@@ -182,7 +185,7 @@ bool TransfersContainer::addTransaction(const TransactionBlockInfo& block, const
     }
 
     if (block.height != WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
-      m_currentHeight = block.height;
+      setCurrentHeight(block.height);
     }
 
     return added;
@@ -597,7 +600,7 @@ std::vector<Hash> TransfersContainer::detach(uint32_t height) {
   }
 
   // TODO: notification on detach
-  m_currentHeight = height == 0 ? 0 : height - 1;
+  setCurrentHeight(height == 0 ? 0 : height - 1);
 
   return deletedTransactions;
 }
@@ -635,6 +638,7 @@ void TransfersContainer::updateTransfersVisibility(const KeyImage& keyImage) {
     updateVisibility(unconfirmedIndex, unconfirmedRange, false);
     updateVisibility(availableIndex, availableRange, false);
     updateVisibility(spentIndex, spentRange, true);
+    setBalanceEntry(keyImage, nullptr);
   } else if (availableCount > 0) {
     updateVisibility(unconfirmedIndex, unconfirmedRange, false);
     updateVisibility(availableIndex, availableRange, false);
@@ -646,8 +650,10 @@ void TransfersContainer::updateTransfersVisibility(const KeyImage& keyImage) {
     auto earliestTransfer = *earliestTransferIt;
     earliestTransfer.visible = true;
     availableIndex.replace(earliestTransferIt, earliestTransfer);
+    setBalanceEntry(keyImage, &earliestTransfer);
   } else {
     updateVisibility(unconfirmedIndex, unconfirmedRange, unconfirmedCount == 1);
+    setBalanceEntry(keyImage, unconfirmedCount == 1 ? &*unconfirmedRange.first : nullptr);
   }
 }
 
@@ -655,7 +661,7 @@ bool TransfersContainer::advanceHeight(uint32_t height) {
   std::lock_guard<std::mutex> lk(m_mutex);
 
   if (m_currentHeight <= height) {
-    m_currentHeight = height;
+    setCurrentHeight(height);
     return true;
   }
 
@@ -676,6 +682,36 @@ uint64_t TransfersContainer::balance(uint32_t flags) const {
   std::lock_guard<std::mutex> lk(m_mutex);
   uint64_t amount = 0;
 
+  if ((flags & IncludeTypeKey) != 0) {
+    if ((flags & IncludeStateUnlocked) != 0) {
+      amount += m_unlockedBalance;
+    }
+
+    if ((flags & IncludeStateLocked) != 0) {
+      amount += m_lockedBalance;
+    }
+
+    if ((flags & IncludeStateSoftLocked) != 0) {
+      amount += m_softLockedBalance;
+    }
+
+    for (const auto& kv : m_timeLockedBalanceEntries) {
+      if ((flags & getBalanceState(kv.second, m_currentHeight)) != 0) {
+        amount += kv.second.amount;
+      }
+    }
+  }
+
+  assert(amount == scanBalance(flags));
+  return amount;
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+uint64_t TransfersContainer::scanBalance(uint32_t flags) const {
+  uint64_t amount = 0;
+
   for (const auto& t : m_availableTransfers) {
     if (t.visible && isIncluded(t, flags)) {
       amount += t.amount;
@@ -693,6 +729,48 @@ uint64_t TransfersContainer::balance(uint32_t flags) const {
   return amount;
 }
 
+size_t TransfersContainer::getUnlockedOutputsCount(uint64_t minAmount, uint64_t maxAmount) const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  size_t first;
+  size_t last;
+  getSpendableAmountRange(minAmount, maxAmount, first, last);
+
+  size_t count = last - first;
+  for (const auto& kv : m_timeLockedBalanceEntries) {
+    if (kv.second.amount >= minAmount && kv.second.amount <= maxAmount &&
+      getBalanceState(kv.second, m_currentHeight) == IncludeStateUnlocked) {
+      ++count;
+    }
+  }
+
+  return count;
+}
+
+bool TransfersContainer::getUnlockedOutput(uint64_t minAmount, uint64_t maxAmount, size_t index, TransactionOutputInformation& output) const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  size_t first;
+  size_t last;
+  getSpendableAmountRange(minAmount, maxAmount, first, last);
+
+  if (index < last - first) {
+    return getSpendableOutput(m_spendableOutputs.get<SpendableAmountIndex>().nth(first + index)->keyImage, output);
+  }
+
+  index -= last - first;
+  for (const auto& kv : m_timeLockedBalanceEntries) {
+    if (kv.second.amount >= minAmount && kv.second.amount <= maxAmount &&
+      getBalanceState(kv.second, m_currentHeight) == IncludeStateUnlocked) {
+      if (index == 0) {
+        return getSpendableOutput(kv.first, output);
+      }
+
+      --index;
+    }
+  }
+
+  return false;
+}
+
 void TransfersContainer::getOutputs(std::vector<TransactionOutputInformation>& transfers, uint32_t flags) const {
   std::lock_guard<std::mutex> lk(m_mutex);
   for (const auto& t : m_availableTransfers) {
@@ -882,6 +960,7 @@ void TransfersContainer::load(std::istream& in) {
   m_unconfirmedTransfers = std::move(unconfirmedTransfers);
   m_availableTransfers = std::move(availableTransfers);
   m_spentTransfers = std::move(spentTransfers);
+  loadBalance();
 
   // Repair the container if it was broken while handling addTransaction() in previous version of the code
   // Hope it isn't necessary anymore
@@ -982,6 +1061,237 @@ void TransfersContainer::repair() {
   }
 }
 
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::setCurrentHeight(uint32_t height) {
+  if (height < m_currentHeight) {
+    m_currentHeight = height;
+    rebuildBalance();
+    return;
+  }
+
+  uint32_t previousHeight = m_currentHeight;
+  m_currentHeight = height;
+  while (!m_balanceTransitions.empty() && m_balanceTransitions.begin()->first <= height) {
+    KeyImage keyImage = m_balanceTransitions.begin()->second;
+    m_balanceTransitions.erase(m_balanceTransitions.begin());
+
+    const auto& entry = m_balanceEntries.at(keyImage);
+    removeFromBalanceBucket(keyImage, entry, getBalanceState(entry, previousHeight));
+    addToBalanceBucket(keyImage, entry, getBalanceState(entry, height));
+
+    uint64_t transitionHeight;
+    if (getNextBalanceTransition(entry, height, transitionHeight)) {
+      m_balanceTransitions.emplace(transitionHeight, keyImage);
+    }
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::setBalanceEntry(const KeyImage& keyImage, const TransactionOutputInformationEx* visibleOutput) {
+  auto it = m_balanceEntries.find(keyImage);
+  if (it != m_balanceEntries.end()) {
+    removeFromBalance(keyImage, it->second);
+    m_balanceEntries.erase(it);
+  }
+
+  if (visibleOutput != nullptr) {
+    BalanceEntry entry;
+    entry.amount = visibleOutput->amount;
+    entry.unlockTime = visibleOutput->unlockTime;
+    entry.blockHeight = visibleOutput->blockHeight;
+
+    m_balanceEntries.emplace(keyImage, entry);
+    addToBalance(keyImage, entry);
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::addToBalance(const KeyImage& keyImage, const BalanceEntry& entry) {
+  if (isLockedByTime(entry)) {
+    m_timeLockedBalanceEntries.emplace(keyImage, entry);
+    return;
+  }
+
+  addToBalanceBucket(keyImage, entry, getBalanceState(entry, m_currentHeight));
+
+  uint64_t transitionHeight;
+  if (getNextBalanceTransition(entry, m_currentHeight, transitionHeight)) {
+    m_balanceTransitions.emplace(transitionHeight, keyImage);
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::removeFromBalance(const KeyImage& keyImage, const BalanceEntry& entry) {
+  if (isLockedByTime(entry)) {
+    m_timeLockedBalanceEntries.erase(keyImage);
+    return;
+  }
+
+  removeFromBalanceBucket(keyImage, entry, getBalanceState(entry, m_currentHeight));
+
+  uint64_t transitionHeight;
+  if (getNextBalanceTransition(entry, m_currentHeight, transitionHeight)) {
+    auto range = m_balanceTransitions.equal_range(transitionHeight);
+    auto it = std::find_if(range.first, range.second, [&keyImage](const std::pair<const uint64_t, KeyImage>& transition) {
+      return transition.second == keyImage;
+    });
+
+    assert(it != range.second);
+    m_balanceTransitions.erase(it);
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::rebuildBalance() {
+  m_timeLockedBalanceEntries.clear();
+  m_balanceTransitions.clear();
+  m_unlockedBalance = 0;
+  m_lockedBalance = 0;
+  m_softLockedBalance = 0;
+  m_spendableOutputs.clear();
+
+  for (const auto& kv : m_balanceEntries) {
+    addToBalance(kv.first, kv.second);
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::loadBalance() {
+  m_balanceEntries.clear();
+
+  auto addEntry = [this](const TransactionOutputInformationEx& output) {
+    if (output.visible && output.type == TransactionTypes::OutputType::Key) {
+      m_balanceEntries[output.keyImage] = BalanceEntry{output.amount, output.unlockTime, output.blockHeight};
+    }
+  };
+
+  std::for_each(m_unconfirmedTransfers.begin(), m_unconfirmedTransfers.end(), addEntry);
+  std::for_each(m_availableTransfers.begin(), m_availableTransfers.end(), addEntry);
+
+  rebuildBalance();
+}
+
+// Confirmed outputs with unlock time set to timestamp can't be moved between states by height
+bool TransfersContainer::isLockedByTime(const BalanceEntry& entry) const {
+  return entry.blockHeight != WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT && entry.unlockTime >= m_currency.maxBlockHeight();
+}
+
+uint32_t TransfersContainer::getBalanceState(const BalanceEntry& entry, uint32_t height) const {
+  if (entry.blockHeight == WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
+    return IncludeStateLocked;
+  }
+
+  if (isLockedByTime(entry)) {
+    if (!isSpendTimeUnlocked(entry.unlockTime)) {
+      return IncludeStateLocked;
+    }
+  } else if (static_cast<uint64_t>(height) + m_currency.lockedTxAllowedDeltaBlocks() < entry.unlockTime) {
+    return IncludeStateLocked;
+  }
+
+  if (height < static_cast<uint64_t>(entry.blockHeight) + m_transactionSpendableAge) {
+    return IncludeStateSoftLocked;
+  }
+
+  return IncludeStateUnlocked;
+}
+
+bool TransfersContainer::getNextBalanceTransition(const BalanceEntry& entry, uint32_t height, uint64_t& transitionHeight) const {
+  if (entry.blockHeight == WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT || isLockedByTime(entry)) {
+    return false;
+  }
+
+  uint64_t unlockHeight = entry.unlockTime > m_currency.lockedTxAllowedDeltaBlocks() ? entry.unlockTime - m_currency.lockedTxAllowedDeltaBlocks() : 0;
+  uint64_t spendableHeight = static_cast<uint64_t>(entry.blockHeight) + m_transactionSpendableAge;
+  if (height < unlockHeight) {
+    transitionHeight = unlockHeight;
+    return true;
+  }
+
+  if (height < spendableHeight) {
+    transitionHeight = spendableHeight;
+    return true;
+  }
+
+  return false;
+}
+
+uint64_t& TransfersContainer::getBalanceBucket(uint32_t state) {
+  switch (state) {
+  case IncludeStateUnlocked:
+    return m_unlockedBalance;
+  case IncludeStateSoftLocked:
+    return m_softLockedBalance;
+  default:
+    assert(state == IncludeStateLocked);
+    return m_lockedBalance;
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::addToBalanceBucket(const KeyImage& keyImage, const BalanceEntry& entry, uint32_t state) {
+  getBalanceBucket(state) += entry.amount;
+  if (state == IncludeStateUnlocked) {
+    bool inserted = m_spendableOutputs.insert(SpendableOutput{entry.amount, entry.blockHeight, keyImage}).second;
+    assert(inserted);
+    (void)inserted;
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::removeFromBalanceBucket(const KeyImage& keyImage, const BalanceEntry& entry, uint32_t state) {
+  getBalanceBucket(state) -= entry.amount;
+  if (state == IncludeStateUnlocked) {
+    size_t erased = m_spendableOutputs.get<SpendableKeyImageIndex>().erase(keyImage);
+    assert(erased == 1);
+    (void)erased;
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::getSpendableAmountRange(uint64_t minAmount, uint64_t maxAmount, size_t& first, size_t& last) const {
+  if (minAmount > maxAmount) {
+    first = last = 0;
+    return;
+  }
+
+  auto& amountIndex = m_spendableOutputs.get<SpendableAmountIndex>();
+  first = amountIndex.rank(amountIndex.lower_bound(boost::make_tuple(minAmount)));
+  last = amountIndex.rank(amountIndex.upper_bound(boost::make_tuple(maxAmount)));
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+bool TransfersContainer::getSpendableOutput(const KeyImage& keyImage, TransactionOutputInformation& output) const {
+  auto range = m_availableTransfers.get<SpentOutputDescriptorIndex>().equal_range(SpentOutputDescriptor(&keyImage));
+  auto it = std::find_if(range.first, range.second, [](const TransactionOutputInformationEx& t) { return t.visible; });
+  if (it == range.second) {
+    return false;
+  }
+
+  output = *it;
+  return true;
+}
+
 bool TransfersContainer::isSpendTimeUnlocked(uint64_t unlockTime) const {
   if (unlockTime < m_currency.maxBlockHeight()) {
     // interpret as block index
@@ -18,14 +18,17 @@
 #pragma once
 
 #include <cstdint>
+#include <map>
 #include <unordered_map>
 #include <mutex>
 
 #include <boost/multi_index_container.hpp>
+#include <boost/multi_index/composite_key.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/mem_fun.hpp>
 #include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/ranked_index.hpp>
 
 #include "crypto/crypto.h"
 #include "CryptoNoteCore/CryptoNoteBasic.h"
@@ -168,6 +171,8 @@ public:
   virtual std::vector<TransactionOutputInformation> getTransactionInputs(const Crypto::Hash& transactionHash, uint32_t flags) const override;
   virtual void getUnconfirmedTransactions(std::vector<Crypto::Hash>& transactions) const override;
   virtual std::vector<TransactionSpentOutputInformation> getSpentOutputs() const override;
+  virtual size_t getUnlockedOutputsCount(uint64_t minAmount, uint64_t maxAmount) const override;
+  virtual bool getUnlockedOutput(uint64_t minAmount, uint64_t maxAmount, size_t index, TransactionOutputInformation& output) const override;
 
   // IStreamSerializable
   virtual void save(std::ostream& os) override;
@@ -177,6 +182,8 @@ private:
   struct ContainingTransactionIndex { };
   struct SpendingTransactionIndex { };
   struct SpentOutputDescriptorIndex { };
+  struct SpendableAmountIndex { };
+  struct SpendableKeyImageIndex { };
 
   typedef boost::multi_index_container<
     TransactionInformation,
@@ -270,6 +277,54 @@ private:
   void copyToSpent(const TransactionBlockInfo& block, const ITransactionReader& tx, size_t inputIndex, const TransactionOutputInformationEx& output);
   void repair();
 
+  // Unlocked key output, ordered by amount and block height for coin selection
+  struct SpendableOutput {
+    uint64_t amount;
+    uint32_t blockHeight;
+    Crypto::KeyImage keyImage;
+  };
+
+  typedef boost::multi_index_container<
+    SpendableOutput,
+    boost::multi_index::indexed_by<
+      boost::multi_index::ranked_non_unique<
+        boost::multi_index::tag<SpendableAmountIndex>,
+        boost::multi_index::composite_key<
+          SpendableOutput,
+          BOOST_MULTI_INDEX_MEMBER(SpendableOutput, uint64_t, amount),
+          BOOST_MULTI_INDEX_MEMBER(SpendableOutput, uint32_t, blockHeight)
+        >
+      >,
+      boost::multi_index::hashed_unique<
+        boost::multi_index::tag<SpendableKeyImageIndex>,
+        BOOST_MULTI_INDEX_MEMBER(SpendableOutput, Crypto::KeyImage, keyImage)
+      >
+    >
+  > SpendableOutputsMultiIndex;
+
+  // Visible key output of a key image, accounted in the running balance
+  struct BalanceEntry {
+    uint64_t amount;
+    uint64_t unlockTime;
+    uint32_t blockHeight;
+  };
+
+  void setCurrentHeight(uint32_t height);
+  void setBalanceEntry(const Crypto::KeyImage& keyImage, const TransactionOutputInformationEx* visibleOutput);
+  void addToBalance(const Crypto::KeyImage& keyImage, const BalanceEntry& entry);
+  void removeFromBalance(const Crypto::KeyImage& keyImage, const BalanceEntry& entry);
+  void rebuildBalance();
+  void loadBalance();
+  bool isLockedByTime(const BalanceEntry& entry) const;
+  uint32_t getBalanceState(const BalanceEntry& entry, uint32_t height) const;
+  bool getNextBalanceTransition(const BalanceEntry& entry, uint32_t height, uint64_t& transitionHeight) const;
+  uint64_t& getBalanceBucket(uint32_t state);
+  void addToBalanceBucket(const Crypto::KeyImage& keyImage, const BalanceEntry& entry, uint32_t state);
+  void removeFromBalanceBucket(const Crypto::KeyImage& keyImage, const BalanceEntry& entry, uint32_t state);
+  void getSpendableAmountRange(uint64_t minAmount, uint64_t maxAmount, size_t& first, size_t& last) const;
+  bool getSpendableOutput(const Crypto::KeyImage& keyImage, TransactionOutputInformation& output) const;
+  uint64_t scanBalance(uint32_t flags) const;
+
 private:
   TransactionMultiIndex m_transactions;
   UnconfirmedTransfersMultiIndex m_unconfirmedTransfers;
@@ -277,6 +332,17 @@ private:
   SpentTransfersMultiIndex m_spentTransfers;
 
   uint32_t m_currentHeight; // current height is needed to check if a transfer is unlocked
+
+  // Balance of visible key outputs by state at m_currentHeight. Outputs unlocked by time are kept aside
+  // and checked on each request, outputs unlocked by height are moved between states when height advances.
+  std::unordered_map<Crypto::KeyImage, BalanceEntry> m_balanceEntries;
+  std::unordered_map<Crypto::KeyImage, BalanceEntry> m_timeLockedBalanceEntries;
+  std::multimap<uint64_t, Crypto::KeyImage> m_balanceTransitions;
+  uint64_t m_unlockedBalance;
+  uint64_t m_lockedBalance;
+  uint64_t m_softLockedBalance;
+  // Key outputs of m_balanceEntries in unlocked state, except ones locked by time
+  SpendableOutputsMultiIndex m_spendableOutputs;
   size_t m_transactionSpendableAge;
   const CryptoNote::Currency& m_currency;
   mutable std::mutex m_mutex;
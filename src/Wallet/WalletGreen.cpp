@@ -21,9 +21,11 @@
 #include <ctime>
 #include <cassert>
 #include <fstream>
+#include <map>
 #include <numeric>
 #include <random>
 #include <set>
+#include <thread>
 #include <tuple>
 #include <utility>
 
@@ -1296,17 +1298,9 @@ void WalletGreen::prepareTransaction(std::vector<WalletOuts>&& wallets,
   const CryptoNote::AccountPublicAddress& changeDestination,
   PreparedTransaction& preparedTransaction) {
 
-  preparedTransaction.destinations = convertOrdersToTransfers(orders);
-  preparedTransaction.neededMoney = countNeededMoney(preparedTransaction.destinations, fee);
-
+  std::unordered_set<Crypto::PublicKey> reservedOutputs;
   std::vector<OutputToTransfer> selectedTransfers;
-  uint64_t foundMoney = selectTransfers(preparedTransaction.neededMoney, mixIn == 0, m_currency.defaultDustThreshold(), std::move(wallets), selectedTransfers);
-
-  if (foundMoney < preparedTransaction.neededMoney) {
-    m_logger(ERROR, BRIGHT_RED) << "Failed to create transaction: not enough money. Needed " << m_currency.formatAmount(preparedTransaction.neededMoney) <<
-      ", found " << m_currency.formatAmount(foundMoney);
-    throw std::system_error(make_error_code(error::WRONG_AMOUNT), "Not enough money");
-  }
+  uint64_t foundMoney = selectTransactionTransfers(std::move(wallets), orders, fee, mixIn, reservedOutputs, selectedTransfers, preparedTransaction);
 
   typedef CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount outs_for_amount;
   std::vector<outs_for_amount> mixinResult;
@@ -1318,6 +1312,114 @@ void WalletGreen::prepareTransaction(std::vector<WalletOuts>&& wallets,
   std::vector<InputInfo> keysInfo;
   prepareInputs(selectedTransfers, mixinResult, mixIn, keysInfo);
 
+  std::vector<ReceiverAmounts> decomposedOutputs = prepareTransactionOutputs(foundMoney, donation, changeDestination, preparedTransaction);
+  preparedTransaction.transaction = makeTransaction(decomposedOutputs, keysInfo, extra, unlockTimestamp);
+}
+
+std::vector<WalletGreen::PreparedTransaction> WalletGreen::prepareTransactions(const std::vector<TransactionParameters>& sendingTransactions) {
+  typedef CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount outs_for_amount;
+
+  size_t transactionCount = sendingTransactions.size();
+  std::vector<PreparedTransaction> preparedTransactions(transactionCount);
+  std::vector<std::vector<OutputToTransfer>> selectedTransfers(transactionCount);
+  std::vector<uint64_t> foundMoney(transactionCount);
+
+  // outputs selected for a transaction are reserved, so the following transactions don't spend them
+  std::unordered_set<Crypto::PublicKey> reservedOutputs;
+  for (size_t i = 0; i < transactionCount; ++i) {
+    const auto& parameters = sendingTransactions[i];
+    validateTransactionParameters(parameters);
+    auto wallets = parameters.sourceAddresses.empty() ? pickWalletsWithMoney() : pickWallets(parameters.sourceAddresses);
+    foundMoney[i] = selectTransactionTransfers(std::move(wallets), parameters.destinations, parameters.fee, parameters.mixIn, reservedOutputs,
+      selectedTransfers[i], preparedTransactions[i]);
+  }
+
+  // random outputs for all transactions with the same mixin are requested at once
+  std::map<uint16_t, std::vector<size_t>> transactionsByMixIn;
+  for (size_t i = 0; i < transactionCount; ++i) {
+    if (sendingTransactions[i].mixIn != 0) {
+      transactionsByMixIn[sendingTransactions[i].mixIn].push_back(i);
+    }
+  }
+
+  std::vector<std::vector<outs_for_amount>> mixinResults(transactionCount);
+  for (const auto& mixInTransactions : transactionsByMixIn) {
+    std::vector<uint64_t> amounts;
+    for (size_t i : mixInTransactions.second) {
+      for (const auto& out : selectedTransfers[i]) {
+        amounts.push_back(out.out.amount);
+      }
+    }
+
+    std::vector<outs_for_amount> mixinResult;
+    requestRandomOutputs(std::move(amounts), mixInTransactions.first, mixinResult);
+
+    auto mixinIt = mixinResult.begin();
+    for (size_t i : mixInTransactions.second) {
+      auto mixinEnd = std::next(mixinIt, selectedTransfers[i].size());
+      mixinResults[i].assign(std::make_move_iterator(mixinIt), std::make_move_iterator(mixinEnd));
+      mixinIt = mixinEnd;
+    }
+  }
+
+  std::vector<std::vector<InputInfo>> keysInfo(transactionCount);
+  std::vector<std::vector<ReceiverAmounts>> decomposedOutputs(transactionCount);
+  for (size_t i = 0; i < transactionCount; ++i) {
+    const auto& parameters = sendingTransactions[i];
+    prepareInputs(selectedTransfers[i], mixinResults[i], parameters.mixIn, keysInfo[i]);
+
+    AccountPublicAddress changeDestination = getChangeDestination(parameters.changeDestination, parameters.sourceAddresses);
+    decomposedOutputs[i] = prepareTransactionOutputs(foundMoney[i], parameters.donation, changeDestination, preparedTransactions[i]);
+  }
+
+  // key derivations and ring signatures of different transactions are computed in parallel
+  size_t threadCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), transactionCount);
+  std::vector<std::unique_ptr<System::RemoteContext<>>> workers;
+  workers.reserve(threadCount);
+  for (size_t worker = 0; worker < threadCount; ++worker) {
+    workers.emplace_back(new System::RemoteContext<>(m_dispatcher, [&, worker, threadCount] {
+      for (size_t i = worker; i < transactionCount; i += threadCount) {
+        preparedTransactions[i].transaction = makeTransaction(decomposedOutputs[i], keysInfo[i], sendingTransactions[i].extra,
+          sendingTransactions[i].unlockTimestamp);
+      }
+    }));
+  }
+
+  for (auto& worker : workers) {
+    worker->get();
+  }
+
+  return preparedTransactions;
+}
+
+uint64_t WalletGreen::selectTransactionTransfers(std::vector<WalletOuts>&& wallets,
+  const std::vector<WalletOrder>& orders,
+  uint64_t fee,
+  uint16_t mixIn,
+  std::unordered_set<Crypto::PublicKey>& reservedOutputs,
+  std::vector<OutputToTransfer>& selectedTransfers,
+  PreparedTransaction& preparedTransaction) {
+
+  preparedTransaction.destinations = convertOrdersToTransfers(orders);
+  preparedTransaction.neededMoney = countNeededMoney(preparedTransaction.destinations, fee);
+
+  uint64_t foundMoney = selectTransfers(preparedTransaction.neededMoney, mixIn == 0, m_currency.defaultDustThreshold(), std::move(wallets),
+    reservedOutputs, selectedTransfers);
+
+  if (foundMoney < preparedTransaction.neededMoney) {
+    m_logger(ERROR, BRIGHT_RED) << "Failed to create transaction: not enough money. Needed " << m_currency.formatAmount(preparedTransaction.neededMoney) <<
+      ", found " << m_currency.formatAmount(foundMoney);
+    throw std::system_error(make_error_code(error::WRONG_AMOUNT), "Not enough money");
+  }
+
+  return foundMoney;
+}
+
+std::vector<WalletGreen::ReceiverAmounts> WalletGreen::prepareTransactionOutputs(uint64_t foundMoney,
+  const DonationSettings& donation,
+  const CryptoNote::AccountPublicAddress& changeDestination,
+  PreparedTransaction& preparedTransaction) {
+
   uint64_t donationAmount = pushDonationTransferIfPossible(donation, foundMoney - preparedTransaction.neededMoney, m_currency.defaultDustThreshold(), preparedTransaction.destinations);
   preparedTransaction.changeAmount = foundMoney - preparedTransaction.neededMoney - donationAmount;
 
@@ -1333,7 +1435,7 @@ void WalletGreen::prepareTransaction(std::vector<WalletOuts>&& wallets,
     decomposedOutputs.emplace_back(std::move(splittedChange));
   }
 
-  preparedTransaction.transaction = makeTransaction(decomposedOutputs, keysInfo, extra, unlockTimestamp);
+  return decomposedOutputs;
 }
 
 void WalletGreen::validateSourceAddresses(const std::vector<std::string>& sourceAddresses) const {
@@ -1602,6 +1704,59 @@ size_t WalletGreen::makeTransaction(const TransactionParameters& sendingTransact
   return id;
 }
 
+std::vector<size_t> WalletGreen::makeTransactions(const std::vector<TransactionParameters>& sendingTransactions) {
+  std::vector<size_t> ids;
+  Tools::ScopeExit releaseContext([this, &ids] {
+    m_dispatcher.yield();
+
+    for (size_t id : ids) {
+      auto& tx = m_transactions[id];
+      m_logger(INFO, BRIGHT_WHITE) << "Delayed transaction created, ID " << id <<
+        ", hash " << tx.hash <<
+        ", state " << tx.state <<
+        ", totalAmount " << m_currency.formatAmount(tx.totalAmount) <<
+        ", fee " << m_currency.formatAmount(tx.fee) <<
+        ", transfers: " << TransferListFormatter(m_currency, getTransactionTransfersRange(id));
+    }
+  });
+
+  System::EventLock lk(m_readyEvent);
+
+  throwIfNotInitialized();
+  throwIfTrackingMode();
+  throwIfStopped();
+
+  m_logger(INFO, BRIGHT_WHITE) << "makeTransactions, count " << sendingTransactions.size();
+
+  std::vector<PreparedTransaction> preparedTransactions = prepareTransactions(sendingTransactions);
+
+  Tools::ScopeExit rollbackTransactions([this, &ids] {
+    rollbackDelayedTransactions(ids);
+    ids.clear();
+  });
+
+  ids.reserve(preparedTransactions.size());
+  for (const auto& preparedTransaction : preparedTransactions) {
+    ids.push_back(validateSaveAndSendTransaction(*preparedTransaction.transaction, preparedTransaction.destinations, false, false));
+  }
+
+  rollbackTransactions.cancel();
+  return ids;
+}
+
+void WalletGreen::rollbackDelayedTransactions(const std::vector<size_t>& transactionIds) {
+  for (size_t transactionId : transactionIds) {
+    try {
+      removeUnconfirmedTransaction(getObjectHash(m_uncommitedTransactions[transactionId]));
+    } catch (...) {
+      m_logger(ERROR, BRIGHT_RED) << "Unknown exception while removing unconfirmed transaction, ID " << transactionId;
+    }
+
+    m_uncommitedTransactions.erase(transactionId);
+    updateTransactionStateAndPushEvent(transactionId, WalletTransactionState::FAILED);
+  }
+}
+
 void WalletGreen::commitTransaction(size_t transactionId) {
   System::EventLock lk(m_readyEvent);
 
@@ -2140,6 +2295,14 @@ void WalletGreen::requestMixinOuts(
     amounts.push_back(out.out.amount);
   }
 
+  requestRandomOutputs(std::move(amounts), mixIn, mixinResult);
+}
+
+void WalletGreen::requestRandomOutputs(
+  std::vector<uint64_t>&& amounts,
+  uint16_t mixIn,
+  std::vector<CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& mixinResult) {
+
   System::Event requestFinished(m_dispatcher);
   std::error_code mixinError;
 
@@ -2172,41 +2335,93 @@ uint64_t WalletGreen::selectTransfers(
   bool dust,
   uint64_t dustThreshold,
   std::vector<WalletOuts>&& wallets,
+  std::unordered_set<Crypto::PublicKey>& reservedOutputs,
   std::vector<OutputToTransfer>& selectedTransfers) {
 
-  uint64_t foundMoney = 0;
-
-  typedef std::pair<WalletRecord*, TransactionOutputInformation> OutputData;
-  std::vector<OutputData> dustOutputs;
-  std::vector<OutputData> walletOuts;
-  for (auto walletIt = wallets.begin(); walletIt != wallets.end(); ++walletIt) {
-    for (auto outIt = walletIt->outs.begin(); outIt != walletIt->outs.end(); ++outIt) {
-      if (outIt->amount > dustThreshold) {
-        walletOuts.emplace_back(std::piecewise_construct, std::forward_as_tuple(walletIt->wallet), std::forward_as_tuple(*outIt));
-      } else if (dust) {
-        dustOutputs.emplace_back(std::piecewise_construct, std::forward_as_tuple(walletIt->wallet), std::forward_as_tuple(*outIt));
-      }
+  std::vector<OutputsRange> walletRanges;
+  std::vector<OutputsRange> dustRanges;
+  for (const auto& wallet : wallets) {
+    walletRanges.push_back(makeOutputsRange(wallet.wallet, dustThreshold + 1, std::numeric_limits<uint64_t>::max()));
+    if (dust) {
+      dustRanges.push_back(makeOutputsRange(wallet.wallet, 0, dustThreshold));
     }
   }
 
-  ShuffleGenerator<size_t, Crypto::random_engine<size_t>> indexGenerator(walletOuts.size());
-  while (foundMoney < neededMoney && !indexGenerator.empty()) {
-    auto& out = walletOuts[indexGenerator()];
-    foundMoney += out.second.amount;
-    selectedTransfers.emplace_back(OutputToTransfer{ std::move(out.second), std::move(out.first) });
+  uint64_t foundMoney = pickRandomOutputs(walletRanges, neededMoney, 0, std::numeric_limits<size_t>::max(), reservedOutputs, selectedTransfers);
+  if (dust) {
+    // at least one dust output is spent, if there is any
+    foundMoney += pickRandomOutputs(dustRanges, foundMoney < neededMoney ? neededMoney - foundMoney : 0, 1,
+      std::numeric_limits<size_t>::max(), reservedOutputs, selectedTransfers);
+  }
+
+  return foundMoney;
+};
+
+WalletGreen::OutputsRange WalletGreen::makeOutputsRange(WalletRecord* wallet, uint64_t minAmount, uint64_t maxAmount) const {
+  return OutputsRange{wallet, minAmount, maxAmount, wallet->container->getUnlockedOutputsCount(minAmount, maxAmount)};
+}
+
+uint64_t WalletGreen::pickRandomOutputs(const std::vector<OutputsRange>& ranges, uint64_t neededMoney, size_t minCount, size_t maxCount,
+  std::unordered_set<Crypto::PublicKey>& reservedOutputs, std::vector<OutputToTransfer>& selectedTransfers) const {
+
+  std::vector<size_t> rangeEnds;
+  rangeEnds.reserve(ranges.size());
+  size_t totalCount = 0;
+  for (const auto& range : ranges) {
+    totalCount += range.count;
+    rangeEnds.push_back(totalCount);
   }
 
-  if (dust && !dustOutputs.empty()) {
-    ShuffleGenerator<size_t, Crypto::random_engine<size_t>> dustIndexGenerator(dustOutputs.size());
-    do {
-      auto& out = dustOutputs[dustIndexGenerator()];
-      foundMoney += out.second.amount;
-      selectedTransfers.emplace_back(OutputToTransfer{ std::move(out.second), std::move(out.first) });
-    } while (foundMoney < neededMoney && !dustIndexGenerator.empty());
+  uint64_t foundMoney = 0;
+  size_t pickedCount = 0;
+  ShuffleGenerator<size_t, Crypto::random_engine<size_t>> indexGenerator(totalCount);
+  while ((pickedCount < minCount || foundMoney < neededMoney) && pickedCount < maxCount && !indexGenerator.empty()) {
+    size_t index = indexGenerator();
+    size_t rangeIndex = std::distance(rangeEnds.begin(), std::upper_bound(rangeEnds.begin(), rangeEnds.end(), index));
+    const auto& range = ranges[rangeIndex];
+
+    TransactionOutputInformation out;
+    if (!range.wallet->container->getUnlockedOutput(range.minAmount, range.maxAmount, index - (rangeEnds[rangeIndex] - range.count), out) ||
+      !reservedOutputs.insert(out.outputKey).second) {
+      // output is reserved or container has changed since the outputs were counted
+      continue;
+    }
+
+    foundMoney += out.amount;
+    ++pickedCount;
+    selectedTransfers.emplace_back(OutputToTransfer{std::move(out), range.wallet});
   }
 
   return foundMoney;
-};
+}
+
+std::vector<std::vector<WalletGreen::OutputsRange>> WalletGreen::getFusionReadyRanges(const std::vector<WalletOuts>& wallets, uint64_t threshold) const {
+  std::vector<std::vector<OutputsRange>> buckets(std::numeric_limits<uint64_t>::digits10 + 1);
+  for (const auto& wallet : wallets) {
+    uint64_t powerOfTenAmount = 1;
+    for (size_t powerOfTen = 0; powerOfTen < buckets.size(); ++powerOfTen) {
+      for (uint64_t digit = 1; digit <= 9; ++digit) {
+        if (powerOfTenAmount > std::numeric_limits<uint64_t>::max() / digit) {
+          break;
+        }
+
+        uint64_t amount = digit * powerOfTenAmount;
+        uint8_t amountPowerOfTen = 0;
+        if (m_currency.isAmountApplicableInFusionTransactionInput(amount, threshold, amountPowerOfTen)) {
+          assert(amountPowerOfTen == powerOfTen);
+          OutputsRange range = makeOutputsRange(wallet.wallet, amount, amount);
+          if (range.count != 0) {
+            buckets[amountPowerOfTen].push_back(range);
+          }
+        }
+      }
+
+      powerOfTenAmount *= 10;
+    }
+  }
+
+  return buckets;
+}
 
 std::vector<WalletGreen::WalletOuts> WalletGreen::pickWalletsWithMoney() const {
   auto& walletsIndex = m_walletsContainer.get<RandomAccessIndex>();
@@ -2220,10 +2435,10 @@ std::vector<WalletGreen::WalletOuts> WalletGreen::pickWalletsWithMoney() const {
     ITransfersContainer* container = wallet.container;
 
     WalletOuts outs;
-    container->getOutputs(outs.outs, ITransfersContainer::IncludeKeyUnlocked);
+    outs.outsCount = container->getUnlockedOutputsCount(0, std::numeric_limits<uint64_t>::max());
     outs.wallet = const_cast<WalletRecord *>(&wallet);
 
-    walletOuts.push_back(std::move(outs));
+    walletOuts.push_back(outs);
   };
 
   return walletOuts;
@@ -2234,7 +2449,7 @@ WalletGreen::WalletOuts WalletGreen::pickWallet(const std::string& address) cons
 
   ITransfersContainer* container = wallet.container;
   WalletOuts outs;
-  container->getOutputs(outs.outs, ITransfersContainer::IncludeKeyUnlocked);
+  outs.outsCount = container->getUnlockedOutputsCount(0, std::numeric_limits<uint64_t>::max());
   outs.wallet = const_cast<WalletRecord *>(&wallet);
 
   return outs;
@@ -2246,8 +2461,8 @@ std::vector<WalletGreen::WalletOuts> WalletGreen::pickWallets(const std::vector<
 
   for (const auto& address: addresses) {
     WalletOuts wallet = pickWallet(address);
-    if (!wallet.outs.empty()) {
-      wallets.emplace_back(std::move(wallet));
+    if (wallet.outsCount != 0) {
+      wallets.emplace_back(wallet);
     }
   }
 
@@ -3083,21 +3298,16 @@ IFusionManager::EstimateResult WalletGreen::estimate(uint64_t threshold, const s
 
   IFusionManager::EstimateResult result{0, 0};
   auto walletOuts = sourceAddresses.empty() ? pickWalletsWithMoney() : pickWallets(sourceAddresses);
-  std::array<size_t, std::numeric_limits<uint64_t>::digits10 + 1> bucketSizes;
-  bucketSizes.fill(0);
-  for (size_t walletIndex = 0; walletIndex < walletOuts.size(); ++walletIndex) {
-    for (auto& out : walletOuts[walletIndex].outs) {
-      uint8_t powerOfTen = 0;
-      if (m_currency.isAmountApplicableInFusionTransactionInput(out.amount, threshold, powerOfTen)) {
-        assert(powerOfTen < std::numeric_limits<uint64_t>::digits10 + 1);
-        bucketSizes[powerOfTen]++;
-      }
-    }
-
-    result.totalOutputCount += walletOuts[walletIndex].outs.size();
+  for (const auto& wallet : walletOuts) {
+    result.totalOutputCount += wallet.outsCount;
   }
 
-  for (auto bucketSize : bucketSizes) {
+  for (const auto& bucket : getFusionReadyRanges(walletOuts, threshold)) {
+    size_t bucketSize = 0;
+    for (const auto& range : bucket) {
+      bucketSize += range.count;
+    }
+
     if (bucketSize >= m_currency.fusionTxMinInputCount()) {
       result.fusionReadyCount += bucketSize;
     }
@@ -3109,18 +3319,13 @@ IFusionManager::EstimateResult WalletGreen::estimate(uint64_t threshold, const s
 std::vector<WalletGreen::OutputToTransfer> WalletGreen::pickRandomFusionInputs(const std::vector<std::string>& addresses,
   uint64_t threshold, size_t minInputCount, size_t maxInputCount) {
 
-  std::vector<WalletGreen::OutputToTransfer> allFusionReadyOuts;
   auto walletOuts = addresses.empty() ? pickWalletsWithMoney() : pickWallets(addresses);
+  auto buckets = getFusionReadyRanges(walletOuts, threshold);
   std::array<size_t, std::numeric_limits<uint64_t>::digits10 + 1> bucketSizes;
   bucketSizes.fill(0);
-  for (size_t walletIndex = 0; walletIndex < walletOuts.size(); ++walletIndex) {
-    for (auto& out : walletOuts[walletIndex].outs) {
-      uint8_t powerOfTen = 0;
-      if (m_currency.isAmountApplicableInFusionTransactionInput(out.amount, threshold, powerOfTen)) {
-        allFusionReadyOuts.push_back({std::move(out), walletOuts[walletIndex].wallet});
-        assert(powerOfTen < std::numeric_limits<uint64_t>::digits10 + 1);
-        bucketSizes[powerOfTen]++;
-      }
+  for (size_t bucketIndex = 0; bucketIndex < buckets.size(); ++bucketIndex) {
+    for (const auto& range : buckets[bucketIndex]) {
+      bucketSizes[bucketIndex] += range.count;
     }
   }
 
@@ -3142,37 +3347,18 @@ std::vector<WalletGreen::OutputToTransfer> WalletGreen::pickRandomFusionInputs(c
   size_t selectedBucket = bucketNumbers[bucketNumberIndex];
   assert(selectedBucket < std::numeric_limits<uint64_t>::digits10 + 1);
   assert(bucketSizes[selectedBucket] >= minInputCount);
-  uint64_t lowerBound = 1;
-  for (size_t i = 0; i < selectedBucket; ++i) {
-    lowerBound *= 10;
-  }
-   
-  uint64_t upperBound = selectedBucket == std::numeric_limits<uint64_t>::digits10 ? UINT64_MAX : lowerBound * 10;
+
   std::vector<WalletGreen::OutputToTransfer> selectedOuts;
-  selectedOuts.reserve(bucketSizes[selectedBucket]);
-  for (size_t outIndex = 0; outIndex < allFusionReadyOuts.size(); ++outIndex) {
-    if (allFusionReadyOuts[outIndex].out.amount >= lowerBound && allFusionReadyOuts[outIndex].out.amount < upperBound) {
-      selectedOuts.push_back(std::move(allFusionReadyOuts[outIndex]));
-    }
+  selectedOuts.reserve(std::min(bucketSizes[selectedBucket], maxInputCount));
+  std::unordered_set<Crypto::PublicKey> reservedOutputs;
+  pickRandomOutputs(buckets[selectedBucket], std::numeric_limits<uint64_t>::max(), 0, maxInputCount, reservedOutputs, selectedOuts);
+  if (selectedOuts.size() < minInputCount) {
+    return {};
   }
 
-  assert(selectedOuts.size() >= minInputCount);
-
   auto outputsSortingFunction = [](const OutputToTransfer& l, const OutputToTransfer& r) { return l.out.amount < r.out.amount; };
-  if (selectedOuts.size() <= maxInputCount) {
-    std::sort(selectedOuts.begin(), selectedOuts.end(), outputsSortingFunction);
-    return selectedOuts;
-  }
-
-  ShuffleGenerator<size_t, Crypto::random_engine<size_t>> generator(selectedOuts.size());
-  std::vector<WalletGreen::OutputToTransfer> trimmedSelectedOuts;
-  trimmedSelectedOuts.reserve(maxInputCount);
-  for (size_t i = 0; i < maxInputCount; ++i) {
-    trimmedSelectedOuts.push_back(std::move(selectedOuts[generator()]));
-  }
-
-  std::sort(trimmedSelectedOuts.begin(), trimmedSelectedOuts.end(), outputsSortingFunction);
-  return trimmedSelectedOuts;  
+  std::sort(selectedOuts.begin(), selectedOuts.end(), outputsSortingFunction);
+  return selectedOuts;
 }
 
 std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsInBlocks(uint32_t blockIndex, size_t count) const {
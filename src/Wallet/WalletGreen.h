@@ -21,6 +21,7 @@
 
 #include <queue>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "IFusionManager.h"
 #include "WalletIndices.h"
@@ -84,6 +85,7 @@ public:
   virtual size_t transfer(const TransactionParameters& sendingTransaction) override;
 
   virtual size_t makeTransaction(const TransactionParameters& sendingTransaction) override;
+  virtual std::vector<size_t> makeTransactions(const std::vector<TransactionParameters>& sendingTransactions) override;
   virtual void commitTransaction(size_t) override;
   virtual void rollbackUncommitedTransaction(size_t) override;
 
@@ -138,9 +140,18 @@ protected:
     std::vector<uint64_t> amounts;
   };
 
+  // Outputs stay in the wallet container and are read on demand
   struct WalletOuts {
     WalletRecord* wallet;
-    std::vector<TransactionOutputInformation> outs;
+    size_t outsCount;
+  };
+
+  // Unlocked outputs of a wallet with amount in [minAmount, maxAmount]
+  struct OutputsRange {
+    WalletRecord* wallet;
+    uint64_t minAmount;
+    uint64_t maxAmount;
+    size_t count;
   };
 
   typedef std::pair<WalletTransfers::const_iterator, WalletTransfers::const_iterator> TransfersRange;
@@ -227,6 +238,19 @@ protected:
     const DonationSettings& donation,
     const CryptoNote::AccountPublicAddress& changeDestinationAddress,
     PreparedTransaction& preparedTransaction);
+  std::vector<PreparedTransaction> prepareTransactions(const std::vector<TransactionParameters>& sendingTransactions);
+  uint64_t selectTransactionTransfers(std::vector<WalletOuts>&& wallets,
+    const std::vector<WalletOrder>& orders,
+    uint64_t fee,
+    uint16_t mixIn,
+    std::unordered_set<Crypto::PublicKey>& reservedOutputs,
+    std::vector<OutputToTransfer>& selectedTransfers,
+    PreparedTransaction& preparedTransaction);
+  std::vector<ReceiverAmounts> prepareTransactionOutputs(uint64_t foundMoney,
+    const DonationSettings& donation,
+    const CryptoNote::AccountPublicAddress& changeDestination,
+    PreparedTransaction& preparedTransaction);
+  void rollbackDelayedTransactions(const std::vector<size_t>& transactionIds);
 
   size_t doTransfer(const TransactionParameters& transactionParameters);
 
@@ -244,6 +268,9 @@ protected:
   void requestMixinOuts(const std::vector<OutputToTransfer>& selectedTransfers,
     uint16_t mixIn,
     std::vector<CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& mixinResult);
+  void requestRandomOutputs(std::vector<uint64_t>&& amounts,
+    uint16_t mixIn,
+    std::vector<CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& mixinResult);
 
   void prepareInputs(const std::vector<OutputToTransfer>& selectedTransfers,
     std::vector<CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& mixinResult,
@@ -254,7 +281,15 @@ protected:
     bool dust,
     uint64_t dustThreshold,
     std::vector<WalletOuts>&& wallets,
+    std::unordered_set<Crypto::PublicKey>& reservedOutputs,
     std::vector<OutputToTransfer>& selectedTransfers);
+  OutputsRange makeOutputsRange(WalletRecord* wallet, uint64_t minAmount, uint64_t maxAmount) const;
+  // Picks outputs in random order while fewer than minCount are picked or neededMoney isn't found, up to maxCount outputs.
+  // Outputs from reservedOutputs are skipped, picked ones are added to it.
+  uint64_t pickRandomOutputs(const std::vector<OutputsRange>& ranges, uint64_t neededMoney, size_t minCount, size_t maxCount,
+    std::unordered_set<Crypto::PublicKey>& reservedOutputs, std::vector<OutputToTransfer>& selectedTransfers) const;
+  // Splits fusion ready outputs to buckets by power of ten of amount
+  std::vector<std::vector<OutputsRange>> getFusionReadyRanges(const std::vector<WalletOuts>& wallets, uint64_t threshold) const;
 
   std::vector<ReceiverAmounts> splitDestinations(const std::vector<WalletTransfer>& destinations,
     uint64_t dustThreshold, const Currency& currency);
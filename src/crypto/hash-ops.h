@@ -66,6 +66,10 @@ enum {
 void cn_fast_hash(const void *data, size_t length, char *hash);
 
 void cn_slow_hash_f(void *, const void *, size_t, void *);
+void cn_slow_hash_multi_f(void *const *contexts, const void *const *data, const size_t *length, void *const *hash, size_t count);
+// number of inputs cn_slow_hash_multi_f hashes at once: 1, 2 or 4 (only 1 without AES-NI)
+size_t cn_slow_hash_get_multi_ways(void);
+void cn_slow_hash_set_multi_ways(size_t ways);
 
 void hash_extra_blake(const void *data, size_t length, char *hash);
 void hash_extra_groestl(const void *data, size_t length, char *hash);
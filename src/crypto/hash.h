@@ -42,6 +42,15 @@ namespace Crypto {
     return h;
   }
 
+  // Memory backing a slow hash scratchpad. Scratchpad is accessed randomly, so huge pages save most of TLB misses.
+  enum class cn_pages {
+    regular,
+    transparent_huge, // kernel accepted madvise(MADV_HUGEPAGE), it may still back the scratchpad with regular pages
+    huge
+  };
+
+  const char *cn_pages_name(cn_pages pages);
+
   class cn_context {
   public:
 
@@ -52,16 +61,40 @@ namespace Crypto {
     void operator=(const cn_context &) = delete;
 #endif
 
+    cn_pages pages() const { return page_kind; }
+
   private:
 
     void *data;
+    cn_pages page_kind;
     friend inline void cn_slow_hash(cn_context &, const void *, size_t, Hash &);
+    friend inline void cn_slow_hash_multi(cn_context *const *, const void *const *, const size_t *, Hash *, size_t);
   };
 
+  // number of existing contexts whose scratchpads are backed by the given pages
+  size_t cn_context_count(cn_pages pages);
+
   inline void cn_slow_hash(cn_context &context, const void *data, size_t length, Hash &hash) {
     (*cn_slow_hash_f)(context.data, data, length, reinterpret_cast<void *>(&hash));
   }
 
+  // Hashes count independent inputs, on CPUs with AES-NI several of them are hashed at once.
+  // Each input needs its own context: data[i] is hashed with contexts[i] into hashes[i].
+  inline void cn_slow_hash_multi(cn_context *const *contexts, const void *const *data, const size_t *length, Hash *hashes, size_t count) {
+    const size_t CHUNK_SIZE = 4;
+    void *chunkContexts[CHUNK_SIZE];
+    void *chunkHashes[CHUNK_SIZE];
+    for (size_t i = 0; i < count; i += CHUNK_SIZE) {
+      size_t chunkSize = count - i < CHUNK_SIZE ? count - i : CHUNK_SIZE;
+      for (size_t j = 0; j < chunkSize; ++j) {
+        chunkContexts[j] = contexts[i + j]->data;
+        chunkHashes[j] = &hashes[i + j];
+      }
+
+      cn_slow_hash_multi_f(chunkContexts, data + i, length + i, chunkHashes, chunkSize);
+    }
+  }
+
   inline void tree_hash(const Hash *hashes, size_t count, Hash &root_hash) {
     tree_hash(reinterpret_cast<const char (*)[HASH_SIZE]>(hashes), count, reinterpret_cast<char *>(&root_hash));
   }
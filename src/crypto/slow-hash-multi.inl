@@ -0,0 +1,91 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+// Interleaved AES-NI CryptoNight, hashes WAYS independent inputs at once.
+// Main loop of a single hash is a chain of dependent scratchpad loads, so iterations of
+// different inputs are interleaved to overlap their memory latencies.
+
+#if WAYS == 2
+#define CN_SLOW_HASH_WAYS_NAME cn_slow_hash_aesni_2way
+#define CN_FOR_EACH_WAY(STEP) STEP(0) STEP(1)
+#elif WAYS == 4
+#define CN_SLOW_HASH_WAYS_NAME cn_slow_hash_aesni_4way
+#define CN_FOR_EACH_WAY(STEP) STEP(0) STEP(1) STEP(2) STEP(3)
+#else
+#error Unsupported number of ways
+#endif
+
+#define CN_MAIN_LOOP_STEP(k)                                                          \
+  {                                                                                   \
+    __m128i c_x = _mm_load_si128((__m128i *)&long_state[k][a[k][0] & 0x1FFFF0]);     \
+    __m128i a_x = _mm_load_si128((__m128i *)a[k]);                                    \
+    ALIGNED_DECL(uint64_t c[2], 16);                                                  \
+    uint64_t b0, b1, hi, lo, *nextblock;                                              \
+                                                                                      \
+    c_x = _mm_aesenc_si128(c_x, a_x);                                                 \
+    _mm_store_si128((__m128i *)&long_state[k][a[k][0] & 0x1FFFF0], _mm_xor_si128(b_x[k], c_x)); \
+                                                                                      \
+    _mm_store_si128((__m128i *)c, c_x);                                               \
+    nextblock = (uint64_t *)&long_state[k][c[0] & 0x1FFFF0];                          \
+    b0 = nextblock[0];                                                                \
+    b1 = nextblock[1];                                                                \
+    lo = cn_mul128(c[0], b0, &hi);                                                    \
+    a[k][0] += hi;                                                                    \
+    a[k][1] += lo;                                                                    \
+    nextblock[0] = a[k][0];                                                           \
+    nextblock[1] = a[k][1];                                                           \
+    a[k][0] ^= b0;                                                                    \
+    a[k][1] ^= b1;                                                                    \
+    b_x[k] = c_x;                                                                     \
+  }
+
+static void CN_SLOW_HASH_WAYS_NAME(void *const *contexts, const void *const *data, const size_t *length, void *const *hash)
+{
+  struct cn_ctx *ctx[WAYS];
+  uint8_t *long_state[WAYS];
+  ALIGNED_DECL(uint64_t a[WAYS][2], 16);
+  __m128i b_x[WAYS];
+  size_t i, k;
+
+  for (k = 0; k < WAYS; k++) {
+    ctx[k] = (struct cn_ctx *) contexts[k];
+    long_state[k] = ctx[k]->long_state;
+    hash_process(&ctx[k]->state.hs, (const uint8_t*) data[k], length[k]);
+    cn_explode_scratchpad_aesni(ctx[k]);
+
+    a[k][0] = ((uint64_t *)ctx[k]->state.k)[0] ^ ((uint64_t *)ctx[k]->state.k)[4];
+    a[k][1] = ((uint64_t *)ctx[k]->state.k)[1] ^ ((uint64_t *)ctx[k]->state.k)[5];
+    b_x[k] = _mm_set_epi64x(((uint64_t *)ctx[k]->state.k)[3] ^ ((uint64_t *)ctx[k]->state.k)[7],
+      ((uint64_t *)ctx[k]->state.k)[2] ^ ((uint64_t *)ctx[k]->state.k)[6]);
+  }
+
+  for (i = 0; likely(i < 0x80000); i++) {
+    CN_FOR_EACH_WAY(CN_MAIN_LOOP_STEP)
+  }
+
+  for (k = 0; k < WAYS; k++) {
+    cn_implode_scratchpad_aesni(ctx[k]);
+    memcpy(ctx[k]->state.init, ctx[k]->text, INIT_SIZE_BYTE);
+    hash_permutation(&ctx[k]->state.hs);
+    extra_hashes[ctx[k]->state.hs.b[0] & 3](&ctx[k]->state, 200, hash[k]);
+  }
+}
+
+#undef CN_MAIN_LOOP_STEP
+#undef CN_FOR_EACH_WAY
+#undef CN_SLOW_HASH_WAYS_NAME
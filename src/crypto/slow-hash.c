@@ -35,11 +35,28 @@
 #include "oaes_lib.h"
 
 void (*cn_slow_hash_fp)(void *, const void *, size_t, void *);
+void (*cn_slow_hash_multi_fp)(void *const *, const void *const *, const size_t *, void *const *, size_t);
+// Number of inputs hashed at once by cn_slow_hash_multi_f, may be lowered on CPUs with little cache per core.
+// It is accessed atomically, hashing threads may run while it is changed.
+static size_t cn_slow_hash_multi_ways = 4;
+
+#if defined(_MSC_VER)
+// MSVC makes aligned volatile accesses atomic on x86 and x64
+#define load_multi_ways() (*(volatile size_t *) &cn_slow_hash_multi_ways)
+#define store_multi_ways(ways) (*(volatile size_t *) &cn_slow_hash_multi_ways = (ways))
+#else
+#define load_multi_ways() __atomic_load_n(&cn_slow_hash_multi_ways, __ATOMIC_RELAXED)
+#define store_multi_ways(ways) __atomic_store_n(&cn_slow_hash_multi_ways, (ways), __ATOMIC_RELAXED)
+#endif
 
 void cn_slow_hash_f(void * a, const void * b, size_t c, void * d){
 (*cn_slow_hash_fp)(a, b, c, d);
 }
 
+void cn_slow_hash_multi_f(void *const *contexts, const void *const *data, const size_t *length, void *const *hash, size_t count) {
+  (*cn_slow_hash_multi_fp)(contexts, data, length, hash, count);
+}
+
 #if defined(__GNUC__)
 #define likely(x) (__builtin_expect(!!(x), 1))
 #define unlikely(x) (__builtin_expect(!!(x), 0))
@@ -175,10 +192,165 @@ static void (*const extra_hashes[4])(const void *, size_t, char *) =
     hash_extra_blake, hash_extra_groestl, hash_extra_jh, hash_extra_skein
 };
 
+static inline uint64_t cn_mul128(uint64_t multiplier, uint64_t multiplicand, uint64_t *product_hi) {
+#if defined(__GNUC__) && defined(__x86_64__)
+  uint64_t lo;
+  __asm__("mulq %3\n\t"
+    : "=d" (*product_hi),
+    "=a" (lo)
+    : "%a" (multiplier),
+    "rm" (multiplicand)
+    : "cc" );
+  return lo;
+#else
+  return mul128(multiplier, multiplicand, product_hi);
+#endif
+}
+
+// Fills scratchpad from keccak state, single and multi-way AES-NI hashes share it
+static void cn_explode_scratchpad_aesni(struct cn_ctx *ctx) {
+  ALIGNED_DECL(uint8_t ExpandedKey[256], 16);
+  __m128i *longoutput = (__m128i *) ctx->long_state;
+  __m128i *expkey = (__m128i *) ExpandedKey;
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7;
+  size_t i, j;
+
+  memcpy(ExpandedKey, ctx->state.hs.b, AES_KEY_SIZE);
+  ExpandAESKey256(ExpandedKey);
+
+  x0 = _mm_load_si128((__m128i *) ctx->state.init);
+  x1 = _mm_load_si128((__m128i *) ctx->state.init + 1);
+  x2 = _mm_load_si128((__m128i *) ctx->state.init + 2);
+  x3 = _mm_load_si128((__m128i *) ctx->state.init + 3);
+  x4 = _mm_load_si128((__m128i *) ctx->state.init + 4);
+  x5 = _mm_load_si128((__m128i *) ctx->state.init + 5);
+  x6 = _mm_load_si128((__m128i *) ctx->state.init + 6);
+  x7 = _mm_load_si128((__m128i *) ctx->state.init + 7);
+
+  for (i = 0; likely(i < MEMORY / AES_BLOCK_SIZE); i += INIT_SIZE_BLK) {
+    for (j = 0; j < 10; j++) {
+      x0 = _mm_aesenc_si128(x0, expkey[j]);
+      x1 = _mm_aesenc_si128(x1, expkey[j]);
+      x2 = _mm_aesenc_si128(x2, expkey[j]);
+      x3 = _mm_aesenc_si128(x3, expkey[j]);
+      x4 = _mm_aesenc_si128(x4, expkey[j]);
+      x5 = _mm_aesenc_si128(x5, expkey[j]);
+      x6 = _mm_aesenc_si128(x6, expkey[j]);
+      x7 = _mm_aesenc_si128(x7, expkey[j]);
+    }
+
+    _mm_store_si128(&longoutput[i], x0);
+    _mm_store_si128(&longoutput[i + 1], x1);
+    _mm_store_si128(&longoutput[i + 2], x2);
+    _mm_store_si128(&longoutput[i + 3], x3);
+    _mm_store_si128(&longoutput[i + 4], x4);
+    _mm_store_si128(&longoutput[i + 5], x5);
+    _mm_store_si128(&longoutput[i + 6], x6);
+    _mm_store_si128(&longoutput[i + 7], x7);
+  }
+}
+
+// Folds scratchpad into ctx->text, single and multi-way AES-NI hashes share it
+static void cn_implode_scratchpad_aesni(struct cn_ctx *ctx) {
+  ALIGNED_DECL(uint8_t ExpandedKey[256], 16);
+  __m128i *longoutput = (__m128i *) ctx->long_state;
+  __m128i *expkey = (__m128i *) ExpandedKey;
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7;
+  size_t i, j;
+
+  memcpy(ExpandedKey, &ctx->state.hs.b[32], AES_KEY_SIZE);
+  ExpandAESKey256(ExpandedKey);
+
+  x0 = _mm_load_si128((__m128i *) ctx->state.init);
+  x1 = _mm_load_si128((__m128i *) ctx->state.init + 1);
+  x2 = _mm_load_si128((__m128i *) ctx->state.init + 2);
+  x3 = _mm_load_si128((__m128i *) ctx->state.init + 3);
+  x4 = _mm_load_si128((__m128i *) ctx->state.init + 4);
+  x5 = _mm_load_si128((__m128i *) ctx->state.init + 5);
+  x6 = _mm_load_si128((__m128i *) ctx->state.init + 6);
+  x7 = _mm_load_si128((__m128i *) ctx->state.init + 7);
+
+  for (i = 0; likely(i < MEMORY / AES_BLOCK_SIZE); i += INIT_SIZE_BLK) {
+    x0 = _mm_xor_si128(longoutput[i], x0);
+    x1 = _mm_xor_si128(longoutput[i + 1], x1);
+    x2 = _mm_xor_si128(longoutput[i + 2], x2);
+    x3 = _mm_xor_si128(longoutput[i + 3], x3);
+    x4 = _mm_xor_si128(longoutput[i + 4], x4);
+    x5 = _mm_xor_si128(longoutput[i + 5], x5);
+    x6 = _mm_xor_si128(longoutput[i + 6], x6);
+    x7 = _mm_xor_si128(longoutput[i + 7], x7);
+
+    for (j = 0; j < 10; j++) {
+      x0 = _mm_aesenc_si128(x0, expkey[j]);
+      x1 = _mm_aesenc_si128(x1, expkey[j]);
+      x2 = _mm_aesenc_si128(x2, expkey[j]);
+      x3 = _mm_aesenc_si128(x3, expkey[j]);
+      x4 = _mm_aesenc_si128(x4, expkey[j]);
+      x5 = _mm_aesenc_si128(x5, expkey[j]);
+      x6 = _mm_aesenc_si128(x6, expkey[j]);
+      x7 = _mm_aesenc_si128(x7, expkey[j]);
+    }
+  }
+
+  _mm_store_si128((__m128i *) ctx->text, x0);
+  _mm_store_si128((__m128i *) ctx->text + 1, x1);
+  _mm_store_si128((__m128i *) ctx->text + 2, x2);
+  _mm_store_si128((__m128i *) ctx->text + 3, x3);
+  _mm_store_si128((__m128i *) ctx->text + 4, x4);
+  _mm_store_si128((__m128i *) ctx->text + 5, x5);
+  _mm_store_si128((__m128i *) ctx->text + 6, x6);
+  _mm_store_si128((__m128i *) ctx->text + 7, x7);
+}
+
 #include "slow-hash.inl"
 #define AESNI
 #include "slow-hash.inl"
 
+#define WAYS 2
+#include "slow-hash-multi.inl"
+#undef WAYS
+#define WAYS 4
+#include "slow-hash-multi.inl"
+#undef WAYS
+
+static void cn_slow_hash_multi_aesni(void *const *contexts, const void *const *data, const size_t *length, void *const *hash, size_t count) {
+  size_t ways = load_multi_ways();
+  if (ways >= 4) {
+    for (; count >= 4; contexts += 4, data += 4, length += 4, hash += 4, count -= 4) {
+      cn_slow_hash_aesni_4way(contexts, data, length, hash);
+    }
+  }
+
+  if (ways >= 2) {
+    for (; count >= 2; contexts += 2, data += 2, length += 2, hash += 2, count -= 2) {
+      cn_slow_hash_aesni_2way(contexts, data, length, hash);
+    }
+  }
+
+  for (; count > 0; contexts++, data++, length++, hash++, count--) {
+    cn_slow_hash_aesni(contexts[0], data[0], length[0], hash[0]);
+  }
+}
+
+static void cn_slow_hash_multi_noaesni(void *const *contexts, const void *const *data, const size_t *length, void *const *hash, size_t count) {
+  size_t i;
+  for (i = 0; i < count; i++) {
+    cn_slow_hash_noaesni(contexts[i], data[i], length[i], hash[i]);
+  }
+}
+
+size_t cn_slow_hash_get_multi_ways(void) {
+  return load_multi_ways();
+}
+
+void cn_slow_hash_set_multi_ways(size_t ways) {
+  if (cn_slow_hash_multi_fp == &cn_slow_hash_multi_noaesni) {
+    return;
+  }
+
+  store_multi_ways(ways >= 4 ? 4 : (ways >= 2 ? 2 : 1));
+}
+
 INITIALIZER(detect_aes) {
   int ecx;
 #if defined(_MSC_VER)
@@ -190,4 +362,8 @@ INITIALIZER(detect_aes) {
   __cpuid(1, a, b, ecx, d);
 #endif
   cn_slow_hash_fp = (ecx & (1 << 25)) ? &cn_slow_hash_aesni : &cn_slow_hash_noaesni;
+  cn_slow_hash_multi_fp = (ecx & (1 << 25)) ? &cn_slow_hash_multi_aesni : &cn_slow_hash_multi_noaesni;
+  if (!(ecx & (1 << 25))) {
+    store_multi_ways(1);
+  }
 }
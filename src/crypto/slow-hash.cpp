@@ -15,6 +15,8 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <atomic>
+#include <cstdint>
 #include <new>
 
 #include "hash.h"
@@ -33,39 +35,145 @@ using std::bad_alloc;
 namespace Crypto {
 
   enum {
-    MAP_SIZE = SLOW_HASH_CONTEXT_SIZE + ((-SLOW_HASH_CONTEXT_SIZE) & 0xfff)
+    MAP_SIZE = SLOW_HASH_CONTEXT_SIZE + ((-SLOW_HASH_CONTEXT_SIZE) & 0xfff),
+    // scratchpad is at the beginning of the context and fits a single huge page
+    HUGE_PAGE_SIZE = 2 * 1024 * 1024
   };
 
+  namespace {
+
+    std::atomic<size_t> context_counts[3];
+
+    void count_context(cn_pages pages, bool created) {
+      if (created) {
+        ++context_counts[static_cast<size_t>(pages)];
+      } else {
+        --context_counts[static_cast<size_t>(pages)];
+      }
+    }
+
+  }
+
+  const char *cn_pages_name(cn_pages pages) {
+    switch (pages) {
+    case cn_pages::huge:
+      return "huge pages";
+    case cn_pages::transparent_huge:
+      return "transparent huge pages";
+    default:
+      return "regular pages";
+    }
+  }
+
+  size_t cn_context_count(cn_pages pages) {
+    return context_counts[static_cast<size_t>(pages)].load();
+  }
+
 #if defined(WIN32)
 
   cn_context::cn_context() {
-    data = VirtualAlloc(nullptr, MAP_SIZE, MEM_COMMIT, PAGE_READWRITE);
+    page_kind = cn_pages::regular;
+    data = nullptr;
+
+    // large pages need SeLockMemoryPrivilege, without it allocation fails and regular pages are used
+    SIZE_T large_page_size = GetLargePageMinimum();
+    if (large_page_size != 0) {
+      SIZE_T size = (MAP_SIZE + large_page_size - 1) / large_page_size * large_page_size;
+      data = VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE);
+      if (data != nullptr) {
+        page_kind = cn_pages::huge;
+      }
+    }
+
     if (data == nullptr) {
-      throw bad_alloc();
+      data = VirtualAlloc(nullptr, MAP_SIZE, MEM_COMMIT, PAGE_READWRITE);
+      if (data == nullptr) {
+        throw bad_alloc();
+      }
     }
+
+    count_context(page_kind, true);
   }
 
   cn_context::~cn_context() {
+    count_context(page_kind, false);
     if (!VirtualFree(data, 0, MEM_RELEASE)) {
       throw bad_alloc();
     }
   }
 
-#else
+#elif defined(__APPLE__)
 
   cn_context::cn_context() {
-#if !defined(__APPLE__)
-    data = mmap(nullptr, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
-#else
+    page_kind = cn_pages::regular;
     data = mmap(nullptr, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
-#endif
     if (data == MAP_FAILED) {
       throw bad_alloc();
     }
     mlock(data, MAP_SIZE);
+    count_context(page_kind, true);
+  }
+
+  cn_context::~cn_context() {
+    count_context(page_kind, false);
+    if (munmap(data, MAP_SIZE) != 0) {
+      throw bad_alloc();
+    }
+  }
+
+#else
+
+  cn_context::cn_context() {
+    // reserve address space for a context starting at a huge page boundary, then map the scratchpad part
+    // with huge pages if there are some reserved, and with regular pages advised to be transparent huge otherwise
+    const size_t reserve_size = MAP_SIZE + HUGE_PAGE_SIZE;
+    void *reserve = mmap(nullptr, reserve_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (reserve == MAP_FAILED) {
+      throw bad_alloc();
+    }
+
+    char *reserve_begin = static_cast<char *>(reserve);
+    char *begin = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(reserve_begin) + HUGE_PAGE_SIZE - 1) & ~static_cast<uintptr_t>(HUGE_PAGE_SIZE - 1));
+    char *end = begin + MAP_SIZE;
+    if (begin != reserve_begin) {
+      munmap(reserve_begin, begin - reserve_begin);
+    }
+
+    munmap(end, reserve_begin + reserve_size - end);
+
+    page_kind = cn_pages::regular;
+#if defined(MAP_HUGETLB)
+    if (mmap(begin, HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB, -1, 0) != MAP_FAILED) {
+      page_kind = cn_pages::huge;
+    }
+#endif
+
+    if (page_kind != cn_pages::huge) {
+      if (mmap(begin, HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED) {
+        munmap(begin, MAP_SIZE);
+        throw bad_alloc();
+      }
+
+#if defined(MADV_HUGEPAGE)
+      if (madvise(begin, HUGE_PAGE_SIZE, MADV_HUGEPAGE) == 0) {
+        page_kind = cn_pages::transparent_huge;
+      }
+#endif
+    }
+
+    if (mmap(begin + HUGE_PAGE_SIZE, MAP_SIZE - HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED) {
+      munmap(begin, MAP_SIZE);
+      throw bad_alloc();
+    }
+
+    data = begin;
+    // faults the pages in, after madvise so they are allocated as huge ones when possible
+    mlock(data, MAP_SIZE);
+    count_context(page_kind, true);
   }
 
   cn_context::~cn_context() {
+    count_context(page_kind, false);
     if (munmap(data, MAP_SIZE) != 0) {
       throw bad_alloc();
     }
@@ -24,44 +24,29 @@ cn_slow_hash_noaesni
 (void *restrict context, const void *restrict data, size_t length, void *restrict hash)
 {
 #define ctx ((struct cn_ctx *) context)
+#if !defined(AESNI)
   ALIGNED_DECL(uint8_t ExpandedKey[256], 16);
+  __m128i *longoutput, *expkey, *xmminput;
+#endif
   size_t i;
-  __m128i *longoutput, *expkey, *xmminput, b_x;
+  __m128i b_x;
   ALIGNED_DECL(uint64_t a[2], 16);
   hash_process(&ctx->state.hs, (const uint8_t*) data, length);
 
-  memcpy(ctx->text, ctx->state.init, INIT_SIZE_BYTE);
 #if defined(AESNI)
-  memcpy(ExpandedKey, ctx->state.hs.b, AES_KEY_SIZE);
-  ExpandAESKey256(ExpandedKey);
+  cn_explode_scratchpad_aesni(ctx);
 #else
+  memcpy(ctx->text, ctx->state.init, INIT_SIZE_BYTE);
   ctx->aes_ctx = oaes_alloc();
   oaes_key_import_data(ctx->aes_ctx, ctx->state.hs.b, AES_KEY_SIZE);
   memcpy(ExpandedKey, ctx->aes_ctx->key->exp_data, ctx->aes_ctx->key->exp_data_len);
-#endif
 
   longoutput = (__m128i *) ctx->long_state;
   expkey = (__m128i *) ExpandedKey;
   xmminput = (__m128i *) ctx->text;
 
-  //for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE)
-  //    aesni_parallel_noxor(&ctx->long_state[i], ctx->text, ExpandedKey);
-
   for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE)
   {
-#if defined(AESNI)
-    for(size_t j = 0; j < 10; j++)
-    {
-      xmminput[0] = _mm_aesenc_si128(xmminput[0], expkey[j]);
-      xmminput[1] = _mm_aesenc_si128(xmminput[1], expkey[j]);
-      xmminput[2] = _mm_aesenc_si128(xmminput[2], expkey[j]);
-      xmminput[3] = _mm_aesenc_si128(xmminput[3], expkey[j]);
-      xmminput[4] = _mm_aesenc_si128(xmminput[4], expkey[j]);
-      xmminput[5] = _mm_aesenc_si128(xmminput[5], expkey[j]);
-      xmminput[6] = _mm_aesenc_si128(xmminput[6], expkey[j]);
-      xmminput[7] = _mm_aesenc_si128(xmminput[7], expkey[j]);
-    }
-#else
     aesb_pseudo_round((uint8_t *) &xmminput[0], (uint8_t *) &xmminput[0], (uint8_t *) expkey);
     aesb_pseudo_round((uint8_t *) &xmminput[1], (uint8_t *) &xmminput[1], (uint8_t *) expkey);
     aesb_pseudo_round((uint8_t *) &xmminput[2], (uint8_t *) &xmminput[2], (uint8_t *) expkey);
@@ -70,7 +55,6 @@ cn_slow_hash_noaesni
     aesb_pseudo_round((uint8_t *) &xmminput[5], (uint8_t *) &xmminput[5], (uint8_t *) expkey);
     aesb_pseudo_round((uint8_t *) &xmminput[6], (uint8_t *) &xmminput[6], (uint8_t *) expkey);
     aesb_pseudo_round((uint8_t *) &xmminput[7], (uint8_t *) &xmminput[7], (uint8_t *) expkey);
-#endif
     _mm_store_si128(&(longoutput[(i >> 4)]), xmminput[0]);
     _mm_store_si128(&(longoutput[(i >> 4) + 1]), xmminput[1]);
     _mm_store_si128(&(longoutput[(i >> 4) + 2]), xmminput[2]);
@@ -80,6 +64,7 @@ cn_slow_hash_noaesni
     _mm_store_si128(&(longoutput[(i >> 4) + 6]), xmminput[6]);
     _mm_store_si128(&(longoutput[(i >> 4) + 7]), xmminput[7]);
   }
+#endif
 
   for (i = 0; i < 2; i++)
   {
@@ -143,17 +128,12 @@ cn_slow_hash_noaesni
     //__builtin_prefetch(&ctx->long_state[a[0] & 0x1FFFF0], 0, 3);
   }
 
-  memcpy(ctx->text, ctx->state.init, INIT_SIZE_BYTE);
 #if defined(AESNI)
-  memcpy(ExpandedKey, &ctx->state.hs.b[32], AES_KEY_SIZE);
-  ExpandAESKey256(ExpandedKey);
+  cn_implode_scratchpad_aesni(ctx);
 #else
+  memcpy(ctx->text, ctx->state.init, INIT_SIZE_BYTE);
   oaes_key_import_data(ctx->aes_ctx, &ctx->state.hs.b[32], AES_KEY_SIZE);
   memcpy(ExpandedKey, ctx->aes_ctx->key->exp_data, ctx->aes_ctx->key->exp_data_len);
-#endif
-
-  //for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE)
-  //    aesni_parallel_xor(&ctx->text, ExpandedKey, &ctx->long_state[i]);
 
   for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE)
   {
@@ -166,19 +146,6 @@ cn_slow_hash_noaesni
     xmminput[6] = _mm_xor_si128(longoutput[(i >> 4) + 6], xmminput[6]);
     xmminput[7] = _mm_xor_si128(longoutput[(i >> 4) + 7], xmminput[7]);
 
-#if defined(AESNI)
-    for(size_t j = 0; j < 10; j++)
-    {
-      xmminput[0] = _mm_aesenc_si128(xmminput[0], expkey[j]);
-      xmminput[1] = _mm_aesenc_si128(xmminput[1], expkey[j]);
-      xmminput[2] = _mm_aesenc_si128(xmminput[2], expkey[j]);
-      xmminput[3] = _mm_aesenc_si128(xmminput[3], expkey[j]);
-      xmminput[4] = _mm_aesenc_si128(xmminput[4], expkey[j]);
-      xmminput[5] = _mm_aesenc_si128(xmminput[5], expkey[j]);
-      xmminput[6] = _mm_aesenc_si128(xmminput[6], expkey[j]);
-      xmminput[7] = _mm_aesenc_si128(xmminput[7], expkey[j]);
-    }
-#else
     aesb_pseudo_round((uint8_t *) &xmminput[0], (uint8_t *) &xmminput[0], (uint8_t *) expkey);
     aesb_pseudo_round((uint8_t *) &xmminput[1], (uint8_t *) &xmminput[1], (uint8_t *) expkey);
     aesb_pseudo_round((uint8_t *) &xmminput[2], (uint8_t *) &xmminput[2], (uint8_t *) expkey);
@@ -187,11 +154,8 @@ cn_slow_hash_noaesni
     aesb_pseudo_round((uint8_t *) &xmminput[5], (uint8_t *) &xmminput[5], (uint8_t *) expkey);
     aesb_pseudo_round((uint8_t *) &xmminput[6], (uint8_t *) &xmminput[6], (uint8_t *) expkey);
     aesb_pseudo_round((uint8_t *) &xmminput[7], (uint8_t *) &xmminput[7], (uint8_t *) expkey);
-#endif
-
   }
 
-#if !defined(AESNI)
   oaes_free((OAES_CTX **) &ctx->aes_ctx);
 #endif
 
@@ -199,3 +163,5 @@ cn_slow_hash_noaesni
   hash_permutation(&ctx->state.hs);
   extra_hashes[ctx->state.hs.b[0] & 3](&ctx->state, 200, hash);
 }
+
+#undef ctx
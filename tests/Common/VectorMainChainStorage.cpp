@@ -29,6 +29,14 @@ void VectorMainChainStorage::popBlock() {
   storage.pop_back();
 }
 
+void VectorMainChainStorage::pushBlocks(const std::vector<RawBlock>& rawBlocks) {
+  storage.insert(storage.end(), rawBlocks.begin(), rawBlocks.end());
+}
+
+void VectorMainChainStorage::popBlocks(uint32_t count) {
+  storage.resize(storage.size() - count);
+}
+
 RawBlock VectorMainChainStorage::getBlockByIndex(uint32_t index) const {
   return storage.at(index);
 }
@@ -0,0 +1,92 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "ChainSwitchDeep.h"
+
+using namespace CryptoNote;
+
+gen_chain_switch_deep::gen_chain_switch_deep(size_t depth) : m_depth(depth) {
+  REGISTER_CALLBACK("mark_switch_start", gen_chain_switch_deep::mark_switch_start);
+  REGISTER_CALLBACK("check_switched", gen_chain_switch_deep::check_switched);
+}
+
+//-----------------------------------------------------------------------------------------------------
+bool gen_chain_switch_deep::generate(std::vector<test_event_entry>& events) const {
+  /*
+  (0 )-(1   )-...-(N   )                <- main chain, until alt block N + 1 isn't connected
+      \-(1'  )-...-(N'  )-(N + 1')      <- alt chain, mined by another account
+  */
+
+  GENERATE_ACCOUNT(miner_account);
+  GENERATE_ACCOUNT(alt_miner_account);
+
+  MAKE_GENESIS_BLOCK(events, blk_0, miner_account, ts_start);
+  REWIND_BLOCKS_N(events, blk_main, blk_0, miner_account, m_depth);
+  REWIND_BLOCKS_N(events, blk_alt, blk_0, alt_miner_account, m_depth);
+  DO_CALLBACK(events, "mark_switch_start");
+  MAKE_NEXT_BLOCK(events, blk_alt_top, blk_alt, alt_miner_account);
+  DO_CALLBACK(events, "check_switched");
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------------------------------
+bool gen_chain_switch_deep::mark_switch_start(CryptoNote::Core& c, size_t ev_index,
+                                              const std::vector<test_event_entry>& events) {
+  DEFINE_TESTS_ERROR_CONTEXT("gen_chain_switch_deep::mark_switch_start");
+
+  CHECK_EQ(m_depth, c.getTopBlockIndex());
+  CHECK_EQ(m_depth, c.getAlternativeBlockCount());
+
+  m_mainChainTopHash = c.getTopBlockHash();
+  m_switchStart = std::chrono::steady_clock::now();
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------------------------------
+bool gen_chain_switch_deep::check_switched(CryptoNote::Core& c, size_t ev_index,
+                                           const std::vector<test_event_entry>& events) {
+  DEFINE_TESTS_ERROR_CONTEXT("gen_chain_switch_deep::check_switched");
+
+  auto switchDuration = std::chrono::steady_clock::now() - m_switchStart;
+
+  auto altTopBlock = boost::get<BlockTemplate>(events[ev_index - 1]);
+  CHECK_EQ(m_depth + 1, c.getTopBlockIndex());
+  CHECK_TEST_CONDITION(c.getTopBlockHash() == getBlockHash(altTopBlock));
+  CHECK_TEST_CONDITION(c.hasBlock(m_mainChainTopHash));
+  CHECK_EQ(m_depth, c.getAlternativeBlockCount());
+
+  // main chain consists of the alternative blocks now
+  auto rawBlocks = c.getBlocks(0, static_cast<uint32_t>(m_depth + 2));
+  CHECK_EQ(m_depth + 2, rawBlocks.size());
+  CHECK_TEST_CONDITION(rawBlocks.back().block == toBinaryArray(altTopBlock));
+
+  // save merges the switched segments into the root one
+  auto mergeStart = std::chrono::steady_clock::now();
+  c.save();
+  auto mergeDuration = std::chrono::steady_clock::now() - mergeStart;
+
+  CHECK_EQ(m_depth + 1, c.getTopBlockIndex());
+  CHECK_TEST_CONDITION(c.getTopBlockHash() == getBlockHash(altTopBlock));
+
+  std::cout << "Reorganization of " << m_depth << " blocks: switch "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(switchDuration).count() << " ms, merge "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(mergeDuration).count() << " ms" << std::endl;
+
+  return true;
+}
@@ -0,0 +1,41 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <chrono>
+
+#include "Chaingen.h"
+
+/************************************************************************/
+/* Deep reorganization benchmark: alternative chain of depth + 1 blocks */
+/* replaces main chain of depth blocks, switch and merge are timed      */
+/************************************************************************/
+class gen_chain_switch_deep : public test_chain_unit_base {
+public:
+  explicit gen_chain_switch_deep(size_t depth = 100);
+
+  bool generate(std::vector<test_event_entry>& events) const;
+
+  bool mark_switch_start(CryptoNote::Core& c, size_t ev_index, const std::vector<test_event_entry>& events);
+  bool check_switched(CryptoNote::Core& c, size_t ev_index, const std::vector<test_event_entry>& events);
+
+private:
+  size_t m_depth;
+  Crypto::Hash m_mainChainTopHash;
+  std::chrono::steady_clock::time_point m_switchStart;
+};
@@ -23,6 +23,7 @@
 #include "BlockValidation.h"
 #include "ChainSplit1.h"
 #include "ChainSwitch1.h"
+#include "ChainSwitchDeep.h"
 #include "Chaingen001.h"
 #include "DoubleSpend.h"
 #include "IntegerOverflow.h"
@@ -82,6 +83,7 @@ int main(int argc, char* argv[]) {
 
       GENERATE_AND_PLAY(GetRandomOutputs);
       GENERATE_AND_PLAY(gen_chain_switch_1);
+      GENERATE_AND_PLAY(gen_chain_switch_deep);
       GENERATE_AND_PLAY(gen_block_reward);
       GENERATE_AND_PLAY(gen_ring_signature_1);
       GENERATE_AND_PLAY(gen_ring_signature_2);
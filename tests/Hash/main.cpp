@@ -15,11 +15,13 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <cstddef>
 #include <fstream>
 #include <iomanip>
 #include <ios>
 #include <string>
+#include <vector>
 
 #include "crypto/hash.h"
 #include "../Io.h"
@@ -46,6 +48,62 @@ extern "C" {
   }
 }
 
+// Hashes all inputs from the file with cn_slow_hash_multi, in groups of different sizes for every number of ways
+static int test_slow_multi(const char *path) {
+  fstream input;
+  vector<chash> expected;
+  vector<vector<char>> data;
+  input.open(path, ios_base::in);
+  for (;;) {
+    chash hash;
+    vector<char> item;
+    input.exceptions(ios_base::badbit);
+    get(input, hash);
+    if (input.rdstate() & ios_base::eofbit) {
+      break;
+    }
+    input.exceptions(ios_base::badbit | ios_base::failbit | ios_base::eofbit);
+    input.clear(input.rdstate());
+    get(input, item);
+    expected.push_back(hash);
+    data.push_back(item);
+  }
+
+  const size_t MAX_GROUP_SIZE = 5;
+  Crypto::cn_context contexts[MAX_GROUP_SIZE];
+  Crypto::cn_context *contextPointers[MAX_GROUP_SIZE];
+  for (size_t i = 0; i < MAX_GROUP_SIZE; i++) {
+    contextPointers[i] = &contexts[i];
+  }
+
+  bool error = false;
+  for (size_t ways = 1; ways <= 4; ways *= 2) {
+    Crypto::cn_slow_hash_set_multi_ways(ways);
+    for (size_t groupSize = 1; groupSize <= MAX_GROUP_SIZE; groupSize++) {
+      for (size_t first = 0; first < data.size(); first += groupSize) {
+        size_t count = min(groupSize, data.size() - first);
+        vector<const void *> inputs;
+        vector<size_t> lengths;
+        vector<chash> actual(count);
+        for (size_t i = first; i < first + count; i++) {
+          inputs.push_back(data[i].data());
+          lengths.push_back(data[i].size());
+        }
+
+        Crypto::cn_slow_hash_multi(contextPointers, inputs.data(), lengths.data(), actual.data(), count);
+        for (size_t i = 0; i < count; i++) {
+          if (expected[first + i] != actual[i]) {
+            cerr << "Hash mismatch on test " << first + i + 1 << " in group of " << groupSize << ", " << ways << "-way" << endl;
+            error = true;
+          }
+        }
+      }
+    }
+  }
+
+  return error ? 1 : 0;
+}
+
 extern "C" typedef void hash_f(const void *, size_t, char *);
 struct hash_func {
   const string name;
@@ -66,6 +124,9 @@ int main(int argc, char *argv[]) {
     cerr << "Wrong number of arguments" << endl;
     return 1;
   }
+  if (argv[1] == string("slow-multi")) {
+    return test_slow_multi(argv[2]);
+  }
   for (hf = hashes;; hf++) {
     if (hf >= &hashes[sizeof(hashes) / sizeof(hash_func)]) {
       cerr << "Unknown function" << endl;
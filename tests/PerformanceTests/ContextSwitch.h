@@ -0,0 +1,59 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "System/Context.h"
+#include "System/Dispatcher.h"
+#include "System/Event.h"
+
+// Ping-pong between the main context and a spawned one, every round switches context twice
+class test_context_switch {
+public:
+  static const size_t loop_count = 10;
+  static const size_t round_count = 100000;
+  static const size_t operations_per_call = 2 * round_count;
+
+  bool init() {
+    return true;
+  }
+
+  bool test() {
+    System::Event ping(m_dispatcher);
+    System::Event pong(m_dispatcher);
+    System::Context<> context(m_dispatcher, [&] {
+      for (size_t i = 0; i < round_count; ++i) {
+        ping.wait();
+        ping.clear();
+        pong.set();
+      }
+    });
+
+    for (size_t i = 0; i < round_count; ++i) {
+      ping.set();
+      pong.wait();
+      pong.clear();
+    }
+
+    context.get();
+    return true;
+  }
+
+private:
+  System::Dispatcher m_dispatcher;
+};
@@ -57,3 +57,47 @@ private:
   Crypto::Hash m_expected_hash;
   Crypto::cn_context m_context;
 };
+
+// Hashes 'ways' inputs per call with 'ways'-way cn_slow_hash_multi, time per hash is reported time divided by 'ways'
+template<size_t ways>
+class test_cn_slow_hash_multi {
+public:
+  static const size_t loop_count = 10;
+
+  bool init() {
+    Crypto::cn_slow_hash_set_multi_ways(ways);
+    for (size_t i = 0; i < ways; ++i) {
+      m_contextPointers[i] = &m_contexts[i];
+      m_inputs[i] = &m_data;
+      m_lengths[i] = sizeof(m_data);
+    }
+
+    size_t size;
+    if (!Common::fromHex("63617665617420656d70746f72", &m_data, sizeof(m_data), size) || size != sizeof(m_data)) {
+      return false;
+    }
+
+    return Common::fromHex("bbec2cacf69866a8e740380fe7b818fc78f8571221742d729d9d02d7f8989b87", &m_expected_hash, sizeof(m_expected_hash), size) &&
+      size == sizeof(m_expected_hash);
+  }
+
+  bool test() {
+    Crypto::Hash hashes[ways];
+    Crypto::cn_slow_hash_multi(m_contextPointers, m_inputs, m_lengths, hashes, ways);
+    for (size_t i = 0; i < ways; ++i) {
+      if (hashes[i] != m_expected_hash) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+private:
+  test_cn_slow_hash::data_t m_data;
+  Crypto::Hash m_expected_hash;
+  Crypto::cn_context m_contexts[ways];
+  Crypto::cn_context* m_contextPointers[ways];
+  const void* m_inputs[ways];
+  size_t m_lengths[ways];
+};
@@ -0,0 +1,114 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "Common/StringTools.h"
+#include "Rpc/CoreRpcServerCommandsDefinitions.h"
+#include "Serialization/SerializationTools.h"
+
+namespace {
+
+// Similar to responses of getblockheaderbyheight and gettransactions RPC commands
+struct json_test_payload {
+  std::vector<CryptoNote::block_header_response> headers;
+  std::vector<std::string> txs_as_hex;
+  std::string status;
+
+  void serialize(CryptoNote::ISerializer& s) {
+    KV_MEMBER(headers)
+    KV_MEMBER(txs_as_hex)
+    KV_MEMBER(status)
+  }
+};
+
+json_test_payload make_json_test_payload() {
+  json_test_payload payload;
+  for (uint32_t i = 0; i < 100; ++i) {
+    CryptoNote::block_header_response header;
+    header.major_version = 1;
+    header.minor_version = 0;
+    header.timestamp = 1500000000 + i * 120;
+    header.prev_hash = Common::toHex(std::string(32, static_cast<char>(i)).data(), 32);
+    header.nonce = i * 7919;
+    header.orphan_status = false;
+    header.height = 1000000 + i;
+    header.depth = 100 - i;
+    header.hash = Common::toHex(std::string(32, static_cast<char>(i + 1)).data(), 32);
+    header.difficulty = 123456789 + i;
+    header.reward = 12345678901 + i;
+    payload.headers.push_back(header);
+  }
+
+  for (uint32_t i = 0; i < 20; ++i) {
+    payload.txs_as_hex.push_back(Common::toHex(std::string(2000, static_cast<char>(i)).data(), 2000));
+  }
+
+  payload.status = "OK";
+  return payload;
+}
+
+}
+
+// 'direct' selects JsonOutputStringSerializer, otherwise Common::JsonValue is built and converted to string
+template<bool direct>
+class test_json_store {
+public:
+  static const size_t loop_count = 1000;
+
+  bool init() {
+    m_payload = make_json_test_payload();
+    return true;
+  }
+
+  bool test() {
+    std::string json = direct ? CryptoNote::storeToJson(m_payload) : CryptoNote::storeToJsonValue(m_payload).toString();
+    return !json.empty();
+  }
+
+private:
+  json_test_payload m_payload;
+};
+
+// 'direct' selects JsonInputStreamSerializer, otherwise text is parsed to Common::JsonValue first
+template<bool direct>
+class test_json_load {
+public:
+  static const size_t loop_count = 1000;
+
+  bool init() {
+    m_json = CryptoNote::storeToJson(make_json_test_payload());
+    return true;
+  }
+
+  bool test() {
+    json_test_payload payload;
+    if (direct) {
+      if (!CryptoNote::loadFromJson(payload, m_json)) {
+        return false;
+      }
+    } else {
+      CryptoNote::loadFromJsonValue(payload, Common::JsonValue::fromString(m_json));
+    }
+
+    return payload.headers.size() == 100;
+  }
+
+private:
+  std::string m_json;
+};
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <stdint.h>
 
@@ -125,7 +126,27 @@ void run_test(const char* test_name)
   }
 }
 
+// for tests doing T::operations_per_call operations per call, reports how many of them run per second
+template <typename T>
+void run_rate_test(const char* test_name, const char* operations_name)
+{
+  test_runner<T> runner;
+  if (runner.run())
+  {
+    std::cout << test_name << " - OK:\n";
+    std::cout << "  loop count:    " << T::loop_count << '\n';
+    std::cout << "  elapsed:       " << runner.elapsed_time() << " ms\n";
+    std::cout << "  " << operations_name << " per second: "
+              << T::loop_count * T::operations_per_call * 1000 / std::max(runner.elapsed_time(), 1) << '\n' << std::endl;
+  }
+  else
+  {
+    std::cout << test_name << " - FAILED" << std::endl;
+  }
+}
+
 #define QUOTEME(x) #x
 #define TEST_PERFORMANCE0(test_class)         run_test< test_class >(QUOTEME(test_class))
 #define TEST_PERFORMANCE1(test_class, a0)     run_test< test_class<a0> >(QUOTEME(test_class<a0>))
 #define TEST_PERFORMANCE2(test_class, a0, a1) run_test< test_class<a0, a1> >(QUOTEME(test_class) "<" QUOTEME(a0) ", " QUOTEME(a1) ">")
+#define TEST_PERFORMANCE_RATE0(test_class, operations_name) run_rate_test< test_class >(QUOTEME(test_class), operations_name)
@@ -21,6 +21,7 @@
 // tests
 #include "ConstructTransaction.h"
 #include "CheckRingSignature.h"
+#include "ContextSwitch.h"
 #include "CryptoNoteSlowHash.h"
 #include "DerivePublicKey.h"
 #include "DeriveSecretKey.h"
@@ -28,6 +29,7 @@
 #include "GenerateKeyImage.h"
 #include "GenerateKeyImageHelper.h"
 #include "IsOutToAccount.h"
+#include "JsonSerialization.h"
 
 int main(int argc, char** argv)
 {
@@ -71,6 +73,16 @@ int main(int argc, char** argv)
   TEST_PERFORMANCE0(test_derive_secret_key);
 
   TEST_PERFORMANCE0(test_cn_slow_hash);
+  TEST_PERFORMANCE1(test_cn_slow_hash_multi, 1);
+  TEST_PERFORMANCE1(test_cn_slow_hash_multi, 2);
+  TEST_PERFORMANCE1(test_cn_slow_hash_multi, 4);
+
+  TEST_PERFORMANCE1(test_json_store, false);
+  TEST_PERFORMANCE1(test_json_store, true);
+  TEST_PERFORMANCE1(test_json_load, false);
+  TEST_PERFORMANCE1(test_json_load, true);
+
+  TEST_PERFORMANCE_RATE0(test_context_switch, "context switches");
 
   std::cout << "Tests finished. Elapsed time: " << timer.elapsed_ms() / 1000 << " sec" << std::endl;
 
@@ -0,0 +1,120 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <future>
+#include <thread>
+
+#include <System/DispatcherPool.h>
+#include <System/Dispatcher.h>
+#include <System/ContextGroup.h>
+#include <System/Event.h>
+#include <System/InterruptedException.h>
+#include <System/Ipv4Address.h>
+#include <System/TcpConnection.h>
+#include <System/TcpConnector.h>
+#include <System/TcpListener.h>
+#include <System/Timer.h>
+#include <gtest/gtest.h>
+
+using namespace System;
+
+TEST(DispatcherPoolTests, createsRequestedLoopCount) {
+  DispatcherPool pool(3);
+  ASSERT_EQ(3, pool.getLoopCount());
+}
+
+TEST(DispatcherPoolTests, spawnRunsProcedureInLoopThread) {
+  DispatcherPool pool(2);
+  std::promise<std::thread::id> promise;
+  pool.spawn(1, [&] {
+    promise.set_value(std::this_thread::get_id());
+  });
+
+  ASSERT_NE(std::this_thread::get_id(), promise.get_future().get());
+}
+
+TEST(DispatcherPoolTests, loopsRunInDifferentThreads) {
+  DispatcherPool pool(2);
+  std::promise<std::thread::id> first;
+  std::promise<std::thread::id> second;
+  pool.spawn(0, [&] { first.set_value(std::this_thread::get_id()); });
+  pool.spawn(1, [&] { second.set_value(std::this_thread::get_id()); });
+
+  ASSERT_NE(first.get_future().get(), second.get_future().get());
+}
+
+TEST(DispatcherPoolTests, spawnChoosesLeastLoadedLoop) {
+  DispatcherPool pool(2);
+  std::promise<void> started;
+  pool.spawn(0, [&] {
+    started.set_value();
+    Timer(pool.getDispatcher(0)).sleep(std::chrono::seconds(10));
+  });
+
+  started.get_future().wait();
+  ASSERT_EQ(1, pool.getLoad(0));
+  ASSERT_EQ(1, pool.getLeastLoadedLoop());
+
+  std::promise<void> done;
+  ASSERT_EQ(1, pool.spawn([&] { done.set_value(); }));
+  done.get_future().wait();
+}
+
+TEST(DispatcherPoolTests, stopInterruptsRunningProcedures) {
+  std::atomic<bool> interrupted(false);
+  {
+    DispatcherPool pool(1);
+    std::promise<void> started;
+    pool.spawn(0, [&] {
+      started.set_value();
+      try {
+        Timer(pool.getDispatcher(0)).sleep(std::chrono::seconds(10));
+      } catch (InterruptedException&) {
+        interrupted = true;
+      }
+    });
+
+    started.get_future().wait();
+  }
+
+  ASSERT_TRUE(interrupted);
+}
+
+TEST(DispatcherPoolTests, acceptedConnectionCanBeUsedInOtherLoop) {
+  Dispatcher dispatcher;
+  DispatcherPool pool(1);
+  TcpListener listener(dispatcher, Ipv4Address("127.0.0.1"), 6666);
+  ContextGroup contextGroup(dispatcher);
+  contextGroup.spawn([&] {
+    TcpConnector connector(dispatcher);
+    TcpConnection connection = connector.connect(Ipv4Address("127.0.0.1"), 6666);
+    uint8_t data = 42;
+    connection.write(&data, 1);
+  });
+
+  auto connection = std::make_shared<TcpConnection>(listener.accept(pool.getDispatcher(0)));
+  contextGroup.wait();
+
+  std::promise<uint8_t> received;
+  pool.spawn(0, [&, connection] {
+    uint8_t data = 0;
+    connection->read(&data, 1);
+    received.set_value(data);
+  });
+
+  ASSERT_EQ(42, received.get_future().get());
+}
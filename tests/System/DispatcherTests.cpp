@@ -15,6 +15,7 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <cfenv>
 #include <future>
 #include <System/Context.h>
 #include <System/Dispatcher.h>
@@ -386,3 +387,73 @@ TEST_F(DispatcherTests, yieldExecutesIoOnItsFront) {
   dispatcher.yield();
   ASSERT_TRUE(spawnDone);
 }
+
+TEST_F(DispatcherTests, floatingPointStateIsPreservedAcrossSwitches) {
+  double value = 1.5;
+  Event event(dispatcher);
+  Context<> context(dispatcher, [&]() {
+    double other = 2.25;
+    event.wait();
+    value *= other;
+  });
+
+  dispatcher.yield();
+  double local = value * 3;
+  event.set();
+  context.get();
+  ASSERT_EQ(4.5, local);
+  ASSERT_EQ(3.375, value);
+}
+
+TEST_F(DispatcherTests, floatingPointControlStateIsPreservedAcrossSwitches) {
+  // fesetround changes both x87 control word and MXCSR on x86-64 and FPCR on aarch64
+  int previousRounding = fegetround();
+  ASSERT_EQ(0, fesetround(FE_DOWNWARD));
+
+  volatile double one = 1.0;
+  volatile double three = 3.0;
+  int contextRounding = -1;
+  double contextQuotient = 0;
+  Event event(dispatcher);
+  Context<> context(dispatcher, [&]() {
+    fesetround(FE_UPWARD);
+    event.wait();
+    contextRounding = fegetround();
+    contextQuotient = one / three;
+  });
+
+  dispatcher.yield();
+  int mainRounding = fegetround();
+  double mainQuotient = one / three;
+  event.set();
+  context.get();
+  int mainRoundingAfterContext = fegetround();
+  fesetround(previousRounding);
+
+  ASSERT_EQ(FE_DOWNWARD, mainRounding);
+  ASSERT_EQ(FE_DOWNWARD, mainRoundingAfterContext);
+  ASSERT_EQ(FE_UPWARD, contextRounding);
+  ASSERT_LT(mainQuotient, contextQuotient);
+}
+
+TEST_F(DispatcherTests, manyContextSwitchesComplete) {
+  const size_t ROUND_COUNT = 200000;
+  Event ping(dispatcher);
+  Event pong(dispatcher);
+  Context<> context(dispatcher, [&]() {
+    for (size_t i = 0; i < ROUND_COUNT; ++i) {
+      ping.wait();
+      ping.clear();
+      pong.set();
+    }
+  });
+
+  for (size_t i = 0; i < ROUND_COUNT; ++i) {
+    ping.set();
+    pong.wait();
+    pong.clear();
+  }
+
+  context.get();
+  SUCCEED();
+}
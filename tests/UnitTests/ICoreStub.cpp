@@ -292,6 +292,18 @@ std::vector<Crypto::Hash> ICoreStub::getPoolTransactionHashes() const {
   return {};
 }
 
+void ICoreStub::getPoolTransactions(const std::vector<Crypto::Hash>& txs_ids, std::vector<CryptoNote::BinaryArray>& txs,
+                                    std::vector<Crypto::Hash>& missed_txs) const {
+  for (const Crypto::Hash& hash : txs_ids) {
+    auto iter = transactionPool.find(hash);
+    if (iter != transactionPool.end()) {
+      txs.push_back(iter->second);
+    } else {
+      missed_txs.push_back(hash);
+    }
+  }
+}
+
 bool ICoreStub::getBlockTemplate(CryptoNote::BlockTemplate& b, const CryptoNote::AccountPublicAddress& adr, const CryptoNote::BinaryArray& extraNonce, CryptoNote::Difficulty& difficulty, uint32_t& height) const {
   assert(false);
   return false;
@@ -320,11 +332,20 @@ std::error_code ICoreStub::addBlock(const CryptoNote::CachedBlock& cachedBlock,
   return {};
 }
 
+std::error_code ICoreStub::addBlock(const CryptoNote::CachedBlock& cachedBlock, std::vector<CryptoNote::CachedTransaction>&& transactions, CryptoNote::RawBlock&& rawBlock) {
+  assert(false);
+  return {};
+}
+
 std::error_code ICoreStub::addBlock(CryptoNote::RawBlock&& rawBlock) {
   assert(false);
   return {};
 }
 
+bool ICoreStub::isInCheckpointZone(uint32_t blockIndex) const {
+  return true;
+}
+
 bool ICoreStub::hasBlock(const Crypto::Hash& id) const {
   return blocks.count(id) > 0;
 }
@@ -353,6 +374,20 @@ CryptoNote::BlockDetails ICoreStub::getBlockDetails(const Crypto::Hash& blockHas
   return details;
 }
 
+std::vector<CryptoNote::BlockDetails> ICoreStub::getBlocksDetails(uint32_t startIndex, uint32_t count) const {
+  std::vector<CryptoNote::BlockDetails> blocksDetails;
+  for (uint32_t index = startIndex; index < startIndex + count; ++index) {
+    auto it = blockHashByHeightIndex.find(index);
+    if (it == blockHashByHeightIndex.end()) {
+      break;
+    }
+
+    blocksDetails.push_back(getBlockDetails(it->second));
+  }
+
+  return blocksDetails;
+}
+
 CryptoNote::TransactionDetails ICoreStub::getTransactionDetails(const Crypto::Hash& transactionHash) const {
   CryptoNote::BinaryArray transactionBinaryArray;
 
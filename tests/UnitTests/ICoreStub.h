@@ -50,7 +50,9 @@ public:
   
   virtual CryptoNote::Difficulty getDifficultyForNextBlock() const override;
   virtual std::error_code addBlock(const CryptoNote::CachedBlock& cachedBlock, CryptoNote::RawBlock&& rawBlock) override;
+  virtual std::error_code addBlock(const CryptoNote::CachedBlock& cachedBlock, std::vector<CryptoNote::CachedTransaction>&& transactions, CryptoNote::RawBlock&& rawBlock) override;
   virtual std::error_code addBlock(CryptoNote::RawBlock&& rawBlock) override;
+  virtual bool isInCheckpointZone(uint32_t blockIndex) const override;
   virtual std::error_code submitBlock(CryptoNote::BinaryArray&& rawBlockTemplate) override;
   
   virtual std::vector<CryptoNote::RawBlock> getBlocks(uint32_t startIndex, uint32_t count) const override;
@@ -58,6 +60,7 @@ public:
   virtual bool getRandomOutputs(uint64_t amount, uint16_t count, std::vector<uint32_t>& globalIndexes, std::vector<Crypto::PublicKey>& publicKeys) const override;
   virtual bool addTransactionToPool(const CryptoNote::BinaryArray& transactionBinaryArray) override;
   virtual std::vector<Crypto::Hash> getPoolTransactionHashes() const override;
+  virtual void getPoolTransactions(const std::vector<Crypto::Hash>& txs_ids, std::vector<CryptoNote::BinaryArray>& txs, std::vector<Crypto::Hash>& missed_txs) const override;
   virtual bool getBlockTemplate(CryptoNote::BlockTemplate& b, const CryptoNote::AccountPublicAddress& adr, const CryptoNote::BinaryArray& extraNonce, CryptoNote::Difficulty& difficulty, uint32_t& height) const override;
 
   virtual CryptoNote::CoreStatistics getCoreStatistics() const override;
@@ -99,6 +102,7 @@ public:
 
   virtual bool hasTransaction(const Crypto::Hash& transactionHash) const override;
   virtual CryptoNote::BlockDetails getBlockDetails(const Crypto::Hash& blockHash) const override;
+  virtual std::vector<CryptoNote::BlockDetails> getBlocksDetails(uint32_t startIndex, uint32_t count) const override;
   virtual CryptoNote::TransactionDetails getTransactionDetails(const Crypto::Hash& transactionHash) const override;
   virtual std::vector<Crypto::Hash> getAlternativeBlockHashesByIndex(uint32_t blockIndex) const override;
   virtual std::vector<Crypto::Hash> getBlockHashesByTimestamps(uint64_t timestampBegin, size_t secondsCount) const override { return {};}
@@ -23,9 +23,68 @@
 #include "Serialization/BinaryOutputStreamSerializer.h"
 #include "Serialization/BinarySerializationTools.h"
 
+#include "Common/MemoryInputStream.h"
+#include "Common/StringOutputStream.h"
+#include "CryptoNoteCore/CryptoNoteSerialization.h"
+
 using namespace Common;
 using namespace CryptoNote;
 
+namespace {
+
+// Writes arrays element by element, as BinaryOutputStreamSerializer did before bulk array support
+class ElementwiseOutputSerializer : public BinaryOutputStreamSerializer {
+public:
+  ElementwiseOutputSerializer(IOutputStream& stream) : BinaryOutputStreamSerializer(stream) {}
+
+  virtual bool binaryArray(void* value, size_t elementSize, size_t count) override { return false; }
+  virtual bool varintArray(uint32_t* value, size_t count) override { return false; }
+  virtual bool varintArray(uint64_t* value, size_t count) override { return false; }
+
+  template<typename T>
+  bool operator()(T& value, Common::StringView name) {
+    return ISerializer::operator()(value, name);
+  }
+};
+
+template<typename T>
+std::string storeBulk(T& value) {
+  std::string result;
+  StringOutputStream stream(result);
+  BinaryOutputStreamSerializer s(stream);
+  s(value, "");
+  return result;
+}
+
+template<typename T>
+std::string storeElementwise(T& value) {
+  std::string result;
+  StringOutputStream stream(result);
+  ElementwiseOutputSerializer s(stream);
+  s(value, "");
+  return result;
+}
+
+template<typename T>
+T load(const std::string& data) {
+  T value;
+  MemoryInputStream stream(data.data(), data.size());
+  BinaryInputStreamSerializer s(stream);
+  s(value, "");
+  EXPECT_TRUE(stream.endOfStream());
+  return value;
+}
+
+template<typename T>
+void fillPod(T& value, uint8_t seed) {
+  uint8_t* data = reinterpret_cast<uint8_t*>(&value);
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    data[i] = static_cast<uint8_t>(seed + i * 7);
+  }
+}
+
+}
+
 TEST(BinarySerializer, uint16) {
 
   std::stringstream ss;
@@ -55,6 +114,92 @@ TEST(BinarySerializer, uint16) {
   }
 }
 
+TEST(BinarySerializer, podVectorIsWireCompatible) {
+  std::vector<Crypto::Hash> hashes(5);
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    fillPod(hashes[i], static_cast<uint8_t>(i));
+  }
+
+  std::string data = storeBulk(hashes);
+  ASSERT_EQ(storeElementwise(hashes), data);
+  ASSERT_EQ(1 + hashes.size() * sizeof(Crypto::Hash), data.size());
+  ASSERT_EQ(hashes, load<std::vector<Crypto::Hash>>(data));
+}
+
+TEST(BinarySerializer, varintVectorIsWireCompatible) {
+  std::vector<uint32_t> small;
+  std::vector<uint64_t> large;
+  for (uint32_t i = 0; i < 1000; ++i) {
+    small.push_back(i * 2654435761u);
+    large.push_back(static_cast<uint64_t>(i) << (i % 64));
+  }
+
+  large.push_back(std::numeric_limits<uint64_t>::max());
+  small.push_back(std::numeric_limits<uint32_t>::max());
+
+  std::string smallData = storeBulk(small);
+  ASSERT_EQ(storeElementwise(small), smallData);
+  ASSERT_EQ(small, load<std::vector<uint32_t>>(smallData));
+
+  std::string largeData = storeBulk(large);
+  ASSERT_EQ(storeElementwise(large), largeData);
+  ASSERT_EQ(large, load<std::vector<uint64_t>>(largeData));
+}
+
+TEST(BinarySerializer, emptyVectorRoundTrip) {
+  std::vector<Crypto::KeyImage> images;
+  std::string data = storeBulk(images);
+  ASSERT_EQ(std::string(1, '\0'), data);
+  ASSERT_TRUE(load<std::vector<Crypto::KeyImage>>(data).empty());
+}
+
+TEST(BinarySerializer, truncatedPodVectorThrows) {
+  std::vector<Crypto::PublicKey> keys(3);
+  std::string data = storeBulk(keys);
+  data.pop_back();
+
+  MemoryInputStream stream(data.data(), data.size());
+  BinaryInputStreamSerializer s(stream);
+  std::vector<Crypto::PublicKey> loaded;
+  ASSERT_ANY_THROW(s(loaded, ""));
+}
+
+TEST(BinarySerializer, transactionIsWireCompatible) {
+  Transaction tx;
+  tx.version = 1;
+  tx.unlockTime = 0x7f1234560089abcd;
+
+  for (uint8_t i = 0; i < 3; ++i) {
+    KeyInput input;
+    input.amount = 1000000 + i;
+    for (uint32_t j = 0; j <= i; ++j) {
+      input.outputIndexes.push_back(j * 100000 + i);
+    }
+
+    fillPod(input.keyImage, i);
+    tx.inputs.push_back(input);
+
+    std::vector<Crypto::Signature> signatures(input.outputIndexes.size());
+    for (auto& signature : signatures) {
+      fillPod(signature, static_cast<uint8_t>(i + 100));
+    }
+
+    tx.signatures.push_back(signatures);
+  }
+
+  KeyOutput output;
+  fillPod(output.key, 200);
+  tx.outputs.push_back({12345, output});
+  tx.extra = {1, 2, 3};
+
+  std::string data = storeBulk(tx);
+  ASSERT_EQ(storeElementwise(tx), data);
+
+  Transaction loaded = load<Transaction>(data);
+  ASSERT_EQ(tx.signatures, loaded.signatures);
+  ASSERT_EQ(data, storeBulk(loaded));
+}
+
 
 //#include <cstring>
 //#include <cstdint>
@@ -0,0 +1,173 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include <array>
+#include <limits>
+#include <sstream>
+
+#include "Serialization/JsonInputStreamSerializer.h"
+#include "Serialization/JsonOutputStringSerializer.h"
+#include "Serialization/SerializationOverloads.h"
+#include "Serialization/SerializationTools.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+struct JsonTestItem {
+  std::string text;
+  int32_t number;
+
+  bool operator==(const JsonTestItem& other) const {
+    return text == other.text && number == other.number;
+  }
+
+  void serialize(ISerializer& s) {
+    KV_MEMBER(text)
+    KV_MEMBER(number)
+  }
+};
+
+struct JsonTestStruct {
+  uint8_t u8;
+  int16_t i16;
+  uint32_t u32;
+  int64_t i64;
+  uint64_t u64;
+  double real;
+  bool flag;
+  std::string text;
+  std::array<uint8_t, 8> blob;
+  std::string binaryString;
+  std::vector<JsonTestItem> items;
+  std::vector<uint32_t> numbers;
+  JsonTestItem item;
+
+  bool operator==(const JsonTestStruct& other) const {
+    return u8 == other.u8 && i16 == other.i16 && u32 == other.u32 && i64 == other.i64 && u64 == other.u64 && real == other.real &&
+      flag == other.flag && text == other.text && blob == other.blob && binaryString == other.binaryString && items == other.items &&
+      numbers == other.numbers && item == other.item;
+  }
+
+  void serialize(ISerializer& s) {
+    KV_MEMBER(u8)
+    KV_MEMBER(i16)
+    KV_MEMBER(u32)
+    KV_MEMBER(i64)
+    KV_MEMBER(u64)
+    KV_MEMBER(real)
+    KV_MEMBER(flag)
+    KV_MEMBER(text)
+    s.binary(blob.data(), blob.size(), "blob");
+    s.binary(binaryString, "binaryString");
+    KV_MEMBER(items)
+    KV_MEMBER(numbers)
+    KV_MEMBER(item)
+  }
+};
+
+JsonTestStruct makeTestStruct() {
+  JsonTestStruct value;
+  value.u8 = 200;
+  value.i16 = -12345;
+  value.u32 = 0xfedcba98;
+  value.i64 = std::numeric_limits<int64_t>::min();
+  value.u64 = std::numeric_limits<uint64_t>::max() - 1;
+  value.real = 0.5;
+  value.flag = true;
+  value.text = "text with spaces";
+  value.blob = {{1, 2, 3, 4, 5, 6, 7, 8}};
+  value.binaryString = std::string("\x00\xff\x10", 3);
+  value.items = {{"first", 1}, {"second", -2}};
+  value.numbers = {1, 2, 3};
+  value.item = {"item", 42};
+  return value;
+}
+
+}
+
+TEST(JsonSerialization, roundTrip) {
+  JsonTestStruct value = makeTestStruct();
+  JsonTestStruct loaded;
+
+  ASSERT_TRUE(loadFromJson(loaded, storeToJson(value)));
+  ASSERT_EQ(value, loaded);
+}
+
+TEST(JsonSerialization, readsJsonValueOutput) {
+  JsonTestStruct value = makeTestStruct();
+  JsonTestStruct loaded;
+
+  ASSERT_TRUE(loadFromJson(loaded, storeToJsonValue(value).toString()));
+  ASSERT_EQ(value, loaded);
+}
+
+TEST(JsonSerialization, outputIsReadableByJsonValue) {
+  JsonTestItem value{"text", -42};
+  JsonTestItem loaded;
+
+  loadFromJsonValue(loaded, Common::JsonValue::fromString(storeToJson(value)));
+  ASSERT_EQ(value, loaded);
+}
+
+TEST(JsonSerialization, streamConstructorReadsWholeStream) {
+  JsonTestStruct value = makeTestStruct();
+  JsonTestStruct loaded;
+
+  std::istringstream stream(storeToJson(value));
+  JsonInputStreamSerializer serializer(stream);
+  serialize(loaded, serializer);
+  ASSERT_EQ(value, loaded);
+}
+
+TEST(JsonSerialization, parsesWhitespaceAndMembersInAnyOrder) {
+  JsonTestItem item;
+  ASSERT_TRUE(loadFromJson(item, " {\n \"number\" : -7 ,\t\"unknown\" : [1, {\"a\": null}, true, 1.5e3], \"text\": \"a b\\\"c\" } "));
+  ASSERT_EQ(-7, item.number);
+  ASSERT_EQ("a b\\\"c", item.text);
+}
+
+TEST(JsonSerialization, malformedInputIsRejected) {
+  std::string json = storeToJson(makeTestStruct());
+  JsonTestStruct loaded;
+  for (size_t size = 1; size < json.size(); ++size) {
+    ASSERT_FALSE(loadFromJson(loaded, json.substr(0, size))) << json.substr(0, size);
+  }
+
+  ASSERT_FALSE(loadFromJson(loaded, "[]"));
+  ASSERT_FALSE(loadFromJson(loaded, "{\"u8\": 01}"));
+  ASSERT_FALSE(loadFromJson(loaded, "{\"u8\": \"1\"}"));
+  ASSERT_FALSE(loadFromJson(loaded, "{\"u64\": 18446744073709551616}"));
+}
+
+TEST(JsonSerialization, onlyWhitespaceIsAcceptedAfterValue) {
+  JsonTestItem item;
+  ASSERT_TRUE(loadFromJson(item, "{\"number\": 1} \r\n\t"));
+  ASSERT_FALSE(loadFromJson(item, "{\"number\": 1} x"));
+  ASSERT_FALSE(loadFromJson(item, "{\"number\": 1}{}"));
+  ASSERT_FALSE(loadFromJson(item, "{\"number\": 1},"));
+  ASSERT_FALSE(loadFromJson(item, std::string("{\"number\": 1}\0", 15)));
+}
+
+TEST(JsonSerialization, unsignedValuesAboveInt64AreAccepted) {
+  JsonTestStruct loaded;
+  ASSERT_TRUE(loadFromJson(loaded, "{\"u64\": 18446744073709551615}"));
+  ASSERT_EQ(std::numeric_limits<uint64_t>::max(), loaded.u64);
+}
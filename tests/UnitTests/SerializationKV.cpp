@@ -19,6 +19,7 @@
 
 #include <boost/lexical_cast.hpp>
 
+#include "Serialization/KVBinaryCommon.h"
 #include "Serialization/KVBinaryInputStreamSerializer.h"
 #include "Serialization/KVBinaryOutputStreamSerializer.h"
 #include "Serialization/SerializationOverloads.h"
@@ -152,3 +153,115 @@ TEST(KVSerialize, DISABLED_CollectionOfCollections) {
   ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(ts2, buf));
   EXPECT_EQ(ts1, ts2);
 }
+
+namespace {
+
+struct ReorderedElement {
+  uint32_t nonce;
+  std::string name;
+  std::string extra;
+
+  void serialize(ISerializer& s) {
+    s(nonce, "nonce");
+    s(extra, "extra");
+    s(name, "name");
+  }
+};
+
+}
+
+TEST(KVSerialize, fieldsCanBeReadInAnyOrder) {
+  TestElement element;
+  element.name = "hello";
+  element.nonce = 12345;
+
+  std::string buf = CryptoNote::storeToBinaryKeyValue(element);
+  ReorderedElement reordered;
+  ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(reordered, buf));
+  EXPECT_EQ(element.name, reordered.name);
+  EXPECT_EQ(element.nonce, reordered.nonce);
+  EXPECT_TRUE(reordered.extra.empty());
+}
+
+TEST(KVSerialize, streamConstructorReadsWholeStream) {
+  TestElement testData1, testData2;
+  testData1.name = std::string(100000, 'x');
+  testData1.nonce = 1;
+  testData1.u32array.resize(1000, 7);
+
+  std::string buf = CryptoNote::storeToBinaryKeyValue(testData1);
+  Common::MemoryInputStream stream(buf.data(), buf.size());
+  KVBinaryInputStreamSerializer serializer(stream);
+  serialize(testData2, serializer);
+  EXPECT_EQ(testData1, testData2);
+}
+
+TEST(KVSerialize, truncatedDataIsRejected) {
+  TestElement testData1, testData2;
+  testData1.name = "hello";
+  testData1.u32array.resize(16);
+
+  std::string buf = CryptoNote::storeToBinaryKeyValue(testData1);
+  for (size_t size = 0; size < buf.size(); ++size) {
+    ASSERT_FALSE(CryptoNote::loadFromBinaryKeyValue(testData2, buf.substr(0, size)));
+  }
+}
+
+namespace {
+
+// builds {"m": [[1, 2], [3]]} the way epee portable storage writes arrays of uint32 arrays
+std::string makeArrayOfArrays(uint8_t nestedType) {
+  std::string buf;
+  KVBinaryStorageBlockHeader hdr;
+  hdr.m_signature_a = PORTABLE_STORAGE_SIGNATUREA;
+  hdr.m_signature_b = PORTABLE_STORAGE_SIGNATUREB;
+  hdr.m_ver = PORTABLE_STORAGE_FORMAT_VER;
+  buf.append(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+
+  buf.push_back(1 << 2); // one entry
+  buf.push_back(1);
+  buf.push_back('m');
+  buf.push_back(static_cast<char>(BIN_KV_SERIALIZE_FLAG_ARRAY | BIN_KV_SERIALIZE_TYPE_ARRAY));
+  buf.push_back(2 << 2);
+
+  std::vector<std::vector<uint32_t>> items = { { 1, 2 }, { 3 } };
+  for (const auto& item : items) {
+    buf.push_back(static_cast<char>(nestedType));
+    buf.push_back(static_cast<char>(item.size() << 2));
+    for (uint32_t number : item) {
+      buf.append(reinterpret_cast<const char*>(&number), sizeof(number));
+    }
+  }
+
+  return buf;
+}
+
+}
+
+TEST(KVSerialize, arraysOfArraysCanBeRead) {
+  std::string buf = makeArrayOfArrays(BIN_KV_SERIALIZE_FLAG_ARRAY | BIN_KV_SERIALIZE_TYPE_UINT32);
+  KVBinaryInputStreamSerializer serializer(buf.data(), buf.size());
+
+  std::vector<std::vector<uint32_t>> result;
+  size_t size;
+  ASSERT_TRUE(serializer.beginArray(size, "m"));
+  result.resize(size);
+  for (auto& item : result) {
+    size_t itemSize;
+    ASSERT_TRUE(serializer.beginArray(itemSize, ""));
+    item.resize(itemSize);
+    for (auto& number : item) {
+      serializer(number, "");
+    }
+    serializer.endArray();
+  }
+  serializer.endArray();
+
+  std::vector<std::vector<uint32_t>> expected = { { 1, 2 }, { 3 } };
+  EXPECT_EQ(expected, result);
+}
+
+TEST(KVSerialize, nestedArrayWithoutArrayTypeIsRejected) {
+  std::string buf = makeArrayOfArrays(BIN_KV_SERIALIZE_TYPE_UINT32);
+  ASSERT_ANY_THROW(KVBinaryInputStreamSerializer(buf.data(), buf.size()));
+}
@@ -0,0 +1,189 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include "CryptoNoteCore/BlockFilter.h"
+#include "CryptoNoteCore/CachedBlock.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/TransactionExtra.h"
+#include "Serialization/SerializationTools.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+std::vector<Crypto::PublicKey> generatePublicKeys(size_t count) {
+  std::vector<Crypto::PublicKey> keys;
+  for (size_t i = 0; i < count; ++i) {
+    keys.push_back(Crypto::rand<Crypto::PublicKey>());
+  }
+
+  return keys;
+}
+
+std::vector<Crypto::KeyImage> generateKeyImages(size_t count) {
+  std::vector<Crypto::KeyImage> keyImages;
+  for (size_t i = 0; i < count; ++i) {
+    keyImages.push_back(Crypto::rand<Crypto::KeyImage>());
+  }
+
+  return keyImages;
+}
+
+Transaction createTransaction(const Crypto::PublicKey& transactionPublicKey, const Crypto::KeyImage& keyImage) {
+  Transaction transaction;
+  transaction.version = CURRENT_TRANSACTION_VERSION;
+  transaction.unlockTime = 0;
+
+  KeyInput input;
+  input.amount = 10;
+  input.outputIndexes = {1};
+  input.keyImage = keyImage;
+  transaction.inputs.push_back(input);
+  transaction.signatures.push_back({Crypto::Signature()});
+
+  addTransactionPublicKeyToExtra(transaction.extra, transactionPublicKey);
+  return transaction;
+}
+
+}
+
+TEST(BlockFilterTest, matchesEveryElementOfBlock) {
+  auto blockHash = Crypto::rand<Crypto::Hash>();
+  auto keys = generatePublicKeys(100);
+  auto keyImages = generateKeyImages(300);
+  BlockFilter filter(blockHash, keys, keyImages);
+
+  ASSERT_EQ(400, filter.getElementCount());
+  ASSERT_EQ(blockHash, filter.getBlockHash());
+
+  for (const auto& key : keys) {
+    ASSERT_TRUE(filter.matchAny({key}, {}));
+  }
+
+  for (const auto& keyImage : keyImages) {
+    ASSERT_TRUE(filter.matchAny({}, {keyImage}));
+  }
+}
+
+TEST(BlockFilterTest, matchesIfAnyOfQueriedElementsIsPresent) {
+  auto keyImages = generateKeyImages(10);
+  BlockFilter filter(Crypto::rand<Crypto::Hash>(), {}, keyImages);
+
+  auto queried = generateKeyImages(1000);
+  queried.push_back(keyImages[5]);
+  ASSERT_TRUE(filter.matchAny(generatePublicKeys(100), queried));
+}
+
+TEST(BlockFilterTest, rarelyMatchesAbsentElements) {
+  BlockFilter filter(Crypto::rand<Crypto::Hash>(), generatePublicKeys(50), generateKeyImages(50));
+
+  size_t falsePositives = 0;
+  for (const auto& keyImage : generateKeyImages(10000)) {
+    if (filter.matchAny({}, {keyImage})) {
+      ++falsePositives;
+    }
+  }
+
+  // expected count is 10000 / INVERSE_FALSE_POSITIVE_RATE, about 0.013
+  ASSERT_LE(falsePositives, 2);
+}
+
+TEST(BlockFilterTest, emptyFilterMatchesNothing) {
+  BlockFilter filter(Crypto::rand<Crypto::Hash>(), {}, {});
+
+  ASSERT_EQ(0, filter.getElementCount());
+  ASSERT_TRUE(filter.getData().empty());
+  ASSERT_FALSE(filter.matchAny(generatePublicKeys(10), generateKeyImages(10)));
+}
+
+TEST(BlockFilterTest, sizeIsAboutRemainderBitsPerElement) {
+  BlockFilter filter(Crypto::rand<Crypto::Hash>(), generatePublicKeys(1000), generateKeyImages(1000));
+
+  // Golomb-Rice coding takes remainder bits plus about 1.5 bits of unary quotient per element
+  ASSERT_LT(filter.getData().size(), 2000 * (BlockFilter::REMAINDER_BITS + 3) / 8);
+}
+
+TEST(BlockFilterTest, serializationRoundTrip) {
+  auto keys = generatePublicKeys(20);
+  BlockFilter filter(Crypto::rand<Crypto::Hash>(), keys, generateKeyImages(20));
+
+  BlockFilter loaded;
+  ASSERT_TRUE(loadFromBinaryKeyValue(loaded, storeToBinaryKeyValue(filter)));
+
+  ASSERT_EQ(filter.getBlockHash(), loaded.getBlockHash());
+  ASSERT_EQ(filter.getElementCount(), loaded.getElementCount());
+  ASSERT_EQ(filter.getData(), loaded.getData());
+  ASSERT_TRUE(loaded.matchAny({keys[7]}, {}));
+}
+
+TEST(BlockFilterTest, truncatedDataThrows) {
+  auto keys = generatePublicKeys(20);
+  BlockFilter filter(Crypto::rand<Crypto::Hash>(), keys, {});
+
+  // same layout as stored filter, with the last half of the data cut
+  struct TruncatedFilter {
+    Crypto::Hash blockHash;
+    uint32_t elementCount;
+    BinaryArray data;
+
+    void serialize(ISerializer& s) {
+      s(blockHash, "block_hash");
+      s(elementCount, "element_count");
+      serializeAsBinary(data, "data", s);
+    }
+  } truncatedFilter{filter.getBlockHash(), filter.getElementCount(), filter.getData()};
+  truncatedFilter.data.resize(truncatedFilter.data.size() / 2);
+
+  BlockFilter truncated;
+  ASSERT_TRUE(loadFromBinaryKeyValue(truncated, storeToBinaryKeyValue(truncatedFilter)));
+  // some of many random keys are hashed beyond the values left in the data
+  ASSERT_ANY_THROW(truncated.matchAny(generatePublicKeys(1000), {}));
+}
+
+TEST(BlockFilterTest, filterOfRawBlockEqualsFilterOfTransactions) {
+  auto transactionPublicKey = Crypto::rand<Crypto::PublicKey>();
+  auto keyImage = Crypto::rand<Crypto::KeyImage>();
+  Transaction transaction = createTransaction(transactionPublicKey, keyImage);
+
+  BlockTemplate block;
+  block.majorVersion = BLOCK_MAJOR_VERSION_1;
+  block.minorVersion = BLOCK_MINOR_VERSION_0;
+  block.timestamp = 1;
+  block.previousBlockHash = NULL_HASH;
+  block.nonce = 0;
+  block.baseTransaction.version = CURRENT_TRANSACTION_VERSION;
+  block.baseTransaction.unlockTime = 10;
+  block.baseTransaction.inputs.push_back(BaseInput{1});
+  auto baseTransactionPublicKey = Crypto::rand<Crypto::PublicKey>();
+  addTransactionPublicKeyToExtra(block.baseTransaction.extra, baseTransactionPublicKey);
+  block.transactionHashes.push_back(getObjectHash(transaction));
+
+  RawBlock rawBlock{toBinaryArray(block), {toBinaryArray(transaction)}};
+  BlockFilter fromRawBlock = BlockFilter::fromRawBlock(rawBlock);
+  BlockFilter fromTransactions = BlockFilter::fromTransactions(CachedBlock(block).getBlockHash(), block.baseTransaction,
+    {CachedTransaction(transaction)});
+
+  ASSERT_EQ(CachedBlock(block).getBlockHash(), fromRawBlock.getBlockHash());
+  ASSERT_EQ(3, fromRawBlock.getElementCount());
+  ASSERT_EQ(fromTransactions.getData(), fromRawBlock.getData());
+  ASSERT_TRUE(fromRawBlock.matchAny({baseTransactionPublicKey}, {}));
+  ASSERT_TRUE(fromRawBlock.matchAny({transactionPublicKey}, {}));
+  ASSERT_TRUE(fromRawBlock.matchAny({}, {keyImage}));
+}
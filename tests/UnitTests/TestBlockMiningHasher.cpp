@@ -0,0 +1,95 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "CryptoNoteConfig.h"
+#include "CryptoNoteCore/BlockMiningHasher.h"
+#include "CryptoNoteCore/CachedBlock.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+BlockTemplate createBlock(uint8_t majorVersion) {
+  BlockTemplate block;
+  block.majorVersion = majorVersion;
+  block.minorVersion = 0;
+  block.timestamp = 1500000000;
+  block.previousBlockHash = Crypto::Hash{{1, 2, 3, 4, 5}};
+  block.nonce = 0;
+  block.baseTransaction.version = CURRENT_TRANSACTION_VERSION;
+  block.baseTransaction.unlockTime = 10;
+  block.baseTransaction.inputs.push_back(BaseInput{10});
+  block.baseTransaction.outputs.push_back(TransactionOutput{1000, KeyOutput{Crypto::PublicKey{{7, 8, 9}}}});
+
+  if (majorVersion >= BLOCK_MAJOR_VERSION_2) {
+    block.parentBlock.majorVersion = BLOCK_MAJOR_VERSION_1;
+    block.parentBlock.minorVersion = 0;
+    block.parentBlock.previousBlockHash = Crypto::Hash{{9, 8, 7}};
+    block.parentBlock.transactionCount = 1;
+    block.parentBlock.baseTransaction.version = CURRENT_TRANSACTION_VERSION;
+    block.parentBlock.baseTransaction.unlockTime = 0;
+  }
+
+  return block;
+}
+
+void checkHashes(const BlockTemplate& block, size_t ways) {
+  BlockMiningHasher hasher(ways);
+  ASSERT_EQ(ways, hasher.getWays());
+  hasher.setBlock(block);
+
+  std::vector<uint32_t> nonces;
+  for (size_t i = 0; i < ways; ++i) {
+    nonces.push_back(0x01020304 * static_cast<uint32_t>(i + 1));
+  }
+
+  std::vector<Crypto::Hash> hashes(ways);
+  hasher.hash(nonces.data(), hashes.data());
+
+  Crypto::cn_context context;
+  for (size_t i = 0; i < ways; ++i) {
+    BlockTemplate blockWithNonce = block;
+    blockWithNonce.nonce = nonces[i];
+    ASSERT_EQ(CachedBlock(blockWithNonce).getBlockLongHash(context), hashes[i]);
+  }
+}
+
+}
+
+TEST(BlockMiningHasher, hashesMatchCachedBlockForVersion1) {
+  checkHashes(createBlock(BLOCK_MAJOR_VERSION_1), 3);
+}
+
+TEST(BlockMiningHasher, hashesMatchCachedBlockForVersion2) {
+  checkHashes(createBlock(BLOCK_MAJOR_VERSION_2), 2);
+}
+
+TEST(BlockMiningHasher, throwsIfBlockIsNotSet) {
+  BlockMiningHasher hasher(1);
+  uint32_t nonce = 0;
+  Crypto::Hash hash;
+  ASSERT_ANY_THROW(hasher.hash(&nonce, &hash));
+}
+
+TEST(BlockMiningHasher, hashesMoreNoncesThanCpuWays) {
+  checkHashes(createBlock(BLOCK_MAJOR_VERSION_1), Crypto::cn_slow_hash_get_multi_ways() + 3);
+}
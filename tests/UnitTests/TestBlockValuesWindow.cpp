@@ -0,0 +1,129 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include <random>
+
+#include "Common/Math.h"
+#include "CryptoNoteCore/BlockValuesWindow.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+// emulates IBlockchainCache::getLastUnits over a chain of values, counting how many values were read
+class ValuesChain {
+public:
+  explicit ValuesChain(size_t size) : readCount(0) {
+    std::mt19937_64 generator(size);
+    for (size_t i = 0; i < size; ++i) {
+      values.push_back(generator() % 50);
+    }
+  }
+
+  std::vector<uint64_t> getLastValues(size_t count, uint32_t blockIndex, UseGenesis useGenesis) {
+    size_t to = blockIndex + 1;
+    size_t from = to - std::min(count, to);
+    if (from == 0 && !useGenesis && to != 0) {
+      from = 1;
+    }
+
+    readCount += to - from;
+    return std::vector<uint64_t>(values.begin() + from, values.begin() + to);
+  }
+
+  BlockValuesWindow::ValuesReader getReader() {
+    return [this](size_t count, uint32_t blockIndex, UseGenesis useGenesis) { return getLastValues(count, blockIndex, useGenesis); };
+  }
+
+  std::vector<uint64_t> values;
+  size_t readCount;
+};
+
+void checkWindow(ValuesChain& chain, BlockValuesWindow& window, size_t count, uint32_t blockIndex, UseGenesis useGenesis) {
+  window.moveTo(blockIndex, chain.getReader());
+
+  size_t readCount = chain.readCount;
+  auto expected = chain.getLastValues(count, blockIndex, useGenesis);
+  chain.readCount = readCount;
+
+  ASSERT_EQ(expected, window.getValues());
+  ASSERT_EQ(Common::medianValue(expected), window.getMedian());
+}
+
+}
+
+TEST(BlockValuesWindow, slidesAlongChainWithGenesis) {
+  ValuesChain chain(300);
+  BlockValuesWindow window(20, UseGenesis(true));
+
+  for (uint32_t blockIndex = 0; blockIndex < 300; ++blockIndex) {
+    ASSERT_NO_FATAL_FAILURE(checkWindow(chain, window, 20, blockIndex, UseGenesis(true)));
+  }
+
+  // every value is read once
+  ASSERT_EQ(300, chain.readCount);
+}
+
+TEST(BlockValuesWindow, slidesAlongChainWithoutGenesis) {
+  ValuesChain chain(100);
+  BlockValuesWindow window(21, UseGenesis(false));
+
+  for (uint32_t blockIndex = 0; blockIndex < 100; ++blockIndex) {
+    ASSERT_NO_FATAL_FAILURE(checkWindow(chain, window, 21, blockIndex, UseGenesis(false)));
+  }
+}
+
+TEST(BlockValuesWindow, movesBackAndJumps) {
+  ValuesChain chain(200);
+  BlockValuesWindow window(30, UseGenesis(true));
+
+  for (uint32_t blockIndex : {150, 140, 141, 170, 199, 10, 11, 45, 0}) {
+    ASSERT_NO_FATAL_FAILURE(checkWindow(chain, window, 30, blockIndex, UseGenesis(true)));
+  }
+}
+
+TEST(BlockValuesWindow, rereadsValuesAfterInvalidation) {
+  ValuesChain chain(100);
+  BlockValuesWindow window(30, UseGenesis(true));
+  ASSERT_NO_FATAL_FAILURE(checkWindow(chain, window, 30, 80, UseGenesis(true)));
+
+  chain.values[80] = 1000;
+  window.invalidateFrom(90);
+  window.moveTo(80, chain.getReader());
+  ASSERT_NE(1000, window.getValues().back());
+
+  window.invalidateFrom(80);
+  ASSERT_NO_FATAL_FAILURE(checkWindow(chain, window, 30, 80, UseGenesis(true)));
+  ASSERT_EQ(1000, window.getValues().back());
+}
+
+TEST(BlockValuesWindows, keepsWindowPerCount) {
+  ValuesChain chain(100);
+  BlockValuesWindows windows(2);
+
+  auto reader = chain.getReader();
+  for (uint32_t blockIndex = 50; blockIndex < 100; ++blockIndex) {
+    auto expected = chain.getLastValues(20, blockIndex, UseGenesis(true));
+    ASSERT_EQ(Common::medianValue(expected), windows.getMedian(20, blockIndex, UseGenesis(true), reader));
+
+    expected = chain.getLastValues(40, blockIndex, UseGenesis(true));
+    ASSERT_EQ(expected, windows.getValues(40, blockIndex, UseGenesis(true), reader));
+  }
+}
@@ -19,6 +19,7 @@
 
 #include "crypto/crypto.h"
 
+#include "Common/Math.h"
 #include "CryptoNoteCore/BlockchainCache.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "CryptoNoteCore/TransactionValidatiorState.h"
@@ -261,6 +262,70 @@ TEST_F(BlockchainCacheTests, split) {
   ASSERT_EQ(SPLIT_HEIGHT, blockCache.getBlockCount());
 }
 
+namespace {
+
+std::vector<uint64_t> getExpectedLastValues(const std::vector<uint64_t>& values, size_t count, uint32_t blockIndex) {
+  uint32_t first = blockIndex + 1 > count ? static_cast<uint32_t>(blockIndex + 1 - count) : 1;
+  return std::vector<uint64_t>(values.begin() + first, values.begin() + blockIndex + 1);
+}
+
+// sizes and timestamps in every block index hold the values expected from the cache
+void checkLastValues(const IBlockchainCache& cache, const std::vector<uint64_t>& sizes, const std::vector<uint64_t>& timestamps,
+  uint32_t blockIndex) {
+  const size_t WINDOW_COUNT = 20;
+  auto expectedSizes = getExpectedLastValues(sizes, WINDOW_COUNT, blockIndex);
+  auto expectedTimestamps = getExpectedLastValues(timestamps, WINDOW_COUNT, blockIndex);
+  ASSERT_EQ(expectedSizes, cache.getLastBlocksSizes(WINDOW_COUNT, blockIndex, UseGenesis(false))) << "block " << blockIndex;
+  ASSERT_EQ(Common::medianValue(expectedSizes), cache.getLastBlocksSizesMedian(WINDOW_COUNT, blockIndex, UseGenesis(false)));
+  ASSERT_EQ(expectedTimestamps, cache.getLastTimestamps(WINDOW_COUNT, blockIndex, UseGenesis(false))) << "block " << blockIndex;
+  ASSERT_EQ(Common::medianValue(expectedTimestamps), cache.getLastTimestampsMedian(WINDOW_COUNT, blockIndex, UseGenesis(false)));
+}
+
+}
+
+TEST_F(BlockchainCacheTests, lastValuesFollowSplitAndReorganization) {
+  const uint32_t BLOCK_COUNT = 40;
+  const uint32_t SPLIT_INDEX = 25;
+  std::vector<CachedTransaction> transactions;
+  TransactionValidatorState validatorState;
+  generator.generateEmptyBlocks(BLOCK_COUNT);
+  auto bcCopy = generator.getBlockchainCopy();
+  ASSERT_LE(BLOCK_COUNT + 1, bcCopy.size());
+
+  // values aren't sorted, so medians differ from the middle values
+  std::vector<uint64_t> sizes(1, 0);
+  std::vector<uint64_t> timestamps(1, 0);
+  for (uint32_t i = 1; i <= BLOCK_COUNT; ++i) {
+    sizes.push_back(1000 + (i * 7919) % 503);
+    timestamps.push_back(1500000000 + (i * 104729) % 1009);
+    bcCopy[i].timestamp = timestamps.back();
+    ASSERT_NO_FATAL_FAILURE(blockCache.pushBlock(CachedBlock(bcCopy[i]), transactions, validatorState, sizes.back(), 1, 1, RawBlock()));
+  }
+
+  for (uint32_t i = 1; i <= BLOCK_COUNT; ++i) {
+    ASSERT_NO_FATAL_FAILURE(checkLastValues(blockCache, sizes, timestamps, i));
+  }
+
+  std::unique_ptr<IBlockchainCache> tail = blockCache.split(SPLIT_INDEX);
+  ASSERT_NO_FATAL_FAILURE(checkLastValues(blockCache, sizes, timestamps, SPLIT_INDEX - 1));
+  ASSERT_NO_FATAL_FAILURE(checkLastValues(*tail, sizes, timestamps, BLOCK_COUNT));
+
+  // alternative blocks replace the split ones in the same cache, as when segments are merged after reorganization
+  std::vector<uint64_t> alternativeSizes(sizes.begin(), sizes.begin() + SPLIT_INDEX);
+  std::vector<uint64_t> alternativeTimestamps(timestamps.begin(), timestamps.begin() + SPLIT_INDEX);
+  for (uint32_t i = SPLIT_INDEX; i <= BLOCK_COUNT; ++i) {
+    alternativeSizes.push_back(2000 + (i * 6007) % 211);
+    alternativeTimestamps.push_back(1600000000 + (i * 7907) % 401);
+    bcCopy[i].timestamp = alternativeTimestamps.back();
+    ASSERT_NO_FATAL_FAILURE(blockCache.pushBlock(CachedBlock(bcCopy[i]), transactions, validatorState, alternativeSizes.back(), 1, 1, RawBlock()));
+  }
+
+  ASSERT_NO_FATAL_FAILURE(checkLastValues(blockCache, alternativeSizes, alternativeTimestamps, BLOCK_COUNT));
+  for (uint32_t i = 1; i <= BLOCK_COUNT; ++i) {
+    ASSERT_NO_FATAL_FAILURE(checkLastValues(blockCache, alternativeSizes, alternativeTimestamps, i));
+  }
+}
+
 TEST_F(BlockchainCacheTests, checkIfSpentFalse) {
   Crypto::KeyImage keyImage = Crypto::rand<Crypto::KeyImage>();
   ASSERT_FALSE(blockCache.checkIfSpent(keyImage));
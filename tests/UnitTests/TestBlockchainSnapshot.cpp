@@ -0,0 +1,427 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include "Common/StringTools.h"
+#include "crypto/hash.h"
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/AddBlockErrors.h"
+#include "CryptoNoteCore/BlockchainReadBatch.h"
+#include "CryptoNoteCore/BlockchainSnapshot.h"
+#include "CryptoNoteCore/BlockchainWriteBatch.h"
+#include "CryptoNoteCore/CachedBlock.h"
+#include "CryptoNoteCore/CachedTransaction.h"
+#include "CryptoNoteCore/Checkpoints.h"
+#include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/DataBaseConfig.h"
+#include "CryptoNoteCore/DatabaseBlockchainCacheFactory.h"
+#include "CryptoNoteCore/MainChainStorage.h"
+#include "CryptoNoteCore/RocksDBWrapper.h"
+#include "CryptoNoteCore/TransactionExtra.h"
+#include "Logging/ConsoleLogger.h"
+#include "System/Dispatcher.h"
+
+#include "../Common/VectorMainChainStorage.h"
+#include "DataBaseMock.h"
+#include "../TestGenerator/TestGenerator.h"
+
+using namespace CryptoNote;
+
+class BlockchainSnapshotTest : public testing::Test {
+public:
+  BlockchainSnapshotTest() :
+    logger(Logging::ERROR),
+    currency(CurrencyBuilder(logger).currency()),
+    generator(currency),
+    snapshot(currency, logger),
+    checkpoints(logger),
+    paymentId(Crypto::cn_fast_hash("payment id", 10)) {
+    minerAccount.generate();
+    core = createCore(database, Checkpoints(logger));
+
+    blocks.push_back(currency.genesisBlock());
+    for (uint32_t index = 1; index < BLOCK_COUNT; ++index) {
+      blocks.push_back(makeBlock(*core, blocks.back(), blocks.back().timestamp + currency.difficultyTarget()));
+      if (index == PAYMENT_ID_BLOCK_INDEX) {
+        BinaryArray extraNonce;
+        setPaymentIdToTransactionExtraNonce(extraNonce, paymentId);
+        addExtraNonceToTransactionExtra(blocks.back().baseTransaction.extra, extraNonce);
+      }
+
+      addBlock(*core, blocks.back());
+    }
+
+    for (const BlockTemplate& block : blocks) {
+      storage.pushBlock(RawBlock{toBinaryArray(block), {}});
+    }
+
+    manifest.topBlockIndex = BLOCK_COUNT - 1;
+    manifest.topBlockHash = CachedBlock(blocks.back()).getBlockHash();
+  }
+
+  void SetUp() override {
+    dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("test_snapshot_%%%%%%%%%%%%");
+  }
+
+  void TearDown() override {
+    boost::system::error_code ignoredErrorCode;
+    boost::filesystem::remove_all(dir, ignoredErrorCode);
+  }
+
+protected:
+  static const uint32_t BLOCK_COUNT = 6;
+  // base transaction of this block has a payment id
+  static const uint32_t PAYMENT_ID_BLOCK_INDEX = 2;
+
+  // database of the snapshot is filled by a node, as it is when the snapshot is exported
+  std::unique_ptr<Core> createCore(IDataBase& coreDatabase, Checkpoints coreCheckpoints,
+    std::unique_ptr<IMainChainStorage> mainChainStorage = nullptr) {
+    std::unique_ptr<Core> node(new Core(currency, logger, std::move(coreCheckpoints), dispatcher,
+      std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(coreDatabase, logger)),
+      mainChainStorage ? std::move(mainChainStorage) : createVectorMainChainStorage(currency)));
+    node->load();
+    return node;
+  }
+
+  BlockTemplate makeBlock(const Core& node, const BlockTemplate& previous, uint64_t timestamp) {
+    BlockDetails previousDetails = node.getBlockDetails(CachedBlock(previous).getBlockHash());
+    std::vector<size_t> blockSizes;
+    BlockTemplate block;
+    generator.constructBlock(block, previousDetails.index + 1, previousDetails.hash, minerAccount, timestamp,
+                             previousDetails.alreadyGeneratedCoins, blockSizes, {});
+    return block;
+  }
+
+  void addBlock(Core& node, const BlockTemplate& block) {
+    ASSERT_EQ(error::AddBlockErrorCode::ADDED_TO_MAIN, node.addBlock(RawBlock{toBinaryArray(block), {}}));
+  }
+
+  // keeps the top block index of database, writing a block info moves it
+  void changeBlockInfo(uint32_t index, std::function<void(CachedBlockInfo&)> change) {
+    BlockchainReadBatch readBatch;
+    readBatch.requestCachedBlock(index).requestTransactionHashesByBlock(index);
+    readBatch.requestCachedBlock(BLOCK_COUNT - 1).requestTransactionHashesByBlock(BLOCK_COUNT - 1);
+    ASSERT_FALSE(database.read(readBatch));
+    auto result = readBatch.extractResult();
+
+    CachedBlockInfo blockInfo = result.getCachedBlocks().at(index);
+    change(blockInfo);
+
+    BlockchainWriteBatch writeBatch;
+    writeBatch.insertCachedBlock(blockInfo, index, result.getTransactionHashesByBlocks().at(index));
+    if (index != BLOCK_COUNT - 1) {
+      writeBatch.insertCachedBlock(result.getCachedBlocks().at(BLOCK_COUNT - 1), BLOCK_COUNT - 1,
+        result.getTransactionHashesByBlocks().at(BLOCK_COUNT - 1));
+    }
+
+    ASSERT_FALSE(database.write(writeBatch));
+  }
+
+  ExtendedTransactionInfo getBaseTransactionInfo(uint32_t index) {
+    Crypto::Hash transactionHash = CachedTransaction(blocks[index].baseTransaction).getTransactionHash();
+    BlockchainReadBatch readBatch;
+    readBatch.requestCachedTransaction(transactionHash);
+    EXPECT_FALSE(database.read(readBatch));
+    return readBatch.extractResult().getCachedTransactions().at(transactionHash);
+  }
+
+  void write(BlockchainWriteBatch& writeBatch) {
+    ASSERT_FALSE(database.write(writeBatch));
+  }
+
+  DataBaseConfig makeDataBaseConfig(const std::string& dataDir) {
+    boost::filesystem::create_directories(dataDir);
+    DataBaseConfig config;
+    config.setDataDir(dataDir);
+    return config;
+  }
+
+  Logging::ConsoleLogger logger;
+  Currency currency;
+  test_generator generator;
+  AccountBase minerAccount;
+  BlockchainSnapshot snapshot;
+  Checkpoints checkpoints;
+  System::Dispatcher dispatcher;
+  DataBaseMock database;
+  std::unique_ptr<Core> core;
+  std::vector<BlockTemplate> blocks;
+  VectorMainChainStorage storage;
+  BlockchainSnapshotManifest manifest;
+  boost::filesystem::path dir;
+  Crypto::Hash paymentId;
+};
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksAcceptsConsistentSnapshot) {
+  ASSERT_NO_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksAcceptsMatchingCheckpoint) {
+  ASSERT_TRUE(checkpoints.addCheckpoint(3, Common::podToHex(CachedBlock(blocks[3]).getBlockHash())));
+  ASSERT_NO_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsWrongTopBlockHash) {
+  manifest.topBlockHash = CachedBlock(blocks[2]).getBlockHash();
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsWrongBlockCount) {
+  manifest.topBlockIndex = BLOCK_COUNT;
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsBrokenChain) {
+  VectorMainChainStorage brokenStorage;
+  for (uint32_t index = 0; index < BLOCK_COUNT; ++index) {
+    BlockTemplate block = blocks[index];
+    if (index == 3) {
+      block.previousBlockHash = CachedBlock(blocks[1]).getBlockHash();
+    }
+
+    brokenStorage.pushBlock(RawBlock{toBinaryArray(block), {}});
+  }
+
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, brokenStorage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsCheckpointMismatch) {
+  ASSERT_TRUE(checkpoints.addCheckpoint(2, Common::podToHex(CachedBlock(blocks[3]).getBlockHash())));
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsDatabaseHashMismatch) {
+  changeBlockInfo(4, [this](CachedBlockInfo& blockInfo) { blockInfo.blockHash = CachedBlock(blocks[1]).getBlockHash(); });
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsDatabaseBehindStorage) {
+  BlockTemplate block = makeBlock(*core, blocks.back(), blocks.back().timestamp + currency.difficultyTarget());
+  storage.pushBlock(RawBlock{toBinaryArray(block), {}});
+  manifest.topBlockIndex = BLOCK_COUNT;
+  manifest.topBlockHash = CachedBlock(block).getBlockHash();
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsWrongCumulativeDifficulty) {
+  changeBlockInfo(3, [](CachedBlockInfo& blockInfo) { ++blockInfo.cumulativeDifficulty; });
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsWrongAlreadyGeneratedCoins) {
+  changeBlockInfo(BLOCK_COUNT - 1, [](CachedBlockInfo& blockInfo) { ++blockInfo.alreadyGeneratedCoins; });
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsWrongBlockSize) {
+  changeBlockInfo(2, [](CachedBlockInfo& blockInfo) { ++blockInfo.blockSize; });
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsWrongAlreadyGeneratedTransactions) {
+  changeBlockInfo(0, [](CachedBlockInfo& blockInfo) { ++blockInfo.alreadyGeneratedTransactions; });
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsWrongKeyOutputInfo) {
+  ExtendedTransactionInfo transactionInfo = getBaseTransactionInfo(3);
+  KeyOutputInfo outputInfo;
+  outputInfo.publicKey = boost::get<KeyOutput>(blocks[4].baseTransaction.outputs[0].target).key;
+  outputInfo.transactionHash = transactionInfo.transactionHash;
+  outputInfo.unlockTime = transactionInfo.unlockTime;
+  outputInfo.outputIndex = 0;
+
+  BlockchainWriteBatch writeBatch;
+  writeBatch.insertKeyOutputInfo(blocks[3].baseTransaction.outputs[0].amount, transactionInfo.globalIndexes[0], outputInfo);
+  write(writeBatch);
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsExtraKeyOutputGlobalIndex) {
+  ExtendedTransactionInfo transactionInfo = getBaseTransactionInfo(BLOCK_COUNT - 1);
+  IBlockchainCache::Amount amount = blocks.back().baseTransaction.outputs.back().amount;
+  PackedOutIndex packedIndex;
+  packedIndex.blockIndex = BLOCK_COUNT - 1;
+  packedIndex.transactionIndex = 0;
+  packedIndex.outputIndex = static_cast<uint16_t>(blocks.back().baseTransaction.outputs.size() - 1);
+
+  BlockchainWriteBatch writeBatch;
+  writeBatch.insertKeyOutputGlobalIndexes(amount, {packedIndex}, transactionInfo.amountToKeyIndexes.at(amount).back() + 2);
+  write(writeBatch);
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsKeyImageNotSpentInBlock) {
+  Crypto::KeyImage keyImage = {};
+  keyImage.data[0] = 1;
+
+  BlockchainWriteBatch writeBatch;
+  writeBatch.insertSpentKeyImages(3, {keyImage});
+  write(writeBatch);
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsMissingTimestamp) {
+  BlockchainWriteBatch writeBatch;
+  writeBatch.insertTimestamp(blocks[3].timestamp, {});
+  write(writeBatch);
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsExtraBlockWithTimestamp) {
+  BlockchainWriteBatch writeBatch;
+  writeBatch.insertTimestamp(blocks[3].timestamp, {CachedBlock(blocks[3]).getBlockHash(), CachedBlock(blocks[1]).getBlockHash()});
+  write(writeBatch);
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsWrongClosestTimestampBlock) {
+  BlockchainWriteBatch writeBatch;
+  writeBatch.insertClosestTimestampBlockIndex(blocks[0].timestamp / (60 * 60 * 24) * (60 * 60 * 24), 1);
+  write(writeBatch);
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsWrongPaymentIdTransaction) {
+  BlockchainWriteBatch writeBatch;
+  writeBatch.insertPaymentId(CachedTransaction(blocks[1].baseTransaction).getTransactionHash(), paymentId, 1);
+  write(writeBatch);
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksRejectsExtraPaymentIdTransaction) {
+  BlockchainWriteBatch writeBatch;
+  writeBatch.insertPaymentId(CachedTransaction(blocks[1].baseTransaction).getTransactionHash(), paymentId, 2);
+  write(writeBatch);
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(manifest, storage, database, checkpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, verifyBlocksChecksProofOfWorkAfterLastCheckpoint) {
+  // a block right after its parent raises difficulty of the next one, whose proof of work a node takes only in checkpoint zone
+  DataBaseMock minerDatabase;
+  auto miner = createCore(minerDatabase, Checkpoints(logger));
+  std::vector<BlockTemplate> chain{currency.genesisBlock()};
+  chain.push_back(makeBlock(*miner, chain.back(), chain.back().timestamp + currency.difficultyTarget()));
+  addBlock(*miner, chain.back());
+  chain.push_back(makeBlock(*miner, chain.back(), chain.back().timestamp + 1));
+  addBlock(*miner, chain.back());
+
+  Difficulty difficulty = miner->getDifficultyForNextBlock();
+  ASSERT_LT(1, difficulty);
+
+  Crypto::cn_context cryptoContext;
+  BlockTemplate weakBlock = makeBlock(*miner, chain.back(), chain.back().timestamp + 1);
+  while (currency.checkProofOfWork(cryptoContext, CachedBlock(weakBlock), difficulty)) {
+    ++weakBlock.nonce;
+  }
+
+  chain.push_back(weakBlock);
+  std::string weakBlockHash = Common::podToHex(CachedBlock(weakBlock).getBlockHash());
+
+  Checkpoints nodeCheckpoints(logger);
+  ASSERT_TRUE(nodeCheckpoints.addCheckpoint(3, weakBlockHash));
+  DataBaseMock nodeDatabase;
+  auto node = createCore(nodeDatabase, std::move(nodeCheckpoints));
+  VectorMainChainStorage nodeStorage;
+  nodeStorage.pushBlock(RawBlock{toBinaryArray(chain[0]), {}});
+  for (uint32_t index = 1; index < chain.size(); ++index) {
+    addBlock(*node, chain[index]);
+    nodeStorage.pushBlock(RawBlock{toBinaryArray(chain[index]), {}});
+  }
+
+  BlockchainSnapshotManifest nodeManifest;
+  nodeManifest.topBlockIndex = 3;
+  nodeManifest.topBlockHash = CachedBlock(weakBlock).getBlockHash();
+
+  ASSERT_TRUE(checkpoints.addCheckpoint(3, weakBlockHash));
+  ASSERT_NO_THROW(snapshot.verifyBlocks(nodeManifest, nodeStorage, nodeDatabase, checkpoints));
+
+  Checkpoints earlierCheckpoints(logger);
+  ASSERT_TRUE(earlierCheckpoints.addCheckpoint(2, Common::podToHex(CachedBlock(chain[2]).getBlockHash())));
+  ASSERT_ANY_THROW(snapshot.verifyBlocks(nodeManifest, nodeStorage, nodeDatabase, earlierCheckpoints));
+}
+
+TEST_F(BlockchainSnapshotTest, importFromRestoresExportedSnapshot) {
+  std::string snapshotDir = (dir / "snapshot").string();
+  BlockchainSnapshotManifest exported;
+  {
+    RocksDBWrapper sourceDatabase(logger);
+    sourceDatabase.init(makeDataBaseConfig((dir / "source").string()));
+    auto source = createCore(sourceDatabase, Checkpoints(logger));
+    for (uint32_t index = 1; index < BLOCK_COUNT; ++index) {
+      addBlock(*source, blocks[index]);
+    }
+
+    exported = snapshot.exportTo(snapshotDir, sourceDatabase, storage);
+    source.reset();
+    sourceDatabase.shutdown();
+  }
+
+  EXPECT_EQ(manifest.topBlockIndex, exported.topBlockIndex);
+  EXPECT_EQ(manifest.topBlockHash, exported.topBlockHash);
+
+  std::string targetDir = (dir / "target").string();
+  DataBaseConfig targetConfig = makeDataBaseConfig(targetDir);
+  BlockchainSnapshotManifest imported = snapshot.importFrom(snapshotDir, targetDir, targetConfig, checkpoints);
+  EXPECT_EQ(exported.topBlockHash, imported.topBlockHash);
+  EXPECT_EQ(exported.files.size(), imported.files.size());
+
+  RocksDBWrapper targetDatabase(logger);
+  targetDatabase.init(targetConfig);
+  {
+    auto target = createCore(targetDatabase, Checkpoints(logger), createSwappedMainChainStorage(targetDir, currency));
+    EXPECT_EQ(BLOCK_COUNT - 1, target->getTopBlockIndex());
+    EXPECT_EQ(manifest.topBlockHash, target->getTopBlockHash());
+  }
+
+  targetDatabase.shutdown();
+}
+
+TEST_F(BlockchainSnapshotTest, importFromRejectsCorruptedSnapshotAndRemovesCopiedFiles) {
+  std::string snapshotDir = (dir / "snapshot").string();
+  {
+    RocksDBWrapper sourceDatabase(logger);
+    sourceDatabase.init(makeDataBaseConfig((dir / "source").string()));
+    auto source = createCore(sourceDatabase, Checkpoints(logger));
+    for (uint32_t index = 1; index < BLOCK_COUNT; ++index) {
+      addBlock(*source, blocks[index]);
+    }
+
+    snapshot.exportTo(snapshotDir, sourceDatabase, storage);
+    source.reset();
+    sourceDatabase.shutdown();
+  }
+
+  std::fstream blocksFile((dir / "snapshot" / currency.blocksFileName()).string(), std::ios::in | std::ios::out | std::ios::binary);
+  char byte = 0;
+  ASSERT_TRUE(static_cast<bool>(blocksFile.seekg(-1, std::ios::end).get(byte)));
+  ASSERT_TRUE(static_cast<bool>(blocksFile.seekp(-1, std::ios::end).put(static_cast<char>(byte ^ 1)).flush()));
+  blocksFile.close();
+
+  std::string targetDir = (dir / "target").string();
+  DataBaseConfig targetConfig = makeDataBaseConfig(targetDir);
+  ASSERT_ANY_THROW(snapshot.importFrom(snapshotDir, targetDir, targetConfig, checkpoints));
+  EXPECT_FALSE(boost::filesystem::exists(dir / "target" / currency.blocksFileName()));
+  EXPECT_FALSE(boost::filesystem::exists(RocksDBWrapper(logger).getDataDir(targetConfig)));
+}
@@ -0,0 +1,107 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "CryptoNoteConfig.h"
+#include "CryptoNoteProtocol/BlocksSynchronization.h"
+
+using namespace CryptoNote;
+
+TEST(BlocksSynchronizationTest, firstRequestUsesDefaultCount) {
+  BlocksSynchronizationStatistics statistics;
+  ASSERT_EQ(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT, getBlocksRequestCount(statistics));
+}
+
+TEST(BlocksSynchronizationTest, updateAccumulatesTotalsAndResetsRequest) {
+  BlocksSynchronizationStatistics statistics;
+  statistics.requestedCount = 10;
+
+  updateBlocksSynchronizationStatistics(statistics, 10, 20000, 100);
+  updateBlocksSynchronizationStatistics(statistics, 5, 5000, 50);
+
+  ASSERT_EQ(0, statistics.requestedCount);
+  ASSERT_EQ(15, statistics.receivedBlocks);
+  ASSERT_EQ(25000, statistics.receivedBytes);
+}
+
+TEST(BlocksSynchronizationTest, firstMeasurementIsTakenAsIs) {
+  BlocksSynchronizationStatistics statistics;
+  updateBlocksSynchronizationStatistics(statistics, 10, 20000, 100);
+
+  ASSERT_DOUBLE_EQ(2000, statistics.averageBlockSize);
+  ASSERT_DOUBLE_EQ(100, statistics.roundTripTime);
+  ASSERT_DOUBLE_EQ(200000, statistics.throughput);
+}
+
+TEST(BlocksSynchronizationTest, laterMeasurementsAreSmoothed) {
+  BlocksSynchronizationStatistics statistics;
+  updateBlocksSynchronizationStatistics(statistics, 10, 20000, 100);
+  updateBlocksSynchronizationStatistics(statistics, 10, 120000, 100);
+
+  ASSERT_GT(statistics.averageBlockSize, 2000);
+  ASSERT_LT(statistics.averageBlockSize, 12000);
+}
+
+TEST(BlocksSynchronizationTest, zeroRoundTripTimeDoesNotChangeThroughput) {
+  BlocksSynchronizationStatistics statistics;
+  updateBlocksSynchronizationStatistics(statistics, 10, 200000, 0);
+
+  ASSERT_EQ(0, statistics.throughput);
+  ASSERT_EQ(BLOCKS_SYNCHRONIZING_TARGET_SIZE / 20000, getBlocksRequestCount(statistics));
+}
+
+TEST(BlocksSynchronizationTest, fastPeerIsLimitedByTargetSize) {
+  BlocksSynchronizationStatistics statistics;
+  statistics.averageBlockSize = 10000;
+  statistics.throughput = 1e9;
+
+  ASSERT_EQ(BLOCKS_SYNCHRONIZING_TARGET_SIZE / 10000, getBlocksRequestCount(statistics));
+}
+
+TEST(BlocksSynchronizationTest, slowPeerIsLimitedByTargetTime) {
+  BlocksSynchronizationStatistics statistics;
+  statistics.averageBlockSize = 10000;
+  statistics.throughput = 100000;
+
+  ASSERT_EQ(static_cast<size_t>(100000.0 * BLOCKS_SYNCHRONIZING_TARGET_TIME / 1000 / 10000), getBlocksRequestCount(statistics));
+}
+
+TEST(BlocksSynchronizationTest, requestCountIsClamped) {
+  BlocksSynchronizationStatistics statistics;
+  statistics.averageBlockSize = 10;
+  ASSERT_EQ(BLOCKS_SYNCHRONIZING_MAX_COUNT, getBlocksRequestCount(statistics));
+
+  statistics.averageBlockSize = 10.0 * BLOCKS_SYNCHRONIZING_TARGET_SIZE;
+  ASSERT_EQ(BLOCKS_SYNCHRONIZING_MIN_COUNT, getBlocksRequestCount(statistics));
+
+  statistics.averageBlockSize = 1000;
+  statistics.throughput = 1;
+  ASSERT_EQ(BLOCKS_SYNCHRONIZING_MIN_COUNT, getBlocksRequestCount(statistics));
+}
+
+TEST(BlocksSynchronizationTest, requestGrowsWhenPeerGetsFaster) {
+  BlocksSynchronizationStatistics statistics;
+  updateBlocksSynchronizationStatistics(statistics, 10, 100000, 2000);
+  size_t slowCount = getBlocksRequestCount(statistics);
+
+  for (int i = 0; i < 10; ++i) {
+    updateBlocksSynchronizationStatistics(statistics, 10, 100000, 100);
+  }
+
+  ASSERT_GT(getBlocksRequestCount(statistics), slowCount);
+}
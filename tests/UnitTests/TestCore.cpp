@@ -0,0 +1,272 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/AddBlockErrors.h"
+#include "CryptoNoteCore/Checkpoints.h"
+#include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/DatabaseBlockchainCacheFactory.h"
+#include "Logging/ConsoleLogger.h"
+#include "System/Dispatcher.h"
+
+#include "../Common/VectorMainChainStorage.h"
+#include "DataBaseMock.h"
+#include "../TestGenerator/TestGenerator.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+void expectSameDetails(const BlockDetails& expected, const BlockDetails& actual) {
+  EXPECT_EQ(expected.hash, actual.hash);
+  EXPECT_EQ(expected.prevBlockHash, actual.prevBlockHash);
+  EXPECT_EQ(expected.index, actual.index);
+  EXPECT_EQ(expected.isAlternative, actual.isAlternative);
+  EXPECT_EQ(expected.timestamp, actual.timestamp);
+  EXPECT_EQ(expected.nonce, actual.nonce);
+  EXPECT_EQ(expected.difficulty, actual.difficulty);
+  EXPECT_EQ(expected.reward, actual.reward);
+  EXPECT_EQ(expected.baseReward, actual.baseReward);
+  EXPECT_EQ(expected.blockSize, actual.blockSize);
+  EXPECT_EQ(expected.transactionsCumulativeSize, actual.transactionsCumulativeSize);
+  EXPECT_EQ(expected.alreadyGeneratedCoins, actual.alreadyGeneratedCoins);
+  EXPECT_EQ(expected.alreadyGeneratedTransactions, actual.alreadyGeneratedTransactions);
+  EXPECT_EQ(expected.sizeMedian, actual.sizeMedian);
+  EXPECT_EQ(expected.penalty, actual.penalty);
+  EXPECT_EQ(expected.totalFeeAmount, actual.totalFeeAmount);
+
+  ASSERT_EQ(expected.transactions.size(), actual.transactions.size());
+  for (size_t i = 0; i < expected.transactions.size(); ++i) {
+    EXPECT_EQ(expected.transactions[i].hash, actual.transactions[i].hash);
+    EXPECT_EQ(expected.transactions[i].blockHash, actual.transactions[i].blockHash);
+    EXPECT_EQ(expected.transactions[i].blockIndex, actual.transactions[i].blockIndex);
+    EXPECT_EQ(expected.transactions[i].size, actual.transactions[i].size);
+    EXPECT_EQ(expected.transactions[i].fee, actual.transactions[i].fee);
+    EXPECT_EQ(expected.transactions[i].totalOutputsAmount, actual.transactions[i].totalOutputsAmount);
+    EXPECT_EQ(expected.transactions[i].inBlockchain, actual.transactions[i].inBlockchain);
+  }
+}
+
+class CoreTest : public ::testing::Test {
+public:
+  CoreTest() :
+    logger(Logging::ERROR),
+    currency(CurrencyBuilder(logger).currency()),
+    generator(currency),
+    core(currency, logger, Checkpoints(logger), dispatcher,
+         std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(database, logger)),
+         createVectorMainChainStorage(currency)) {
+    minerAccount.generate();
+    core.load();
+    mainChain.push_back(currency.genesisBlock());
+  }
+
+protected:
+  BlockTemplate makeBlock(const BlockTemplate& previous) {
+    // coins are taken from the core, the generator doesn't count the genesis block reward
+    BlockDetails previousDetails = core.getBlockDetails(CachedBlock(previous).getBlockHash());
+    std::vector<size_t> blockSizes;
+    BlockTemplate block;
+    generator.constructBlock(block, previousDetails.index + 1, previousDetails.hash, minerAccount,
+                             previous.timestamp + currency.difficultyTarget(), previousDetails.alreadyGeneratedCoins, blockSizes, {});
+    return block;
+  }
+
+  std::error_code addBlock(const BlockTemplate& block) {
+    return core.addBlock(RawBlock{toBinaryArray(block), {}});
+  }
+
+  void addMainChainBlocks(size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      BlockTemplate block = makeBlock(mainChain.back());
+      ASSERT_EQ(error::AddBlockErrorCode::ADDED_TO_MAIN, addBlock(block));
+      mainChain.push_back(block);
+    }
+  }
+
+  // alternative chain of count blocks on top of main chain block previousIndex, the last one is added with lastResult
+  std::vector<BlockTemplate> addAlternativeChain(uint32_t previousIndex, size_t count, error::AddBlockErrorCode lastResult) {
+    std::vector<BlockTemplate> chain;
+    BlockTemplate previous = mainChain[previousIndex];
+    for (size_t i = 0; i < count; ++i) {
+      BlockTemplate block = makeBlock(previous);
+      auto expectedResult = i + 1 == count ? lastResult : error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE;
+      EXPECT_EQ(expectedResult, addBlock(block));
+      chain.push_back(block);
+      previous = block;
+    }
+
+    return chain;
+  }
+
+  Crypto::Hash getMainChainHash(uint32_t index) const {
+    return CachedBlock(mainChain[index]).getBlockHash();
+  }
+
+  // checks the supplement of remote ids and the main chain hashes it is served with
+  void expectSupplementStartsAt(const std::vector<Crypto::Hash>& remoteBlockIds, uint32_t expectedStartIndex) {
+    uint32_t totalBlockCount = 0;
+    uint32_t startBlockIndex = 0;
+    auto hashes = core.findBlockchainSupplement(remoteBlockIds, 5, totalBlockCount, startBlockIndex);
+    EXPECT_EQ(expectedStartIndex, startBlockIndex);
+    EXPECT_EQ(core.getTopBlockIndex() + 1, totalBlockCount);
+    std::vector<Crypto::Hash> expectedHashes;
+    for (uint32_t index = expectedStartIndex; index < mainChain.size() && expectedHashes.size() < 5; ++index) {
+      expectedHashes.push_back(getMainChainHash(index));
+    }
+
+    EXPECT_EQ(expectedHashes, hashes);
+  }
+
+  void expectRangeMatchesSingleBlocks(uint32_t startIndex, uint32_t count) {
+    auto blocksDetails = core.getBlocksDetails(startIndex, count);
+    ASSERT_EQ(count, blocksDetails.size());
+    for (uint32_t i = 0; i < count; ++i) {
+      SCOPED_TRACE("block " + std::to_string(startIndex + i));
+      expectSameDetails(core.getBlockDetails(core.getBlockHashByIndex(startIndex + i)), blocksDetails[i]);
+      EXPECT_FALSE(blocksDetails[i].isAlternative);
+    }
+  }
+
+  Logging::ConsoleLogger logger;
+  Currency currency;
+  test_generator generator;
+  AccountBase minerAccount;
+  System::Dispatcher dispatcher;
+  DataBaseMock database;
+  Core core;
+  std::vector<BlockTemplate> mainChain;
+};
+
+TEST_F(CoreTest, blocksDetailsRangeMatchesSingleBlockDetails) {
+  addMainChainBlocks(20);
+
+  expectRangeMatchesSingleBlocks(0, 21);
+  expectRangeMatchesSingleBlocks(5, 7);
+  expectRangeMatchesSingleBlocks(20, 1);
+}
+
+TEST_F(CoreTest, blocksDetailsRangeIsClippedToTopBlock) {
+  addMainChainBlocks(10);
+
+  auto blocksDetails = core.getBlocksDetails(8, 10);
+  ASSERT_EQ(3, blocksDetails.size());
+  EXPECT_EQ(CachedBlock(mainChain[10]).getBlockHash(), blocksDetails.back().hash);
+
+  EXPECT_TRUE(core.getBlocksDetails(11, 5).empty());
+  EXPECT_TRUE(core.getBlocksDetails(0, 0).empty());
+}
+
+TEST_F(CoreTest, blocksDetailsRangeCrossesSegmentBoundary) {
+  addMainChainBlocks(20);
+  // the alternative block splits the main chain into two segments at index 10
+  addAlternativeChain(9, 1, error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE);
+
+  expectRangeMatchesSingleBlocks(0, 21);
+  expectRangeMatchesSingleBlocks(8, 5);
+  expectRangeMatchesSingleBlocks(10, 3);
+}
+
+TEST_F(CoreTest, blocksDetailsRangeFollowsSwitchedChain) {
+  addMainChainBlocks(20);
+  auto alternativeChain = addAlternativeChain(9, 12, error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE_AND_SWITCHED);
+  ASSERT_EQ(CachedBlock(alternativeChain.back()).getBlockHash(), core.getTopBlockHash());
+
+  expectRangeMatchesSingleBlocks(0, core.getTopBlockIndex() + 1);
+  expectRangeMatchesSingleBlocks(7, 6);
+}
+
+TEST_F(CoreTest, blocksDetailsByHashesMatchSingleBlockDetails) {
+  addMainChainBlocks(20);
+  auto alternativeChain = addAlternativeChain(9, 1, error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE);
+
+  std::vector<Crypto::Hash> hashes;
+  for (uint32_t index : {3, 4, 5, 8, 9, 10, 11, 2}) {
+    hashes.push_back(CachedBlock(mainChain[index]).getBlockHash());
+  }
+  hashes.insert(hashes.begin() + 5, CachedBlock(alternativeChain.front()).getBlockHash());
+
+  auto blocksDetails = core.getBlocksDetails(hashes);
+  ASSERT_EQ(hashes.size(), blocksDetails.size());
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    SCOPED_TRACE("hash " + std::to_string(i));
+    expectSameDetails(core.getBlockDetails(hashes[i]), blocksDetails[i]);
+  }
+
+  EXPECT_TRUE(blocksDetails[5].isAlternative);
+  EXPECT_EQ(10, blocksDetails[5].index);
+}
+
+TEST_F(CoreTest, blockchainSupplementStartsAtForkOfRemoteChain) {
+  addMainChainBlocks(12);
+  // remote chain forks after index 4, its blocks are known to the core as an alternative chain
+  auto alternativeChain = addAlternativeChain(4, 5, error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE);
+
+  std::vector<Crypto::Hash> remoteBlockIds;
+  for (auto it = alternativeChain.rbegin(); it != alternativeChain.rend(); ++it) {
+    remoteBlockIds.push_back(CachedBlock(*it).getBlockHash());
+  }
+
+  for (uint32_t index = 5; index > 0; --index) {
+    remoteBlockIds.push_back(getMainChainHash(index - 1));
+  }
+
+  expectSupplementStartsAt(remoteBlockIds, 4);
+
+  // sparse chain of the remote top block at index 9: 9, 8, 7, 5, 1 and genesis
+  std::vector<Crypto::Hash> sparseBlockIds{remoteBlockIds[0], remoteBlockIds[1], remoteBlockIds[2], remoteBlockIds[4],
+                                           getMainChainHash(1), getMainChainHash(0)};
+  expectSupplementStartsAt(sparseBlockIds, 1);
+}
+
+TEST_F(CoreTest, blockchainSupplementStartsAtGenesisIfOnlyGenesisMatches) {
+  addMainChainBlocks(6);
+  auto alternativeChain = addAlternativeChain(0, 3, error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE);
+
+  Crypto::Hash unknownHash = Crypto::Hash();
+  unknownHash.data[0] = 1;
+  std::vector<Crypto::Hash> remoteBlockIds{unknownHash, CachedBlock(alternativeChain[2]).getBlockHash(),
+                                           CachedBlock(alternativeChain[0]).getBlockHash(), getMainChainHash(0)};
+  expectSupplementStartsAt(remoteBlockIds, 0);
+  expectSupplementStartsAt({getMainChainHash(0)}, 0);
+}
+
+TEST_F(CoreTest, blockchainSupplementThrowsIfRemoteIdsDontEndInGenesis) {
+  addMainChainBlocks(6);
+
+  uint32_t totalBlockCount = 0;
+  uint32_t startBlockIndex = 0;
+  std::vector<Crypto::Hash> remoteBlockIds{getMainChainHash(5), getMainChainHash(4), getMainChainHash(2)};
+  ASSERT_ANY_THROW(core.findBlockchainSupplement(remoteBlockIds, 5, totalBlockCount, startBlockIndex));
+  ASSERT_ANY_THROW(core.findBlockchainSupplement({}, 5, totalBlockCount, startBlockIndex));
+}
+
+TEST_F(CoreTest, getBlockHashByIndexThrowsBeyondTopBlock) {
+  addMainChainBlocks(3);
+
+  EXPECT_EQ(getMainChainHash(3), core.getBlockHashByIndex(3));
+  ASSERT_THROW(core.getBlockHashByIndex(4), std::out_of_range);
+}
+
+}
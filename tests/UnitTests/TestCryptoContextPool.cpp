@@ -0,0 +1,114 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <set>
+#include <thread>
+
+#include "CryptoNoteCore/CryptoContextPool.h"
+
+using namespace CryptoNote;
+
+TEST(CryptoContextPool, releasedContextIsReused) {
+  CryptoContextPool pool(2);
+
+  Crypto::cn_context* released;
+  {
+    auto context = pool.acquire();
+    released = context.get();
+    ASSERT_EQ(0, pool.getIdleContextCount());
+  }
+
+  ASSERT_EQ(1, pool.getIdleContextCount());
+  auto context = pool.acquire();
+  ASSERT_EQ(released, context.get());
+  ASSERT_EQ(0, pool.getIdleContextCount());
+}
+
+TEST(CryptoContextPool, acquiresDistinctContexts) {
+  CryptoContextPool pool(4);
+
+  auto contexts = pool.acquire(3);
+  ASSERT_EQ(3, contexts.size());
+  ASSERT_NE(contexts[0].get(), contexts[1].get());
+  ASSERT_NE(contexts[1].get(), contexts[2].get());
+  ASSERT_NE(contexts[0].get(), contexts[2].get());
+}
+
+TEST(CryptoContextPool, concurrentHoldersGetDistinctContexts) {
+  const size_t THREAD_COUNT = 8;
+  const size_t CONTEXTS_PER_THREAD = 4;
+  CryptoContextPool pool(THREAD_COUNT * CONTEXTS_PER_THREAD);
+
+  for (size_t round = 0; round < 3; ++round) {
+    std::vector<std::vector<Crypto::cn_context*>> held(THREAD_COUNT);
+    std::atomic<size_t> acquired(0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < THREAD_COUNT; ++i) {
+      threads.emplace_back([&, i] {
+        auto contexts = pool.acquire(CONTEXTS_PER_THREAD);
+        for (auto& context : contexts) {
+          held[i].push_back(context.get());
+        }
+
+        // contexts are kept until every thread holds its own
+        ++acquired;
+        while (acquired != THREAD_COUNT) {
+          std::this_thread::yield();
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    std::set<Crypto::cn_context*> distinct;
+    for (auto& contexts : held) {
+      distinct.insert(contexts.begin(), contexts.end());
+    }
+
+    ASSERT_EQ(THREAD_COUNT * CONTEXTS_PER_THREAD, distinct.size());
+  }
+}
+
+TEST(CryptoContextPool, keepsNoMoreThanMaxIdleContexts) {
+  CryptoContextPool pool(2);
+
+  pool.acquire(3).clear();
+  ASSERT_EQ(2, pool.getIdleContextCount());
+}
+
+TEST(CryptoContextPool, contextsAreCountedByPages) {
+  auto countContexts = [] {
+    return Crypto::cn_context_count(Crypto::cn_pages::regular) + Crypto::cn_context_count(Crypto::cn_pages::transparent_huge) +
+      Crypto::cn_context_count(Crypto::cn_pages::huge);
+  };
+
+  size_t initialCount = countContexts();
+  {
+    CryptoContextPool pool(1);
+    auto context = pool.acquire();
+    ASSERT_EQ(initialCount + 1, countContexts());
+    ASSERT_LE(1, Crypto::cn_context_count(context->pages()));
+  }
+
+  ASSERT_EQ(initialCount, countContexts());
+}
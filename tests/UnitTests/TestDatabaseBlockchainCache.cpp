@@ -19,9 +19,11 @@
 
 #include "crypto/crypto.h"
 
+#include "Common/Math.h"
 #include "CryptoNoteCore/BlockchainCache.h"
 #include <CryptoNoteCore/DatabaseBlockchainCache.h>
 #include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/TransactionExtra.h"
 #include "CryptoNoteCore/TransactionValidatiorState.h"
 #include "DataBaseMock.h"
 #include <CryptoNoteCore/DBUtils.h>
@@ -186,3 +188,261 @@ TEST_F(DatabaseBlockchainCacheTests, RawBlocksWithTxsSerialization) {
   ASSERT_EQ(deserializedRawBlock.block, rawBlock.block);
   ASSERT_EQ(deserializedRawBlock.transactions, rawBlock.transactions);
 }
+
+namespace {
+
+// windowed values are compared with values read by getLastUnits directly
+void checkLastValues(const IBlockchainCache& cache, uint32_t blockIndex) {
+  const size_t WINDOW_COUNT = 20;
+  auto expectedSizes = cache.getLastUnits(WINDOW_COUNT, blockIndex, UseGenesis(false), [](const CachedBlockInfo& info) { return info.blockSize; });
+  auto expectedTimestamps = cache.getLastUnits(WINDOW_COUNT, blockIndex, UseGenesis(false), [](const CachedBlockInfo& info) { return info.timestamp; });
+  ASSERT_EQ(expectedSizes, cache.getLastBlocksSizes(WINDOW_COUNT, blockIndex, UseGenesis(false))) << "block " << blockIndex;
+  ASSERT_EQ(Common::medianValue(expectedSizes), cache.getLastBlocksSizesMedian(WINDOW_COUNT, blockIndex, UseGenesis(false)));
+  ASSERT_EQ(expectedTimestamps, cache.getLastTimestamps(WINDOW_COUNT, blockIndex, UseGenesis(false))) << "block " << blockIndex;
+  ASSERT_EQ(Common::medianValue(expectedTimestamps), cache.getLastTimestampsMedian(WINDOW_COUNT, blockIndex, UseGenesis(false)));
+}
+
+}
+
+TEST_F(DatabaseBlockchainCacheTests, LastValuesFollowSplitAndReorganization) {
+  const uint32_t BLOCK_COUNT = 40;
+  const uint32_t firstIndex = blockchain.getTopBlockIndex() + 1;
+  generator.generateEmptyBlocks(BLOCK_COUNT);
+  auto blocks = generator.getBlockchainCopy();
+  blocks.erase(blocks.begin(), blocks.end() - BLOCK_COUNT);
+
+  for (uint32_t i = 0; i < BLOCK_COUNT; ++i) {
+    // genesis block is pushed twice in SetUp, so generated block indexes are shifted
+    boost::get<BaseInput>(blocks[i].baseTransaction.inputs.front()).blockIndex = firstIndex + i;
+    blocks[i].timestamp = 1500000000 + (i * 104729) % 1009;
+    TransactionValidatorState state;
+    blockchain.pushBlock(CachedBlock(blocks[i]), {}, state, 1000 + (i * 7919) % 503, 1, 1, { toBinaryArray(blocks[i]), {} });
+  }
+
+  uint32_t topIndex = blockchain.getTopBlockIndex();
+  ASSERT_EQ(firstIndex + BLOCK_COUNT - 1, topIndex);
+  for (uint32_t index = 1; index <= topIndex; ++index) {
+    ASSERT_NO_FATAL_FAILURE(checkLastValues(blockchain, index));
+  }
+
+  const uint32_t splitIndex = topIndex - 15;
+  auto tail = blockchain.split(splitIndex);
+  ASSERT_EQ(splitIndex - 1, blockchain.getTopBlockIndex());
+  ASSERT_NO_FATAL_FAILURE(checkLastValues(blockchain, splitIndex - 1));
+  ASSERT_NO_FATAL_FAILURE(checkLastValues(*tail, topIndex));
+
+  std::vector<uint64_t> tailSizes = tail->getLastBlocksSizes(20, topIndex, UseGenesis(false));
+
+  // alternative blocks with other sizes and timestamps replace the split ones, as when segments are merged after reorganization
+  for (uint32_t i = splitIndex - firstIndex; i < BLOCK_COUNT; ++i) {
+    blocks[i].timestamp = 1600000000 + (i * 7907) % 401;
+    TransactionValidatorState state;
+    blockchain.pushBlock(CachedBlock(blocks[i]), {}, state, 2000 + (i * 6007) % 211, 1, 1, { toBinaryArray(blocks[i]), {} });
+  }
+
+  ASSERT_EQ(topIndex, blockchain.getTopBlockIndex());
+  ASSERT_NO_FATAL_FAILURE(checkLastValues(blockchain, topIndex));
+  ASSERT_NE(tailSizes, blockchain.getLastBlocksSizes(20, topIndex, UseGenesis(false)));
+  for (uint32_t index = 1; index <= topIndex; ++index) {
+    ASSERT_NO_FATAL_FAILURE(checkLastValues(blockchain, index));
+  }
+}
+
+namespace {
+
+bool hasStoredBlockFilter(const DataBaseMock& database, uint32_t blockIndex) {
+  return database.baseState.count(DB::serializeKey(DB::BLOCK_INDEX_TO_BLOCK_FILTER_PREFIX, blockIndex)) != 0;
+}
+
+void checkBlockFilters(const IBlockchainCache& cache, uint32_t startIndex, const std::vector<BlockFilter>& filters) {
+  for (uint32_t i = 0; i < filters.size(); ++i) {
+    auto expected = BlockFilter::fromRawBlock(cache.getBlockByIndex(startIndex + i));
+    ASSERT_EQ(cache.getBlockHash(startIndex + i), filters[i].getBlockHash());
+    ASSERT_EQ(expected.getElementCount(), filters[i].getElementCount());
+    ASSERT_EQ(expected.getData(), filters[i].getData());
+  }
+}
+
+}
+
+TEST_F(DatabaseBlockchainCacheTests, PushBlockStoresBlockFilters) {
+  uint32_t topIndex = blockchain.getTopBlockIndex();
+  for (uint32_t index = 0; index <= topIndex; ++index) {
+    ASSERT_TRUE(hasStoredBlockFilter(database, index));
+  }
+
+  auto filters = blockchain.getBlockFiltersByIndexRange(0, topIndex + 1);
+  ASSERT_EQ(topIndex + 1, filters.size());
+  ASSERT_NO_FATAL_FAILURE(checkBlockFilters(blockchain, 0, filters));
+}
+
+TEST_F(DatabaseBlockchainCacheTests, SplitRemovesBlockFiltersAndMemorySegmentBuildsThem) {
+  const uint32_t BLOCK_COUNT = 6;
+  const uint32_t firstIndex = blockchain.getTopBlockIndex() + 1;
+  generator.generateEmptyBlocks(BLOCK_COUNT);
+  auto blocks = generator.getBlockchainCopy();
+  blocks.erase(blocks.begin(), blocks.end() - BLOCK_COUNT);
+
+  // split blocks are moved to a memory segment, which needs their sizes
+  for (uint32_t i = 0; i < BLOCK_COUNT; ++i) {
+    boost::get<BaseInput>(blocks[i].baseTransaction.inputs.front()).blockIndex = firstIndex + i;
+    TransactionValidatorState state;
+    blockchain.pushBlock(CachedBlock(blocks[i]), {}, state, 1000, 1, 1, { toBinaryArray(blocks[i]), {} });
+  }
+
+  uint32_t topIndex = blockchain.getTopBlockIndex();
+  uint32_t splitIndex = topIndex - 3;
+  auto tail = blockchain.split(splitIndex);
+
+  for (uint32_t index = 0; index <= topIndex; ++index) {
+    ASSERT_EQ(index < splitIndex, hasStoredBlockFilter(database, index));
+  }
+
+  auto tailFilters = tail->getBlockFiltersByIndexRange(splitIndex, topIndex - splitIndex + 1);
+  ASSERT_EQ(topIndex - splitIndex + 1, tailFilters.size());
+  ASSERT_NO_FATAL_FAILURE(checkBlockFilters(*tail, splitIndex, tailFilters));
+
+  // range crossing the segment boundary takes stored filters from the database segment
+  auto crossingFilters = tail->getBlockFiltersByIndexRange(splitIndex - 2, 4);
+  ASSERT_EQ(4, crossingFilters.size());
+  ASSERT_NO_FATAL_FAILURE(checkBlockFilters(*tail, splitIndex - 2, crossingFilters));
+}
+
+TEST_F(DatabaseBlockchainCacheTests, BackfillsBlockFiltersOfOlderDatabaseOnLoad) {
+  uint32_t topIndex = blockchain.getTopBlockIndex();
+  auto filters = blockchain.getBlockFiltersByIndexRange(0, topIndex + 1);
+  for (uint32_t index = 0; index <= topIndex; ++index) {
+    database.baseState.erase(DB::serializeKey(DB::BLOCK_INDEX_TO_BLOCK_FILTER_PREFIX, index));
+  }
+
+  DatabaseBlockchainCache loaded(currency, database, blockchainCacheFactory, logger);
+  for (uint32_t index = 0; index <= topIndex; ++index) {
+    ASSERT_TRUE(hasStoredBlockFilter(database, index));
+  }
+
+  auto loadedFilters = loaded.getBlockFiltersByIndexRange(0, topIndex + 1);
+  ASSERT_EQ(filters.size(), loadedFilters.size());
+  ASSERT_NO_FATAL_FAILURE(checkBlockFilters(loaded, 0, loadedFilters));
+}
+
+namespace {
+
+// blocks with two transactions of the same payment id each, first two blocks share a timestamp
+std::vector<PushedBlock> makeBlocksWithPaymentIds(const Currency& currency, const Hash& previousBlockHash, uint32_t firstIndex,
+                                                  uint32_t count, const Hash& paymentId) {
+  BinaryArray extraNonce;
+  setPaymentIdToTransactionExtraNonce(extraNonce, paymentId);
+
+  std::vector<PushedBlock> blocks;
+  Hash previousHash = previousBlockHash;
+  for (uint32_t i = 0; i < count; ++i) {
+    BlockTemplate block;
+    block.majorVersion = BLOCK_MAJOR_VERSION_1;
+    block.minorVersion = BLOCK_MINOR_VERSION_0;
+    block.timestamp = currency.genesisBlock().timestamp + std::max<uint32_t>(i, 1) * 60;
+    block.previousBlockHash = previousHash;
+    block.nonce = i;
+    block.baseTransaction.version = CURRENT_TRANSACTION_VERSION;
+    block.baseTransaction.unlockTime = firstIndex + i + currency.minedMoneyUnlockWindow();
+    block.baseTransaction.inputs.push_back(BaseInput{firstIndex + i});
+    block.baseTransaction.outputs.push_back(TransactionOutput{1000, KeyOutput{generateKeyPair().publicKey}});
+
+    std::vector<CachedTransaction> transactions;
+    RawBlock rawBlock;
+    for (uint32_t j = 0; j < 2; ++j) {
+      Transaction transaction;
+      transaction.version = CURRENT_TRANSACTION_VERSION;
+      transaction.unlockTime = i * 2 + j;
+      transaction.outputs.push_back(TransactionOutput{100, KeyOutput{generateKeyPair().publicKey}});
+      addExtraNonceToTransactionExtra(transaction.extra, extraNonce);
+
+      transactions.emplace_back(std::move(transaction));
+      block.transactionHashes.push_back(transactions.back().getTransactionHash());
+      rawBlock.transactions.push_back(transactions.back().getTransactionBinaryArray());
+    }
+
+    rawBlock.block = toBinaryArray(block);
+    previousHash = CachedBlock(block).getBlockHash();
+    blocks.push_back(PushedBlock{block, std::move(transactions), PushedBlockInfo{std::move(rawBlock), {}, 100, 1000, 1}});
+  }
+
+  return blocks;
+}
+
+// fails writes on demand, as a database on a full disk does
+class FailingDataBaseMock : public DataBaseMock {
+public:
+  std::error_code write(IWriteBatch& batch) override {
+    if (failWrites) {
+      return std::make_error_code(std::errc::no_space_on_device);
+    }
+
+    return DataBaseMock::write(batch);
+  }
+
+  bool failWrites = false;
+};
+
+}
+
+TEST_F(DatabaseBlockchainCacheTests, PushBlocksWritesSameDataAsPushBlock) {
+  DataBaseMock singleDatabase;
+  DataBaseMock batchDatabase;
+  DatabaseBlockchainCache single(currency, singleDatabase, blockchainCacheFactory, logger);
+  DatabaseBlockchainCache batched(currency, batchDatabase, blockchainCacheFactory, logger);
+
+  const uint32_t BLOCK_COUNT = 5;
+  auto paymentId = randomBlockHash();
+  auto blocks = makeBlocksWithPaymentIds(currency, single.getTopBlockHash(), 1, BLOCK_COUNT, paymentId);
+  for (const auto& block : blocks) {
+    single.pushBlock(CachedBlock(block.block), block.transactions, block.info.validatorState, block.info.blockSize,
+                     block.info.generatedCoins, block.info.blockDifficulty, RawBlock(block.info.rawBlock));
+  }
+
+  batched.pushBlocks(std::vector<PushedBlock>(blocks));
+
+  ASSERT_EQ(singleDatabase.baseState, batchDatabase.baseState);
+  ASSERT_EQ(BLOCK_COUNT, batched.getTopBlockIndex());
+  ASSERT_EQ(CachedBlock(blocks.back().block).getBlockHash(), batched.getTopBlockHash());
+  ASSERT_EQ(2 * BLOCK_COUNT, batched.getTransactionHashesByPaymentId(paymentId).size());
+  ASSERT_EQ(2, batched.getBlockHashesByTimestamps(blocks.front().block.timestamp, 1).size());
+
+  auto infos = batched.getBlockInfosByIndexRange(0, BLOCK_COUNT + 1);
+  ASSERT_EQ(BLOCK_COUNT + 1, infos.size());
+  for (uint32_t i = 1; i <= BLOCK_COUNT; ++i) {
+    EXPECT_EQ(infos[i - 1].cumulativeDifficulty + 1, infos[i].cumulativeDifficulty);
+    EXPECT_EQ(infos[i - 1].alreadyGeneratedCoins + 1000, infos[i].alreadyGeneratedCoins);
+    EXPECT_EQ(infos[i - 1].alreadyGeneratedTransactions + 3, infos[i].alreadyGeneratedTransactions);
+  }
+}
+
+TEST_F(DatabaseBlockchainCacheTests, FailedPushKeepsCacheAtWrittenTopBlock) {
+  FailingDataBaseMock failingDatabase;
+  DataBaseMock expectedDatabase;
+  DatabaseBlockchainCache cache(currency, failingDatabase, blockchainCacheFactory, logger);
+  DatabaseBlockchainCache expected(currency, expectedDatabase, blockchainCacheFactory, logger);
+
+  auto genesisHash = cache.getTopBlockHash();
+  auto blocks = makeBlocksWithPaymentIds(currency, genesisHash, 1, 3, randomBlockHash());
+  auto writtenState = failingDatabase.baseState;
+  failingDatabase.failWrites = true;
+  ASSERT_ANY_THROW(cache.pushBlocks(std::vector<PushedBlock>(blocks)));
+  ASSERT_ANY_THROW(cache.pushBlock(CachedBlock(blocks[0].block), blocks[0].transactions, blocks[0].info.validatorState,
+                                   blocks[0].info.blockSize, blocks[0].info.generatedCoins, blocks[0].info.blockDifficulty,
+                                   RawBlock(blocks[0].info.rawBlock)));
+
+  ASSERT_EQ(writtenState, failingDatabase.baseState);
+  EXPECT_EQ(0, cache.getTopBlockIndex());
+  EXPECT_EQ(genesisHash, cache.getTopBlockHash());
+  EXPECT_EQ(1, cache.getTransactionCount());
+  EXPECT_FALSE(cache.hasBlock(CachedBlock(blocks[0].block).getBlockHash()));
+  EXPECT_EQ(genesisHash, cache.getBlockInfosByIndexRange(0, 1).back().blockHash);
+
+  // counters moved by the failed pushes are not carried into the next batch
+  failingDatabase.failWrites = false;
+  cache.pushBlocks(std::vector<PushedBlock>(blocks));
+  expected.pushBlocks(std::vector<PushedBlock>(blocks));
+  ASSERT_EQ(expectedDatabase.baseState, failingDatabase.baseState);
+  EXPECT_EQ(3, cache.getTopBlockIndex());
+  EXPECT_EQ(expected.getTransactionCount(), cache.getTransactionCount());
+}
@@ -0,0 +1,197 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include <thread>
+
+#include "CryptoNoteCore/DatabaseTipCache.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+Crypto::Hash makeHash(uint32_t value, uint8_t kind) {
+  Crypto::Hash hash = {};
+  hash.data[0] = kind;
+  *reinterpret_cast<uint32_t*>(hash.data + 1) = value;
+  return hash;
+}
+
+// every block has one transaction with one key output of amount 10 and global index equal to block index
+DatabaseTipCache::Block makeBlock(uint32_t index) {
+  DatabaseTipCache::Block block;
+  block.index = index;
+  block.hash = makeHash(index, 1);
+
+  ExtendedTransactionInfo transaction;
+  transaction.blockIndex = index;
+  transaction.transactionIndex = 0;
+  transaction.transactionHash = makeHash(index, 2);
+  transaction.unlockTime = 0;
+  transaction.globalIndexes.push_back(index);
+  block.transactions.push_back(transaction);
+
+  KeyOutputInfo output;
+  output.publicKey = {};
+  output.transactionHash = transaction.transactionHash;
+  output.unlockTime = 0;
+  output.outputIndex = 0;
+  block.keyOutputs.emplace_back(DatabaseTipCache::KeyOutputId{10, index}, output);
+
+  return block;
+}
+
+DatabaseTipCache makeCache(size_t maxBlockCount, uint32_t blockCount) {
+  DatabaseTipCache cache(maxBlockCount);
+  for (uint32_t i = 0; i < blockCount; ++i) {
+    cache.pushBlock(makeBlock(i));
+  }
+
+  return cache;
+}
+
+bool hasBlock(const DatabaseTipCache& cache, uint32_t index) {
+  uint32_t foundIndex;
+  return cache.findBlockIndex(makeHash(index, 1), foundIndex) && foundIndex == index;
+}
+
+bool hasTransaction(const DatabaseTipCache& cache, uint32_t index) {
+  auto transaction = cache.findTransaction(makeHash(index, 2));
+  return transaction != nullptr && transaction->blockIndex == index;
+}
+
+bool hasOutput(const DatabaseTipCache& cache, uint32_t index) {
+  return cache.findKeyOutput(10, index) != nullptr;
+}
+
+}
+
+TEST(DatabaseTipCacheTest, evictsOldestBlocks) {
+  auto cache = makeCache(5, 8);
+
+  ASSERT_EQ(5, cache.getBlockCount());
+  for (uint32_t i = 0; i < 8; ++i) {
+    ASSERT_EQ(i >= 3, hasBlock(cache, i)) << i;
+    ASSERT_EQ(i >= 3, hasTransaction(cache, i)) << i;
+    ASSERT_EQ(i >= 3, hasOutput(cache, i)) << i;
+  }
+}
+
+TEST(DatabaseTipCacheTest, findsBlockHashesByIndex) {
+  auto cache = makeCache(5, 8);
+
+  Crypto::Hash hash;
+  ASSERT_FALSE(cache.findBlockHash(2, hash));
+  ASSERT_TRUE(cache.findBlockHash(7, hash));
+  ASSERT_EQ(makeHash(7, 1), hash);
+  ASSERT_FALSE(cache.findBlockHash(8, hash));
+
+  std::vector<Crypto::Hash> hashes;
+  ASSERT_TRUE(cache.findBlockHashes(4, 3, hashes));
+  ASSERT_EQ((std::vector<Crypto::Hash>{makeHash(4, 1), makeHash(5, 1), makeHash(6, 1)}), hashes);
+
+  hashes.clear();
+  ASSERT_FALSE(cache.findBlockHashes(2, 3, hashes));
+  ASSERT_FALSE(cache.findBlockHashes(6, 3, hashes));
+  ASSERT_TRUE(hashes.empty());
+}
+
+TEST(DatabaseTipCacheTest, cutFromDropsSplitBlocks) {
+  auto cache = makeCache(10, 8);
+
+  cache.cutFrom(5);
+
+  ASSERT_EQ(5, cache.getBlockCount());
+  for (uint32_t i = 0; i < 8; ++i) {
+    ASSERT_EQ(i < 5, hasBlock(cache, i)) << i;
+    ASSERT_EQ(i < 5, hasTransaction(cache, i)) << i;
+    ASSERT_EQ(i < 5, hasOutput(cache, i)) << i;
+  }
+
+  // alternative chain continues from split index
+  auto block = makeBlock(5);
+  block.hash = makeHash(100, 1);
+  cache.pushBlock(std::move(block));
+
+  Crypto::Hash hash;
+  ASSERT_TRUE(cache.findBlockHash(5, hash));
+  ASSERT_EQ(makeHash(100, 1), hash);
+  ASSERT_FALSE(hasBlock(cache, 5));
+}
+
+TEST(DatabaseTipCacheTest, gapInBlockIndexesClearsCache) {
+  auto cache = makeCache(10, 4);
+
+  cache.pushBlock(makeBlock(6));
+
+  ASSERT_EQ(1, cache.getBlockCount());
+  ASSERT_FALSE(hasBlock(cache, 3));
+  ASSERT_TRUE(hasBlock(cache, 6));
+}
+
+TEST(DatabaseTipCacheTest, zeroSizeCacheKeepsNothing) {
+  auto cache = makeCache(0, 4);
+
+  ASSERT_EQ(0, cache.getBlockCount());
+  ASSERT_FALSE(hasBlock(cache, 3));
+  ASSERT_FALSE(hasTransaction(cache, 3));
+}
+
+TEST(DatabaseTipCacheTest, countsHitsAndMisses) {
+  auto cache = makeCache(5, 8);
+
+  hasBlock(cache, 1);
+  hasBlock(cache, 7);
+  hasTransaction(cache, 7);
+  hasOutput(cache, 1);
+  hasOutput(cache, 6);
+  hasOutput(cache, 7);
+
+  auto statistics = cache.getStatistics();
+  ASSERT_EQ(1, statistics.blockHits);
+  ASSERT_EQ(1, statistics.blockMisses);
+  ASSERT_EQ(1, statistics.transactionHits);
+  ASSERT_EQ(0, statistics.transactionMisses);
+  ASSERT_EQ(2, statistics.outputHits);
+  ASSERT_EQ(1, statistics.outputMisses);
+}
+
+TEST(DatabaseTipCacheTest, countsConcurrentLookups) {
+  const size_t THREAD_COUNT = 4;
+  const size_t LOOKUP_COUNT = 10000;
+  auto cache = makeCache(5, 8);
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < THREAD_COUNT; ++i) {
+    threads.emplace_back([&] {
+      for (size_t j = 0; j < LOOKUP_COUNT; ++j) {
+        hasBlock(cache, 7);
+        hasOutput(cache, 1);
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto statistics = cache.getStatistics();
+  ASSERT_EQ(THREAD_COUNT * LOOKUP_COUNT, statistics.blockHits);
+  ASSERT_EQ(THREAD_COUNT * LOOKUP_COUNT, statistics.outputMisses);
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include <System/ContextGroup.h>
+#include <System/Dispatcher.h>
+#include <System/InterruptedException.h>
+
+#include "Rpc/HttpClientPool.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const uint16_t TEST_PORT = 18080;
+
+}
+
+class HttpClientPoolTest : public testing::Test {
+public:
+  HttpClientPoolTest() : contextGroup(dispatcher) {
+  }
+
+protected:
+  System::Dispatcher dispatcher;
+  System::ContextGroup contextGroup;
+};
+
+TEST_F(HttpClientPoolTest, acquiresDistinctClients) {
+  HttpClientPool pool(dispatcher, "127.0.0.1", TEST_PORT, 2);
+
+  auto client1 = pool.acquire(HttpClientPool::Priority::HIGH);
+  auto client2 = pool.acquire(HttpClientPool::Priority::HIGH);
+  ASSERT_NE(client1.get(), client2.get());
+  ASSERT_EQ(0, pool.getIdleClientCount());
+
+  client1.reset();
+  ASSERT_EQ(1, pool.getIdleClientCount());
+}
+
+TEST_F(HttpClientPoolTest, lowPriorityRequestsLeaveLastClientFree) {
+  HttpClientPool pool(dispatcher, "127.0.0.1", TEST_PORT, 2);
+
+  auto lowClient = pool.acquire(HttpClientPool::Priority::LOW);
+
+  bool lowAcquired = false;
+  contextGroup.spawn([&] {
+    auto client = pool.acquire(HttpClientPool::Priority::LOW);
+    lowAcquired = true;
+  });
+
+  dispatcher.yield();
+  ASSERT_FALSE(lowAcquired);
+  ASSERT_EQ(1, pool.getIdleClientCount());
+
+  auto highClient = pool.acquire(HttpClientPool::Priority::HIGH);
+  ASSERT_NE(lowClient.get(), highClient.get());
+
+  lowClient.reset();
+  contextGroup.wait();
+  ASSERT_TRUE(lowAcquired);
+}
+
+TEST_F(HttpClientPoolTest, highPriorityWaiterIsServedFirst) {
+  HttpClientPool pool(dispatcher, "127.0.0.1", TEST_PORT, 1);
+
+  auto client = pool.acquire(HttpClientPool::Priority::HIGH);
+
+  std::string order;
+  contextGroup.spawn([&] {
+    auto client = pool.acquire(HttpClientPool::Priority::LOW);
+    order += "L";
+  });
+
+  contextGroup.spawn([&] {
+    auto client = pool.acquire(HttpClientPool::Priority::HIGH);
+    order += "H";
+  });
+
+  dispatcher.yield();
+  ASSERT_TRUE(order.empty());
+
+  client.reset();
+  contextGroup.wait();
+  ASSERT_EQ("HL", order);
+}
+
+TEST_F(HttpClientPoolTest, interruptedWaiterDoesNotTakeClient) {
+  HttpClientPool pool(dispatcher, "127.0.0.1", TEST_PORT, 1);
+
+  auto client = pool.acquire(HttpClientPool::Priority::HIGH);
+
+  bool interrupted = false;
+  contextGroup.spawn([&] {
+    try {
+      pool.acquire(HttpClientPool::Priority::HIGH);
+    } catch (System::InterruptedException&) {
+      interrupted = true;
+    }
+  });
+
+  dispatcher.yield();
+  contextGroup.interrupt();
+  contextGroup.wait();
+  ASSERT_TRUE(interrupted);
+
+  client.reset();
+  ASSERT_EQ(1, pool.getIdleClientCount());
+}
@@ -368,6 +368,30 @@ TEST_F(InProcessNodeTests, getBlocksByHeightMany) {
   }
 }
 
+TEST_F(InProcessNodeTests, getBlocksByHeightSplitsNonConsecutiveHeightsIntoRanges) {
+  const size_t NUMBER_OF_BLOCKS = 10;
+
+  generator.generateEmptyBlocks(NUMBER_OF_BLOCKS);
+  for (auto iter = generator.getBlockchain().begin() + 1; iter != generator.getBlockchain().end(); iter++) {
+    coreStub.addBlock(*iter);
+  }
+
+  std::vector<uint32_t> blockHeights = { 3, 4, 5, 9, 1, 2, 7, 7, 8 };
+  std::vector<std::vector<CryptoNote::BlockDetails>> actualBlocks;
+
+  CallbackStatus status(dispatcher);
+  node.getBlocks(blockHeights, actualBlocks, [&status] (std::error_code ec) { status.setStatusRemote(ec); });
+  ASSERT_TRUE(status.wait());
+  ASSERT_EQ(std::error_code(), status.getStatus());
+
+  ASSERT_EQ(blockHeights.size(), actualBlocks.size());
+  for (size_t i = 0; i < blockHeights.size(); ++i) {
+    ASSERT_EQ(1, actualBlocks[i].size());
+    EXPECT_EQ(blockHeights[i], actualBlocks[i].front().index);
+    EXPECT_EQ(CryptoNote::CachedBlock(generator.getBlockchain()[blockHeights[i]]).getBlockHash(), actualBlocks[i].front().hash);
+  }
+}
+
 TEST_F(InProcessNodeTests, getBlocksByHeightFail) {
   const size_t NUMBER_OF_BLOCKS = 10;
 
@@ -0,0 +1,121 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include "Rpc/CoreRpcServerCommandsDefinitions.h"
+#include "Rpc/JsonRpc.h"
+
+using namespace CryptoNote;
+using namespace CryptoNote::JsonRpc;
+
+namespace {
+
+int getErrorCode(const std::string& body) {
+  JsonRpcRequest request;
+  try {
+    request.parseRequest(body);
+  } catch (const JsonRpcError& error) {
+    return error.code;
+  }
+
+  return 0;
+}
+
+}
+
+TEST(JsonRpc, requestMembersAreParsed) {
+  JsonRpcRequest request;
+  request.parseRequest(R"({"jsonrpc":"2.0","params":{"height":15},"id":"a\"b","method":"getblockheaderbyheight"})");
+
+  EXPECT_EQ("getblockheaderbyheight", request.getMethod());
+  ASSERT_TRUE(request.getId().is_initialized());
+  EXPECT_EQ("\"a\\\"b\"", request.getId()->toString());
+
+  COMMAND_RPC_GET_BLOCK_HEADER_BY_HEIGHT::request params;
+  ASSERT_TRUE(request.loadParams(params));
+  EXPECT_EQ(15, params.height);
+}
+
+TEST(JsonRpc, arrayParamsAreParsed) {
+  JsonRpcRequest request;
+  request.parseRequest(R"({"method":"on_getblockhash","id":7,"params":[3,4]})");
+
+  EXPECT_EQ("7", request.getId()->toString());
+
+  COMMAND_RPC_GETBLOCKHASH::request params;
+  request.loadParams(params);
+  EXPECT_EQ(COMMAND_RPC_GETBLOCKHASH::request({3, 4}), params);
+}
+
+TEST(JsonRpc, missingIdAndParamsAreAccepted) {
+  JsonRpcRequest request;
+  request.parseRequest(R"({"method":"getblockcount"})");
+
+  EXPECT_FALSE(request.getId().is_initialized());
+
+  COMMAND_RPC_GET_BLOCK_HEADER_BY_HEIGHT::request params;
+  params.height = 1;
+  request.loadParams(params);
+  EXPECT_EQ(1, params.height);
+}
+
+TEST(JsonRpc, invalidRequestsAreRejected) {
+  EXPECT_EQ(errParseError, getErrorCode(R"({"method":"getblockcount")"));
+  EXPECT_EQ(errParseError, getErrorCode("[]"));
+  EXPECT_EQ(errInvalidRequest, getErrorCode(R"({"id":1})"));
+  EXPECT_EQ(errInvalidRequest, getErrorCode(R"({"method":"getblockcount","id":{"a":1}})"));
+}
+
+TEST(JsonRpc, responseResultAndErrorAreParsed) {
+  JsonRpcResponse response;
+  response.parse(R"({"jsonrpc":"2.0","id":0,"result":{"count":10,"status":"OK"}})");
+
+  JsonRpcError error;
+  EXPECT_FALSE(response.getError(error));
+
+  COMMAND_RPC_GETBLOCKCOUNT::response result;
+  ASSERT_TRUE(response.getResult(result));
+  EXPECT_EQ(10, result.count);
+  EXPECT_EQ("OK", result.status);
+
+  JsonRpcResponse errorResponse;
+  errorResponse.parse(R"({"jsonrpc":"2.0","error":{"code":-32601,"message":"Method not found"}})");
+  ASSERT_TRUE(errorResponse.getError(error));
+  EXPECT_EQ(errMethodNotFound, error.code);
+  EXPECT_EQ("Method not found", error.message);
+  EXPECT_FALSE(errorResponse.getResult(result));
+}
+
+TEST(JsonRpc, responseBodyIsReadableByRequestSide) {
+  JsonRpcRequest request;
+  request.parseRequest(R"({"method":"getblockcount","id":"x"})");
+
+  JsonRpcResponse response;
+  response.setId(request.getId());
+  COMMAND_RPC_GETBLOCKCOUNT::response result;
+  result.count = 3;
+  result.status = "OK";
+  response.setResult(result);
+
+  JsonRpcResponse parsed;
+  parsed.parse(response.getBody());
+  COMMAND_RPC_GETBLOCKCOUNT::response parsedResult;
+  ASSERT_TRUE(parsed.getResult(parsedResult));
+  EXPECT_EQ(3, parsedResult.count);
+}
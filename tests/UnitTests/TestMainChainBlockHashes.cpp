@@ -0,0 +1,106 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+
+#include "CryptoNoteCore/MainChainBlockHashes.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+Crypto::Hash makeHash(uint32_t blockIndex) {
+  Crypto::Hash hash = Crypto::Hash();
+  *reinterpret_cast<uint32_t*>(hash.data) = blockIndex + 1;
+  return hash;
+}
+
+MainChainBlockHashes makeHashes(uint32_t blockCount) {
+  MainChainBlockHashes hashes;
+  for (uint32_t i = 0; i < blockCount; ++i) {
+    hashes.pushBlock(makeHash(i));
+  }
+
+  return hashes;
+}
+
+}
+
+TEST(MainChainBlockHashesTest, returnsPushedHashesByIndex) {
+  auto hashes = makeHashes(10);
+
+  ASSERT_EQ(10, hashes.getBlockCount());
+  for (uint32_t i = 0; i < 10; ++i) {
+    ASSERT_EQ(makeHash(i), hashes.getBlockHash(i));
+    ASSERT_TRUE(hashes.hasBlock(i, makeHash(i)));
+  }
+
+  ASSERT_FALSE(hashes.hasBlock(3, makeHash(4)));
+  ASSERT_FALSE(hashes.hasBlock(10, makeHash(10)));
+}
+
+TEST(MainChainBlockHashesTest, getBlockHashThrowsBeyondTopBlock) {
+  auto hashes = makeHashes(3);
+
+  ASSERT_THROW(hashes.getBlockHash(3), std::out_of_range);
+  ASSERT_THROW(MainChainBlockHashes().getBlockHash(0), std::out_of_range);
+}
+
+TEST(MainChainBlockHashesTest, getBlockHashesIsLimitedByTopBlock) {
+  auto hashes = makeHashes(10);
+
+  ASSERT_EQ((std::vector<Crypto::Hash>{makeHash(2), makeHash(3), makeHash(4)}), hashes.getBlockHashes(2, 3));
+  ASSERT_EQ((std::vector<Crypto::Hash>{makeHash(8), makeHash(9)}), hashes.getBlockHashes(8, 5));
+  ASSERT_TRUE(hashes.getBlockHashes(10, 5).empty());
+}
+
+TEST(MainChainBlockHashesTest, cutFromReplacesChainAfterSplit) {
+  auto hashes = makeHashes(10);
+
+  hashes.cutFrom(6);
+  ASSERT_EQ(6, hashes.getBlockCount());
+
+  hashes.pushBlocks({makeHash(100), makeHash(101)});
+  ASSERT_EQ(8, hashes.getBlockCount());
+  ASSERT_EQ(makeHash(5), hashes.getBlockHash(5));
+  ASSERT_EQ(makeHash(100), hashes.getBlockHash(6));
+  ASSERT_EQ(makeHash(101), hashes.getBlockHash(7));
+
+  hashes.cutFrom(20);
+  ASSERT_EQ(8, hashes.getBlockCount());
+}
+
+TEST(MainChainBlockHashesTest, sparseChainOfGenesisOnly) {
+  auto hashes = makeHashes(1);
+
+  ASSERT_EQ(std::vector<Crypto::Hash>{makeHash(0)}, hashes.buildSparseChain());
+}
+
+TEST(MainChainBlockHashesTest, sparseChainGoesFromTopToGenesisWithGrowingSteps) {
+  auto hashes = makeHashes(21);
+
+  std::vector<Crypto::Hash> expected{makeHash(20), makeHash(19), makeHash(18), makeHash(16), makeHash(12), makeHash(4), makeHash(0)};
+  ASSERT_EQ(expected, hashes.buildSparseChain());
+}
+
+TEST(MainChainBlockHashesTest, sparseChainOfTwoBlocks) {
+  auto hashes = makeHashes(2);
+
+  ASSERT_EQ((std::vector<Crypto::Hash>{makeHash(1), makeHash(0)}), hashes.buildSparseChain());
+}
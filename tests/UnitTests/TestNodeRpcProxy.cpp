@@ -0,0 +1,274 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include <System/Dispatcher.h>
+#include <System/Event.h>
+#include <System/Timer.h>
+
+#include "Common/StringTools.h"
+#include "crypto/crypto.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "Logging/ConsoleLogger.h"
+#include "NodeRpcProxy/NodeRpcProxy.h"
+#include "Rpc/CoreRpcServerCommandsDefinitions.h"
+#include "Rpc/HttpServer.h"
+#include "Rpc/JsonRpc.h"
+#include "Serialization/SerializationTools.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const uint16_t FAKE_NODE_PORT = 6690;
+
+// answers the requests NodeRpcProxy makes to keep its node status up to date
+class FakeNode {
+public:
+  FakeNode() : longPollSupported(true), poolChangesFail(false), lastBlockHeaderRequests(0), waitForChangesRequests(0),
+    topBlockHash(Crypto::rand<Crypto::Hash>()), topBlockIndex(1), poolDigest(NULL_HASH) {
+    std::promise<void> started;
+    auto startedFuture = started.get_future();
+    thread = std::thread([this, &started] { run(started); });
+    startedFuture.wait();
+  }
+
+  ~FakeNode() {
+    dispatcher->remoteSpawn([this] { stopEvent->set(); });
+    thread.join();
+  }
+
+  void setTopBlock(uint32_t index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    topBlockHash = Crypto::rand<Crypto::Hash>();
+    topBlockIndex = index;
+  }
+
+  // the digest long poll reports for the pool, get_pool_changes_lite.bin keeps returning no transactions
+  void setPoolDigest(const Crypto::Hash& digest) {
+    std::lock_guard<std::mutex> lock(mutex);
+    poolDigest = digest;
+  }
+
+  std::atomic<bool> longPollSupported;
+  std::atomic<bool> poolChangesFail;
+  std::atomic<size_t> lastBlockHeaderRequests;
+  std::atomic<size_t> waitForChangesRequests;
+
+private:
+  class Server : public HttpServer {
+  public:
+    Server(System::Dispatcher& dispatcher, Logging::ILogger& logger, FakeNode& node) :
+      HttpServer(dispatcher, logger), node(node) {
+    }
+
+    virtual void processRequest(const HttpRequest& request, HttpResponse& response) override {
+      node.processRequest(m_dispatcher, request, response);
+    }
+
+  private:
+    FakeNode& node;
+  };
+
+  void run(std::promise<void>& started) {
+    System::Dispatcher localDispatcher;
+    System::Event localStopEvent(localDispatcher);
+    Server server(localDispatcher, logger, *this);
+    server.start("127.0.0.1", FAKE_NODE_PORT);
+
+    dispatcher = &localDispatcher;
+    stopEvent = &localStopEvent;
+    started.set_value();
+
+    localStopEvent.wait();
+    server.stop();
+  }
+
+  void processRequest(System::Dispatcher& localDispatcher, const HttpRequest& request, HttpResponse& response) {
+    if (request.getUrl() == "/json_rpc") {
+      JsonRpc::JsonRpcRequest jsonRequest;
+      JsonRpc::JsonRpcResponse jsonResponse;
+      jsonRequest.parseRequest(request.getBody());
+      jsonResponse.setId(jsonRequest.getId());
+
+      ++lastBlockHeaderRequests;
+      COMMAND_RPC_GET_LAST_BLOCK_HEADER::response rsp = boost::value_initialized<COMMAND_RPC_GET_LAST_BLOCK_HEADER::response>();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        rsp.block_header.hash = Common::podToHex(topBlockHash);
+        rsp.block_header.height = topBlockIndex;
+      }
+
+      rsp.block_header.prev_hash = Common::podToHex(NULL_HASH);
+      rsp.status = CORE_RPC_STATUS_OK;
+      jsonResponse.setResult(rsp);
+      response.setBody(jsonResponse.getBody());
+    } else if (request.getUrl() == "/getinfo") {
+      COMMAND_RPC_GET_INFO::response rsp = boost::value_initialized<COMMAND_RPC_GET_INFO::response>();
+      rsp.status = CORE_RPC_STATUS_OK;
+      response.setBody(storeToJson(rsp));
+    } else if (request.getUrl() == "/get_pool_changes_lite.bin") {
+      COMMAND_RPC_GET_POOL_CHANGES_LITE::request req;
+      loadFromBinaryKeyValue(req, request.getBody());
+
+      COMMAND_RPC_GET_POOL_CHANGES_LITE::response rsp = boost::value_initialized<COMMAND_RPC_GET_POOL_CHANGES_LITE::response>();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        rsp.isTailBlockActual = req.tailBlockId == topBlockHash;
+      }
+
+      rsp.status = poolChangesFail ? CORE_RPC_STATUS_BUSY : CORE_RPC_STATUS_OK;
+      response.setBody(storeToBinaryKeyValue(rsp));
+    } else if (request.getUrl() == "/wait_for_changes.bin" && longPollSupported) {
+      ++waitForChangesRequests;
+      COMMAND_RPC_WAIT_FOR_CHANGES::request req;
+      loadFromBinaryKeyValue(req, request.getBody());
+
+      COMMAND_RPC_WAIT_FOR_CHANGES::response rsp = boost::value_initialized<COMMAND_RPC_WAIT_FOR_CHANGES::response>();
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(req.timeout);
+      for (;;) {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          rsp.topBlockId = topBlockHash;
+          rsp.poolDigest = poolDigest;
+        }
+
+        if (rsp.topBlockId != req.knownBlockId || rsp.poolDigest != req.knownPoolDigest ||
+            std::chrono::steady_clock::now() >= deadline) {
+          break;
+        }
+
+        System::Timer(localDispatcher).sleep(std::chrono::milliseconds(10));
+      }
+
+      rsp.status = CORE_RPC_STATUS_OK;
+      response.setBody(storeToBinaryKeyValue(rsp));
+    } else {
+      response.setStatus(HttpResponse::STATUS_404);
+    }
+  }
+
+  std::mutex mutex;
+  Crypto::Hash topBlockHash;
+  uint32_t topBlockIndex;
+  Crypto::Hash poolDigest;
+  std::thread thread;
+  System::Dispatcher* dispatcher = nullptr;
+  System::Event* stopEvent = nullptr;
+  Logging::ConsoleLogger logger{Logging::ERROR};
+};
+
+class BlockchainUpdatesObserver : public INodeObserver {
+public:
+  virtual void localBlockchainUpdated(uint32_t height) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    lastHeight = height;
+    updated.notify_all();
+  }
+
+  bool waitForHeight(uint32_t height, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return updated.wait_for(lock, timeout, [&] { return lastHeight == height; });
+  }
+
+private:
+  std::mutex mutex;
+  std::condition_variable updated;
+  uint32_t lastHeight = 0;
+};
+
+class NodeRpcProxyTest : public ::testing::Test {
+public:
+  NodeRpcProxyTest() : logger(Logging::ERROR), proxy("127.0.0.1", FAKE_NODE_PORT, logger) {
+    proxy.addObserver(&observer);
+  }
+
+  ~NodeRpcProxyTest() {
+    proxy.shutdown();
+    proxy.removeObserver(&observer);
+  }
+
+  void initProxy(uint64_t pullInterval) {
+    proxy.pullInterval(pullInterval);
+    proxy.changesWaitTimeout(10000);
+
+    std::promise<std::error_code> initialized;
+    auto initializedFuture = initialized.get_future();
+    proxy.init([&initialized](std::error_code ec) { initialized.set_value(ec); });
+    ASSERT_FALSE(initializedFuture.get());
+    ASSERT_TRUE(observer.waitForHeight(1, std::chrono::seconds(5)));
+  }
+
+protected:
+  FakeNode node;
+  Logging::ConsoleLogger logger;
+  NodeRpcProxy proxy;
+  BlockchainUpdatesObserver observer;
+};
+
+}
+
+TEST_F(NodeRpcProxyTest, longPollWakesUpOnNewBlockBeforePullInterval) {
+  initProxy(60000);
+  while (node.waitForChangesRequests == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  node.setTopBlock(2);
+  ASSERT_TRUE(observer.waitForHeight(2, std::chrono::seconds(5)));
+}
+
+TEST_F(NodeRpcProxyTest, fallsBackToPollingIfNodeDoesNotSupportLongPoll) {
+  node.longPollSupported = false;
+  initProxy(100);
+
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  ASSERT_GE(node.lastBlockHeaderRequests.load(), 5);
+  ASSERT_LE(node.lastBlockHeaderRequests.load(), 20);
+
+  node.setTopBlock(2);
+  ASSERT_TRUE(observer.waitForHeight(2, std::chrono::seconds(5)));
+}
+
+TEST_F(NodeRpcProxyTest, doesNotLongPollWhilePoolRefreshFails) {
+  node.poolChangesFail = true;
+  node.setPoolDigest(Crypto::rand<Crypto::Hash>());
+  initProxy(100);
+
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  ASSERT_EQ(0, node.waitForChangesRequests.load());
+  ASSERT_LE(node.lastBlockHeaderRequests.load(), 20);
+}
+
+TEST_F(NodeRpcProxyTest, pollsAtPullIntervalIfRefreshDoesNotCatchUpWithLongPoll) {
+  node.setPoolDigest(Crypto::rand<Crypto::Hash>());
+  initProxy(100);
+
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  ASSERT_GE(node.waitForChangesRequests.load(), 1);
+  ASSERT_LE(node.waitForChangesRequests.load(), 20);
+  ASSERT_LE(node.lastBlockHeaderRequests.load(), 20);
+}
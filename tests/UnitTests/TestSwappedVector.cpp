@@ -0,0 +1,162 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include "CryptoNoteCore/CryptoNoteSerialization.h"
+#include "CryptoNoteCore/SwappedVector.h"
+
+#include <memory>
+
+#include <boost/filesystem/operations.hpp>
+
+using namespace CryptoNote;
+
+namespace {
+
+// items have different sizes so wrong offsets show up as wrong items
+RawBlock makeItem(uint8_t value) {
+  RawBlock item;
+  item.block.assign(value % 7 + 1, value);
+  item.transactions.assign(value % 3, BinaryArray(value % 5 + 1, value));
+  return item;
+}
+
+std::vector<RawBlock> makeItems(uint8_t firstValue, size_t count) {
+  std::vector<RawBlock> items;
+  for (size_t i = 0; i < count; ++i) {
+    items.push_back(makeItem(static_cast<uint8_t>(firstValue + i)));
+  }
+
+  return items;
+}
+
+class SwappedVectorTests : public ::testing::Test {
+public:
+  void SetUp() override {
+    m_dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("test_swapped_vector_%%%%%%%%%%%%");
+    boost::system::error_code ignoredErrorCode;
+    boost::filesystem::create_directory(m_dir, ignoredErrorCode);
+    ASSERT_TRUE(open());
+  }
+
+  void TearDown() override {
+    vector.reset();
+    boost::system::error_code ignoredErrorCode;
+    boost::filesystem::remove_all(m_dir, ignoredErrorCode);
+  }
+
+protected:
+  // pool is smaller than the batches, so some items are read back from the file
+  static const size_t POOL_SIZE = 3;
+
+  bool open() {
+    vector.reset(new SwappedVector<RawBlock>());
+    return vector->open((m_dir / "items.dat").string(), (m_dir / "indexes.dat").string(), POOL_SIZE);
+  }
+
+  // files are closed by the destructor only
+  void reopen() {
+    vector.reset();
+    ASSERT_TRUE(open());
+  }
+
+  void expectItems(const std::vector<RawBlock>& expected) {
+    ASSERT_EQ(expected.size(), vector->size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(expected[i].block, (*vector)[i].block) << "item " << i;
+      EXPECT_EQ(expected[i].transactions, (*vector)[i].transactions) << "item " << i;
+    }
+  }
+
+  boost::filesystem::path m_dir;
+  std::unique_ptr<SwappedVector<RawBlock>> vector;
+};
+
+TEST_F(SwappedVectorTests, pushBackManyAppendsItemsInOrder) {
+  std::vector<RawBlock> expected = makeItems(0, 2);
+  for (const auto& item : expected) {
+    vector->push_back(item);
+  }
+
+  auto items = makeItems(2, 10);
+  vector->push_back(items);
+  expected.insert(expected.end(), items.begin(), items.end());
+  expectItems(expected);
+
+  vector->push_back(makeItem(12));
+  expected.push_back(makeItem(12));
+  expectItems(expected);
+
+  reopen();
+  expectItems(expected);
+}
+
+TEST_F(SwappedVectorTests, pushBackManyWithNoItemsKeepsVector) {
+  auto expected = makeItems(0, 4);
+  vector->push_back(expected);
+  vector->push_back(std::vector<RawBlock>());
+
+  expectItems(expected);
+  reopen();
+  expectItems(expected);
+}
+
+TEST_F(SwappedVectorTests, popBackManyRemovesLastItems) {
+  auto expected = makeItems(0, 10);
+  vector->push_back(expected);
+  expectItems(expected);
+
+  vector->pop_back(4);
+  expected.resize(6);
+  expectItems(expected);
+
+  // new items overwrite the tail of the items file
+  auto items = makeItems(100, 5);
+  vector->push_back(items);
+  expected.insert(expected.end(), items.begin(), items.end());
+  expectItems(expected);
+
+  reopen();
+  expectItems(expected);
+}
+
+TEST_F(SwappedVectorTests, popBackManyCanRemoveAllItems) {
+  vector->push_back(makeItems(0, 5));
+  vector->pop_back(5);
+  ASSERT_TRUE(vector->empty());
+
+  reopen();
+  ASSERT_TRUE(vector->empty());
+}
+
+TEST_F(SwappedVectorTests, popBackZeroItemsKeepsVector) {
+  auto expected = makeItems(0, 5);
+  vector->push_back(expected);
+  vector->pop_back(0);
+  expectItems(expected);
+}
+
+TEST_F(SwappedVectorTests, popBackManyThrowsIfThereAreFewerItems) {
+  auto expected = makeItems(0, 5);
+  vector->push_back(expected);
+  ASSERT_THROW(vector->pop_back(6), std::runtime_error);
+  expectItems(expected);
+}
+
+}
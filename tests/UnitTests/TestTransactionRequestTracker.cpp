@@ -0,0 +1,152 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "CryptoNoteProtocol/TransactionRequestTracker.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const std::chrono::seconds TIMEOUT = std::chrono::seconds(30);
+
+Crypto::Hash makeHash(uint32_t value) {
+  Crypto::Hash hash = Crypto::Hash();
+  *reinterpret_cast<uint32_t*>(hash.data) = value + 1;
+  return hash;
+}
+
+net_connection_id makePeer(uint8_t value) {
+  net_connection_id peer = net_connection_id();
+  peer.data[0] = value + 1;
+  return peer;
+}
+
+class TransactionRequestTrackerTest : public testing::Test {
+public:
+  TransactionRequestTrackerTest() : tracker(TIMEOUT), now(std::chrono::steady_clock::now()) {
+  }
+
+protected:
+  TransactionRequestTracker tracker;
+  TransactionRequestTracker::TimePoint now;
+};
+
+}
+
+TEST_F(TransactionRequestTrackerTest, transactionIsRequestedFromFirstAnnouncerOnly) {
+  ASSERT_EQ(std::vector<Crypto::Hash>{makeHash(0)}, tracker.addAnnouncement(makePeer(0), {makeHash(0)}, now));
+  ASSERT_TRUE(tracker.addAnnouncement(makePeer(1), {makeHash(0)}, now).empty());
+  ASSERT_TRUE(tracker.isTracked(makeHash(0)));
+  ASSERT_EQ(1, tracker.size());
+}
+
+TEST_F(TransactionRequestTrackerTest, timedOutRequestIsRetriedFromNextAnnouncer) {
+  tracker.addAnnouncement(makePeer(0), {makeHash(0), makeHash(1)}, now);
+  tracker.addAnnouncement(makePeer(1), {makeHash(0)}, now);
+  tracker.addAnnouncement(makePeer(2), {makeHash(0), makeHash(1)}, now);
+
+  ASSERT_TRUE(tracker.expireRequests(now + TIMEOUT).empty());
+
+  auto retries = tracker.expireRequests(now + TIMEOUT + std::chrono::seconds(1));
+  ASSERT_EQ(2, retries.size());
+  ASSERT_EQ(std::vector<Crypto::Hash>{makeHash(0)}, retries[makePeer(1)]);
+  ASSERT_EQ(std::vector<Crypto::Hash>{makeHash(1)}, retries[makePeer(2)]);
+
+  retries = tracker.expireRequests(now + 2 * TIMEOUT + std::chrono::seconds(2));
+  ASSERT_EQ(1, retries.size());
+  ASSERT_EQ(std::vector<Crypto::Hash>{makeHash(0)}, retries[makePeer(2)]);
+  ASSERT_FALSE(tracker.isTracked(makeHash(1)));
+
+  ASSERT_TRUE(tracker.expireRequests(now + 3 * TIMEOUT + std::chrono::seconds(3)).empty());
+  ASSERT_EQ(0, tracker.size());
+}
+
+TEST_F(TransactionRequestTrackerTest, receivedTransactionIsNotRetried) {
+  tracker.addAnnouncement(makePeer(0), {makeHash(0)}, now);
+  tracker.addAnnouncement(makePeer(1), {makeHash(0)}, now);
+
+  tracker.removeTransaction(makeHash(0));
+
+  ASSERT_TRUE(tracker.expireRequests(now + 2 * TIMEOUT).empty());
+  ASSERT_EQ(0, tracker.size());
+}
+
+TEST_F(TransactionRequestTrackerTest, requestToDisconnectedPeerIsRetriedAtOnce) {
+  tracker.addAnnouncement(makePeer(0), {makeHash(0)}, now);
+  tracker.addAnnouncement(makePeer(1), {makeHash(0)}, now);
+  tracker.addAnnouncement(makePeer(2), {makeHash(0)}, now);
+
+  tracker.removePeer(makePeer(0));
+  tracker.removePeer(makePeer(1));
+
+  auto retries = tracker.expireRequests(now);
+  ASSERT_EQ(1, retries.size());
+  ASSERT_EQ(std::vector<Crypto::Hash>{makeHash(0)}, retries[makePeer(2)]);
+}
+
+TEST_F(TransactionRequestTrackerTest, announcerIsRememberedOnce) {
+  tracker.addAnnouncement(makePeer(0), {makeHash(0)}, now);
+  tracker.addAnnouncement(makePeer(1), {makeHash(0)}, now);
+  tracker.addAnnouncement(makePeer(1), {makeHash(0)}, now);
+  tracker.addAnnouncement(makePeer(0), {makeHash(0)}, now);
+
+  ASSERT_EQ(1, tracker.expireRequests(now + 2 * TIMEOUT).size());
+  ASSERT_TRUE(tracker.expireRequests(now + 4 * TIMEOUT).empty());
+  ASSERT_EQ(0, tracker.size());
+}
+
+TEST_F(TransactionRequestTrackerTest, announcersPerTransactionAreLimited) {
+  tracker.addAnnouncement(makePeer(0), {makeHash(0)}, now);
+  for (uint8_t i = 1; i <= TransactionRequestTracker::MAX_ANNOUNCERS + 5; ++i) {
+    tracker.addAnnouncement(makePeer(i), {makeHash(0)}, now);
+  }
+
+  size_t retryCount = 0;
+  for (size_t i = 1; tracker.size() != 0; ++i) {
+    retryCount += tracker.expireRequests(now + i * 2 * TIMEOUT).size();
+  }
+
+  ASSERT_EQ(TransactionRequestTracker::MAX_ANNOUNCERS, retryCount);
+}
+
+TEST_F(TransactionRequestTrackerTest, requestFromOneAnnouncementIsLimited) {
+  std::vector<Crypto::Hash> hashes;
+  for (uint32_t i = 0; i < TransactionRequestTracker::MAX_REQUEST_TRANSACTIONS + 10; ++i) {
+    hashes.push_back(makeHash(i));
+  }
+
+  ASSERT_EQ(TransactionRequestTracker::MAX_REQUEST_TRANSACTIONS, tracker.addAnnouncement(makePeer(0), hashes, now).size());
+  ASSERT_EQ(TransactionRequestTracker::MAX_REQUEST_TRANSACTIONS, tracker.size());
+  ASSERT_FALSE(tracker.isTracked(hashes.back()));
+}
+
+TEST_F(TransactionRequestTrackerTest, trackedTransactionsAreLimited) {
+  uint32_t value = 0;
+  for (uint8_t peer = 0; tracker.size() < TransactionRequestTracker::MAX_TRACKED_TRANSACTIONS; ++peer) {
+    std::vector<Crypto::Hash> hashes;
+    for (size_t i = 0; i < TransactionRequestTracker::MAX_REQUEST_TRANSACTIONS; ++i) {
+      hashes.push_back(makeHash(value++));
+    }
+
+    tracker.addAnnouncement(makePeer(peer), hashes, now);
+  }
+
+  ASSERT_TRUE(tracker.addAnnouncement(makePeer(0), {makeHash(value)}, now).empty());
+  ASSERT_EQ(TransactionRequestTracker::MAX_TRACKED_TRANSACTIONS, tracker.size());
+}
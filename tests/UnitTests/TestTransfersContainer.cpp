@@ -17,6 +17,9 @@
 
 #include "gtest/gtest.h"
 
+#include <limits>
+#include <sstream>
+
 #include "IWalletLegacy.h"
 
 #include "crypto/crypto.h"
@@ -731,6 +734,68 @@ TEST_F(TransfersContainer_balance, handlesTransferStateUnLocked) {
   ASSERT_EQ(AMOUNT_2, container.balance(ITransfersContainer::IncludeStateUnlocked | ITransfersContainer::IncludeTypeAll));
 }
 
+TEST_F(TransfersContainer_balance, movesTransfersBetweenStatesWhenHeightAdvances) {
+  const uint32_t unlockHeight = TEST_BLOCK_HEIGHT + 10;
+
+  TestTransactionBuilder tx1;
+  tx1.setUnlockTime(unlockHeight + currency.lockedTxAllowedDeltaBlocks());
+  tx1.addTestInput(AMOUNT_1 + 1);
+  auto outInfo = tx1.addTestKeyOutput(AMOUNT_1, TEST_TRANSACTION_OUTPUT_GLOBAL_INDEX, account);
+  ASSERT_TRUE(container.addTransaction(blockInfo(TEST_BLOCK_HEIGHT), *tx1.build(), { outInfo }));
+
+  auto tx2 = addTransaction(TEST_BLOCK_HEIGHT, AMOUNT_2);
+
+  ASSERT_EQ(AMOUNT_1, container.balance(ITransfersContainer::IncludeAllLocked & ~ITransfersContainer::IncludeStateSoftLocked));
+  ASSERT_EQ(AMOUNT_2, container.balance(ITransfersContainer::IncludeAllLocked & ~ITransfersContainer::IncludeStateLocked));
+
+  ASSERT_TRUE(container.advanceHeight(unlockHeight - 1));
+  ASSERT_EQ(AMOUNT_1, container.balance(ITransfersContainer::IncludeAllLocked));
+  ASSERT_EQ(AMOUNT_2, container.balance(ITransfersContainer::IncludeAllUnlocked));
+
+  ASSERT_TRUE(container.advanceHeight(unlockHeight));
+  ASSERT_EQ(0, container.balance(ITransfersContainer::IncludeAllLocked));
+  ASSERT_EQ(AMOUNT_1 + AMOUNT_2, container.balance(ITransfersContainer::IncludeAllUnlocked));
+}
+
+TEST_F(TransfersContainer_balance, detachLocksTransfersAgain) {
+  const uint32_t unlockHeight = TEST_BLOCK_HEIGHT + 10;
+
+  TestTransactionBuilder tx1;
+  tx1.setUnlockTime(unlockHeight + currency.lockedTxAllowedDeltaBlocks());
+  tx1.addTestInput(AMOUNT_1 + 1);
+  auto outInfo = tx1.addTestKeyOutput(AMOUNT_1, TEST_TRANSACTION_OUTPUT_GLOBAL_INDEX, account);
+  ASSERT_TRUE(container.addTransaction(blockInfo(TEST_BLOCK_HEIGHT), *tx1.build(), { outInfo }));
+
+  ASSERT_TRUE(container.advanceHeight(unlockHeight + 10));
+  auto tx2 = addTransaction(unlockHeight + 10, AMOUNT_2);
+  ASSERT_EQ(AMOUNT_1, container.balance(ITransfersContainer::IncludeAllUnlocked));
+  ASSERT_EQ(AMOUNT_2, container.balance(ITransfersContainer::IncludeAllLocked));
+
+  container.detach(unlockHeight - 1);
+
+  ASSERT_EQ(0, container.balance(ITransfersContainer::IncludeAllUnlocked));
+  ASSERT_EQ(AMOUNT_1, container.balance(ITransfersContainer::IncludeAllLocked));
+}
+
+TEST_F(TransfersContainer_balance, isRestoredAfterLoad) {
+  auto tx1 = addTransaction(TEST_CONTAINER_CURRENT_HEIGHT - TEST_TRANSACTION_SPENDABLE_AGE, AMOUNT_2);
+  auto tx2 = addTransaction(TEST_CONTAINER_CURRENT_HEIGHT, AMOUNT_1);
+  auto tx3 = addTransaction(WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT, AMOUNT_1 + AMOUNT_2);
+
+  std::stringstream stream;
+  container.save(stream);
+
+  TransfersContainer loadedContainer(currency, logger, TEST_TRANSACTION_SPENDABLE_AGE);
+  loadedContainer.load(stream);
+
+  ASSERT_EQ(AMOUNT_2, loadedContainer.balance(ITransfersContainer::IncludeStateUnlocked | ITransfersContainer::IncludeTypeAll));
+  ASSERT_EQ(AMOUNT_1, loadedContainer.balance(ITransfersContainer::IncludeStateSoftLocked | ITransfersContainer::IncludeTypeAll));
+  ASSERT_EQ(AMOUNT_1 + AMOUNT_2, loadedContainer.balance(ITransfersContainer::IncludeStateLocked | ITransfersContainer::IncludeTypeAll));
+
+  ASSERT_TRUE(loadedContainer.advanceHeight(TEST_CONTAINER_CURRENT_HEIGHT + 1));
+  ASSERT_EQ(AMOUNT_1 + AMOUNT_2, loadedContainer.balance(ITransfersContainer::IncludeStateUnlocked | ITransfersContainer::IncludeTypeAll));
+}
+
 //--------------------------------------------------------------------------- 
 // TransfersContainer_getOutputs
 //--------------------------------------------------------------------------- 
@@ -818,3 +883,88 @@ TEST_F(TransfersContainer_getOutputs, handlesTransferTypeKey) {
   ASSERT_EQ(1, transfers.size());
   ASSERT_EQ(AMOUNT_1, transfers.front().amount);
 }
+
+//--------------------------------------------------------------------------- 
+// TransfersContainer_getUnlockedOutput
+//--------------------------------------------------------------------------- 
+
+class TransfersContainer_getUnlockedOutput : public TransfersContainerTest {
+public:
+  enum TestAmounts : uint64_t {
+    AMOUNT_1 = 13,
+    AMOUNT_2 = 17,
+    AMOUNT_3 = 30
+  };
+};
+
+TEST_F(TransfersContainer_getUnlockedOutput, returnsOutputsOrderedByAmount) {
+  addTransaction(TEST_CONTAINER_CURRENT_HEIGHT - TEST_TRANSACTION_SPENDABLE_AGE, AMOUNT_2);
+  addTransaction(TEST_CONTAINER_CURRENT_HEIGHT - TEST_TRANSACTION_SPENDABLE_AGE, AMOUNT_3);
+  addTransaction(TEST_CONTAINER_CURRENT_HEIGHT - TEST_TRANSACTION_SPENDABLE_AGE, AMOUNT_1);
+  addTransaction(TEST_CONTAINER_CURRENT_HEIGHT, AMOUNT_1);
+
+  ASSERT_EQ(3, container.getUnlockedOutputsCount(0, std::numeric_limits<uint64_t>::max()));
+
+  TransactionOutputInformation output;
+  ASSERT_TRUE(container.getUnlockedOutput(0, std::numeric_limits<uint64_t>::max(), 0, output));
+  ASSERT_EQ(AMOUNT_1, output.amount);
+  ASSERT_TRUE(container.getUnlockedOutput(0, std::numeric_limits<uint64_t>::max(), 1, output));
+  ASSERT_EQ(AMOUNT_2, output.amount);
+  ASSERT_TRUE(container.getUnlockedOutput(0, std::numeric_limits<uint64_t>::max(), 2, output));
+  ASSERT_EQ(AMOUNT_3, output.amount);
+  ASSERT_FALSE(container.getUnlockedOutput(0, std::numeric_limits<uint64_t>::max(), 3, output));
+}
+
+TEST_F(TransfersContainer_getUnlockedOutput, returnsOutputsInAmountRange) {
+  addTransaction(TEST_CONTAINER_CURRENT_HEIGHT, AMOUNT_1);
+  addTransaction(TEST_CONTAINER_CURRENT_HEIGHT, AMOUNT_2);
+  addTransaction(TEST_CONTAINER_CURRENT_HEIGHT, AMOUNT_3);
+  container.advanceHeight(TEST_CONTAINER_CURRENT_HEIGHT + TEST_TRANSACTION_SPENDABLE_AGE);
+
+  ASSERT_EQ(1, container.getUnlockedOutputsCount(AMOUNT_1 + 1, AMOUNT_3 - 1));
+  ASSERT_EQ(2, container.getUnlockedOutputsCount(AMOUNT_1, AMOUNT_2));
+  ASSERT_EQ(0, container.getUnlockedOutputsCount(AMOUNT_3 + 1, std::numeric_limits<uint64_t>::max()));
+
+  TransactionOutputInformation output;
+  ASSERT_TRUE(container.getUnlockedOutput(AMOUNT_1 + 1, AMOUNT_3 - 1, 0, output));
+  ASSERT_EQ(AMOUNT_2, output.amount);
+  ASSERT_FALSE(container.getUnlockedOutput(AMOUNT_1 + 1, AMOUNT_3 - 1, 1, output));
+}
+
+TEST_F(TransfersContainer_getUnlockedOutput, followsHeightChanges) {
+  addTransaction(TEST_BLOCK_HEIGHT, AMOUNT_1);
+  ASSERT_EQ(0, container.getUnlockedOutputsCount(0, std::numeric_limits<uint64_t>::max()));
+
+  container.advanceHeight(TEST_BLOCK_HEIGHT + TEST_TRANSACTION_SPENDABLE_AGE);
+  ASSERT_EQ(1, container.getUnlockedOutputsCount(0, std::numeric_limits<uint64_t>::max()));
+
+  container.detach(TEST_BLOCK_HEIGHT);
+  ASSERT_EQ(0, container.getUnlockedOutputsCount(0, std::numeric_limits<uint64_t>::max()));
+}
+
+TEST_F(TransfersContainer_getUnlockedOutput, skipsSpentOutputs) {
+  auto tx = addTransaction(TEST_CONTAINER_CURRENT_HEIGHT - TEST_TRANSACTION_SPENDABLE_AGE, AMOUNT_2);
+  container.advanceHeight(TEST_CONTAINER_CURRENT_HEIGHT);
+  ASSERT_EQ(1, container.getUnlockedOutputsCount(0, std::numeric_limits<uint64_t>::max()));
+
+  addSpendingTransaction(tx->getTransactionHash(), TEST_CONTAINER_CURRENT_HEIGHT, 0, AMOUNT_2);
+  ASSERT_EQ(0, container.getUnlockedOutputsCount(0, std::numeric_limits<uint64_t>::max()));
+}
+
+TEST_F(TransfersContainer_getUnlockedOutput, includesOutputsUnlockedByTime) {
+  TestTransactionBuilder tx1;
+  tx1.setUnlockTime(time(nullptr) - 60 * 60 * 24);
+  tx1.addTestInput(AMOUNT_1 + 1);
+  auto outInfo = tx1.addTestKeyOutput(AMOUNT_1, TEST_TRANSACTION_OUTPUT_GLOBAL_INDEX, account);
+  ASSERT_TRUE(container.addTransaction(blockInfo(TEST_CONTAINER_CURRENT_HEIGHT - TEST_TRANSACTION_SPENDABLE_AGE), *tx1.build(), { outInfo }));
+  addTransaction(TEST_CONTAINER_CURRENT_HEIGHT - TEST_TRANSACTION_SPENDABLE_AGE, AMOUNT_3);
+  container.advanceHeight(TEST_CONTAINER_CURRENT_HEIGHT);
+
+  ASSERT_EQ(2, container.getUnlockedOutputsCount(0, std::numeric_limits<uint64_t>::max()));
+
+  TransactionOutputInformation output;
+  ASSERT_TRUE(container.getUnlockedOutput(0, std::numeric_limits<uint64_t>::max(), 0, output));
+  ASSERT_EQ(AMOUNT_3, output.amount);
+  ASSERT_TRUE(container.getUnlockedOutput(0, std::numeric_limits<uint64_t>::max(), 1, output));
+  ASSERT_EQ(AMOUNT_1, output.amount);
+}
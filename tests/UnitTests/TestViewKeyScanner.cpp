@@ -0,0 +1,149 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The MasterCoin developers
+//
+// This file is part of MasterCoin.
+//
+// MasterCoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// MasterCoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with MasterCoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include <System/Dispatcher.h>
+
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/TransactionApi.h"
+#include "Logging/ConsoleLogger.h"
+#include "Rpc/ViewKeyScanner.h"
+
+using namespace CryptoNote;
+
+class ViewKeyScannerTest : public testing::Test {
+public:
+  ViewKeyScannerTest() :
+    currency(CurrencyBuilder(logger).currency()),
+    scanner(dispatcher, 2, 10, 2) {
+    miner.generate();
+    receiver.generate();
+  }
+
+protected:
+  RawBlock makeBlock(uint32_t height, uint64_t receiverAmount) {
+    BlockTemplate block;
+    block.majorVersion = BLOCK_MAJOR_VERSION_1;
+    block.minorVersion = BLOCK_MINOR_VERSION_0;
+    block.timestamp = height;
+    block.previousBlockHash = NULL_HASH;
+    block.nonce = 0;
+    EXPECT_TRUE(currency.constructMinerTx(block.majorVersion, height, 0, 0, 0, 0, miner.getAccountKeys().address, block.baseTransaction));
+
+    auto transaction = createTransaction();
+    transaction->addOutput(receiverAmount, receiver.getAccountKeys().address);
+    block.transactionHashes.push_back(transaction->getTransactionHash());
+
+    RawBlock rawBlock;
+    rawBlock.block = toBinaryArray(block);
+    rawBlock.transactions.push_back(transaction->getTransactionData());
+    return rawBlock;
+  }
+
+  void addAccount(const AccountBase& account) {
+    scanner.addAccount(account.getAccountKeys().address, account.getAccountKeys().viewSecretKey);
+  }
+
+  Logging::ConsoleLogger logger;
+  Currency currency;
+  System::Dispatcher dispatcher;
+  ViewKeyScanner scanner;
+  AccountBase miner;
+  AccountBase receiver;
+};
+
+TEST_F(ViewKeyScannerTest, findsNothingWithoutAccounts) {
+  ASSERT_TRUE(scanner.scan(1, { makeBlock(1, 100) }).empty());
+}
+
+TEST_F(ViewKeyScannerTest, findsTransactionsOfRegisteredAccounts) {
+  addAccount(miner);
+  addAccount(receiver);
+
+  auto transactions = scanner.scan(1, { makeBlock(1, 100), makeBlock(2, 200) });
+  ASSERT_EQ(4, transactions.size());
+
+  for (size_t i = 0; i < transactions.size(); ++i) {
+    const auto& receiverKeys = (i % 2 == 0 ? miner : receiver).getAccountKeys();
+    ASSERT_EQ(1 + i / 2, transactions[i].blockIndex);
+    ASSERT_FALSE(transactions[i].outputs.empty());
+    ASSERT_EQ(receiverKeys.address.spendPublicKey, transactions[i].outputs.front().spendPublicKey);
+  }
+
+  ASSERT_EQ(200, transactions[3].transaction.txPrefix.outputs[transactions[3].outputs.front().outputIndex].amount);
+}
+
+TEST_F(ViewKeyScannerTest, doesNotReportUnregisteredAccount) {
+  addAccount(miner);
+  addAccount(receiver);
+
+  auto block = makeBlock(1, 100);
+  ASSERT_EQ(2, scanner.scan(1, { block }).size());
+
+  ASSERT_TRUE(scanner.removeAccount(receiver.getAccountKeys().address));
+  auto transactions = scanner.scan(1, { block });
+  ASSERT_EQ(1, transactions.size());
+  ASSERT_EQ(miner.getAccountKeys().address.spendPublicKey, transactions.front().outputs.front().spendPublicKey);
+  ASSERT_FALSE(scanner.removeAccount(receiver.getAccountKeys().address));
+}
+
+TEST_F(ViewKeyScannerTest, rejectsWrongViewKey) {
+  ASSERT_THROW(scanner.addAccount(miner.getAccountKeys().address, receiver.getAccountKeys().viewSecretKey), std::invalid_argument);
+  ASSERT_EQ(0, scanner.getAccountCount());
+}
+
+TEST_F(ViewKeyScannerTest, rejectsAccountsOverLimit) {
+  AccountBase third;
+  third.generate();
+
+  addAccount(miner);
+  addAccount(receiver);
+  ASSERT_THROW(addAccount(third), std::runtime_error);
+  ASSERT_EQ(2, scanner.getAccountCount());
+
+  ASSERT_NO_THROW(addAccount(miner));
+  ASSERT_TRUE(scanner.removeAccount(receiver.getAccountKeys().address));
+  ASSERT_NO_THROW(addAccount(third));
+  ASSERT_EQ(2, scanner.getAccountCount());
+}
+
+TEST_F(ViewKeyScannerTest, cachesScannedBlocks) {
+  addAccount(receiver);
+
+  auto block = makeBlock(1, 100);
+  auto transactions = scanner.scan(1, { block });
+  ASSERT_EQ(1, scanner.getCachedBlockCount());
+
+  auto cachedTransactions = scanner.scan(1, { block });
+  ASSERT_EQ(1, cachedTransactions.size());
+  ASSERT_EQ(transactions.front().transaction.txHash, cachedTransactions.front().transaction.txHash);
+
+  addAccount(miner);
+  ASSERT_EQ(0, scanner.getCachedBlockCount());
+  ASSERT_EQ(2, scanner.scan(1, { block }).size());
+}
+
+TEST_F(ViewKeyScannerTest, throwsOnInvalidBlock) {
+  addAccount(receiver);
+
+  RawBlock block;
+  block.block = { 1, 2, 3 };
+  ASSERT_THROW(scanner.scan(1, { block }), std::runtime_error);
+}
@@ -2976,6 +2976,63 @@ TEST_F(WalletApi_makeTransaction, ifFailedDoesNotSendTransactionCreatedEvent) {
   ASSERT_FALSE(eventContext.get());
 }
 
+TEST_F(WalletApi_makeTransaction, makeTransactionsCreatesDelayedTransactionsInOrder) {
+  generateAndUnlockMoney();
+
+  CryptoNote::TransactionParameters params;
+  params.sourceAddresses = {alice.getAddress(0)};
+  params.destinations = { CryptoNote::WalletOrder{ RANDOM_ADDRESS, SENT } };
+  params.fee = FEE;
+
+  auto ids = alice.makeTransactions({params, params});
+  ASSERT_EQ(2, ids.size());
+  ASSERT_LT(ids[0], ids[1]);
+  ASSERT_EQ(WalletTransactionState::CREATED, alice.getTransaction(ids[0]).state);
+  ASSERT_EQ(WalletTransactionState::CREATED, alice.getTransaction(ids[1]).state);
+  ASSERT_EQ(2, alice.getDelayedTransactionIds().size());
+}
+
+TEST_F(WalletApi_makeTransaction, makeTransactionsSpendsDistinctOutputs) {
+  generateAndUnlockMoney();
+
+  std::string sourceAddress = alice.getAddress(0);
+  uint64_t actualBefore = alice.getActualBalance(sourceAddress);
+
+  CryptoNote::TransactionParameters params;
+  params.sourceAddresses = {sourceAddress};
+  params.destinations = { CryptoNote::WalletOrder{ RANDOM_ADDRESS, SENT } };
+  params.fee = FEE;
+
+  auto ids = alice.makeTransactions({params, params});
+  waitForTransactionUpdated(alice, ids[1]);
+
+  ASSERT_GE(actualBefore - 2 * (SENT + FEE), alice.getActualBalance(sourceAddress));
+}
+
+TEST_F(WalletApi_makeTransaction, makeTransactionsCreatesNothingIfOneTransactionFails) {
+  generateAndUnlockMoney();
+
+  std::string sourceAddress = alice.getAddress(0);
+  uint64_t actualBefore = alice.getActualBalance(sourceAddress);
+  size_t transactionCountBefore = alice.getTransactionCount();
+
+  CryptoNote::TransactionParameters params;
+  params.sourceAddresses = {sourceAddress};
+  params.destinations = { CryptoNote::WalletOrder{ RANDOM_ADDRESS, SENT } };
+  params.fee = FEE;
+
+  CryptoNote::TransactionParameters bigParams = params;
+  bigParams.extra = getExtraForBigTransaction();
+
+  ASSERT_ANY_THROW(alice.makeTransactions({params, bigParams}));
+  ASSERT_EQ(actualBefore, alice.getActualBalance(sourceAddress));
+  ASSERT_TRUE(alice.getDelayedTransactionIds().empty());
+
+  // the first transaction is created and rolled back, the big one fails before it is created
+  ASSERT_EQ(transactionCountBefore + 1, alice.getTransactionCount());
+  ASSERT_EQ(CryptoNote::WalletTransactionState::FAILED, alice.getTransaction(transactionCountBefore).state);
+}
+
 namespace {
 
 class WalletApi_commitTransaction : public WalletApi {
@@ -94,6 +94,7 @@ struct IWalletBaseStub : public CryptoNote::IWallet, public CryptoNote::IFusionM
   virtual size_t transfer(const TransactionParameters& sendingTransaction) override { return 0; }
 
   virtual size_t makeTransaction(const TransactionParameters& sendingTransaction) override { return 0; }
+  virtual std::vector<size_t> makeTransactions(const std::vector<TransactionParameters>& sendingTransactions) override { return {}; }
   virtual void commitTransaction(size_t transactionId) override { }
   virtual void rollbackUncommitedTransaction(size_t transactionId) override { }
 